@@ -66,6 +66,22 @@ static struct bgp_table *bgp_connected_table[AFI_MAX];
 
 /* BGP nexthop lookup query client. */
 struct zclient *zlookup = NULL;
+
+/* Nexthop addresses zebra tracks for us (on the main zclient): as
+   long as zebra hasn't reported a change, their cache entries are
+   kept across scans instead of being looked up again, and a change
+   starts a scan at once. */
+struct bgp_nexthop_track
+{
+  u_char valid;
+  u_char stale;                 /* changed, or not registered */
+  u_int32_t metric;
+};
+
+static struct bgp_table *bgp_nexthop_track_table[AFI_MAX];
+static struct thread *bgp_scan_event_thread = NULL;
+
+extern struct zclient *zclient;
 
 /* Add nexthop to the end of the list.  */
 static void
@@ -212,6 +228,100 @@ bgp_nexthop_onlink (afi_t afi, struct attr *attr)
   return 0;
 }
 
+static struct bgp_table *
+bgp_nexthop_cache_other (afi_t afi)
+{
+  if (bgp_nexthop_cache_table[afi] == cache1_table[afi])
+    return cache2_table[afi];
+  return cache1_table[afi];
+}
+
+/* Take the entry of a tracked nexthop from the previous cache */
+static struct bgp_nexthop_cache *
+bgp_nexthop_cache_reuse (afi_t afi, struct prefix *p)
+{
+  struct bgp_node *trn, *oldrn;
+  struct bgp_nexthop_track *track;
+  struct bgp_nexthop_cache *bnc;
+
+  if (zclient == NULL || zclient->sock < 0)
+    return NULL;
+
+  trn = bgp_node_lookup (bgp_nexthop_track_table[afi], p);
+  if (trn == NULL)
+    return NULL;
+  bgp_unlock_node (trn);
+  track = trn->info;
+  if (track->stale)
+    return NULL;
+
+  oldrn = bgp_node_lookup (bgp_nexthop_cache_other (afi), p);
+  if (oldrn == NULL)
+    return NULL;
+  bnc = oldrn->info;
+  oldrn->info = NULL;
+  bgp_unlock_node (oldrn);
+  bgp_unlock_node (oldrn);
+
+  bnc->changed = 0;
+  bnc->metricchanged = 0;
+  return bnc;
+}
+
+/* Have zebra track a nexthop just looked up */
+static void
+bgp_nexthop_track (afi_t afi, struct prefix *p, struct bgp_nexthop_cache *bnc)
+{
+  struct bgp_node *trn;
+  struct bgp_nexthop_track *track;
+
+  trn = bgp_node_get (bgp_nexthop_track_table[afi], p);
+  if (trn->info)
+    {
+      track = trn->info;
+      bgp_unlock_node (trn);
+    }
+  else
+    {
+      track = XCALLOC (MTYPE_BGP_NEXTHOP_CACHE,
+                       sizeof (struct bgp_nexthop_track));
+      trn->info = track;
+      track->stale = 1;
+    }
+
+  track->valid = bnc->valid;
+  track->metric = bnc->metric;
+  if (track->stale && zclient && zclient->sock >= 0)
+    track->stale = zclient_nexthop_register (zclient, ZEBRA_NEXTHOP_REGISTER,
+                                             p) < 0;
+}
+
+/* Stop tracking the nexthops the scan didn't look up */
+static void
+bgp_nexthop_untrack_unused (afi_t afi)
+{
+  struct bgp_node *trn, *rn;
+
+  for (trn = bgp_table_top (bgp_nexthop_track_table[afi]); trn;
+       trn = bgp_route_next (trn))
+    {
+      if (trn->info == NULL)
+        continue;
+      rn = bgp_node_lookup (bgp_nexthop_cache_table[afi], &trn->p);
+      if (rn)
+        {
+          bgp_unlock_node (rn);
+          continue;
+        }
+
+      if (zclient && zclient->sock >= 0)
+        zclient_nexthop_register (zclient, ZEBRA_NEXTHOP_UNREGISTER, &trn->p);
+      XFREE (MTYPE_BGP_NEXTHOP_CACHE, trn->info);
+      trn->info = NULL;
+      bgp_unlock_node (trn);
+    }
+}
+
 #ifdef HAVE_IPV6
 /* Check specified next-hop is reachable or not. */
 static int
@@ -251,6 +361,8 @@ bgp_nexthop_lookup_ipv6 (struct peer *peer, struct bgp_info *ri, int *changed,
       bnc = rn->info;
       bgp_unlock_node (rn);
     }
+  else if ((bnc = bgp_nexthop_cache_reuse (AFI_IP6, &p)) != NULL)
+    rn->info = bnc;
   else
     {
       if (NULL == (bnc = zlookup_query_ipv6 (&attr->extra->mp_nexthop_global)))
@@ -282,6 +394,7 @@ bgp_nexthop_lookup_ipv6 (struct peer *peer, struct bgp_info *ri, int *changed,
 	    }
 	}
       rn->info = bnc;
+      bgp_nexthop_track (AFI_IP6, &p, bnc);
     }
 
   if (changed)
@@ -337,6 +450,8 @@ bgp_nexthop_lookup (afi_t afi, struct peer *peer, struct bgp_info *ri,
       bnc = rn->info;
       bgp_unlock_node (rn);
     }
+  else if ((bnc = bgp_nexthop_cache_reuse (AFI_IP, &p)) != NULL)
+    rn->info = bnc;
   else
     {
       if (NULL == (bnc = zlookup_query (addr)))
@@ -368,6 +483,7 @@ bgp_nexthop_lookup (afi_t afi, struct peer *peer, struct bgp_info *ri,
 	    }
 	}
       rn->info = bnc;
+      bgp_nexthop_track (AFI_IP, &p, bnc);
     }
 
   if (changed)
@@ -497,6 +613,8 @@ bgp_scan (afi_t afi, safi_t safi)
   else
     bgp_nexthop_cache_reset (cache1_table[afi]);
 
+  bgp_nexthop_untrack_unused (afi);
+
   if (BGP_DEBUG (events, EVENTS))
     {
       if (afi == AFI_IP)
@@ -525,6 +643,86 @@ bgp_scan_timer (struct thread *t)
   return 0;
 }
 
+/* Scan at once, zebra reported a nexthop change */
+static int
+bgp_scan_event (struct thread *t)
+{
+  bgp_scan_event_thread = NULL;
+
+  if (BGP_DEBUG (events, EVENTS))
+    zlog_debug ("Performing BGP scanning after a nexthop change");
+
+  bgp_scan (AFI_IP, SAFI_UNICAST);
+
+#ifdef HAVE_IPV6
+  bgp_scan (AFI_IP6, SAFI_UNICAST);
+#endif /* HAVE_IPV6 */
+
+  return 0;
+}
+
+/* ZEBRA_NEXTHOP_UPDATE: the resolution of a tracked nexthop */
+int
+bgp_nexthop_update (int command, struct zclient *zclient,
+                    zebra_size_t length)
+{
+  struct bgp_node *trn;
+  struct bgp_nexthop_track *track;
+  struct prefix p;
+  u_int32_t metric;
+  u_char valid;
+  char buf[INET6_ADDRSTRLEN];
+
+  valid = zebra_nexthop_update_read (zclient->ibuf, &p, &metric) > 0;
+  if (p.family != AF_INET && p.family != AF_INET6)
+    return -1;
+
+  trn = bgp_node_lookup (bgp_nexthop_track_table[family2afi (p.family)], &p);
+  if (trn == NULL)
+    return 0;
+  bgp_unlock_node (trn);
+  track = trn->info;
+
+  if (track->valid == valid && (! valid || track->metric == metric))
+    return 0;
+
+  if (BGP_DEBUG (events, EVENTS))
+    zlog_debug ("nexthop %s is now %s, metric %u",
+                inet_ntop (p.family, &p.u.prefix, buf, sizeof (buf)),
+                valid ? "reachable" : "unreachable", metric);
+
+  /* looked up again by the scan */
+  track->stale = 1;
+  if (bgp_scan_event_thread == NULL)
+    bgp_scan_event_thread = thread_add_event (master, bgp_scan_event,
+                                              NULL, 0);
+  return 0;
+}
+
+/* Connected to zebra again: register the tracked nexthops, until
+   zebra has answered they are looked up by the scans */
+void
+bgp_nexthop_zebra_connected (struct zclient *zclient)
+{
+  struct bgp_node *trn;
+  struct bgp_nexthop_track *track;
+  afi_t afi;
+
+  for (afi = AFI_IP; afi < AFI_MAX; afi++)
+    {
+      if (bgp_nexthop_track_table[afi] == NULL)
+        continue;
+      for (trn = bgp_table_top (bgp_nexthop_track_table[afi]); trn;
+           trn = bgp_route_next (trn))
+        if ((track = trn->info) != NULL)
+          {
+            zclient_nexthop_register (zclient, ZEBRA_NEXTHOP_REGISTER,
+                                      &trn->p);
+            track->stale = 1;
+          }
+    }
+}
+
 struct bgp_connected_ref
 {
   unsigned int refcnt;
@@ -1331,12 +1529,14 @@ bgp_scan_init (void)
   bgp_nexthop_cache_table[AFI_IP] = cache1_table[AFI_IP];
 
   bgp_connected_table[AFI_IP] = bgp_table_init (AFI_IP, SAFI_UNICAST);
+  bgp_nexthop_track_table[AFI_IP] = bgp_table_init (AFI_IP, SAFI_UNICAST);
 
 #ifdef HAVE_IPV6
   cache1_table[AFI_IP6] = bgp_table_init (AFI_IP6, SAFI_UNICAST);
   cache2_table[AFI_IP6] = bgp_table_init (AFI_IP6, SAFI_UNICAST);
   bgp_nexthop_cache_table[AFI_IP6] = cache1_table[AFI_IP6];
   bgp_connected_table[AFI_IP6] = bgp_table_init (AFI_IP6, SAFI_UNICAST);
+  bgp_nexthop_track_table[AFI_IP6] = bgp_table_init (AFI_IP6, SAFI_UNICAST);
 #endif /* HAVE_IPV6 */
 
   /* Make BGP scan thread. */
@@ -56,5 +56,8 @@ extern int bgp_multiaccess_check_v4 (struct in_addr, char *);
 extern int bgp_config_write_scan_time (struct vty *);
 extern int bgp_nexthop_onlink (afi_t, struct attr *);
 extern int bgp_nexthop_self (afi_t, struct attr *);
+struct zclient;
+extern int bgp_nexthop_update (int, struct zclient *, zebra_size_t);
+extern void bgp_nexthop_zebra_connected (struct zclient *);
 
 #endif /* _QUAGGA_BGP_NEXTHOP_H */
@@ -87,6 +87,11 @@ bgp_packet_set_size (struct stream *s)
 static void
 bgp_packet_add (struct peer *peer, struct stream *s)
 {
+  /* Packets are built in streams of BGP_MAX_PACKET_SIZE, but only
+     what they take is kept while queued. */
+  if (STREAM_SIZE (s) > stream_get_endp (s))
+    stream_resize (s, stream_get_endp (s));
+
   /* Add packet to the end of list. */
   stream_fifo_push (peer->obuf, s);
 }
@@ -233,7 +238,6 @@ static struct stream *
 bgp_update_packet_eor (struct peer *peer, afi_t afi, safi_t safi)
 {
   struct stream *s;
-  struct stream *packet;
 
   if (DISABLE_BGP_ANNOUNCE)
     return NULL;
@@ -266,10 +270,8 @@ bgp_update_packet_eor (struct peer *peer, afi_t afi, safi_t safi)
     }
 
   bgp_packet_set_size (s);
-  packet = stream_dup (s);
-  bgp_packet_add (peer, packet);
-  stream_free (s);
-  return packet;
+  bgp_packet_add (peer, s);
+  return s;
 }
 
 /* Make BGP withdraw packet.  */
@@ -361,7 +363,6 @@ bgp_default_update_send (struct peer *peer, struct attr *attr,
 			 afi_t afi, safi_t safi, struct peer *from)
 {
   struct stream *s;
-  struct stream *packet;
   struct prefix p;
   unsigned long pos;
   bgp_size_t total_attr_len;
@@ -410,16 +411,13 @@ bgp_default_update_send (struct peer *peer, struct attr *attr,
   /* Set size. */
   bgp_packet_set_size (s);
 
-  packet = stream_dup (s);
-  stream_free (s);
-
   /* Dump packet if debug option is set. */
 #ifdef DEBUG
-  /* bgp_packet_dump (packet); */
+  /* bgp_packet_dump (s); */
 #endif /* DEBUG */
 
   /* Add packet to the peer. */
-  bgp_packet_add (peer, packet);
+  bgp_packet_add (peer, s);
 
   BGP_WRITE_ON (peer->t_write, bgp_write, peer->fd);
 }
@@ -428,7 +426,6 @@ void
 bgp_default_withdraw_send (struct peer *peer, afi_t afi, safi_t safi)
 {
   struct stream *s;
-  struct stream *packet;
   struct prefix p;
   unsigned long pos;
   unsigned long cp;
@@ -488,16 +485,14 @@ bgp_default_withdraw_send (struct peer *peer, afi_t afi, safi_t safi)
 
   bgp_packet_set_size (s);
 
-  packet = stream_dup (s);
-  stream_free (s);
-
   /* Add packet to the peer. */
-  bgp_packet_add (peer, packet);
+  bgp_packet_add (peer, s);
 
   BGP_WRITE_ON (peer->t_write, bgp_write, peer->fd);
 }
 
-/* Get next packet to be written.  */
+/* Make the next packet to be written from the routes waiting to be
+   withdrawn or advertised, adding it to the queue.  */
 static struct stream *
 bgp_write_packet (struct peer *peer)
 {
@@ -506,10 +501,6 @@ bgp_write_packet (struct peer *peer)
   struct stream *s = NULL;
   struct bgp_advertise *adv;
 
-  s = stream_fifo_head (peer->obuf);
-  if (s)
-    return s;
-
   for (afi = AFI_IP; afi < AFI_MAX; afi++)
     for (safi = SAFI_UNICAST; safi < SAFI_MAX; safi++)
       {
@@ -595,8 +586,9 @@ bgp_write (struct thread *thread)
   struct peer *peer;
   u_char type;
   struct stream *s; 
-  int num;
-  unsigned int count = 0;
+  struct iovec iov[BGP_WRITE_PACKET_MAX];
+  int iovcnt;
+  size_t num;
 
   /* Yes first of all get peer pointer. */
   peer = THREAD_ARG (thread);
@@ -609,42 +601,49 @@ bgp_write (struct thread *thread)
       return 0;
     }
 
-  s = bgp_write_packet (peer);
-  if (!s)
+  /* Gather the queued packets, making more as there is room, so that
+     one writev() sends them without copying.  Nothing is sent after a
+     NOTIFY. */
+  for (s = stream_fifo_head (peer->obuf), iovcnt = 0;
+       iovcnt < (int) BGP_WRITE_PACKET_MAX; s = s->next)
+    {
+      if (s == NULL && (s = bgp_write_packet (peer)) == NULL)
+	break;
+      iov[iovcnt].iov_base = STREAM_PNT (s);
+      iov[iovcnt++].iov_len = STREAM_READABLE (s);
+      if (stream_getc_from (s, BGP_MARKER_SIZE + 2) == BGP_MSG_NOTIFY)
+	break;
+    }
+  if (iovcnt == 0)
     return 0;	/* nothing to send */
 
   sockopt_cork (peer->fd, 1);
 
-  /* Nonblocking write until TCP output buffer is full.  */
-  do
+  /* Nonblocking write of what the TCP output buffer takes.  */
+  if ((ssize_t) (num = writev (peer->fd, iov, iovcnt)) < 0)
     {
-      int writenum;
-
-      /* Number of bytes to be sent.  */
-      writenum = stream_get_endp (s) - stream_get_getp (s);
-
-      /* Call write() system call.  */
-      num = write (peer->fd, STREAM_PNT (s), writenum);
-      if (num < 0)
+      /* write failed either retry needed or error */
+      if (! ERRNO_IO_RETRY(errno))
 	{
-	  /* write failed either retry needed or error */
-	  if (ERRNO_IO_RETRY(errno))
-		break;
-
-          BGP_EVENT_ADD (peer, TCP_fatal_error);
+	  BGP_EVENT_ADD (peer, TCP_fatal_error);
 	  return 0;
 	}
+      num = 0;
+    }
 
-      if (num != writenum)
+  /* Account for and delete the packets written. */
+  while (num > 0 && (s = stream_fifo_head (peer->obuf)) != NULL)
+    {
+      if (num < STREAM_READABLE (s))
 	{
 	  /* Partial write */
 	  stream_forward_getp (s, num);
 	  break;
 	}
+      num -= STREAM_READABLE (s);
 
       /* Retrieve BGP packet type. */
-      stream_set_getp (s, BGP_MARKER_SIZE + 2);
-      type = stream_getc (s);
+      type = stream_getc_from (s, BGP_MARKER_SIZE + 2);
 
       switch (type)
 	{
@@ -681,8 +680,6 @@ bgp_write (struct thread *thread)
       /* OK we send packet so delete it. */
       bgp_packet_delete (peer);
     }
-  while (++count < BGP_WRITE_PACKET_MAX &&
-	 (s = bgp_write_packet (peer)) != NULL);
   
   if (bgp_write_proceed (peer))
     BGP_WRITE_ON (peer->t_write, bgp_write, peer->fd);
@@ -933,7 +930,6 @@ bgp_route_refresh_send (struct peer *peer, afi_t afi, safi_t safi,
 			u_char orf_type, u_char when_to_refresh, int remove)
 {
   struct stream *s;
-  struct stream *packet;
   int length;
   struct bgp_filter *filter;
   int orf_refresh = 0;
@@ -1014,12 +1010,8 @@ bgp_route_refresh_send (struct peer *peer, afi_t afi, safi_t safi,
 		 BGP_MSG_ROUTE_REFRESH_NEW : BGP_MSG_ROUTE_REFRESH_OLD, length);
     }
 
-  /* Make real packet. */
-  packet = stream_dup (s);
-  stream_free (s);
-
   /* Add packet to the peer. */
-  bgp_packet_add (peer, packet);
+  bgp_packet_add (peer, s);
 
   BGP_WRITE_ON (peer->t_write, bgp_write, peer->fd);
 }
@@ -1030,7 +1022,6 @@ bgp_capability_send (struct peer *peer, afi_t afi, safi_t safi,
 		     int capability_code, int action)
 {
   struct stream *s;
-  struct stream *packet;
   int length;
 
   /* Adjust safi code. */
@@ -1061,12 +1052,8 @@ bgp_capability_send (struct peer *peer, afi_t afi, safi_t safi,
   /* Set packet size. */
   length = bgp_packet_set_size (s);
 
-  /* Make real packet. */
-  packet = stream_dup (s);
-  stream_free (s);
-
   /* Add packet to the peer. */
-  bgp_packet_add (peer, packet);
+  bgp_packet_add (peer, s);
 
   if (BGP_DEBUG (normal, NORMAL))
     zlog_debug ("%s send message type %d, length (incl. header) %d",
@@ -210,7 +210,7 @@ route_match_ip_address (void *rule, struct prefix *prefix,
 
   if (type == RMAP_BGP)
     {
-      alist = access_list_lookup (AFI_IP, (char *) rule);
+      alist = access_list_ref_lookup (rule);
       if (alist == NULL)
 	return RMAP_NOMATCH;
     
@@ -225,14 +225,14 @@ route_match_ip_address (void *rule, struct prefix *prefix,
 static void *
 route_match_ip_address_compile (const char *arg)
 {
-  return XSTRDUP (MTYPE_ROUTE_MAP_COMPILED, arg);
+  return access_list_ref_new (AFI_IP, arg);
 }
 
 /* Free route map's compiled `ip address' value. */
 static void
 route_match_ip_address_free (void *rule)
 {
-  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+  access_list_ref_free (rule);
 }
 
 /* Route map commands for ip address matching. */
@@ -262,7 +262,7 @@ route_match_ip_next_hop (void *rule, struct prefix *prefix,
       p.prefix = bgp_info->attr->nexthop;
       p.prefixlen = IPV4_MAX_BITLEN;
 
-      alist = access_list_lookup (AFI_IP, (char *) rule);
+      alist = access_list_ref_lookup (rule);
       if (alist == NULL)
 	return RMAP_NOMATCH;
 
@@ -277,14 +277,14 @@ route_match_ip_next_hop (void *rule, struct prefix *prefix,
 static void *
 route_match_ip_next_hop_compile (const char *arg)
 {
-  return XSTRDUP (MTYPE_ROUTE_MAP_COMPILED, arg);
+  return access_list_ref_new (AFI_IP, arg);
 }
 
 /* Free route map's compiled `ip address' value. */
 static void
 route_match_ip_next_hop_free (void *rule)
 {
-  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+  access_list_ref_free (rule);
 }
 
 /* Route map commands for ip next-hop matching. */
@@ -320,7 +320,7 @@ route_match_ip_route_source (void *rule, struct prefix *prefix,
       p.prefix = peer->su.sin.sin_addr;
       p.prefixlen = IPV4_MAX_BITLEN;
 
-      alist = access_list_lookup (AFI_IP, (char *) rule);
+      alist = access_list_ref_lookup (rule);
       if (alist == NULL)
 	return RMAP_NOMATCH;
 
@@ -335,14 +335,14 @@ route_match_ip_route_source (void *rule, struct prefix *prefix,
 static void *
 route_match_ip_route_source_compile (const char *arg)
 {
-  return XSTRDUP (MTYPE_ROUTE_MAP_COMPILED, arg);
+  return access_list_ref_new (AFI_IP, arg);
 }
 
 /* Free route map's compiled `ip address' value. */
 static void
 route_match_ip_route_source_free (void *rule)
 {
-  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+  access_list_ref_free (rule);
 }
 
 /* Route map commands for ip route-source matching. */
@@ -364,7 +364,7 @@ route_match_ip_address_prefix_list (void *rule, struct prefix *prefix,
 
   if (type == RMAP_BGP)
     {
-      plist = prefix_list_lookup (AFI_IP, (char *) rule);
+      plist = prefix_list_ref_lookup (rule);
       if (plist == NULL)
 	return RMAP_NOMATCH;
     
@@ -377,13 +377,13 @@ route_match_ip_address_prefix_list (void *rule, struct prefix *prefix,
 static void *
 route_match_ip_address_prefix_list_compile (const char *arg)
 {
-  return XSTRDUP (MTYPE_ROUTE_MAP_COMPILED, arg);
+  return prefix_list_ref_new (AFI_IP, arg);
 }
 
 static void
 route_match_ip_address_prefix_list_free (void *rule)
 {
-  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+  prefix_list_ref_free (rule);
 }
 
 struct route_map_rule_cmd route_match_ip_address_prefix_list_cmd =
@@ -411,7 +411,7 @@ route_match_ip_next_hop_prefix_list (void *rule, struct prefix *prefix,
       p.prefix = bgp_info->attr->nexthop;
       p.prefixlen = IPV4_MAX_BITLEN;
 
-      plist = prefix_list_lookup (AFI_IP, (char *) rule);
+      plist = prefix_list_ref_lookup (rule);
       if (plist == NULL)
         return RMAP_NOMATCH;
 
@@ -424,13 +424,13 @@ route_match_ip_next_hop_prefix_list (void *rule, struct prefix *prefix,
 static void *
 route_match_ip_next_hop_prefix_list_compile (const char *arg)
 {
-  return XSTRDUP (MTYPE_ROUTE_MAP_COMPILED, arg);
+  return prefix_list_ref_new (AFI_IP, arg);
 }
 
 static void
 route_match_ip_next_hop_prefix_list_free (void *rule)
 {
-  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+  prefix_list_ref_free (rule);
 }
 
 struct route_map_rule_cmd route_match_ip_next_hop_prefix_list_cmd =
@@ -464,7 +464,7 @@ route_match_ip_route_source_prefix_list (void *rule, struct prefix *prefix,
       p.prefix = peer->su.sin.sin_addr;
       p.prefixlen = IPV4_MAX_BITLEN;
 
-      plist = prefix_list_lookup (AFI_IP, (char *) rule);
+      plist = prefix_list_ref_lookup (rule);
       if (plist == NULL)
         return RMAP_NOMATCH;
 
@@ -477,13 +477,13 @@ route_match_ip_route_source_prefix_list (void *rule, struct prefix *prefix,
 static void *
 route_match_ip_route_source_prefix_list_compile (const char *arg)
 {
-  return XSTRDUP (MTYPE_ROUTE_MAP_COMPILED, arg);
+  return prefix_list_ref_new (AFI_IP, arg);
 }
 
 static void
 route_match_ip_route_source_prefix_list_free (void *rule)
 {
-  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+  prefix_list_ref_free (rule);
 }
 
 struct route_map_rule_cmd route_match_ip_route_source_prefix_list_cmd =
@@ -1828,7 +1828,7 @@ route_match_ipv6_address (void *rule, struct prefix *prefix,
 
   if (type == RMAP_BGP)
     {
-      alist = access_list_lookup (AFI_IP6, (char *) rule);
+      alist = access_list_ref_lookup (rule);
       if (alist == NULL)
 	return RMAP_NOMATCH;
     
@@ -1841,13 +1841,13 @@ route_match_ipv6_address (void *rule, struct prefix *prefix,
 static void *
 route_match_ipv6_address_compile (const char *arg)
 {
-  return XSTRDUP (MTYPE_ROUTE_MAP_COMPILED, arg);
+  return access_list_ref_new (AFI_IP6, arg);
 }
 
 static void
 route_match_ipv6_address_free (void *rule)
 {
-  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+  access_list_ref_free (rule);
 }
 
 /* Route map commands for ip address matching. */
@@ -1931,7 +1931,7 @@ route_match_ipv6_address_prefix_list (void *rule, struct prefix *prefix,
 
   if (type == RMAP_BGP)
     {
-      plist = prefix_list_lookup (AFI_IP6, (char *) rule);
+      plist = prefix_list_ref_lookup (rule);
       if (plist == NULL)
 	return RMAP_NOMATCH;
     
@@ -1944,13 +1944,13 @@ route_match_ipv6_address_prefix_list (void *rule, struct prefix *prefix,
 static void *
 route_match_ipv6_address_prefix_list_compile (const char *arg)
 {
-  return XSTRDUP (MTYPE_ROUTE_MAP_COMPILED, arg);
+  return prefix_list_ref_new (AFI_IP6, arg);
 }
 
 static void
 route_match_ipv6_address_prefix_list_free (void *rule)
 {
-  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+  prefix_list_ref_free (rule);
 }
 
 struct route_map_rule_cmd route_match_ipv6_address_prefix_list_cmd =
@@ -97,7 +97,7 @@ bgp_interface_delete (int command, struct zclient *zclient,
 
   s = zclient->ibuf;
   ifp = zebra_interface_state_read (s);
-  ifp->ifindex = IFINDEX_INTERNAL;
+  if_set_index (ifp, IFINDEX_INTERNAL);
 
   if (BGP_DEBUG(zebra, ZEBRA))
     zlog_debug("Zebra rcvd: interface delete %s", ifp->name);
@@ -1077,6 +1077,8 @@ bgp_zebra_init (void)
   zclient->ipv4_route_delete = zebra_read_ipv4;
   zclient->interface_up = bgp_interface_up;
   zclient->interface_down = bgp_interface_down;
+  zclient->nexthop_update = bgp_nexthop_update;
+  zclient->zebra_connected = bgp_nexthop_zebra_connected;
 #ifdef HAVE_IPV6
   zclient->ipv6_route_add = zebra_read_ipv6;
   zclient->ipv6_route_delete = zebra_read_ipv6;
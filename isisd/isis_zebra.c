@@ -113,7 +113,7 @@ isis_zebra_if_del (int command, struct zclient *zclient, zebra_size_t length)
      in case there is configuration info attached to it. */
   if_delete_retain(ifp);
 
-  ifp->ifindex = IFINDEX_INTERNAL;
+  if_set_index (ifp, IFINDEX_INTERNAL);
 
   return 0;
 }
@@ -65,6 +65,8 @@ struct buffer_data
 
 #define BUFFER_DATA_FREE(D) XFREE(MTYPE_BUFFER_DATA, (D))
 
+struct buffer_stats buffer_stats;
+
 /* Make new buffer. */
 struct buffer *
 buffer_new (size_t size)
@@ -127,6 +129,18 @@ buffer_empty (struct buffer *b)
   return (b->head == NULL);
 }
 
+/* Return the number of bytes not yet flushed. */
+size_t
+buffer_length (struct buffer *b)
+{
+  struct buffer_data *d;
+  size_t length = 0;
+
+  for (d = b->head; d; d = d->next)
+    length += d->cp - d->sp;
+  return length;
+}
+
 /* Clear and free all allocated data. */
 void
 buffer_reset (struct buffer *b)
@@ -168,6 +182,8 @@ buffer_put(struct buffer *b, const void *p, size_t size)
   struct buffer_data *data = b->tail;
   const char *ptr = p;
 
+  buffer_stats.copied += size;
+
   /* We use even last one byte of data buffer. */
   while (size)    
     {
@@ -430,6 +446,8 @@ in one shot. */
 		__func__, fd, safe_strerror(errno));
       return BUFFER_ERROR;
     }
+  buffer_stats.writevs++;
+  buffer_stats.iovecs += iovcnt;
 
   /* Free printed buffer data. */
   while (written > 0)
@@ -486,6 +504,7 @@ buffer_write(struct buffer *b, int fd, const void *p, size_t size)
 	  return BUFFER_ERROR;
 	}
     }
+  buffer_stats.direct += nbytes;
   /* Add any remaining data to the buffer. */
   {
     size_t written = nbytes;
@@ -52,6 +52,9 @@ char *buffer_getstr (struct buffer *);
 /* Returns 1 if there is no pending data in the buffer.  Otherwise returns 0. */
 int buffer_empty (struct buffer *);
 
+/* Returns the number of bytes of pending data in the buffer. */
+extern size_t buffer_length (struct buffer *);
+
 typedef enum
   {
     /* An I/O error occurred.  The buffer should be destroyed and the
@@ -99,4 +102,15 @@ extern buffer_status_t buffer_flush_all (struct buffer *, int fd);
 extern buffer_status_t buffer_flush_window (struct buffer *, int fd, int width,
 					    int height, int erase, int no_more);
 
+/* What every buffer has done with the data given it. */
+struct buffer_stats
+{
+  unsigned long long copied;	/* bytes copied into buffer chunks */
+  unsigned long long direct;	/* bytes written without being queued */
+  unsigned long writevs;	/* writev() calls flushing queued data */
+  unsigned long iovecs;		/* chunks gathered by those calls */
+};
+
+extern struct buffer_stats buffer_stats;
+
 #endif /* _ZEBRA_BUFFER_H */
@@ -31,6 +31,7 @@ Boston, MA 02111-1307, USA.  */
 #include "command.h"
 #include "workqueue.h"
 #include "built.h"
+#include "telemetry.h"
 
 /* Command vector which includes some level of command lists. Normally
    each daemon maintains each own cmdvec. */
@@ -188,6 +189,133 @@ argv_concat (const char **argv, int argc, int shift)
   return str;
 }
 
+/* The commands of a node are also kept in a trie keyed by their
+   tokens, so that a line is matched against the few commands sharing
+   its leading tokens rather than against every command of the node.
+   Each edge is one token spec of a command, alternatives "(a|b)"
+   making one edge each.  A trie node at depth D holds the commands of
+   at least D tokens leading to it, and those of them with no mandatory
+   token left. */
+struct cmd_trie_edge
+{
+  const char *spec;
+  struct cmd_trie *next;
+};
+
+struct cmd_trie
+{
+  vector cmds;
+  vector complete;
+
+  /* Keyword edges sorted by spec, then the other ones. */
+  struct cmd_trie_edge *edges;
+  unsigned int keywords;
+  unsigned int count;
+};
+
+#define CMD_KEYWORD(S) \
+  (!CMD_OPTION (S) && !CMD_VARIABLE (S) && !CMD_VARARG (S))
+
+static struct cmd_trie *
+cmd_trie_new (void)
+{
+  struct cmd_trie *trie;
+
+  trie = XCALLOC (MTYPE_CMD_TRIE, sizeof (struct cmd_trie));
+  trie->cmds = vector_init (1);
+  trie->complete = vector_init (1);
+  return trie;
+}
+
+static void
+cmd_trie_free (struct cmd_trie *trie)
+{
+  unsigned int i;
+
+  for (i = 0; i < trie->count; i++)
+    cmd_trie_free (trie->edges[i].next);
+  if (trie->edges)
+    XFREE (MTYPE_CMD_TRIE_EDGES, trie->edges);
+  vector_free (trie->cmds);
+  vector_free (trie->complete);
+  XFREE (MTYPE_CMD_TRIE, trie);
+}
+
+/* Find the first keyword edge not sorting before TOKEN. */
+static unsigned int
+cmd_trie_keyword (struct cmd_trie *trie, const char *token)
+{
+  unsigned int lo = 0, hi = trie->keywords;
+
+  while (lo < hi)
+    {
+      unsigned int mid = (lo + hi) / 2;
+
+      if (strcmp (trie->edges[mid].spec, token) < 0)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return lo;
+}
+
+/* Return the node the edge for SPEC leads to, adding it if need be. */
+static struct cmd_trie *
+cmd_trie_next (struct cmd_trie *trie, const char *spec)
+{
+  unsigned int i;
+
+  if (CMD_KEYWORD (spec))
+    {
+      i = cmd_trie_keyword (trie, spec);
+      if (i < trie->keywords && strcmp (trie->edges[i].spec, spec) == 0)
+	return trie->edges[i].next;
+      trie->keywords++;
+    }
+  else
+    {
+      for (i = trie->keywords; i < trie->count; i++)
+	if (strcmp (trie->edges[i].spec, spec) == 0)
+	  return trie->edges[i].next;
+    }
+
+  trie->edges = XREALLOC (MTYPE_CMD_TRIE_EDGES, trie->edges,
+			  (trie->count + 1) * sizeof (struct cmd_trie_edge));
+  memmove (&trie->edges[i + 1], &trie->edges[i],
+	   (trie->count - i) * sizeof (struct cmd_trie_edge));
+  trie->count++;
+  trie->edges[i].spec = spec;
+  trie->edges[i].next = cmd_trie_new ();
+  return trie->edges[i].next;
+}
+
+/* Add CMD to TRIE, at DEPTH, and along its remaining tokens. */
+static void
+cmd_trie_insert (struct cmd_trie *trie, struct cmd_element *cmd,
+		 unsigned int depth)
+{
+  unsigned int i;
+  vector descvec;
+  struct desc *desc;
+
+  /* Two alternatives of the same spec lead here again. */
+  if (vector_active (trie->cmds)
+      && vector_slot (trie->cmds, vector_active (trie->cmds) - 1) == cmd)
+    return;
+
+  vector_set (trie->cmds, cmd);
+  if (depth >= cmd->cmdsize)
+    vector_set (trie->complete, cmd);
+
+  if (depth >= vector_active (cmd->strvec))
+    return;
+
+  descvec = vector_slot (cmd->strvec, depth);
+  for (i = 0; i < vector_active (descvec); i++)
+    if ((desc = vector_slot (descvec, i)) != NULL)
+      cmd_trie_insert (cmd_trie_next (trie, desc->cmd), cmd, depth + 1);
+}
+
 /* Install top node of command vector. */
 void
 install_node (struct cmd_node *node, 
@@ -196,6 +324,7 @@ install_node (struct cmd_node *node,
   vector_set_index (cmdvec, node->node, node);
   node->func = func;
   node->cmd_vector = vector_init (VECTOR_MIN_SIZE);
+  node->trie = cmd_trie_new ();
 }
 
 /* Compare two command's string.  Used in sort_node (). */
@@ -504,6 +633,8 @@ install_element (enum node_type ntype, struct cmd_element *cmd)
     cmd->strvec = cmd_make_descvec (cmd->string, cmd->doc);
 
   cmd->cmdsize = cmd_cmdsize (cmd->strvec);
+
+  cmd_trie_insert (cnode->trie, cmd, 0);
 }
 
 static const unsigned char itoa64[] =
@@ -539,6 +670,8 @@ zencrypt (const char *passwd)
 static int
 config_write_host (struct vty *vty)
 {
+  struct zlog_async_stats async;
+
   if (host.name)
     vty_out (vty, "hostname %s%s", host.name, VTY_NEWLINE);
 
@@ -609,6 +742,19 @@ config_write_host (struct vty *vty)
     vty_out (vty, "log timestamp precision %d%s",
 	     zlog_default->timestamp_precision, VTY_NEWLINE);
 
+  if (zlog_get_async_stats (zlog_default, &async))
+    {
+      vty_out (vty, "log asynchronous");
+      if (async.size != ZLOG_ASYNC_DEFAULT_SIZE)
+	vty_out (vty, " %u", async.size);
+      vty_out (vty, "%s", VTY_NEWLINE);
+    }
+
+  if (thread_latency)
+    vty_out (vty, "thread latency%s", VTY_NEWLINE);
+
+  telemetry_config_write (vty);
+
   if (host.advanced)
     vty_out (vty, "service advanced-vty%s", VTY_NEWLINE);
 
@@ -1247,114 +1393,6 @@ cmd_filter_by_completion (char *command, vector v, unsigned int index)
   return match_type;
 }
 
-/* Filter vector by command character with index. */
-static enum match_type
-cmd_filter_by_string (char *command, vector v, unsigned int index)
-{
-  unsigned int i;
-  const char *str;
-  struct cmd_element *cmd_element;
-  enum match_type match_type;
-  vector descvec;
-  struct desc *desc;
-
-  match_type = no_match;
-
-  /* If command and cmd_element string does not match set NULL to vector */
-  for (i = 0; i < vector_active (v); i++)
-    if ((cmd_element = vector_slot (v, i)) != NULL)
-      {
-	/* If given index is bigger than max string vector of command,
-	   set NULL */
-	if (index >= vector_active (cmd_element->strvec))
-	  vector_slot (v, i) = NULL;
-	else
-	  {
-	    unsigned int j;
-	    int matched = 0;
-
-	    descvec = vector_slot (cmd_element->strvec, index);
-
-	    for (j = 0; j < vector_active (descvec); j++)
-	      if ((desc = vector_slot (descvec, j)))
-		{
-		  str = desc->cmd;
-
-		  if (CMD_VARARG (str))
-		    {
-		      if (match_type < vararg_match)
-			match_type = vararg_match;
-		      matched++;
-		    }
-		  else if (CMD_RANGE (str))
-		    {
-		      if (cmd_range_match (str, command))
-			{
-			  if (match_type < range_match)
-			    match_type = range_match;
-			  matched++;
-			}
-		    }
-#ifdef HAVE_IPV6
-		  else if (CMD_IPV6 (str))
-		    {
-		      if (cmd_ipv6_match (command) == exact_match)
-			{
-			  if (match_type < ipv6_match)
-			    match_type = ipv6_match;
-			  matched++;
-			}
-		    }
-		  else if (CMD_IPV6_PREFIX (str))
-		    {
-		      if (cmd_ipv6_prefix_match (command) == exact_match)
-			{
-			  if (match_type < ipv6_prefix_match)
-			    match_type = ipv6_prefix_match;
-			  matched++;
-			}
-		    }
-#endif /* HAVE_IPV6  */
-		  else if (CMD_IPV4 (str))
-		    {
-		      if (cmd_ipv4_match (command) == exact_match)
-			{
-			  if (match_type < ipv4_match)
-			    match_type = ipv4_match;
-			  matched++;
-			}
-		    }
-		  else if (CMD_IPV4_PREFIX (str))
-		    {
-		      if (cmd_ipv4_prefix_match (command) == exact_match)
-			{
-			  if (match_type < ipv4_prefix_match)
-			    match_type = ipv4_prefix_match;
-			  matched++;
-			}
-		    }
-		  else if (CMD_OPTION (str) || CMD_VARIABLE (str))
-		    {
-		      if (match_type < extend_match)
-			match_type = extend_match;
-		      matched++;
-		    }
-		  else
-		    {
-		      if (strcmp (command, str) == 0)
-			{
-			  match_type = exact_match;
-			  matched++;
-			}
-		    }
-		}
-	    if (!matched)
-	      vector_slot (v, i) = NULL;
-	  }
-      }
-  return match_type;
-}
-
 /* Check ambiguous match */
 static int
 is_cmd_ambiguous (char *command, vector v, int index, enum match_type type)
@@ -2001,86 +2039,276 @@ node_parent ( enum node_type node )
   return ret;
 }
 
-/* Execute command by argument vline vector. */
+/* How SPEC, an argument rather than a keyword, matches TOKEN, as
+   cmd_filter_by_completion () judges it.  If STRICT, addresses must
+   be complete. */
+static enum match_type
+cmd_trie_arg_match (const char *spec, const char *token, int strict)
+{
+  enum match_type match;
+
+  if (CMD_VARARG (spec))
+    return vararg_match;
+  if (CMD_RANGE (spec))
+    return cmd_range_match (spec, token) ? range_match : no_match;
+#ifdef HAVE_IPV6
+  if (CMD_IPV6 (spec))
+    {
+      match = cmd_ipv6_match (token);
+      return (strict ? match == exact_match : match != no_match)
+	? ipv6_match : no_match;
+    }
+  if (CMD_IPV6_PREFIX (spec))
+    {
+      match = cmd_ipv6_prefix_match (token);
+      return (strict ? match == exact_match : match != no_match)
+	? ipv6_prefix_match : no_match;
+    }
+#endif /* HAVE_IPV6 */
+  if (CMD_IPV4 (spec))
+    {
+      match = cmd_ipv4_match (token);
+      return (strict ? match == exact_match : match != no_match)
+	? ipv4_match : no_match;
+    }
+  if (CMD_IPV4_PREFIX (spec))
+    {
+      match = cmd_ipv4_prefix_match (token);
+      return (strict ? match == exact_match : match != no_match)
+	? ipv4_prefix_match : no_match;
+    }
+  return extend_match;
+}
+
+/* Whether a command with SPEC for TOKEN stays a candidate once the
+   best match of the token is TYPE, as in is_cmd_ambiguous (). */
 static int
-cmd_execute_command_real (vector vline, struct vty *vty,
-			  struct cmd_element **cmd)
+cmd_trie_keeps (const char *spec, const char *token, enum match_type type)
+{
+  switch (type)
+    {
+    case exact_match:
+      return !(CMD_OPTION (spec) || CMD_VARIABLE (spec))
+	&& strcmp (token, spec) == 0;
+    case partly_match:
+      return !(CMD_OPTION (spec) || CMD_VARIABLE (spec))
+	&& strncmp (token, spec, strlen (token)) == 0;
+    case range_match:
+      return cmd_range_match (spec, token);
+#ifdef HAVE_IPV6
+    case ipv6_match:
+      return CMD_IPV6 (spec);
+    case ipv6_prefix_match:
+      return 1;
+#endif /* HAVE_IPV6 */
+    case ipv4_match:
+      return CMD_IPV4 (spec);
+    case ipv4_prefix_match:
+      return 1;
+    case extend_match:
+      return CMD_OPTION (spec) || CMD_VARIABLE (spec);
+    case no_match:
+    default:
+      return 0;
+    }
+}
+
+/* Note the commands of V as candidates.  Only whether there are none,
+   one or more distinct ones matters. */
+static void
+cmd_trie_candidates (vector v, struct cmd_element **matched,
+		     unsigned int *count)
 {
   unsigned int i;
-  unsigned int index;
-  vector cmd_vector;
-  struct cmd_element *cmd_element;
-  struct cmd_element *matched_element;
-  unsigned int matched_count, incomplete_count;
-  int argc;
-  const char *argv[CMD_ARGC_MAX];
-  enum match_type match = 0;
-  int varflag;
-  char *command;
+  struct cmd_element *cmd;
 
-  /* Make copy of command elements. */
-  cmd_vector = vector_copy (cmd_node_vector (cmdvec, vty->node));
+  for (i = 0; i < vector_active (v); i++)
+    if ((cmd = vector_slot (v, i)) != NULL)
+      {
+	if (*matched == NULL)
+	  {
+	    *matched = cmd;
+	    *count = 1;
+	  }
+	else if (cmd != *matched)
+	  *count = 2;
+      }
+}
+
+/* Find the command of CNODE that VLINE names, keywords abbreviated
+   unless STRICT.  The result is the one filtering the whole command
+   vector of the node token by token with cmd_filter_by_completion ()
+   and is_cmd_ambiguous () would give, but each token is only checked
+   against the edges of the trie nodes the tokens before led to, so
+   matching takes time in the number of tokens rather than of the
+   commands of the node. */
+static int
+cmd_trie_match (struct cmd_node *cnode, vector vline, int strict,
+		struct cmd_element **matched)
+{
+  vector frontier, next, hits, tmp;
+  unsigned int nfrontier, nnext, nhits;
+  unsigned int index, i, j;
+  unsigned int count = 0;
+  int incomplete = 0;
+  int ret = CMD_SUCCESS;
+
+  *matched = NULL;
+  frontier = vector_init (VECTOR_MIN_SIZE);
+  next = vector_init (VECTOR_MIN_SIZE);
+  hits = vector_init (VECTOR_MIN_SIZE);
+  nfrontier = 0;
+  vector_set_index (frontier, nfrontier++, cnode->trie);
 
   for (index = 0; index < vector_active (vline); index++)
-    if ((command = vector_slot (vline, index)))
-      {
-	int ret;
+    {
+      char *command = vector_slot (vline, index);
+      enum match_type match = no_match;
+      const char *ambiguous = NULL;
 
-	match = cmd_filter_by_completion (command, cmd_vector, index);
+      /* The edges of the frontier matching the token, and the best
+	 match among them. */
+      nhits = 0;
+      for (i = 0; i < nfrontier; i++)
+	{
+	  struct cmd_trie *trie = vector_slot (frontier, i);
 
-	if (match == vararg_match)
-	  break;
-        
-	ret = is_cmd_ambiguous (command, cmd_vector, index, match);
+	  /* A missing token matches anything. */
+	  if (command == NULL)
+	    {
+	      for (j = 0; j < trie->count; j++)
+		vector_set_index (hits, nhits++, &trie->edges[j]);
+	      continue;
+	    }
 
-	if (ret == 1)
-	  {
-	    vector_free (cmd_vector);
-	    return CMD_ERR_AMBIGUOUS;
-	  }
-	else if (ret == 2)
-	  {
-	    vector_free (cmd_vector);
-	    return CMD_ERR_NO_MATCH;
-	  }
-      }
+	  for (j = cmd_trie_keyword (trie, command); j < trie->keywords; j++)
+	    {
+	      const char *spec = trie->edges[j].spec;
+
+	      if (strcmp (spec, command) == 0)
+		match = exact_match;
+	      else if (strict
+		       || strncmp (command, spec, strlen (command)) != 0)
+		break;
+	      else if (match < partly_match)
+		match = partly_match;
+	      vector_set_index (hits, nhits++, &trie->edges[j]);
+	    }
 
-  /* Check matched count. */
-  matched_element = NULL;
-  matched_count = 0;
-  incomplete_count = 0;
+	  for (j = trie->keywords; j < trie->count; j++)
+	    {
+	      enum match_type m;
+
+	      m = cmd_trie_arg_match (trie->edges[j].spec, command, strict);
+	      if (m == no_match)
+		continue;
+	      if (match < m)
+		match = m;
+	      vector_set_index (hits, nhits++, &trie->edges[j]);
+	    }
+	}
 
-  for (i = 0; i < vector_active (cmd_vector); i++)
-    if ((cmd_element = vector_slot (cmd_vector, i)))
-      {
-	if (match == vararg_match || index >= cmd_element->cmdsize)
-	  {
-	    matched_element = cmd_element;
-#if 0
-	    printf ("DEBUG: %s\n", cmd_element->string);
-#endif
-	    matched_count++;
-	  }
-	else
-	  {
-	    incomplete_count++;
-	  }
-      }
+      if (command == NULL)
+	match = extend_match;
 
-  /* Finish of using cmd_vector. */
-  vector_free (cmd_vector);
+      if (nhits == 0)
+	{
+	  ret = CMD_ERR_NO_MATCH;
+	  goto done;
+	}
+
+      /* A variable number of arguments ends matching: every command
+	 still taking the token is a candidate. */
+      if (match == vararg_match)
+	{
+	  for (i = 0; i < nhits; i++)
+	    {
+	      struct cmd_trie_edge *edge = vector_slot (hits, i);
+
+	      cmd_trie_candidates (edge->next->cmds, matched, &count);
+	    }
+	  goto found;
+	}
+
+      if ((match == ipv4_prefix_match
+	   && cmd_ipv4_prefix_match (command) == partly_match)
+#ifdef HAVE_IPV6
+	  || (match == ipv6_prefix_match
+	      && cmd_ipv6_prefix_match (command) == partly_match)
+#endif /* HAVE_IPV6 */
+	  )
+	{
+	  ret = CMD_ERR_NO_MATCH;
+	  goto done;
+	}
+
+      /* Follow the edges as good as the best match. */
+      nnext = 0;
+      for (i = 0; i < nhits; i++)
+	{
+	  struct cmd_trie_edge *edge = vector_slot (hits, i);
+
+	  if (command != NULL && !cmd_trie_keeps (edge->spec, command, match))
+	    continue;
+
+	  if (match == partly_match || match == range_match)
+	    {
+	      if (ambiguous && strcmp (ambiguous, edge->spec) != 0)
+		{
+		  ret = CMD_ERR_AMBIGUOUS;
+		  goto done;
+		}
+	      ambiguous = edge->spec;
+	    }
+	  vector_set_index (next, nnext++, edge->next);
+	}
+
+      tmp = frontier;
+      frontier = next;
+      next = tmp;
+      nfrontier = nnext;
+    }
 
-  /* To execute command, matched_count must be 1. */
-  if (matched_count == 0)
+  /* The line is a command if one command with no mandatory token left
+     is reached. */
+  for (i = 0; i < nfrontier; i++)
     {
-      if (incomplete_count)
-	return CMD_ERR_INCOMPLETE;
-      else
-	return CMD_ERR_NO_MATCH;
+      struct cmd_trie *trie = vector_slot (frontier, i);
+
+      cmd_trie_candidates (trie->complete, matched, &count);
+      if (vector_active (trie->cmds) > vector_active (trie->complete))
+	incomplete = 1;
     }
 
-  if (matched_count > 1)
-    return CMD_ERR_AMBIGUOUS;
+ found:
+  if (count == 0)
+    ret = incomplete ? CMD_ERR_INCOMPLETE : CMD_ERR_NO_MATCH;
+  else if (count > 1)
+    ret = CMD_ERR_AMBIGUOUS;
+
+ done:
+  vector_free (frontier);
+  vector_free (next);
+  vector_free (hits);
+  return ret;
+}
+
+/* Execute command by argument vline vector. */
+static int
+cmd_execute_command_real (vector vline, struct vty *vty,
+			  struct cmd_element **cmd)
+{
+  unsigned int i;
+  struct cmd_element *matched_element;
+  int argc;
+  const char *argv[CMD_ARGC_MAX];
+  int varflag;
+  int ret;
+
+  ret = cmd_trie_match (vector_slot (cmdvec, vty->node), vline, 0,
+			&matched_element);
+  if (ret != CMD_SUCCESS)
+    return ret;
 
   /* Argument treatment */
   varflag = 0;
@@ -2190,77 +2418,16 @@ cmd_execute_command_strict (vector vline, struct vty *vty,
 			    struct cmd_element **cmd)
 {
   unsigned int i;
-  unsigned int index;
-  vector cmd_vector;
-  struct cmd_element *cmd_element;
   struct cmd_element *matched_element;
-  unsigned int matched_count, incomplete_count;
   int argc;
   const char *argv[CMD_ARGC_MAX];
   int varflag;
-  enum match_type match = 0;
-  char *command;
-
-  /* Make copy of command element */
-  cmd_vector = vector_copy (cmd_node_vector (cmdvec, vty->node));
-
-  for (index = 0; index < vector_active (vline); index++)
-    if ((command = vector_slot (vline, index)))
-      {
-	int ret;
-	
-	match = cmd_filter_by_string (vector_slot (vline, index),
-				      cmd_vector, index);
-
-	/* If command meets '.VARARG' then finish matching. */
-	if (match == vararg_match)
-	  break;
-        
-	ret = is_cmd_ambiguous (command, cmd_vector, index, match);
-	if (ret == 1)
-	  {
-	    vector_free (cmd_vector);
-	    return CMD_ERR_AMBIGUOUS;
-	  }
-	if (ret == 2)
-	  {
-	    vector_free (cmd_vector);
-	    return CMD_ERR_NO_MATCH;
-	  }
-      }
-
-  /* Check matched count. */
-  matched_element = NULL;
-  matched_count = 0;
-  incomplete_count = 0;
-  for (i = 0; i < vector_active (cmd_vector); i++)
-    if (vector_slot (cmd_vector, i) != NULL)
-      {
-	cmd_element = vector_slot (cmd_vector, i);
-
-	if (match == vararg_match || index >= cmd_element->cmdsize)
-	  {
-	    matched_element = cmd_element;
-	    matched_count++;
-	  }
-	else
-	  incomplete_count++;
-      }
-
-  /* Finish of using cmd_vector. */
-  vector_free (cmd_vector);
-
-  /* To execute command, matched_count must be 1. */
-  if (matched_count == 0)
-    {
-      if (incomplete_count)
-	return CMD_ERR_INCOMPLETE;
-      else
-	return CMD_ERR_NO_MATCH;
-    }
+  int ret;
 
-  if (matched_count > 1)
-    return CMD_ERR_AMBIGUOUS;
+  ret = cmd_trie_match (vector_slot (cmdvec, vty->node), vline, 1,
+			&matched_element);
+  if (ret != CMD_SUCCESS)
+    return ret;
 
   /* Argument treatment */
   varflag = 0;
@@ -3089,6 +3256,7 @@ DEFUN (show_logging,
        "Show current logging configuration\n")
 {
   struct zlog *zl = zlog_default;
+  struct zlog_async_stats async;
 
   vty_out (vty, "Syslog logging: ");
   if (zl->maxlvl[ZLOG_DEST_SYSLOG] == ZLOG_DISABLED)
@@ -3132,6 +3300,17 @@ DEFUN (show_logging,
   vty_out (vty, "Timestamp precision: %d%s",
 	   zl->timestamp_precision, VTY_NEWLINE);
 
+  vty_out (vty, "Asynchronous logging: ");
+  if (!zlog_get_async_stats (zl, &async))
+    vty_out (vty, "disabled%s", VTY_NEWLINE);
+  else
+    {
+      vty_out (vty, "queue depth %u of %u, at most %u%s",
+	       async.depth, async.size, async.maxdepth, VTY_NEWLINE);
+      vty_out (vty, "  %lu messages queued, %lu written, %lu dropped%s",
+	       async.queued, async.written, async.dropped, VTY_NEWLINE);
+    }
+
   return CMD_SUCCESS;
 }
 
@@ -3486,6 +3665,60 @@ DEFUN (no_config_log_timestamp_precision,
   return CMD_SUCCESS;
 }
 
+DEFUN (config_log_async,
+       config_log_async_cmd,
+       "log asynchronous",
+       "Logging control\n"
+       "Write log messages from a separate thread\n")
+{
+  if (!zlog_set_async (NULL, ZLOG_ASYNC_DEFAULT_SIZE))
+    {
+      vty_out (vty, "%% Asynchronous logging is not available%s",
+	       VTY_NEWLINE);
+      return CMD_WARNING;
+    }
+  return CMD_SUCCESS;
+}
+
+DEFUN (config_log_async_size,
+       config_log_async_size_cmd,
+       "log asynchronous <16-4096>",
+       "Logging control\n"
+       "Write log messages from a separate thread\n"
+       "Number of messages queued before new ones are dropped\n")
+{
+  unsigned int size;
+
+  VTY_GET_INTEGER_RANGE ("queue size", size, argv[0], 16,
+			 ZLOG_ASYNC_MAX_SIZE);
+  if (!zlog_set_async (NULL, size))
+    {
+      vty_out (vty, "%% Asynchronous logging is not available%s",
+	       VTY_NEWLINE);
+      return CMD_WARNING;
+    }
+  return CMD_SUCCESS;
+}
+
+DEFUN (no_config_log_async,
+       no_config_log_async_cmd,
+       "no log asynchronous",
+       NO_STR
+       "Logging control\n"
+       "Write log messages from a separate thread\n")
+{
+  zlog_set_async (NULL, 0);
+  return CMD_SUCCESS;
+}
+
+ALIAS (no_config_log_async,
+       no_config_log_async_size_cmd,
+       "no log asynchronous <16-4096>",
+       NO_STR
+       "Logging control\n"
+       "Write log messages from a separate thread\n"
+       "Number of messages queued before new ones are dropped\n")
+
 DEFUN (banner_motd_file,
        banner_motd_file_cmd,
        "banner motd file [FILE]",
@@ -3659,6 +3892,10 @@ cmd_init (int terminal)
       install_element (CONFIG_NODE, &no_config_log_record_priority_cmd);
       install_element (CONFIG_NODE, &config_log_timestamp_precision_cmd);
       install_element (CONFIG_NODE, &no_config_log_timestamp_precision_cmd);
+      install_element (CONFIG_NODE, &config_log_async_cmd);
+      install_element (CONFIG_NODE, &config_log_async_size_cmd);
+      install_element (CONFIG_NODE, &no_config_log_async_cmd);
+      install_element (CONFIG_NODE, &no_config_log_async_size_cmd);
       install_element (CONFIG_NODE, &service_password_encrypt_cmd);
       install_element (CONFIG_NODE, &no_service_password_encrypt_cmd);
       install_element (CONFIG_NODE, &banner_motd_default_cmd);
@@ -3672,6 +3909,14 @@ cmd_init (int terminal)
       install_element (RESTRICTED_NODE, &show_thread_cpu_cmd);
       
       install_element (ENABLE_NODE, &clear_thread_cpu_cmd);
+      install_element (VIEW_NODE, &show_thread_latency_cmd);
+      install_element (ENABLE_NODE, &show_thread_latency_cmd);
+      install_element (RESTRICTED_NODE, &show_thread_latency_cmd);
+      install_element (VIEW_NODE, &show_thread_lanes_cmd);
+      install_element (ENABLE_NODE, &show_thread_lanes_cmd);
+      install_element (RESTRICTED_NODE, &show_thread_lanes_cmd);
+      install_element (CONFIG_NODE, &config_thread_latency_cmd);
+      install_element (CONFIG_NODE, &no_config_thread_latency_cmd);
       install_element (VIEW_NODE, &show_work_queues_cmd);
       install_element (ENABLE_NODE, &show_work_queues_cmd);
     }
@@ -3721,6 +3966,8 @@ cmd_terminate ()
                 }
 
             vector_free (cmd_node_v);
+            cmd_trie_free (cmd_node->trie);
+            cmd_node->trie = NULL;
           }
 
       vector_free (cmdvec);
@@ -123,6 +123,8 @@ enum node_type
 #endif  /* QUAGGA_MULTICAST */
 };
 
+struct cmd_trie;
+
 /* Node which has some commands and prompt string and configuration
    function pointer . */
 struct cmd_node 
@@ -141,6 +143,9 @@ struct cmd_node
 
   /* Vector of this node's command list. */
   vector cmd_vector;	
+
+  /* The same commands indexed by their tokens, to match lines. */
+  struct cmd_trie *trie;
 };
 
 enum
@@ -111,6 +111,10 @@ static struct access_master access_master_ipv6 =
 };
 #endif /* HAVE_IPV6 */
 
+/* Bumped whenever an access list is added or deleted, so that
+   access_list_ref lookups are redone. */
+static unsigned int access_list_generation = 1;
+
 static struct access_master *
 access_master_get (afi_t afi)
 {
@@ -263,6 +267,7 @@ access_list_delete (struct access_list *access)
     XFREE (MTYPE_TMP, access->remark);
 
   access_list_free (access);
+  access_list_generation++;
 }
 
 /* Insert new access list to list of access_list.  Each acceess_list
@@ -285,6 +290,7 @@ access_list_insert (afi_t afi, const char *name)
   access = access_list_new ();
   access->name = XSTRDUP (MTYPE_ACCESS_LIST_STR, name);
   access->master = master;
+  access_list_generation++;
 
   /* If name is made by all digit character.  We treat it as
      number. */
@@ -382,6 +388,39 @@ access_list_lookup (afi_t afi, const char *name)
   return NULL;
 }
 
+/* Reference access list NAME, which need not exist yet. */
+struct access_list_ref *
+access_list_ref_new (afi_t afi, const char *name)
+{
+  struct access_list_ref *ref;
+
+  ref = XCALLOC (MTYPE_ACCESS_LIST_REF, sizeof (struct access_list_ref));
+  ref->afi = afi;
+  ref->name = XSTRDUP (MTYPE_ACCESS_LIST_STR, name);
+  return ref;
+}
+
+void
+access_list_ref_free (struct access_list_ref *ref)
+{
+  XFREE (MTYPE_ACCESS_LIST_STR, ref->name);
+  XFREE (MTYPE_ACCESS_LIST_REF, ref);
+}
+
+/* The access list referenced, or NULL if there is none by its name.
+   This is access_list_lookup() without the walk through the lists
+   when none have been added or deleted since the last time. */
+struct access_list *
+access_list_ref_lookup (struct access_list_ref *ref)
+{
+  if (ref->generation != access_list_generation)
+    {
+      ref->access = access_list_lookup (ref->afi, ref->name);
+      ref->generation = access_list_generation;
+    }
+  return ref->access;
+}
+
 /* Get access list from list of access_list.  If there isn't matched
    access_list create new one and return it. */
 static struct access_list *
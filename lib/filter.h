@@ -56,6 +56,16 @@ struct access_list
   struct filter *tail;
 };
 
+/* An access list named by a route map rule or the like.  The name is
+   looked up again only after access lists have been added or deleted. */
+struct access_list_ref
+{
+  afi_t afi;
+  char *name;
+  struct access_list *access;
+  unsigned int generation;
+};
+
 /* Prototypes for access-list. */
 extern void access_list_init (void);
 extern void access_list_reset (void);
@@ -63,5 +73,8 @@ extern void access_list_add_hook (void (*func)(struct access_list *));
 extern void access_list_delete_hook (void (*func)(struct access_list *));
 extern struct access_list *access_list_lookup (afi_t, const char *);
 extern enum filter_type access_list_apply (struct access_list *, void *);
+extern struct access_list_ref *access_list_ref_new (afi_t, const char *);
+extern void access_list_ref_free (struct access_list_ref *);
+extern struct access_list *access_list_ref_lookup (struct access_list_ref *);
 
 #endif /* _ZEBRA_FILTER_H */
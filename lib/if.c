@@ -35,10 +35,16 @@
 #include "buffer.h"
 #include "str.h"
 #include "log.h"
+#include "hash.h"
 
 /* Master list of interfaces. */
 struct list *iflist;
 
+/* Interfaces by name and, if not IFINDEX_INTERNAL, by index; iflist
+   stays sorted by name for display. */
+static struct hash *if_name_hash;
+static struct hash *if_index_hash;
+
 /* One for each program.  This structure is needed to store hooks. */
 struct if_master
 {
@@ -111,6 +117,64 @@ if_cmp_func (struct interface *ifp1, struct interface *ifp2)
   return 0;
 }
 
+static unsigned int
+if_name_hash_key (void *data)
+{
+  return string_hash_make (((struct interface *) data)->name);
+}
+
+static int
+if_name_hash_cmp (const void *a, const void *b)
+{
+  return strcmp (((const struct interface *) a)->name,
+		 ((const struct interface *) b)->name) == 0;
+}
+
+static unsigned int
+if_index_hash_key (void *data)
+{
+  return ((struct interface *) data)->ifindex;
+}
+
+static int
+if_index_hash_cmp (const void *a, const void *b)
+{
+  return ((const struct interface *) a)->ifindex ==
+    ((const struct interface *) b)->ifindex;
+}
+
+/* Remove ifp from an index, unless another interface has its key. */
+static void
+if_hash_release (struct hash *hash, struct interface *ifp)
+{
+  if (hash_lookup (hash, ifp) == ifp)
+    hash_release (hash, ifp);
+}
+
+/* Change the index of an interface. */
+void
+if_set_index (struct interface *ifp, unsigned int ifindex)
+{
+  struct interface *oifp;
+
+  if (ifp->ifindex == ifindex)
+    return;
+
+  if (ifp->ifindex != IFINDEX_INTERNAL)
+    if_hash_release (if_index_hash, ifp);
+
+  ifp->ifindex = ifindex;
+
+  if (ifindex != IFINDEX_INTERNAL)
+    {
+      /* the most recent holder of an index wins, as the kernel's does */
+      oifp = hash_lookup (if_index_hash, ifp);
+      if (oifp)
+	hash_release (if_index_hash, oifp);
+      hash_get (if_index_hash, ifp, hash_alloc_intern);
+    }
+}
+
 /* Create new interface structure. */
 struct interface *
 if_create (const char *name, int namelen)
@@ -125,7 +189,10 @@ if_create (const char *name, int namelen)
   strncpy (ifp->name, name, namelen);
   ifp->name[namelen] = '\0';
   if (if_lookup_by_name(ifp->name) == NULL)
-    listnode_add_sort (iflist, ifp);
+    {
+      listnode_add_sort (iflist, ifp);
+      hash_get (if_name_hash, ifp, hash_alloc_intern);
+    }
   else
     zlog_err("if_create(%s): corruption detected -- interface with this "
 	     "name exists already!", ifp->name);
@@ -154,6 +221,9 @@ void
 if_delete (struct interface *ifp)
 {
   listnode_delete (iflist, ifp);
+  if_hash_release (if_name_hash, ifp);
+  if (ifp->ifindex != IFINDEX_INTERNAL)
+    if_hash_release (if_index_hash, ifp);
 
   if_delete_retain(ifp);
 
@@ -183,7 +253,13 @@ struct interface *
 if_lookup_by_index (unsigned int index)
 {
   struct listnode *node;
-  struct interface *ifp;
+  struct interface *ifp, key;
+
+  if (index != IFINDEX_INTERNAL)
+    {
+      key.ifindex = index;
+      return hash_lookup (if_index_hash, &key);
+    }
 
   for (ALL_LIST_ELEMENTS_RO(iflist, node, ifp))
     {
@@ -215,33 +291,22 @@ ifname2ifindex (const char *name)
 struct interface *
 if_lookup_by_name (const char *name)
 {
-  struct listnode *node;
-  struct interface *ifp;
-  
   if (name)
-    for (ALL_LIST_ELEMENTS_RO (iflist, node, ifp))
-      {
-        if (strcmp(name, ifp->name) == 0)
-          return ifp;
-      }
+    return if_lookup_by_name_len (name, strlen (name));
   return NULL;
 }
 
 struct interface *
 if_lookup_by_name_len(const char *name, size_t namelen)
 {
-  struct listnode *node;
-  struct interface *ifp;
+  struct interface key;
 
   if (namelen > INTERFACE_NAMSIZ)
     return NULL;
 
-  for (ALL_LIST_ELEMENTS_RO (iflist, node, ifp))
-    {
-      if (!memcmp(name, ifp->name, namelen) && (ifp->name[namelen] == '\0'))
-	return ifp;
-    }
-  return NULL;
+  memcpy (key.name, name, namelen);
+  key.name[namelen] = '\0';
+  return hash_lookup (if_name_hash, &key);
 }
 
 /* Lookup interface by IPv4 address. */
@@ -873,6 +938,8 @@ void
 if_init (void)
 {
   iflist = list_new ();
+  if_name_hash = hash_create (if_name_hash_key, if_name_hash_cmp);
+  if_index_hash = hash_create (if_index_hash_key, if_index_hash_cmp);
 #if 0
   ifaddr_ipv4_table = route_table_init ();
 #endif /* ifaddr_ipv4_table */
@@ -901,4 +968,8 @@ if_terminate (void)
 
   list_delete (iflist);
   iflist = NULL;
+
+  hash_free (if_name_hash);
+  hash_free (if_index_hash);
+  if_name_hash = if_index_hash = NULL;
 }
@@ -34,6 +34,9 @@
 #ifdef HAVE_UCONTEXT_H
 #include <ucontext.h>
 #endif
+#ifdef HAVE_PTHREADS
+#include <pthread.h>
+#endif /* HAVE_PTHREADS */
 
 static int logfile_fd = -1;	/* Used in signal handler. */
 
@@ -151,32 +154,425 @@ time_print(FILE *fp, struct timestamp_control *ctl)
 }
   
 
-/* va_list version of zlog. */
+#ifdef HAVE_PTHREADS
+/* Asynchronous logging.  Messages are formatted once, by the thread
+   logging them, into a bounded queue (after D. Vyukov's multi-producer
+   queue, so that nothing is locked on the way in) and written to
+   syslog, the log file and stdout by a writer thread, one flush per
+   batch.  When the queue is full messages are counted and dropped. */
+
+#define ZLOG_ASYNC_TEXTSIZ	1024	/* longest line queued */
+#define ZLOG_ASYNC_BATCH	256	/* most lines written per flush */
+
+struct zlog_async_slot
+{
+  volatile unsigned long seq;	/* position the slot is ready for */
+  int priority;
+  int dests;			/* bit per zlog_dest_t */
+  size_t bodyoff;		/* message after timestamp and names */
+  size_t len;
+  char text[ZLOG_ASYNC_TEXTSIZ];
+};
+
+struct zlog_async
+{
+  struct zlog *zl;
+  unsigned int size;		/* a power of 2 */
+  struct zlog_async_slot *slots;
+
+  volatile unsigned long head;	/* next position to fill */
+  volatile unsigned long tail;	/* next position to write */
+  unsigned int maxdepth;
+  unsigned long dropped;
+
+  pthread_t thread;
+  int running;
+  volatile int stop;
+  volatile int waiting;		/* writer is waiting for messages */
+
+  /* Held while writing, so that the log file can be changed safely. */
+  pthread_mutex_t mutex;
+  pthread_mutex_t wake_mutex;
+  pthread_cond_t wake;
+};
+
+/* The queue pthread_atfork() handlers look after. */
+static struct zlog_async *zlog_async_active = NULL;
+
+static int
+zlog_async_pending (struct zlog_async *q)
+{
+  return q->slots[q->tail & (q->size - 1)].seq == q->tail + 1;
+}
+
+/* Write up to a batch of queued messages, returning how many. */
+static unsigned int
+zlog_async_write (struct zlog_async *q)
+{
+  struct zlog *zl = q->zl;
+  int dests = 0;
+  unsigned int n;
+
+  pthread_mutex_lock (&q->mutex);
+  for (n = 0; n < ZLOG_ASYNC_BATCH && zlog_async_pending (q); n++)
+    {
+      struct zlog_async_slot *slot = &q->slots[q->tail & (q->size - 1)];
+
+      __sync_synchronize ();
+
+      if (slot->dests & (1 << ZLOG_DEST_SYSLOG))
+	syslog (slot->priority|zl->facility, "%s",
+		slot->text + slot->bodyoff);
+      if ((slot->dests & (1 << ZLOG_DEST_FILE)) && zl->fp)
+	{
+	  fwrite (slot->text, 1, slot->len, zl->fp);
+	  fputc ('\n', zl->fp);
+	}
+      if (slot->dests & (1 << ZLOG_DEST_STDOUT))
+	{
+	  fwrite (slot->text, 1, slot->len, stdout);
+	  fputc ('\n', stdout);
+	}
+      dests |= slot->dests;
+
+      __sync_synchronize ();
+      slot->seq = q->tail + q->size;
+      q->tail++;
+    }
+
+  if ((dests & (1 << ZLOG_DEST_FILE)) && zl->fp)
+    fflush (zl->fp);
+  if (dests & (1 << ZLOG_DEST_STDOUT))
+    fflush (stdout);
+  pthread_mutex_unlock (&q->mutex);
+
+  return n;
+}
+
+static void *
+zlog_async_writer (void *arg)
+{
+  struct zlog_async *q = arg;
+
+  for (;;)
+    {
+      if (zlog_async_write (q))
+	continue;
+
+      pthread_mutex_lock (&q->wake_mutex);
+      q->waiting = 1;
+      __sync_synchronize ();
+      if (!zlog_async_pending (q))
+	{
+	  if (q->stop)
+	    {
+	      q->waiting = 0;
+	      pthread_mutex_unlock (&q->wake_mutex);
+	      break;
+	    }
+	  pthread_cond_wait (&q->wake, &q->wake_mutex);
+	}
+      q->waiting = 0;
+      pthread_mutex_unlock (&q->wake_mutex);
+    }
+
+  return NULL;
+}
+
 static void
-vzlog (struct zlog *zl, int priority, const char *format, va_list args)
+zlog_async_wakeup (struct zlog_async *q)
 {
-  struct timestamp_control tsctl;
-  tsctl.already_rendered = 0;
+  pthread_mutex_lock (&q->wake_mutex);
+  pthread_cond_signal (&q->wake);
+  pthread_mutex_unlock (&q->wake_mutex);
+}
+
+static int
+zlog_async_start (struct zlog_async *q)
+{
+  sigset_t sigs, oldsigs;
+  int ret;
+
+  /* Leave signals to the main thread. */
+  sigfillset (&sigs);
+  pthread_sigmask (SIG_SETMASK, &sigs, &oldsigs);
+  q->stop = 0;
+  ret = pthread_create (&q->thread, NULL, zlog_async_writer, q);
+  pthread_sigmask (SIG_SETMASK, &oldsigs, NULL);
+  if (ret)
+    return 0;
+
+  q->running = 1;
+  return 1;
+}
+
+/* Stop the writer thread once everything queued is written. */
+static void
+zlog_async_stop (struct zlog_async *q)
+{
+  if (!q->running)
+    return;
+
+  pthread_mutex_lock (&q->wake_mutex);
+  q->stop = 1;
+  pthread_cond_signal (&q->wake);
+  pthread_mutex_unlock (&q->wake_mutex);
+  pthread_join (q->thread, NULL);
+  q->running = 0;
+}
+
+/* Threads do not survive fork(), and daemon() is called after the
+   configuration is read: have the queue emptied beforehand and the
+   writer started again in the child when it next has work. */
+static void
+zlog_async_prepare (void)
+{
+  struct zlog_async *q = zlog_async_active;
+
+  if (q == NULL || !q->running)
+    return;
+
+  while (q->tail != q->head)
+    {
+      zlog_async_wakeup (q);
+      usleep (1000);
+    }
+  pthread_mutex_lock (&q->mutex);
+}
+
+static void
+zlog_async_parent (void)
+{
+  struct zlog_async *q = zlog_async_active;
+
+  if (q == NULL || !q->running)
+    return;
+
+  pthread_mutex_unlock (&q->mutex);
+}
+
+static void
+zlog_async_child (void)
+{
+  struct zlog_async *q = zlog_async_active;
+
+  if (q == NULL || !q->running)
+    return;
+
+  pthread_mutex_init (&q->mutex, NULL);
+  pthread_mutex_init (&q->wake_mutex, NULL);
+  pthread_cond_init (&q->wake, NULL);
+  q->waiting = 0;
+  q->running = 0;
+}
+
+/* Queue the syslog, file and stdout output of a message.  Returns 0
+   if the message must be written by the caller instead. */
+static int
+zlog_async_log (struct zlog *zl, int priority, const char *format,
+		va_list args, struct timestamp_control *tsctl)
+{
+  struct zlog_async *q = zl->async;
+  struct zlog_async_slot *slot;
+  unsigned long pos, depth;
+  int dests = 0;
+  va_list ac;
+  int len;
+
+  if (priority <= zl->maxlvl[ZLOG_DEST_SYSLOG])
+    dests |= 1 << ZLOG_DEST_SYSLOG;
+  if ((priority <= zl->maxlvl[ZLOG_DEST_FILE]) && zl->fp)
+    dests |= 1 << ZLOG_DEST_FILE;
+  if (priority <= zl->maxlvl[ZLOG_DEST_STDOUT])
+    dests |= 1 << ZLOG_DEST_STDOUT;
+  if (!dests)
+    return 1;
+
+  if (!q->running && !zlog_async_start (q))
+    return 0;
+
+  /* Claim a slot. */
+  pos = q->head;
+  for (;;)
+    {
+      long diff;
+
+      slot = &q->slots[pos & (q->size - 1)];
+      diff = (long) (slot->seq - pos);
+      __sync_synchronize ();
+      if (diff == 0)
+	{
+	  if (__sync_bool_compare_and_swap (&q->head, pos, pos + 1))
+	    break;
+	}
+      else if (diff < 0)
+	{
+	  __sync_fetch_and_add (&q->dropped, 1);
+	  return 1;
+	}
+      pos = q->head;
+    }
+
+  slot->priority = priority;
+  slot->dests = dests;
+  len = 0;
+  if (dests & ((1 << ZLOG_DEST_FILE) | (1 << ZLOG_DEST_STDOUT)))
+    {
+      if (!tsctl->already_rendered)
+	{
+	  tsctl->len = quagga_timestamp (tsctl->precision, tsctl->buf,
+					 sizeof (tsctl->buf));
+	  tsctl->already_rendered = 1;
+	}
+      len = snprintf (slot->text, sizeof (slot->text), "%s %s%s%s: ",
+		      tsctl->buf,
+		      zl->record_priority ? zlog_priority[priority] : "",
+		      zl->record_priority ? ": " : "",
+		      zlog_proto_names[zl->protocol]);
+      if (len < 0 || (size_t) len >= sizeof (slot->text))
+	len = 0;
+    }
+  slot->bodyoff = len;
+  va_copy (ac, args);
+  len = vsnprintf (slot->text + slot->bodyoff,
+		   sizeof (slot->text) - slot->bodyoff, format, ac);
+  va_end (ac);
+  if (len < 0)
+    len = 0;
+  slot->len = MIN (slot->bodyoff + len, sizeof (slot->text) - 1);
+
+  __sync_synchronize ();
+  slot->seq = pos + 1;
+
+  depth = pos + 1 - q->tail;
+  if (depth > q->maxdepth)
+    q->maxdepth = depth;
+
+  __sync_synchronize ();
+  if (q->waiting)
+    zlog_async_wakeup (q);
+
+  return 1;
+}
+#endif /* HAVE_PTHREADS */
+
+/* Keep the writer thread away from the log file while it changes. */
+static void
+zlog_file_lock (struct zlog *zl)
+{
+#ifdef HAVE_PTHREADS
+  if (zl->async)
+    pthread_mutex_lock (&zl->async->mutex);
+#endif /* HAVE_PTHREADS */
+}
+
+static void
+zlog_file_unlock (struct zlog *zl)
+{
+#ifdef HAVE_PTHREADS
+  if (zl->async)
+    pthread_mutex_unlock (&zl->async->mutex);
+#endif /* HAVE_PTHREADS */
+}
+
+int
+zlog_set_async (struct zlog *zl, unsigned int size)
+{
+#ifdef HAVE_PTHREADS
+  static int atfork = 0;
+  struct zlog_async *q;
+  unsigned int i;
 
-  /* If zlog is not specified, use default one. */
   if (zl == NULL)
     zl = zlog_default;
+  if (size > ZLOG_ASYNC_MAX_SIZE)
+    size = ZLOG_ASYNC_MAX_SIZE;
 
-  /* When zlog_default is also NULL, use stderr for logging. */
-  if (zl == NULL)
+  if ((q = zl->async) != NULL)
     {
-      tsctl.precision = 0;
-      time_print(stderr, &tsctl);
-      fprintf (stderr, "%s: ", "unknown");
-      vfprintf (stderr, format, args);
-      fprintf (stderr, "\n");
-      fflush (stderr);
+      if (q->size >= size && q->size / 2 < size)
+	return 1;
+
+      zlog_async_stop (q);
+      zl->async = NULL;
+      if (zlog_async_active == q)
+	zlog_async_active = NULL;
+      pthread_cond_destroy (&q->wake);
+      pthread_mutex_destroy (&q->wake_mutex);
+      pthread_mutex_destroy (&q->mutex);
+      XFREE (MTYPE_ZLOG_ASYNC, q->slots);
+      XFREE (MTYPE_ZLOG_ASYNC, q);
+    }
 
-      /* In this case we return at here. */
-      return;
+  if (size == 0)
+    return 1;
+
+  if (!atfork)
+    {
+      if (pthread_atfork (zlog_async_prepare, zlog_async_parent,
+			  zlog_async_child))
+	return 0;
+      atfork = 1;
     }
-  tsctl.precision = zl->timestamp_precision;
 
+  q = XCALLOC (MTYPE_ZLOG_ASYNC, sizeof (struct zlog_async));
+  q->zl = zl;
+  for (q->size = 1; q->size < size; q->size <<= 1)
+    ;
+  q->slots = XCALLOC (MTYPE_ZLOG_ASYNC,
+		      q->size * sizeof (struct zlog_async_slot));
+  for (i = 0; i < q->size; i++)
+    q->slots[i].seq = i;
+  pthread_mutex_init (&q->mutex, NULL);
+  pthread_mutex_init (&q->wake_mutex, NULL);
+  pthread_cond_init (&q->wake, NULL);
+
+  if (!zlog_async_start (q))
+    {
+      pthread_cond_destroy (&q->wake);
+      pthread_mutex_destroy (&q->wake_mutex);
+      pthread_mutex_destroy (&q->mutex);
+      XFREE (MTYPE_ZLOG_ASYNC, q->slots);
+      XFREE (MTYPE_ZLOG_ASYNC, q);
+      return 0;
+    }
+
+  zl->async = q;
+  zlog_async_active = q;
+  return 1;
+#else
+  return size == 0;
+#endif /* HAVE_PTHREADS */
+}
+
+int
+zlog_get_async_stats (struct zlog *zl, struct zlog_async_stats *stats)
+{
+#ifdef HAVE_PTHREADS
+  struct zlog_async *q;
+
+  if (zl == NULL)
+    zl = zlog_default;
+  if ((q = zl->async) == NULL)
+    return 0;
+
+  stats->size = q->size;
+  stats->queued = q->head;
+  stats->written = q->tail;
+  stats->depth = stats->queued - stats->written;
+  stats->maxdepth = q->maxdepth;
+  stats->dropped = q->dropped;
+  return 1;
+#else
+  return 0;
+#endif /* HAVE_PTHREADS */
+}
+
+/* Write a message to syslog, the log file and stdout. */
+static void
+vzlog_dests (struct zlog *zl, int priority, const char *format,
+	     va_list args, struct timestamp_control *tsctl)
+{
   /* Syslog output */
   if (priority <= zl->maxlvl[ZLOG_DEST_SYSLOG])
     {
@@ -190,7 +586,7 @@ vzlog (struct zlog *zl, int priority, const char *format, va_list args)
   if ((priority <= zl->maxlvl[ZLOG_DEST_FILE]) && zl->fp)
     {
       va_list ac;
-      time_print (zl->fp, &tsctl);
+      time_print (zl->fp, tsctl);
       if (zl->record_priority)
 	fprintf (zl->fp, "%s: ", zlog_priority[priority]);
       fprintf (zl->fp, "%s: ", zlog_proto_names[zl->protocol]);
@@ -205,7 +601,7 @@ vzlog (struct zlog *zl, int priority, const char *format, va_list args)
   if (priority <= zl->maxlvl[ZLOG_DEST_STDOUT])
     {
       va_list ac;
-      time_print (stdout, &tsctl);
+      time_print (stdout, tsctl);
       if (zl->record_priority)
 	fprintf (stdout, "%s: ", zlog_priority[priority]);
       fprintf (stdout, "%s: ", zlog_proto_names[zl->protocol]);
@@ -215,6 +611,38 @@ vzlog (struct zlog *zl, int priority, const char *format, va_list args)
       fprintf (stdout, "\n");
       fflush (stdout);
     }
+}
+
+/* va_list version of zlog. */
+static void
+vzlog (struct zlog *zl, int priority, const char *format, va_list args)
+{
+  struct timestamp_control tsctl;
+  tsctl.already_rendered = 0;
+
+  /* If zlog is not specified, use default one. */
+  if (zl == NULL)
+    zl = zlog_default;
+
+  /* When zlog_default is also NULL, use stderr for logging. */
+  if (zl == NULL)
+    {
+      tsctl.precision = 0;
+      time_print(stderr, &tsctl);
+      fprintf (stderr, "%s: ", "unknown");
+      vfprintf (stderr, format, args);
+      fprintf (stderr, "\n");
+      fflush (stderr);
+
+      /* In this case we return at here. */
+      return;
+    }
+  tsctl.precision = zl->timestamp_precision;
+
+#ifdef HAVE_PTHREADS
+  if (zl->async == NULL || !zlog_async_log (zl, priority, format, args, &tsctl))
+#endif /* HAVE_PTHREADS */
+    vzlog_dests (zl, priority, format, args, &tsctl);
 
   /* Terminal monitor. */
   if (priority <= zl->maxlvl[ZLOG_DEST_MONITOR])
@@ -654,6 +1082,7 @@ openzlog (const char *progname, zlog_proto_t protocol,
 void
 closezlog (struct zlog *zl)
 {
+  zlog_set_async (zl, 0);
   closelog();
 
   if (zl->fp != NULL)
@@ -696,10 +1125,12 @@ zlog_set_file (struct zlog *zl, const char *filename, int log_level)
     return 0;
 
   /* Set flags. */
+  zlog_file_lock (zl);
   zl->filename = strdup (filename);
   zl->maxlvl[ZLOG_DEST_FILE] = log_level;
   zl->fp = fp;
   logfile_fd = fileno(fp);
+  zlog_file_unlock (zl);
 
   return 1;
 }
@@ -711,6 +1142,7 @@ zlog_reset_file (struct zlog *zl)
   if (zl == NULL)
     zl = zlog_default;
 
+  zlog_file_lock (zl);
   if (zl->fp)
     fclose (zl->fp);
   zl->fp = NULL;
@@ -720,6 +1152,7 @@ zlog_reset_file (struct zlog *zl)
   if (zl->filename)
     free (zl->filename);
   zl->filename = NULL;
+  zlog_file_unlock (zl);
 
   return 1;
 }
@@ -733,6 +1166,7 @@ zlog_rotate (struct zlog *zl)
   if (zl == NULL)
     zl = zlog_default;
 
+  zlog_file_lock (zl);
   if (zl->fp)
     fclose (zl->fp);
   zl->fp = NULL;
@@ -751,6 +1185,7 @@ zlog_rotate (struct zlog *zl)
       umask(oldumask);
       if (zl->fp == NULL)
         {
+	  zlog_file_unlock (zl);
 	  zlog_err("Log rotate failed: cannot open file %s for append: %s",
 	  	   zl->filename, safe_strerror(save_errno));
 	  return -1;
@@ -758,6 +1193,7 @@ zlog_rotate (struct zlog *zl)
       logfile_fd = fileno(zl->fp);
       zl->maxlvl[ZLOG_DEST_FILE] = level;
     }
+  zlog_file_unlock (zl);
 
   return 1;
 }
@@ -855,6 +1291,13 @@ static const struct zebra_desc_table command_types[] = {
   DESC_ENTRY	(ZEBRA_LINKMETRICS_METRICS),
   DESC_ENTRY	(ZEBRA_LINKMETRICS_STATUS),
   DESC_ENTRY	(ZEBRA_LINKMETRICS_METRICS_REQUEST),
+  DESC_ENTRY	(ZEBRA_RIB_SHM_SUBSCRIBE),
+  DESC_ENTRY	(ZEBRA_RIB_SHM_UNSUBSCRIBE),
+  DESC_ENTRY	(ZEBRA_RIB_SHM_UPDATE),
+  DESC_ENTRY	(ZEBRA_NEXTHOP_REGISTER),
+  DESC_ENTRY	(ZEBRA_NEXTHOP_UNREGISTER),
+  DESC_ENTRY	(ZEBRA_NEXTHOP_UPDATE),
+  DESC_ENTRY	(ZEBRA_LINKMETRICS_BATCH),
 };
 #undef DESC_ENTRY
 
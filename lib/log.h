@@ -75,6 +75,8 @@ typedef enum
 } zlog_dest_t;
 #define ZLOG_NUM_DESTS		(ZLOG_DEST_FILE+1)
 
+struct zlog_async;
+
 struct zlog 
 {
   const char *ident;	/* daemon name (first arg to openlog) */
@@ -89,6 +91,24 @@ struct zlog
   			   priority of the message? */
   int syslog_options;	/* 2nd arg to openlog */
   int timestamp_precision;	/* # of digits of subsecond precision */
+  struct zlog_async *async;	/* queue for the writer thread, if
+				   logging asynchronously */
+};
+
+/* Default and largest number of messages queued for asynchronous
+   logging; each takes a little over 1 KB. */
+#define ZLOG_ASYNC_DEFAULT_SIZE	1024
+#define ZLOG_ASYNC_MAX_SIZE	4096
+
+/* Asynchronous logging statistics. */
+struct zlog_async_stats
+{
+  unsigned int size;		/* messages the queue holds */
+  unsigned int depth;		/* messages currently queued */
+  unsigned int maxdepth;	/* most messages ever queued */
+  unsigned long queued;		/* messages queued */
+  unsigned long written;	/* messages written by the writer thread */
+  unsigned long dropped;	/* messages dropped with the queue full */
 };
 
 /* Message structure. */
@@ -152,6 +172,16 @@ extern int zlog_reset_file (struct zlog *zl);
 /* Rotate log. */
 extern int zlog_rotate (struct zlog *);
 
+/* Hand syslog, file and stdout output to a writer thread through a
+   queue of the given number of messages, or write it from the calling
+   thread again if size is 0.  Messages are dropped rather than waited
+   for when the queue is full.  Returns 0 on failure, or if POSIX
+   threads are not available. */
+extern int zlog_set_async (struct zlog *zl, unsigned int size);
+/* Fill in stats, returning 0 if not logging asynchronously. */
+extern int zlog_get_async_stats (struct zlog *zl,
+				 struct zlog_async_stats *stats);
+
 /* For hackey massage lookup and check */
 #define LOOKUP(x, y) mes_lookup(x, x ## _max, y, "(no item found)", #x)
 
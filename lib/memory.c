@@ -25,9 +25,15 @@
 #if !defined(HAVE_STDLIB_H) || (defined(GNU_LINUX) && defined(HAVE_MALLINFO))
 #include <malloc.h>
 #endif /* !HAVE_STDLIB_H || HAVE_MALLINFO */
+#if defined(HAVE_SLAB_ALLOC) && defined(HAVE_PTHREADS)
+#include <pthread.h>
+#endif /* HAVE_SLAB_ALLOC && HAVE_PTHREADS */
 
 #include "log.h"
 #include "memory.h"
+#ifdef HAVE_SLAB_ALLOC
+#include "thread.h"
+#endif /* HAVE_SLAB_ALLOC */
 
 static void alloc_inc (int);
 static void alloc_dec (int);
@@ -58,6 +64,538 @@ zerror (const char *fname, int type, size_t size)
   abort();
 }
 
+#ifdef HAVE_SLAB_ALLOC
+/* Slab allocation.
+
+   A type whose allocations all have the same size, as most do, is
+   allocated from slabs once SLAB_LEARN allocations have shown its size.
+   Slabs are blocks carved into objects of that size, which are kept for
+   reuse rather than returned to the system.  Each thread keeps freed
+   objects of a type in a magazine, a stack of up to MAGAZINE_SIZE of
+   them, so that most allocations and frees take no lock; full and empty
+   magazines are exchanged with the type's depot.
+
+   A type later allocated with another size, reallocated or duplicated
+   as a string goes back to malloc().  The objects in its magazines are
+   then taken as free, and frees of the objects still in its slabs find
+   them by address.  Once none is in use its slabs are freed. */
+
+#define SLAB_LEARN	32		/* allocations before using slabs */
+#define SLAB_MIN	16		/* objects in a type's first slab */
+#define SLAB_MAX_BYTES	(64 * 1024)	/* the size slabs grow to */
+#define SLAB_ALIGN	16
+#define MAGAZINE_SIZE	32
+
+enum mslab_state
+{
+  MSLAB_UNKNOWN,		/* not allocated yet */
+  MSLAB_LEARNING,		/* allocated with one size so far */
+  MSLAB_SLAB,			/* allocated from slabs */
+  MSLAB_VARIABLE,		/* allocated by malloc() */
+};
+
+struct magazine
+{
+  struct magazine *next;
+  unsigned int count;
+  void *objects[MAGAZINE_SIZE];
+};
+
+struct slab
+{
+  char *base;
+  size_t bytes;
+};
+
+static struct mslab
+{
+  enum mslab_state state;
+  size_t size;
+  unsigned int learned;
+
+  /* Magazines holding objects, and empty ones. */
+  struct magazine *full;
+  struct magazine *empty;
+
+  /* Slabs by address, and the part of the last one not carved yet. */
+  struct slab *slabs;
+  unsigned int nslabs;
+  unsigned int maxslabs;
+  unsigned long slabobjects;
+  char *carve;
+  char *carve_end;
+
+  /* Objects of the slabs freed since the type went back to malloc(),
+     other than those still in magazines of threads. */
+  unsigned long freed;
+
+  /* Statistics. */
+  unsigned long capacity;	/* objects in slabs */
+  unsigned long total;		/* allocations */
+  unsigned long total_shown;	/* allocations when last shown */
+  struct timeval shown;		/* when last shown */
+} mslab[MTYPE_MAX];
+
+/* When statistics started, for the allocation rates of types not
+   shown yet. */
+static struct timeval mslab_started;
+
+/* Depots and slabs are shared by all threads, under this lock. */
+#ifdef HAVE_PTHREADS
+static pthread_mutex_t mslab_mtx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t magazines_key;
+static pthread_once_t magazines_once = PTHREAD_ONCE_INIT;
+
+/* This thread's magazines, by type. */
+static __thread struct magazine **magazines;
+
+#define MSLAB_LOCK()	pthread_mutex_lock (&mslab_mtx)
+#define MSLAB_UNLOCK()	pthread_mutex_unlock (&mslab_mtx)
+
+/* The state of a type is changed under the lock, but read without it. */
+#define MSLAB_STATE(ms)	__atomic_load_n (&(ms)->state, __ATOMIC_ACQUIRE)
+#define MSLAB_SET_STATE(ms, s) \
+  __atomic_store_n (&(ms)->state, (s), __ATOMIC_RELEASE)
+#else
+static struct magazine **magazines;
+
+#define MSLAB_LOCK()
+#define MSLAB_UNLOCK()
+
+#define MSLAB_STATE(ms)	((ms)->state)
+#define MSLAB_SET_STATE(ms, s) ((ms)->state = (s))
+#endif /* HAVE_PTHREADS */
+
+static int mslab_owns (struct mslab *, void *);
+static void mslab_release (struct mslab *);
+static void magazine_drain (struct mslab *, struct magazine *);
+
+static struct magazine *
+magazine_new (void)
+{
+  struct magazine *m;
+
+  m = malloc (sizeof (struct magazine));
+  if (m == NULL)
+    zerror ("malloc", MTYPE_TMP, sizeof (struct magazine));
+  m->next = NULL;
+  m->count = 0;
+  return m;
+}
+
+#ifdef HAVE_PTHREADS
+/* Give an exiting thread's magazines to the depots. */
+static void
+magazines_flush (void *arg)
+{
+  struct magazine **mags = arg;
+  struct magazine *m;
+  int type;
+
+  MSLAB_LOCK ();
+  for (type = 0; type < MTYPE_MAX; type++)
+    if ((m = mags[type]) != NULL)
+      {
+	if (mslab[type].state == MSLAB_VARIABLE)
+	  {
+	    magazine_drain (&mslab[type], m);
+	    mslab_release (&mslab[type]);
+	  }
+	else if (m->count)
+	  {
+	    m->next = mslab[type].full;
+	    mslab[type].full = m;
+	  }
+	else
+	  {
+	    m->next = mslab[type].empty;
+	    mslab[type].empty = m;
+	  }
+      }
+  MSLAB_UNLOCK ();
+  free (mags);
+}
+
+/* A child forked while another thread held the lock would find it
+   held forever. */
+static void
+mslab_atfork_prepare (void)
+{
+  MSLAB_LOCK ();
+}
+
+static void
+mslab_atfork_release (void)
+{
+  MSLAB_UNLOCK ();
+}
+
+static void
+magazines_key_init (void)
+{
+  pthread_key_create (&magazines_key, magazines_flush);
+  pthread_atfork (mslab_atfork_prepare, mslab_atfork_release,
+		  mslab_atfork_release);
+}
+#endif /* HAVE_PTHREADS */
+
+/* This thread's magazine for TYPE. */
+static struct magazine *
+magazine_get (int type)
+{
+  if (magazines == NULL)
+    {
+      magazines = calloc (MTYPE_MAX, sizeof (struct magazine *));
+      if (magazines == NULL)
+	zerror ("calloc", type, MTYPE_MAX * sizeof (struct magazine *));
+#ifdef HAVE_PTHREADS
+      pthread_once (&magazines_once, magazines_key_init);
+      pthread_setspecific (magazines_key, magazines);
+#endif /* HAVE_PTHREADS */
+    }
+  if (magazines[type] == NULL)
+    magazines[type] = magazine_new ();
+  return magazines[type];
+}
+
+/* Add a slab to type MS, bigger than the last one up to SLAB_MAX_BYTES.
+   Called with the lock held. */
+static void
+mslab_grow (struct mslab *ms, int type)
+{
+  size_t stride = (ms->size + SLAB_ALIGN - 1) & ~(SLAB_ALIGN - 1);
+  unsigned long objects;
+  struct slab *slab;
+  char *base;
+
+  objects = ms->slabobjects ? ms->slabobjects * 2 : SLAB_MIN;
+  if (objects * stride > SLAB_MAX_BYTES)
+    objects = MAX (SLAB_MAX_BYTES / stride, SLAB_MIN);
+  ms->slabobjects = objects;
+
+  base = malloc (objects * stride);
+  if (base == NULL)
+    zerror ("malloc", type, objects * stride);
+
+  if (ms->nslabs == ms->maxslabs)
+    {
+      ms->maxslabs = ms->maxslabs ? ms->maxslabs * 2 : 4;
+      ms->slabs = realloc (ms->slabs, ms->maxslabs * sizeof (struct slab));
+      if (ms->slabs == NULL)
+	zerror ("realloc", type, ms->maxslabs * sizeof (struct slab));
+    }
+  for (slab = &ms->slabs[ms->nslabs]; slab > ms->slabs; slab--)
+    {
+      if (slab[-1].base < base)
+	break;
+      slab[0] = slab[-1];
+    }
+  slab->base = base;
+  slab->bytes = objects * stride;
+  ms->nslabs++;
+
+  ms->carve = base;
+  ms->carve_end = base + objects * stride;
+  ms->capacity += objects;
+}
+
+/* Take the objects of magazine M of type MS, all of its slabs, as free,
+   the type being allocated by malloc() now, and free M.  Called with the
+   lock held. */
+static void
+magazine_drain (struct mslab *ms, struct magazine *m)
+{
+  ms->freed += m->count;
+  free (m);
+}
+
+/* Drain this thread's magazine for TYPE if it has one.  Called with the
+   lock held. */
+static void
+magazine_put (int type)
+{
+  if (magazines && magazines[type])
+    {
+      magazine_drain (&mslab[type], magazines[type]);
+      magazines[type] = NULL;
+    }
+}
+
+/* Fill this thread's empty magazine for TYPE, from the depot or from
+   slabs, or return NULL if the type has gone back to malloc(). */
+static struct magazine *
+magazine_refill (int type, struct magazine *m)
+{
+  struct mslab *ms = &mslab[type];
+  size_t stride = (ms->size + SLAB_ALIGN - 1) & ~(SLAB_ALIGN - 1);
+
+  MSLAB_LOCK ();
+  if (ms->state == MSLAB_VARIABLE)
+    {
+      magazine_put (type);
+      mslab_release (ms);
+      m = NULL;
+    }
+  else if (ms->full)
+    {
+      m->next = ms->empty;
+      ms->empty = m;
+      m = ms->full;
+      ms->full = m->next;
+      magazines[type] = m;
+    }
+  else
+    {
+      while (m->count < MAGAZINE_SIZE)
+	{
+	  if (ms->carve == ms->carve_end)
+	    {
+	      if (m->count)
+		break;
+	      mslab_grow (ms, type);
+	    }
+	  m->objects[m->count++] = ms->carve;
+	  ms->carve += stride;
+	}
+    }
+  MSLAB_UNLOCK ();
+  return m;
+}
+
+/* Whether PTR is in one of type MS's slabs.  Called with the lock
+   held. */
+static int
+mslab_owns (struct mslab *ms, void *ptr)
+{
+  unsigned int lo = 0, hi = ms->nslabs;
+  char *p = ptr;
+
+  while (lo < hi)
+    {
+      unsigned int mid = (lo + hi) / 2;
+
+      if (p < ms->slabs[mid].base)
+	hi = mid;
+      else if (p >= ms->slabs[mid].base + ms->slabs[mid].bytes)
+	lo = mid + 1;
+      else
+	return 1;
+    }
+  return 0;
+}
+
+/* Free the slabs of type MS, allocated by malloc() now, if none of their
+   objects is in use any longer.  Called with the lock held. */
+static void
+mslab_release (struct mslab *ms)
+{
+  size_t stride = (ms->size + SLAB_ALIGN - 1) & ~(SLAB_ALIGN - 1);
+  unsigned int i;
+
+  if (ms->nslabs == 0
+      || ms->freed < ms->capacity - (ms->carve_end - ms->carve) / stride)
+    return;
+
+  for (i = 0; i < ms->nslabs; i++)
+    free (ms->slabs[i].base);
+  free (ms->slabs);
+  ms->slabs = NULL;
+  ms->nslabs = ms->maxslabs = 0;
+  ms->slabobjects = 0;
+  ms->carve = ms->carve_end = NULL;
+  ms->capacity = 0;
+  ms->freed = 0;
+}
+
+/* Send TYPE back to malloc(), taking the objects in its depot and in
+   this thread's magazine as free.  Other threads drain theirs when they
+   next allocate or free the type, or exit.  Called with the lock
+   held. */
+static void
+mslab_set_variable (int type)
+{
+  struct mslab *ms = &mslab[type];
+  struct magazine *m;
+
+  MSLAB_SET_STATE (ms, MSLAB_VARIABLE);
+  while ((m = ms->full) != NULL)
+    {
+      ms->full = m->next;
+      magazine_drain (ms, m);
+    }
+  while ((m = ms->empty) != NULL)
+    {
+      ms->empty = m->next;
+      free (m);
+    }
+  magazine_put (type);
+  mslab_release (ms);
+}
+
+/* Note that TYPE is being allocated with SIZE, which decides whether
+   it is allocated from slabs. */
+static void
+mslab_learn (int type, size_t size)
+{
+  struct mslab *ms = &mslab[type];
+
+  MSLAB_LOCK ();
+  switch (ms->state)
+    {
+    case MSLAB_UNKNOWN:
+      ms->size = size;
+      ms->learned = 1;
+      MSLAB_SET_STATE (ms, size ? MSLAB_LEARNING : MSLAB_VARIABLE);
+      break;
+    case MSLAB_LEARNING:
+      if (size != ms->size)
+	MSLAB_SET_STATE (ms, MSLAB_VARIABLE);
+      else if (++ms->learned == SLAB_LEARN)
+	MSLAB_SET_STATE (ms, MSLAB_SLAB);
+      break;
+    case MSLAB_SLAB:
+      if (size != ms->size)
+	mslab_set_variable (type);
+      break;
+    case MSLAB_VARIABLE:
+      break;
+    }
+  MSLAB_UNLOCK ();
+}
+
+/* Allocate SIZE bytes of TYPE from its slabs if it is allocated from
+   them, or return NULL. */
+static inline void *
+mslab_alloc (int type, size_t size)
+{
+  struct mslab *ms = &mslab[type];
+  enum mslab_state state = MSLAB_STATE (ms);
+  struct magazine *m;
+
+  if (state != MSLAB_SLAB || size != ms->size)
+    {
+      if (state != MSLAB_VARIABLE)
+	mslab_learn (type, size);
+      else if (magazines && magazines[type])
+	{
+	  MSLAB_LOCK ();
+	  magazine_put (type);
+	  mslab_release (ms);
+	  MSLAB_UNLOCK ();
+	}
+      return NULL;
+    }
+
+  m = magazine_get (type);
+  if (m->count == 0 && (m = magazine_refill (type, m)) == NULL)
+    return NULL;
+  return m->objects[--m->count];
+}
+
+/* Free PTR of TYPE to its slabs if it is allocated from them, or
+   return 0. */
+static inline int
+mslab_free (int type, void *ptr)
+{
+  struct mslab *ms = &mslab[type];
+  struct magazine *m;
+  int owned;
+
+  switch (MSLAB_STATE (ms))
+    {
+    case MSLAB_SLAB:
+      /* Only objects of the slabs are cached.  Anything else, allocated
+	 before the type used slabs, under another type or by strdup(),
+	 need not be of the type's size and goes back to free(). */
+      MSLAB_LOCK ();
+      owned = mslab_owns (ms, ptr);
+      if (ms->state == MSLAB_VARIABLE)
+	{
+	  /* Gone back to malloc() meanwhile. */
+	  magazine_put (type);
+	  if (owned)
+	    ms->freed++;
+	  mslab_release (ms);
+	}
+      else if (owned)
+	{
+	  m = magazine_get (type);
+	  if (m->count == MAGAZINE_SIZE)
+	    {
+	      m->next = ms->full;
+	      ms->full = m;
+	      if ((m = ms->empty) != NULL)
+		ms->empty = m->next;
+	      else
+		m = magazine_new ();
+	      m->count = 0;
+	      magazines[type] = m;
+	    }
+	  m->objects[m->count++] = ptr;
+	}
+      MSLAB_UNLOCK ();
+      return owned;
+
+    case MSLAB_VARIABLE:
+      if (ms->nslabs == 0 && ! (magazines && magazines[type]))
+	return 0;
+      MSLAB_LOCK ();
+      magazine_put (type);
+      owned = mslab_owns (ms, ptr);
+      if (owned)
+	ms->freed++;
+      mslab_release (ms);
+      MSLAB_UNLOCK ();
+      return owned;
+
+    default:
+      return 0;
+    }
+}
+
+/* Reallocate PTR of TYPE, which is then no longer allocated from slabs,
+   to SIZE bytes. */
+static void *
+mslab_realloc (int type, void *ptr, size_t size)
+{
+  struct mslab *ms = &mslab[type];
+  void *memory;
+  int owned;
+
+  MSLAB_LOCK ();
+  mslab_set_variable (type);
+  owned = ptr && mslab_owns (ms, ptr);
+  MSLAB_UNLOCK ();
+
+  if (! owned)
+    return realloc (ptr, size);
+
+  memory = malloc (size);
+  if (memory == NULL)
+    return NULL;
+  memcpy (memory, ptr, MIN (size, ms->size));
+
+  /* The object goes back to its slab. */
+  MSLAB_LOCK ();
+  ms->freed++;
+  mslab_release (ms);
+  MSLAB_UNLOCK ();
+  return memory;
+}
+
+/* Note that TYPE is allocated with varying sizes. */
+static void
+mslab_variable (int type)
+{
+  if (MSLAB_STATE (&mslab[type]) != MSLAB_VARIABLE)
+    {
+      MSLAB_LOCK ();
+      mslab_set_variable (type);
+      MSLAB_UNLOCK ();
+    }
+}
+#endif /* HAVE_SLAB_ALLOC */
+
 /*
  * Allocate memory of a given size, to be tracked by a given type.
  * Effects: Returns a pointer to usable memory.  If memory cannot
@@ -68,6 +606,14 @@ zmalloc (int type, size_t size)
 {
   void *memory;
 
+#ifdef HAVE_SLAB_ALLOC
+  if ((memory = mslab_alloc (type, size)) != NULL)
+    {
+      alloc_inc (type);
+      return memory;
+    }
+#endif /* HAVE_SLAB_ALLOC */
+
   memory = malloc (size);
 
   if (memory == NULL)
@@ -86,6 +632,15 @@ zcalloc (int type, size_t size)
 {
   void *memory;
 
+#ifdef HAVE_SLAB_ALLOC
+  if ((memory = mslab_alloc (type, size)) != NULL)
+    {
+      memset (memory, 0, size);
+      alloc_inc (type);
+      return memory;
+    }
+#endif /* HAVE_SLAB_ALLOC */
+
   memory = calloc (1, size);
 
   if (memory == NULL)
@@ -108,7 +663,11 @@ zrealloc (int type, void *ptr, size_t size)
 {
   void *memory;
 
+#ifdef HAVE_SLAB_ALLOC
+  memory = mslab_realloc (type, ptr, size);
+#else
   memory = realloc (ptr, size);
+#endif /* HAVE_SLAB_ALLOC */
   if (memory == NULL)
     zerror ("realloc", type, size);
   if (ptr == NULL)
@@ -129,6 +688,10 @@ zfree (int type, void *ptr)
   if (ptr != NULL)
     {
       alloc_dec (type);
+#ifdef HAVE_SLAB_ALLOC
+      if (mslab_free (type, ptr))
+	return;
+#endif /* HAVE_SLAB_ALLOC */
       free (ptr);
     }
 }
@@ -144,6 +707,9 @@ zstrdup (int type, const char *str)
 {
   void *dup;
 
+#ifdef HAVE_SLAB_ALLOC
+  mslab_variable (type);
+#endif /* HAVE_SLAB_ALLOC */
   dup = strdup (str);
   if (dup == NULL)
     zerror ("strdup", type, strlen (str));
@@ -246,18 +812,34 @@ static struct
 } mstat [MTYPE_MAX];
 #endif /* MEMORY_LOG */
 
-/* Increment allocation counter. */
+/* Increment allocation counter.  With POSIX threads enabled, worker
+   threads may allocate memory too, so the counters are updated
+   atomically. */
 static void
 alloc_inc (int type)
 {
+#ifdef HAVE_PTHREADS
+  __sync_fetch_and_add (&mstat[type].alloc, 1);
+#ifdef HAVE_SLAB_ALLOC
+  __sync_fetch_and_add (&mslab[type].total, 1);
+#endif /* HAVE_SLAB_ALLOC */
+#else
   mstat[type].alloc++;
+#ifdef HAVE_SLAB_ALLOC
+  mslab[type].total++;
+#endif /* HAVE_SLAB_ALLOC */
+#endif /* HAVE_PTHREADS */
 }
 
 /* Decrement allocation counter. */
 static void
 alloc_dec (int type)
 {
+#ifdef HAVE_PTHREADS
+  __sync_fetch_and_sub (&mstat[type].alloc, 1);
+#else
   mstat[type].alloc--;
+#endif /* HAVE_PTHREADS */
 }
 
 /* Looking up memory status from vty interface. */
@@ -265,6 +847,20 @@ alloc_dec (int type)
 #include "vty.h"
 #include "command.h"
 
+/* Daemon supplied extra output for one memory list. */
+static struct
+{
+  struct memory_list *list;
+  int (*func) (struct vty *);
+} memory_show_hook;
+
+void
+memory_show_hook_set (struct memory_list *list, int (*func) (struct vty *))
+{
+  memory_show_hook.list = list;
+  memory_show_hook.func = func;
+}
+
 static void
 log_memstats(int pri)
 {
@@ -328,11 +924,53 @@ show_separator(struct vty *vty)
   vty_out (vty, "-----------------------------\r\n");
 }
 
+#ifdef HAVE_SLAB_ALLOC
+/* Show the live objects of a type, their bytes if its size is fixed,
+   how much of its slabs they use, and the allocations per second since
+   it was last shown. */
+static void
+show_memory_type (struct vty *vty, struct memory_list *m)
+{
+  struct mslab *ms = &mslab[m->index];
+  long alloc = mstat[m->index].alloc;
+  char bytes[MTYPE_MEMSTR_LEN], use[8];
+  struct timeval now, diff;
+  unsigned long total;
+  double secs;
+
+  if (MSLAB_STATE (ms) == MSLAB_LEARNING
+      || MSLAB_STATE (ms) == MSLAB_SLAB)
+    mtype_memstr (bytes, sizeof (bytes), alloc * ms->size);
+  else
+    strcpy (bytes, "-");
+
+  if (ms->capacity)
+    snprintf (use, sizeof (use), "%lu%%",
+	      MIN ((unsigned long) alloc, ms->capacity) * 100 / ms->capacity);
+  else
+    strcpy (use, "-");
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &now);
+  timersub (&now, ms->shown.tv_sec ? &ms->shown : &mslab_started, &diff);
+  secs = diff.tv_sec + diff.tv_usec / 1000000.0;
+  total = ms->total;
+
+  vty_out (vty, "%-30s: %10ld %10s %5s %10.0f\r\n", m->format, alloc, bytes,
+	   use, secs > 0 ? (total - ms->total_shown) / secs : 0);
+
+  ms->total_shown = total;
+  ms->shown = now;
+}
+#endif /* HAVE_SLAB_ALLOC */
+
 static int
 show_memory_vty (struct vty *vty, struct memory_list *list)
 {
   struct memory_list *m;
   int needsep = 0;
+#ifdef HAVE_SLAB_ALLOC
+  int header = 0;
+#endif /* HAVE_SLAB_ALLOC */
 
   for (m = list; m->index >= 0; m++)
     if (m->index == 0)
@@ -345,9 +983,27 @@ show_memory_vty (struct vty *vty, struct memory_list *list)
       }
     else if (mstat[m->index].alloc)
       {
+#ifdef HAVE_SLAB_ALLOC
+	if (! header)
+	  {
+	    vty_out (vty, "%-30s  %10s %10s %5s %10s\r\n", "Type", "Live",
+		     "Bytes", "Slabs", "Allocs/s");
+	    header = 1;
+	  }
+	show_memory_type (vty, m);
+#else
 	vty_out (vty, "%-30s: %10ld\r\n", m->format, mstat[m->index].alloc);
+#endif /* HAVE_SLAB_ALLOC */
 	needsep = 1;
       }
+
+  if (memory_show_hook.func && memory_show_hook.list == list)
+    {
+      if (needsep)
+	show_separator (vty);
+      needsep = (*memory_show_hook.func) (vty);
+    }
+
   return needsep;
 }
 
@@ -524,6 +1180,10 @@ DEFUN (show_memory_isis,
 void
 memory_init (void)
 {
+#ifdef HAVE_SLAB_ALLOC
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &mslab_started);
+#endif /* HAVE_SLAB_ALLOC */
+
   install_element (RESTRICTED_NODE, &show_memory_cmd);
   install_element (RESTRICTED_NODE, &show_memory_all_cmd);
   install_element (RESTRICTED_NODE, &show_memory_lib_cmd);
@@ -85,6 +85,12 @@ extern char *mtype_zstrdup (const char *file, int line, int type,
 extern void memory_init (void);
 extern void log_memstats_stderr (const char *);
 
+/* Extra statistics printed after the given list by "show memory";
+   the function returns non-zero if it printed anything */
+struct vty;
+extern void memory_show_hook_set (struct memory_list *,
+                                  int (*) (struct vty *));
+
 /* return number of allocations outstanding for the type */
 extern unsigned long mtype_stats_alloc (int);
 
@@ -25,6 +25,7 @@ struct memory_list memory_list_lib[] =
   { MTYPE_VTY,			"VTY"				},
   { MTYPE_VTY_OUT_BUF,		"VTY output buffer"		},
   { MTYPE_VTY_HIST,		"VTY history"			},
+  { MTYPE_VTY_OUTPUT,		"VTY output cursor"		},
   { MTYPE_IF,			"Interface"			},
   { MTYPE_CONNECTED,		"Connected" 			},
   { MTYPE_CONNECTED_LABEL,	"Connected interface label"	},
@@ -41,21 +42,28 @@ struct memory_list memory_list_lib[] =
   { MTYPE_HASH_INDEX,		"Hash Index"			},
   { MTYPE_ROUTE_TABLE,		"Route table"			},
   { MTYPE_ROUTE_NODE,		"Route node"			},
+  { MTYPE_ROUTE_STRIDE,		"Route table stride"		},
   { MTYPE_DISTRIBUTE,		"Distribute list"		},
   { MTYPE_DISTRIBUTE_IFNAME,	"Dist-list ifname"		},
   { MTYPE_ACCESS_LIST,		"Access List"			},
   { MTYPE_ACCESS_LIST_STR,	"Access List Str"		},
+  { MTYPE_ACCESS_LIST_REF,	"Access List Ref"		},
   { MTYPE_ACCESS_FILTER,	"Access Filter"			},
   { MTYPE_PREFIX_LIST,		"Prefix List"			},
   { MTYPE_PREFIX_LIST_ENTRY,	"Prefix List Entry"		},
   { MTYPE_PREFIX_LIST_STR,	"Prefix List Str"		},
+  { MTYPE_PREFIX_LIST_TRIE,	"Prefix List Trie"		},
+  { MTYPE_PREFIX_LIST_REF,	"Prefix List Ref"		},
   { MTYPE_ROUTE_MAP,		"Route map"			},
   { MTYPE_ROUTE_MAP_NAME,	"Route map name"		},
   { MTYPE_ROUTE_MAP_INDEX,	"Route map index"		},
   { MTYPE_ROUTE_MAP_RULE,	"Route map rule"		},
   { MTYPE_ROUTE_MAP_RULE_STR,	"Route map rule str"		},
   { MTYPE_ROUTE_MAP_COMPILED,	"Route map compiled"		},
+  { MTYPE_ROUTE_MAP_PROGRAM,	"Route map program"		},
   { MTYPE_DESC,			"Command desc"			},
+  { MTYPE_CMD_TRIE,		"Command trie"			},
+  { MTYPE_CMD_TRIE_EDGES,	"Command trie edges"		},
   { MTYPE_KEY,			"Key"				},
   { MTYPE_KEYCHAIN,		"Key chain"			},
   { MTYPE_IF_RMAP,		"Interface route map"		},
@@ -63,13 +71,19 @@ struct memory_list memory_list_lib[] =
   { MTYPE_SOCKUNION,		"Socket union"			},
   { MTYPE_PRIVS,		"Privilege information"		},
   { MTYPE_ZLOG,			"Logging"			},
+  { MTYPE_ZLOG_ASYNC,		"Logging queue"			},
   { MTYPE_ZCLIENT,		"Zclient"			},
+  { MTYPE_ZCLIENT_ROUTE,	"Zclient redistributed route"	},
   { MTYPE_WORK_QUEUE,		"Work queue"			},
   { MTYPE_WORK_QUEUE_ITEM,	"Work queue item"		},
   { MTYPE_WORK_QUEUE_NAME,	"Work queue name string"	},
   { MTYPE_PQUEUE,		"Priority queue"		},
   { MTYPE_PQUEUE_DATA,		"Priority queue data"		},
   { MTYPE_HOST,			"Host config"			},
+  { MTYPE_RIB_SHM,		"RIB shared-memory export"	},
+  { MTYPE_TELEMETRY,		"Telemetry export"		},
+  { MTYPE_TELEMETRY_CLIENT,	"Telemetry client"		},
+  { MTYPE_TELEMETRY_SERIES,	"Telemetry series"		},
   { -1, NULL },
 };
 
@@ -81,6 +95,11 @@ struct memory_list memory_list_zebra[] =
   { MTYPE_NEXTHOP,		"Nexthop"			},
   { MTYPE_RIB,			"RIB"				},
   { MTYPE_RIB_QUEUE,		"RIB process work queue"	},
+  { MTYPE_RIB_DEP,		"RIB nexthop dependency"	},
+  { MTYPE_RNH,			"Nexthop tracking"		},
+  { MTYPE_RIB_UPDATE,		"RIB update batch"		},
+  { MTYPE_NETLINK_EVENT,	"Netlink event"			},
+  { MTYPE_LINKMETRICS_UPDATE,	"Link metrics update"		},
   { MTYPE_STATIC_IPV4,		"Static IPv4 route"		},
   { MTYPE_STATIC_IPV6,		"Static IPv6 route"		},
   { -1, NULL },
@@ -222,6 +241,7 @@ struct memory_list memory_list_ospf6[] =
   { MTYPE_OSPF6_PREFIX,       "OSPF6 prefix"			},
   { MTYPE_OSPF6_MESSAGE,      "OSPF6 message"			},
   { MTYPE_OSPF6_LSA,          "OSPF6 LSA"			},
+  { MTYPE_OSPF6_LSA_DATA,     "OSPF6 LSA data"			},
   { MTYPE_OSPF6_LSA_SUMMARY,  "OSPF6 LSA summary"		},
   { MTYPE_OSPF6_LSDB,         "OSPF6 LSA database"		},
   { MTYPE_OSPF6_VERTEX,       "OSPF6 vertex"			},
@@ -229,6 +249,7 @@ struct memory_list memory_list_ospf6[] =
   { MTYPE_OSPF6_NEXTHOP,      "OSPF6 nexthop"			},
   { MTYPE_OSPF6_EXTERNAL_INFO,"OSPF6 ext. info"			},
   { MTYPE_OSPF6_MDR,          "OSPF6 MDR"			},
+  { MTYPE_OSPF6_MDR_ACK,      "OSPF6 MDR ack cache"		},
   { MTYPE_OSPF6_OTHER,        "OSPF6 other"			},
   { -1, NULL },
 };
@@ -29,6 +29,7 @@
 #include "buffer.h"
 #include "stream.h"
 #include "log.h"
+#include "table.h"
 
 /* Each prefix-list's entry. */
 struct prefix_list_entry
@@ -46,8 +47,27 @@ struct prefix_list_entry
   unsigned long refcnt;
   unsigned long hitcnt;
 
+  /* Matches since refcnt was brought up to date. */
+  unsigned long matchcnt;
+
   struct prefix_list_entry *next;
   struct prefix_list_entry *prev;
+
+  /* Next entry of the same prefix in the trie, by sequence number. */
+  struct prefix_list_entry *trie_next;
+};
+
+/* Prefix lists are indexed by prefix once they have this many
+   entries. */
+#define PREFIX_LIST_TRIE_MIN	8
+
+/* Entries by prefix, for AF_INET and AF_INET6.  A node's info is the
+   first of the entries with its prefix, which are chained by trie_next
+   in sequence order.  The first entry matching a prefix is then the
+   one of lowest sequence number among the nodes on its path. */
+struct prefix_list_trie
+{
+  struct route_table *table[2];
 };
 
 /* List of struct prefix_list. */
@@ -111,6 +131,10 @@ static struct prefix_master prefix_master_orf =
   NULL,
 };
 
+/* Bumped whenever a prefix list is added or deleted, so that
+   prefix_list_ref lookups are redone. */
+static unsigned int prefix_list_generation = 1;
+
 static struct prefix_master *
 prefix_master_get (afi_t afi)
 {
@@ -150,6 +174,39 @@ prefix_list_lookup (afi_t afi, const char *name)
   return NULL;
 }
 
+/* Reference prefix list NAME, which need not exist yet. */
+struct prefix_list_ref *
+prefix_list_ref_new (afi_t afi, const char *name)
+{
+  struct prefix_list_ref *ref;
+
+  ref = XCALLOC (MTYPE_PREFIX_LIST_REF, sizeof (struct prefix_list_ref));
+  ref->afi = afi;
+  ref->name = XSTRDUP (MTYPE_PREFIX_LIST_STR, name);
+  return ref;
+}
+
+void
+prefix_list_ref_free (struct prefix_list_ref *ref)
+{
+  XFREE (MTYPE_PREFIX_LIST_STR, ref->name);
+  XFREE (MTYPE_PREFIX_LIST_REF, ref);
+}
+
+/* The prefix list referenced, or NULL if there is none by its name.
+   This is prefix_list_lookup() without the walk through the lists when
+   none have been added or deleted since the last time. */
+struct prefix_list *
+prefix_list_ref_lookup (struct prefix_list_ref *ref)
+{
+  if (ref->generation != prefix_list_generation)
+    {
+      ref->plist = prefix_list_lookup (ref->afi, ref->name);
+      ref->generation = prefix_list_generation;
+    }
+  return ref->plist;
+}
+
 static struct prefix_list *
 prefix_list_new (void)
 {
@@ -180,6 +237,227 @@ prefix_list_entry_free (struct prefix_list_entry *pentry)
   XFREE (MTYPE_PREFIX_LIST_ENTRY, pentry);
 }
 
+static struct route_table **
+prefix_list_trie_table (struct prefix_list_trie *trie, u_char family)
+{
+  if (family == AF_INET)
+    return &trie->table[0];
+#ifdef HAVE_IPV6
+  if (family == AF_INET6)
+    return &trie->table[1];
+#endif /* HAVE_IPV6 */
+  return NULL;
+}
+
+/* Add pentry to the trie, returning 0 if it cannot be indexed. */
+static int
+prefix_list_trie_add (struct prefix_list_trie *trie,
+		      struct prefix_list_entry *pentry)
+{
+  struct route_table **table;
+  struct route_node *rn;
+  struct prefix_list_entry *prev;
+  struct prefix p;
+
+  table = prefix_list_trie_table (trie, pentry->prefix.family);
+  if (table == NULL)
+    return 0;
+  if (*table == NULL)
+    *table = route_table_init ();
+
+  prefix_copy (&p, &pentry->prefix);
+  apply_mask (&p);
+  rn = route_node_get (*table, &p);
+
+  /* Keep one lock for the node's entries. */
+  if (rn->info)
+    route_unlock_node (rn);
+
+  prev = rn->info;
+  if (prev == NULL || prev->seq > pentry->seq)
+    {
+      pentry->trie_next = prev;
+      rn->info = pentry;
+    }
+  else
+    {
+      while (prev->trie_next && prev->trie_next->seq < pentry->seq)
+	prev = prev->trie_next;
+      pentry->trie_next = prev->trie_next;
+      prev->trie_next = pentry;
+    }
+
+  return 1;
+}
+
+static void
+prefix_list_trie_delete (struct prefix_list_trie *trie,
+			 struct prefix_list_entry *pentry)
+{
+  struct route_table **table;
+  struct route_node *rn;
+  struct prefix_list_entry *prev;
+  struct prefix p;
+
+  table = prefix_list_trie_table (trie, pentry->prefix.family);
+  if (table == NULL || *table == NULL)
+    return;
+
+  prefix_copy (&p, &pentry->prefix);
+  apply_mask (&p);
+  rn = route_node_lookup (*table, &p);
+  if (rn == NULL)
+    return;
+
+  prev = rn->info;
+  if (prev == pentry)
+    rn->info = pentry->trie_next;
+  else if (prev)
+    {
+      while (prev->trie_next && prev->trie_next != pentry)
+	prev = prev->trie_next;
+      if (prev->trie_next == pentry)
+	prev->trie_next = pentry->trie_next;
+    }
+  pentry->trie_next = NULL;
+
+  route_unlock_node (rn);
+  if (rn->info == NULL)
+    route_unlock_node (rn);
+}
+
+/* The entries of exactly the given prefix, or NULL. */
+static struct prefix_list_entry *
+prefix_list_trie_lookup (struct prefix_list_trie *trie, struct prefix *prefix)
+{
+  struct route_table **table;
+  struct route_node *rn;
+  struct prefix_list_entry *pentry;
+  struct prefix p;
+
+  table = prefix_list_trie_table (trie, prefix->family);
+  if (table == NULL || *table == NULL)
+    return NULL;
+
+  prefix_copy (&p, prefix);
+  apply_mask (&p);
+  rn = route_node_lookup (*table, &p);
+  if (rn == NULL)
+    return NULL;
+
+  pentry = rn->info;
+  route_unlock_node (rn);
+  return pentry;
+}
+
+static int prefix_list_entry_match (struct prefix_list_entry *,
+				    struct prefix *);
+
+/* The first entry matching p, or NULL. */
+static struct prefix_list_entry *
+prefix_list_trie_match (struct prefix_list_trie *trie, struct prefix *p)
+{
+  struct route_table **table;
+  struct route_node *rn, *node;
+  struct prefix_list_entry *pentry;
+  struct prefix_list_entry *match = NULL;
+
+  table = prefix_list_trie_table (trie, p->family);
+  if (table == NULL || *table == NULL)
+    return NULL;
+
+  rn = route_node_match (*table, p);
+  if (rn == NULL)
+    return NULL;
+
+  for (node = rn; node; node = route_node_parent (node))
+    for (pentry = node->info; pentry; pentry = pentry->trie_next)
+      {
+	if (match && pentry->seq >= match->seq)
+	  break;
+	if (prefix_list_entry_match (pentry, p))
+	  {
+	    match = pentry;
+	    break;
+	  }
+      }
+
+  route_unlock_node (rn);
+  return match;
+}
+
+static void
+prefix_list_trie_free (struct prefix_list *plist)
+{
+  struct prefix_list_trie *trie = plist->trie;
+  struct route_node *rn;
+  int i;
+
+  if (trie == NULL)
+    return;
+
+  for (i = 0; i < 2; i++)
+    if (trie->table[i])
+      {
+	for (rn = route_top (trie->table[i]); rn; rn = route_next (rn))
+	  if (rn->info)
+	    {
+	      rn->info = NULL;
+	      route_unlock_node (rn);
+	    }
+	route_table_finish (trie->table[i]);
+      }
+
+  XFREE (MTYPE_PREFIX_LIST_TRIE, trie);
+  plist->trie = NULL;
+}
+
+/* Return the trie of a list, building it if the list is long enough,
+   or NULL if the list is to be searched in order. */
+static struct prefix_list_trie *
+prefix_list_trie_get (struct prefix_list *plist)
+{
+  struct prefix_list_entry *pentry;
+
+  if (plist->trie || plist->count < PREFIX_LIST_TRIE_MIN)
+    return plist->trie;
+
+  plist->trie = XCALLOC (MTYPE_PREFIX_LIST_TRIE,
+			 sizeof (struct prefix_list_trie));
+
+  /* Last entry first, so that each is put at the head of its chain. */
+  for (pentry = plist->tail; pentry; pentry = pentry->prev)
+    if (! prefix_list_trie_add (plist->trie, pentry))
+      {
+	prefix_list_trie_free (plist);
+	return NULL;
+      }
+
+  return plist->trie;
+}
+
+/* Bring the entries' refcounts up to date.  The entries are tried in
+   order, so an application reaches an entry unless one before it
+   matched. */
+static void
+prefix_list_refcnt_update (struct prefix_list *plist)
+{
+  struct prefix_list_entry *pentry;
+  unsigned long reached;
+
+  if (plist->applycnt == 0)
+    return;
+
+  reached = plist->applycnt;
+  for (pentry = plist->head; pentry; pentry = pentry->next)
+    {
+      pentry->refcnt += reached;
+      reached -= pentry->matchcnt;
+      pentry->matchcnt = 0;
+    }
+  plist->applycnt = 0;
+}
+
 /* Insert new prefix list to list of prefix_list.  Each prefix_list
    is sorted by the name. */
 static struct prefix_list *
@@ -200,6 +478,7 @@ prefix_list_insert (afi_t afi, const char *name)
   plist = prefix_list_new ();
   plist->name = XSTRDUP (MTYPE_PREFIX_LIST_STR, name);
   plist->master = master;
+  prefix_list_generation++;
 
   /* If name is made by all digit character.  We treat it as
      number. */
@@ -293,6 +572,8 @@ prefix_list_delete (struct prefix_list *plist)
   struct prefix_list_entry *pentry;
   struct prefix_list_entry *next;
 
+  prefix_list_trie_free (plist);
+
   /* If prefix-list contain prefix_list_entry free all of it. */
   for (pentry = plist->head; pentry; pentry = next)
     {
@@ -329,6 +610,7 @@ prefix_list_delete (struct prefix_list *plist)
     XFREE (MTYPE_PREFIX_LIST_STR, plist->name);
   
   prefix_list_free (plist);
+  prefix_list_generation++;
   
   if (master->delete_hook)
     (*master->delete_hook) (NULL);
@@ -380,15 +662,9 @@ prefix_new_seq_get (struct prefix_list *plist)
 {
   int maxseq;
   int newseq;
-  struct prefix_list_entry *pentry;
 
-  maxseq = newseq = 0;
-
-  for (pentry = plist->head; pentry; pentry = pentry->next)
-    {
-      if (maxseq < pentry->seq)
-	maxseq = pentry->seq;
-    }
+  /* The entries are in sequence order. */
+  maxseq = plist->tail ? plist->tail->seq : 0;
 
   newseq = ((maxseq / 5) * 5) + 5;
   
@@ -401,6 +677,9 @@ prefix_seq_check (struct prefix_list *plist, int seq)
 {
   struct prefix_list_entry *pentry;
 
+  if (plist->tail == NULL || plist->tail->seq < seq)
+    return NULL;
+
   for (pentry = plist->head; pentry; pentry = pentry->next)
     if (pentry->seq == seq)
       return pentry;
@@ -411,8 +690,20 @@ static struct prefix_list_entry *
 prefix_list_entry_lookup (struct prefix_list *plist, struct prefix *prefix,
 			  enum prefix_list_type type, int seq, int le, int ge)
 {
+  struct prefix_list_trie *trie;
   struct prefix_list_entry *pentry;
 
+  if ((trie = prefix_list_trie_get (plist)) != NULL)
+    {
+      for (pentry = prefix_list_trie_lookup (trie, prefix); pentry;
+	   pentry = pentry->trie_next)
+	if (prefix_same (&pentry->prefix, prefix) && pentry->type == type
+	    && (seq < 0 || pentry->seq == seq)
+	    && pentry->le == le && pentry->ge == ge)
+	  return pentry;
+      return NULL;
+    }
+
   for (pentry = plist->head; pentry; pentry = pentry->next)
     if (prefix_same (&pentry->prefix, prefix) && pentry->type == type)
       {
@@ -437,6 +728,11 @@ prefix_list_entry_delete (struct prefix_list *plist,
 {
   if (plist == NULL || pentry == NULL)
     return;
+
+  prefix_list_refcnt_update (plist);
+  if (plist->trie)
+    prefix_list_trie_delete (plist->trie, pentry);
+
   if (pentry->prev)
     pentry->prev->next = pentry->next;
   else
@@ -469,6 +765,8 @@ prefix_list_entry_add (struct prefix_list *plist,
   struct prefix_list_entry *replace;
   struct prefix_list_entry *point;
 
+  prefix_list_refcnt_update (plist);
+
   /* Automatic asignment of seq no. */
   if (pentry->seq == -1)
     pentry->seq = prefix_new_seq_get (plist);
@@ -479,9 +777,12 @@ prefix_list_entry_add (struct prefix_list *plist,
     prefix_list_entry_delete (plist, replace, 0);
 
   /* Check insert point. */
-  for (point = plist->head; point; point = point->next)
-    if (point->seq >= pentry->seq)
-      break;
+  if (plist->tail && plist->tail->seq < pentry->seq)
+    point = NULL;
+  else
+    for (point = plist->head; point; point = point->next)
+      if (point->seq >= pentry->seq)
+	break;
 
   /* In case of this is the first element of the list. */
   pentry->next = point;
@@ -510,6 +811,9 @@ prefix_list_entry_add (struct prefix_list *plist,
   /* Increment count. */
   plist->count++;
 
+  if (plist->trie && ! prefix_list_trie_add (plist->trie, pentry))
+    prefix_list_trie_free (plist);
+
   /* Run hook function. */
   if (plist->master->add_hook)
     (*plist->master->add_hook) (plist);
@@ -563,6 +867,7 @@ prefix_list_entry_match (struct prefix_list_entry *pentry, struct prefix *p)
 enum prefix_list_type
 prefix_list_apply (struct prefix_list *plist, void *object)
 {
+  struct prefix_list_trie *trie;
   struct prefix_list_entry *pentry;
   struct prefix *p;
 
@@ -574,14 +879,22 @@ prefix_list_apply (struct prefix_list *plist, void *object)
   if (plist->count == 0)
     return PREFIX_PERMIT;
 
-  for (pentry = plist->head; pentry; pentry = pentry->next)
-    {
-      pentry->refcnt++;
+  /* Each entry's refcnt follows from applycnt and the matches before
+     it, see prefix_list_refcnt_update(). */
+  plist->applycnt++;
+
+  if ((trie = prefix_list_trie_get (plist)) != NULL)
+    pentry = prefix_list_trie_match (trie, p);
+  else
+    for (pentry = plist->head; pentry; pentry = pentry->next)
       if (prefix_list_entry_match (pentry, p))
-	{
-	  pentry->hitcnt++;
-	  return pentry->type;
-	}
+	break;
+
+  if (pentry)
+    {
+      pentry->hitcnt++;
+      pentry->matchcnt++;
+      return pentry->type;
     }
 
   return PREFIX_DENY;
@@ -627,6 +940,7 @@ static struct prefix_list_entry *
 prefix_entry_dup_check (struct prefix_list *plist,
 			struct prefix_list_entry *new)
 {
+  struct prefix_list_trie *trie;
   struct prefix_list_entry *pentry;
   int seq = 0;
 
@@ -635,7 +949,12 @@ prefix_entry_dup_check (struct prefix_list *plist,
   else
     seq = new->seq;
 
-  for (pentry = plist->head; pentry; pentry = pentry->next)
+  if ((trie = prefix_list_trie_get (plist)) != NULL)
+    pentry = prefix_list_trie_lookup (trie, &new->prefix);
+  else
+    pentry = plist->head;
+
+  for (; pentry; pentry = trie ? pentry->trie_next : pentry->next)
     {
       if (prefix_same (&pentry->prefix, &new->prefix)
 	  && pentry->type == new->type
@@ -926,6 +1245,8 @@ vty_show_prefix_entry (struct vty *vty, afi_t afi, struct prefix_list *plist,
 {
   struct prefix_list_entry *pentry;
 
+  prefix_list_refcnt_update (plist);
+
   /* Print the name of the protocol */
   if (zlog_default)
       vty_out (vty, "%s: ", zlog_proto_names[zlog_default->protocol]);
@@ -1061,6 +1382,8 @@ vty_show_prefix_list_prefix (struct vty *vty, afi_t afi, const char *name,
       return CMD_WARNING;
     }
 
+  prefix_list_refcnt_update (plist);
+
   for (pentry = plist->head; pentry; pentry = pentry->next)
     {
       match = 0;
@@ -52,10 +52,27 @@ struct prefix_list
   struct prefix_list_entry *head;
   struct prefix_list_entry *tail;
 
+  /* Entries indexed by prefix, built when the list is first used. */
+  struct prefix_list_trie *trie;
+
+  /* Applications since the entries' refcounts were brought up to
+     date. */
+  unsigned long applycnt;
+
   struct prefix_list *next;
   struct prefix_list *prev;
 };
 
+/* A prefix list named by a route map rule or the like.  The name is
+   looked up again only after prefix lists have been added or deleted. */
+struct prefix_list_ref
+{
+  afi_t afi;
+  char *name;
+  struct prefix_list *plist;
+  unsigned int generation;
+};
+
 struct orf_prefix
 {
   u_int32_t seq;
@@ -72,6 +89,9 @@ extern void prefix_list_delete_hook (void (*func) (struct prefix_list *));
 
 extern struct prefix_list *prefix_list_lookup (afi_t, const char *);
 extern enum prefix_list_type prefix_list_apply (struct prefix_list *, void *);
+extern struct prefix_list_ref *prefix_list_ref_new (afi_t, const char *);
+extern void prefix_list_ref_free (struct prefix_list_ref *);
+extern struct prefix_list *prefix_list_ref_lookup (struct prefix_list_ref *);
 
 extern struct stream * prefix_bgp_orf_entry (struct stream *,
                                              struct prefix_list *,
@@ -0,0 +1,495 @@
+/* Shared-memory export of the zebra RIB
+ *
+ * This file is part of GNU Zebra.
+ *
+ * GNU Zebra is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * GNU Zebra is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Zebra; see the file COPYING.  If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <zebra.h>
+#include <sys/mman.h>
+#include <sched.h>
+
+#include "memory.h"
+#include "log.h"
+#include "prefix.h"
+#include "table.h"
+#include "rib_shm.h"
+
+/* how often a reader retries a slot that zebra keeps writing */
+#define RIB_SHM_READ_TRIES 1000
+
+#define RIB_SHM_ADDRLEN(family) ((family) == AF_INET ? 4 : 16)
+
+static size_t
+rib_shm_size (u_int32_t slots, u_int32_t log_size)
+{
+  return sizeof (struct rib_shm_header) +
+    slots * sizeof (struct rib_shm_route) +
+    log_size * sizeof (struct rib_shm_change);
+}
+
+static void
+rib_shm_layout (struct rib_shm *shm)
+{
+  shm->routes = (struct rib_shm_route *) (shm->header + 1);
+  shm->log = (struct rib_shm_change *) (shm->routes + shm->header->slots);
+}
+
+static void
+rib_shm_unmap (struct rib_shm *shm)
+{
+  if (shm->header)
+    munmap (shm->header, shm->size);
+  if (shm->fd >= 0)
+    close (shm->fd);
+  shm->header = NULL;
+  shm->fd = -1;
+}
+
+/* Map a new, empty file at path.new; rib_shm_install() renames it
+   over path once it is filled */
+static int
+rib_shm_map_new (struct rib_shm *shm, u_int32_t slots, u_int32_t log_size,
+                 u_int32_t generation)
+{
+  char tmp[MAXPATHLEN];
+  void *addr;
+
+  snprintf (tmp, sizeof (tmp), "%s.new", shm->path);
+  shm->size = rib_shm_size (slots, log_size);
+  shm->fd = open (tmp, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (shm->fd < 0)
+    {
+      zlog_err ("%s: can't create %s: %s", __func__, tmp,
+                safe_strerror (errno));
+      return -1;
+    }
+  if (ftruncate (shm->fd, shm->size) < 0)
+    {
+      zlog_err ("%s: can't size %s: %s", __func__, tmp,
+                safe_strerror (errno));
+      unlink (tmp);
+      rib_shm_unmap (shm);
+      return -1;
+    }
+  addr = mmap (NULL, shm->size, PROT_READ | PROT_WRITE, MAP_SHARED,
+               shm->fd, 0);
+  if (addr == MAP_FAILED)
+    {
+      zlog_err ("%s: can't map %s: %s", __func__, tmp,
+                safe_strerror (errno));
+      unlink (tmp);
+      rib_shm_unmap (shm);
+      return -1;
+    }
+
+  shm->header = addr;
+  shm->header->magic = RIB_SHM_MAGIC;
+  shm->header->format = RIB_SHM_FORMAT;
+  shm->header->generation = generation;
+  shm->header->slots = slots;
+  shm->header->log_size = log_size;
+  rib_shm_layout (shm);
+
+  return 0;
+}
+
+static int
+rib_shm_install (struct rib_shm *shm)
+{
+  char tmp[MAXPATHLEN];
+
+  snprintf (tmp, sizeof (tmp), "%s.new", shm->path);
+  if (rename (tmp, shm->path) < 0)
+    {
+      zlog_err ("%s: can't rename %s: %s", __func__, tmp,
+                safe_strerror (errno));
+      unlink (tmp);
+      return -1;
+    }
+  return 0;
+}
+
+struct rib_shm *
+rib_shm_create (const char *path, u_int32_t slots, u_int32_t log_size)
+{
+  struct rib_shm *shm;
+
+  assert (log_size && (log_size & (log_size - 1)) == 0);
+
+  shm = XCALLOC (MTYPE_RIB_SHM, sizeof (struct rib_shm));
+  shm->path = XSTRDUP (MTYPE_RIB_SHM, path);
+  shm->fd = -1;
+
+  /* differs from what a previous zebra left at the same path */
+  if (rib_shm_map_new (shm, slots, log_size,
+                       (u_int32_t) time (NULL) ^ ((u_int32_t) getpid () << 16))
+      || rib_shm_install (shm))
+    {
+      rib_shm_unmap (shm);
+      XFREE (MTYPE_RIB_SHM, shm->path);
+      XFREE (MTYPE_RIB_SHM, shm);
+      return NULL;
+    }
+
+  shm->index[AFI_IP] = route_table_init ();
+  shm->index[AFI_IP6] = route_table_init ();
+  shm->free = XMALLOC (MTYPE_RIB_SHM, slots * sizeof (u_int32_t));
+
+  return shm;
+}
+
+/* Withdraw the export: readers still mapping the file see it retired */
+void
+rib_shm_destroy (struct rib_shm *shm)
+{
+  afi_t afi;
+
+  if (shm->header)
+    {
+      shm->header->retired = 1;
+      unlink (shm->path);
+    }
+  rib_shm_unmap (shm);
+
+  for (afi = AFI_IP; afi < AFI_MAX; afi++)
+    if (shm->index[afi])
+      route_table_finish (shm->index[afi]);
+  if (shm->free)
+    XFREE (MTYPE_RIB_SHM, shm->free);
+  XFREE (MTYPE_RIB_SHM, shm->path);
+  XFREE (MTYPE_RIB_SHM, shm);
+}
+
+/* Replace a full file by one with twice the slots */
+static int
+rib_shm_grow (struct rib_shm *shm)
+{
+  struct rib_shm old = *shm;
+  struct route_node *rn;
+  afi_t afi;
+
+  if (rib_shm_map_new (shm, old.header->slots * 2, old.header->log_size,
+                       old.header->generation + 1))
+    {
+      *shm = old;
+      return -1;
+    }
+
+  memcpy (shm->routes, old.routes,
+          old.header->used * sizeof (struct rib_shm_route));
+  shm->header->version = old.header->version;
+  shm->header->routes = old.header->routes;
+  shm->header->used = old.header->used;
+
+  if (rib_shm_install (shm))
+    {
+      rib_shm_unmap (shm);
+      *shm = old;
+      return -1;
+    }
+
+  old.header->retired = 1;
+  rib_shm_unmap (&old);
+
+  /* the index points into the mapping */
+  for (afi = AFI_IP; afi < AFI_MAX; afi++)
+    for (rn = route_top (shm->index[afi]); rn; rn = route_next (rn))
+      if (rn->info)
+        rn->info = shm->routes +
+          ((struct rib_shm_route *) rn->info - old.routes);
+
+  shm->free = XREALLOC (MTYPE_RIB_SHM, shm->free,
+                        shm->header->slots * sizeof (u_int32_t));
+
+  return 0;
+}
+
+/* Write a slot (or mark it free when route is NULL) and log the
+   change under the next version */
+static void
+rib_shm_write (struct rib_shm *shm, u_int32_t slot, struct prefix *p,
+               const struct rib_shm_route *route)
+{
+  struct rib_shm_route *r = &shm->routes[slot];
+  struct rib_shm_change *c;
+  u_int32_t version = shm->header->version + 1;
+  u_int32_t seq = r->seq;
+
+  r->seq = seq + 1;
+  __sync_synchronize ();
+  if (route)
+    {
+      r->state = RIB_SHM_ROUTE_ACTIVE;
+      r->family = p->family;
+      r->prefixlen = p->prefixlen;
+      memset (r->prefix, 0, sizeof (r->prefix));
+      memcpy (r->prefix, &p->u.prefix, RIB_SHM_ADDRLEN (p->family));
+      r->type = route->type;
+      r->flags = route->flags;
+      r->distance = route->distance;
+      r->metric = route->metric;
+      r->ifindex = route->ifindex;
+      memcpy (r->gate, route->gate, sizeof (r->gate));
+    }
+  else
+    r->state = 0;
+  r->version = version;
+  __sync_synchronize ();
+  r->seq = seq + 2;
+
+  /* readers still expecting the previous entry at this index notice
+     the version change */
+  c = &shm->log[version & (shm->header->log_size - 1)];
+  c->version = version;
+  __sync_synchronize ();
+  c->slot = slot;
+  c->family = p->family;
+  c->prefixlen = p->prefixlen;
+  memset (c->prefix, 0, sizeof (c->prefix));
+  memcpy (c->prefix, &p->u.prefix, RIB_SHM_ADDRLEN (p->family));
+  __sync_synchronize ();
+  shm->header->version = version;
+}
+
+int
+rib_shm_set (struct rib_shm *shm, struct prefix *p,
+             const struct rib_shm_route *route)
+{
+  struct route_node *rn;
+  u_int32_t slot;
+  afi_t afi = family2afi (p->family);
+
+  if (afi != AFI_IP && afi != AFI_IP6)
+    return -1;
+
+  rn = route_node_get (shm->index[afi], p);
+  if (rn->info)
+    {
+      route_unlock_node (rn);
+      slot = (struct rib_shm_route *) rn->info - shm->routes;
+    }
+  else
+    {
+      if (shm->nfree)
+        slot = shm->free[--shm->nfree];
+      else
+        {
+          if (shm->header->used == shm->header->slots && rib_shm_grow (shm))
+            {
+              route_unlock_node (rn);
+              return -1;
+            }
+          slot = shm->header->used++;
+        }
+      /* keeps the lock from route_node_get() */
+      rn->info = &shm->routes[slot];
+      shm->header->routes++;
+    }
+
+  rib_shm_write (shm, slot, p, route);
+  return 0;
+}
+
+int
+rib_shm_unset (struct rib_shm *shm, struct prefix *p)
+{
+  struct route_node *rn;
+  u_int32_t slot;
+  afi_t afi = family2afi (p->family);
+
+  if (afi != AFI_IP && afi != AFI_IP6)
+    return -1;
+
+  rn = route_node_lookup (shm->index[afi], p);
+  if (rn == NULL)
+    return -1;
+  slot = (struct rib_shm_route *) rn->info - shm->routes;
+  rn->info = NULL;
+  route_unlock_node (rn);
+  route_unlock_node (rn);
+
+  shm->free[shm->nfree++] = slot;
+  shm->header->routes--;
+
+  rib_shm_write (shm, slot, p, NULL);
+  return 0;
+}
+
+struct rib_shm *
+rib_shm_open (const char *path)
+{
+  struct rib_shm *shm;
+  struct stat st;
+  void *addr;
+
+  shm = XCALLOC (MTYPE_RIB_SHM, sizeof (struct rib_shm));
+  shm->path = XSTRDUP (MTYPE_RIB_SHM, path);
+  shm->fd = open (path, O_RDONLY);
+  if (shm->fd < 0 || fstat (shm->fd, &st) < 0 ||
+      (size_t) st.st_size < sizeof (struct rib_shm_header))
+    goto fail;
+
+  shm->size = st.st_size;
+  addr = mmap (NULL, shm->size, PROT_READ, MAP_SHARED, shm->fd, 0);
+  if (addr == MAP_FAILED)
+    goto fail;
+  shm->header = addr;
+
+  if (shm->header->magic != RIB_SHM_MAGIC ||
+      shm->header->format != RIB_SHM_FORMAT ||
+      shm->size != rib_shm_size (shm->header->slots,
+                                 shm->header->log_size))
+    goto fail;
+  rib_shm_layout (shm);
+
+  return shm;
+
+ fail:
+  rib_shm_close (shm);
+  return NULL;
+}
+
+void
+rib_shm_close (struct rib_shm *shm)
+{
+  rib_shm_unmap (shm);
+  XFREE (MTYPE_RIB_SHM, shm->path);
+  XFREE (MTYPE_RIB_SHM, shm);
+}
+
+/* Copy a slot, retrying while zebra writes it */
+static int
+rib_shm_read (const struct rib_shm_route *src, struct rib_shm_route *dst)
+{
+  const volatile u_int32_t *seqp = &src->seq;
+  u_int32_t seq;
+  int i;
+
+  for (i = 0; i < RIB_SHM_READ_TRIES; i++)
+    {
+      seq = *seqp;
+      if (seq & 1)
+        {
+          sched_yield ();
+          continue;
+        }
+      __sync_synchronize ();
+      memcpy (dst, src, sizeof (struct rib_shm_route));
+      __sync_synchronize ();
+      if (*seqp == seq)
+        return 0;
+    }
+  return -1;
+}
+
+static u_int32_t
+rib_shm_version (struct rib_shm *shm)
+{
+  u_int32_t version = *(volatile u_int32_t *) &shm->header->version;
+
+  __sync_synchronize ();
+  return version;
+}
+
+/* Call func for every route and set version to the one the routes
+   are at least as recent as.  Returns -1 when the file is retired or
+   a slot can't be read, the reader should then reopen the path. */
+int
+rib_shm_walk (struct rib_shm *shm, rib_shm_func func, void *arg,
+              u_int32_t *version)
+{
+  struct rib_shm_route route;
+  u_int32_t start, used, slot;
+
+  start = rib_shm_version (shm);
+  if (shm->header->retired)
+    return -1;
+
+  used = shm->header->used;
+  if (used > shm->header->slots)
+    return -1;
+  for (slot = 0; slot < used; slot++)
+    {
+      if (rib_shm_read (&shm->routes[slot], &route))
+        return -1;
+      if (CHECK_FLAG (route.state, RIB_SHM_ROUTE_ACTIVE))
+        (*func) (&route, arg);
+    }
+
+  *version = start;
+  return 0;
+}
+
+/* Call func for the route of every prefix changed after version
+   since, a removed route is passed without RIB_SHM_ROUTE_ACTIVE.
+   Returns -1 when the changes are no longer logged, the reader
+   should then walk the file again. */
+int
+rib_shm_changes (struct rib_shm *shm, u_int32_t since, rib_shm_func func,
+                 void *arg, u_int32_t *version)
+{
+  const struct rib_shm_change *entry;
+  const volatile u_int32_t *cversion;
+  struct rib_shm_change change;
+  struct rib_shm_route route;
+  u_int32_t end, v;
+
+  end = rib_shm_version (shm);
+  if (shm->header->retired || end - since > shm->header->log_size)
+    return -1;
+
+  for (v = since + 1; v != end + 1; v++)
+    {
+      entry = &shm->log[v & (shm->header->log_size - 1)];
+      cversion = &entry->version;
+      if (*cversion != v)
+        return -1;
+      __sync_synchronize ();
+      memcpy (&change, entry, sizeof (change));
+      __sync_synchronize ();
+      if (*cversion != v || change.slot >= shm->header->slots)
+        return -1;
+
+      if (rib_shm_read (&shm->routes[change.slot], &route))
+        return -1;
+      if (! CHECK_FLAG (route.state, RIB_SHM_ROUTE_ACTIVE) ||
+          route.family != change.family ||
+          route.prefixlen != change.prefixlen ||
+          memcmp (route.prefix, change.prefix, sizeof (route.prefix)))
+        {
+          /* removed since, the slot may even hold another prefix */
+          memset (&route, 0, sizeof (route));
+          route.version = v;
+          route.family = change.family;
+          route.prefixlen = change.prefixlen;
+          memcpy (route.prefix, change.prefix, sizeof (route.prefix));
+        }
+      (*func) (&route, arg);
+    }
+
+  *version = end;
+  return 0;
+}
+
+void
+rib_shm_route_prefix (const struct rib_shm_route *route, struct prefix *p)
+{
+  memset (p, 0, sizeof (struct prefix));
+  p->family = route->family;
+  p->prefixlen = route->prefixlen;
+  memcpy (&p->u.prefix, route->prefix, RIB_SHM_ADDRLEN (route->family));
+}
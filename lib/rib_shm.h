@@ -0,0 +1,129 @@
+/* Shared-memory export of the zebra RIB
+ *
+ * This file is part of GNU Zebra.
+ *
+ * GNU Zebra is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * GNU Zebra is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Zebra; see the file COPYING.  If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef _ZEBRA_RIB_SHM_H
+#define _ZEBRA_RIB_SHM_H
+
+#include "prefix.h"
+
+/* zebra writes the selected route of every prefix into a file that
+   other daemons map read-only.  The file holds a header, an array of
+   route slots and a ring of changes:
+
+   - every slot is protected by its own sequence counter, odd while
+     zebra is writing the slot, so readers retry instead of locking;
+
+   - every change increments the export version and is logged at
+     index (version % log_size), so a reader that has seen version V
+     can catch up on the slots changed since, or scan the whole file
+     again when the log has wrapped past V;
+
+   - a full file is replaced by a larger one renamed over the same
+     path: the old one is marked retired and readers reopen the path.
+
+   zserv only notifies subscribed clients of the new version. */
+
+#define RIB_SHM_MAGIC          0x51524942 /* "QRIB" */
+#define RIB_SHM_FORMAT         1
+
+#define RIB_SHM_SLOTS_DEFAULT  4096
+#define RIB_SHM_LOG_DEFAULT    4096     /* a power of two */
+
+struct rib_shm_header
+{
+  u_int32_t magic;
+  u_int32_t format;
+  u_int32_t generation;         /* changes whenever the file is replaced */
+  u_int32_t retired;            /* nonzero once replaced or withdrawn */
+  u_int32_t slots;
+  u_int32_t log_size;
+  u_int32_t version;            /* of the last change */
+  u_int32_t routes;             /* slots in use */
+  u_int32_t used;               /* slots ever used, free ones included */
+};
+
+#define RIB_SHM_ROUTE_ACTIVE   0x01
+
+struct rib_shm_route
+{
+  u_int32_t seq;                /* odd while the slot is written */
+  u_int32_t version;            /* of the last change of the slot */
+  u_char state;
+  u_char family;
+  u_char prefixlen;
+  u_char type;                  /* ZEBRA_ROUTE_* */
+  u_char flags;                 /* ZEBRA_FLAG_* */
+  u_char distance;
+  u_char pad[2];
+  u_int32_t metric;
+  u_int32_t ifindex;            /* of the first installed nexthop */
+  u_char prefix[16];
+  u_char gate[16];
+};
+
+struct rib_shm_change
+{
+  u_int32_t version;
+  u_int32_t slot;
+  u_char family;
+  u_char prefixlen;
+  u_char pad[2];
+  u_char prefix[16];
+};
+
+/* A mapping of the file, by zebra or by a reader */
+struct rib_shm
+{
+  char *path;
+  int fd;
+  size_t size;
+
+  struct rib_shm_header *header;
+  struct rib_shm_route *routes;
+  struct rib_shm_change *log;
+
+  /* zebra only: the slot of each prefix and the free slots */
+  struct route_table *index[AFI_MAX];
+  u_int32_t *free;
+  u_int32_t nfree;
+};
+
+typedef void (*rib_shm_func) (const struct rib_shm_route *, void *);
+
+/* zebra */
+extern struct rib_shm *rib_shm_create (const char *path, u_int32_t slots,
+                                       u_int32_t log_size);
+extern void rib_shm_destroy (struct rib_shm *shm);
+extern int rib_shm_set (struct rib_shm *shm, struct prefix *p,
+                        const struct rib_shm_route *route);
+extern int rib_shm_unset (struct rib_shm *shm, struct prefix *p);
+
+/* readers */
+extern struct rib_shm *rib_shm_open (const char *path);
+extern void rib_shm_close (struct rib_shm *shm);
+extern int rib_shm_walk (struct rib_shm *shm, rib_shm_func func, void *arg,
+                         u_int32_t *version);
+extern int rib_shm_changes (struct rib_shm *shm, u_int32_t since,
+                            rib_shm_func func, void *arg,
+                            u_int32_t *version);
+extern void rib_shm_route_prefix (const struct rib_shm_route *route,
+                                  struct prefix *p);
+
+#endif /* _ZEBRA_RIB_SHM_H */
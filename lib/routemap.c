@@ -23,6 +23,7 @@ Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
 #include "linklist.h"
 #include "memory.h"
 #include "vector.h"
+#include "hash.h"
 #include "prefix.h"
 #include "routemap.h"
 #include "command.h"
@@ -47,6 +48,9 @@ struct route_map_rule
   /* Pre-compiled match rule. */
   void *value;
 
+  /* Routes that matched the rule, or had it set. */
+  unsigned long hitcnt;
+
   /* Linked list. */
   struct route_map_rule *next;
   struct route_map_rule *prev;
@@ -58,13 +62,70 @@ struct route_map_list
   struct route_map *head;
   struct route_map *tail;
 
+  /* Route maps by name. */
+  struct hash *hash;
+
+  /* Bumped by any change to route maps, which makes the programs
+     compiled before it stale. */
+  unsigned int generation;
+
   void (*add_hook) (const char *);
   void (*delete_hook) (const char *);
   void (*event_hook) (route_map_event_t, const char *); 
 };
 
 /* Master list of route map. */
-static struct route_map_list route_map_master = { NULL, NULL, NULL, NULL };
+static struct route_map_list route_map_master =
+  { NULL, NULL, NULL, 0, NULL, NULL, NULL };
+
+/* A match or set rule as applied. */
+struct route_map_closure
+{
+  route_map_result_t (*func_apply) (void *, struct prefix *,
+				    route_map_object_t, void *);
+  void *value;
+  unsigned long *hitcnt;
+};
+
+/* What route maps are hashed by. */
+struct route_map_key
+{
+  const char *name;
+};
+
+/* A route map entry as applied.  Its match and set rules are runs of
+   the program's closures. */
+struct route_map_step
+{
+  struct route_map_index *index;
+
+  struct route_map_closure *match;
+  unsigned int nmatch;
+
+  struct route_map_closure *set;
+  unsigned int nset;
+
+  /* Whether there is a call statement, and the route map it calls if
+     that exists. */
+  int call;
+  struct route_map *nextrm;
+
+  /* The step its exit policy goes on to after a match, or -1 to
+     finish. */
+  int next;
+};
+
+/* A route map compiled into an array of its entries, so that applying
+   it follows no lists and looks up no names. */
+struct route_map_program
+{
+  /* route_map_master.generation when compiled. */
+  unsigned int generation;
+
+  unsigned int nsteps;
+  struct route_map_step *steps;
+  struct route_map_closure *closures;
+};
 
 static void
 route_map_rule_delete (struct route_map_rule_list *,
@@ -85,15 +146,51 @@ route_map_new (const char *name)
   return new;
 }
 
+/* The route map hash holds route maps and is searched by keys. */
+static unsigned int
+route_map_hash_key (void *arg)
+{
+  struct route_map_key *key = arg;
+
+  return string_hash_make (key->name);
+}
+
+static int
+route_map_hash_cmp (const void *arg1, const void *arg2)
+{
+  const struct route_map *map = arg1;
+  const struct route_map_key *key = arg2;
+
+  return strcmp (map->name, key->name) == 0;
+}
+
+static void *
+route_map_hash_alloc (void *arg)
+{
+  struct route_map_key *key = arg;
+
+  return route_map_new (key->name);
+}
+
+static void
+route_map_program_free (struct route_map *map)
+{
+  if (map->program)
+    XFREE (MTYPE_ROUTE_MAP_PROGRAM, map->program);
+  map->program = NULL;
+}
+
 /* Add new name to route_map. */
 static struct route_map *
 route_map_add (const char *name)
 {
   struct route_map *map;
   struct route_map_list *list;
+  struct route_map_key key;
 
-  map = route_map_new (name);
   list = &route_map_master;
+  key.name = name;
+  map = hash_get (list->hash, &key, route_map_hash_alloc);
     
   map->next = NULL;
   map->prev = list->tail;
@@ -103,6 +200,8 @@ route_map_add (const char *name)
     list->head = map;
   list->tail = map;
 
+  list->generation++;
+
   /* Execute hook. */
   if (route_map_master.add_hook)
     (*route_map_master.add_hook) (name);
@@ -116,6 +215,7 @@ route_map_delete (struct route_map *map)
 {
   struct route_map_list *list;
   struct route_map_index *index;
+  struct route_map_key key;
   char *name;
   
   while ((index = map->head) != NULL)
@@ -135,6 +235,11 @@ route_map_delete (struct route_map *map)
   else
     list->head = map->next;
 
+  key.name = name;
+  hash_release (list->hash, &key);
+  list->generation++;
+
+  route_map_program_free (map);
   XFREE (MTYPE_ROUTE_MAP, map);
 
   /* Execute deletion hook. */
@@ -150,12 +255,10 @@ route_map_delete (struct route_map *map)
 struct route_map *
 route_map_lookup_by_name (const char *name)
 {
-  struct route_map *map;
+  struct route_map_key key;
 
-  for (map = route_map_master.head; map; map = map->next)
-    if (strcmp (map->name, name) == 0)
-      return map;
-  return NULL;
+  key.name = name;
+  return hash_lookup (route_map_master.hash, &key);
 }
 
 /* Lookup route map.  If there isn't route map create one and return
@@ -224,13 +327,13 @@ vty_show_route_map_entry (struct vty *vty, struct route_map *map)
       /* Match clauses */
       vty_out (vty, "  Match clauses:%s", VTY_NEWLINE);
       for (rule = index->match_list.head; rule; rule = rule->next)
-        vty_out (vty, "    %s %s%s", 
-                 rule->cmd->str, rule->rule_str, VTY_NEWLINE);
+        vty_out (vty, "    %s %s (matched %lu)%s", 
+                 rule->cmd->str, rule->rule_str, rule->hitcnt, VTY_NEWLINE);
       
       vty_out (vty, "  Set clauses:%s", VTY_NEWLINE);
       for (rule = index->set_list.head; rule; rule = rule->next)
-        vty_out (vty, "    %s %s%s",
-                 rule->cmd->str, rule->rule_str, VTY_NEWLINE);
+        vty_out (vty, "    %s %s (set %lu)%s",
+                 rule->cmd->str, rule->rule_str, rule->hitcnt, VTY_NEWLINE);
       
       /* Call clause */
       vty_out (vty, "  Call clause:%s", VTY_NEWLINE);
@@ -245,6 +348,9 @@ vty_show_route_map_entry (struct vty *vty, struct route_map *map)
         vty_out (vty, "    Continue to next entry%s", VTY_NEWLINE);
       else if (index->exitpolicy == RMAP_EXIT)
         vty_out (vty, "    Exit routemap%s", VTY_NEWLINE);
+
+      vty_out (vty, "  Matched %lu of %lu routes%s",
+               index->hitcnt, index->applycnt, VTY_NEWLINE);
     }
 }
 
@@ -318,6 +424,8 @@ route_map_index_delete (struct route_map_index *index, int notify)
   if (index->nextrm)
     XFREE (MTYPE_ROUTE_MAP_NAME, index->nextrm);
 
+  route_map_master.generation++;
+
     /* Execute event hook. */
   if (route_map_master.event_hook && notify)
     (*route_map_master.event_hook) (RMAP_EVENT_INDEX_DELETED,
@@ -384,6 +492,8 @@ route_map_index_add (struct route_map *map, enum route_map_type type,
       point->prev = index;
     }
 
+  route_map_master.generation++;
+
   /* Execute event hook. */
   if (route_map_master.event_hook)
     (*route_map_master.event_hook) (RMAP_EVENT_INDEX_ADDED,
@@ -475,6 +585,8 @@ route_map_rule_add (struct route_map_rule_list *list,
   else
     list->head = rule;
   list->tail = rule;
+
+  route_map_master.generation++;
 }
 
 /* Delete rule from rule list. */
@@ -498,6 +610,8 @@ route_map_rule_delete (struct route_map_rule_list *list,
     list->head = rule->next;
 
   XFREE (MTYPE_ROUTE_MAP_RULE, rule);
+
+  route_map_master.generation++;
 }
 
 /* strcmp wrapper function which don't crush even argument is NULL. */
@@ -739,34 +853,104 @@ route_map_delete_set (struct route_map_index *index, const char *set_name,
    We need to make sure our route-map processing matches the above
 */
 
-static route_map_result_t
-route_map_apply_match (struct route_map_rule_list *match_list,
-                       struct prefix *prefix, route_map_object_t type,
-                       void *object)
+/* Compile route map MAP into a program. */
+static struct route_map_program *
+route_map_compile (struct route_map *map)
 {
-  route_map_result_t ret = RMAP_NOMATCH;
-  struct route_map_rule *match;
+  struct route_map_program *program;
+  struct route_map_closure *closure;
+  struct route_map_step *step;
+  struct route_map_index *index;
+  struct route_map_rule *rule;
+  unsigned int nsteps = 0, nclosures = 0;
+  int i, j;
 
+  for (index = map->head; index; index = index->next)
+    {
+      nsteps++;
+      for (rule = index->match_list.head; rule; rule = rule->next)
+	nclosures++;
+      for (rule = index->set_list.head; rule; rule = rule->next)
+	nclosures++;
+    }
 
-  /* Check all match rule and if there is no match rule, go to the
-     set statement. */
-  if (!match_list->head)
-    ret = RMAP_MATCH;
-  else
+  program = XCALLOC (MTYPE_ROUTE_MAP_PROGRAM,
+		     sizeof (struct route_map_program)
+		     + nsteps * sizeof (struct route_map_step)
+		     + nclosures * sizeof (struct route_map_closure));
+  program->generation = route_map_master.generation;
+  program->nsteps = nsteps;
+  program->steps = (struct route_map_step *) (program + 1);
+  program->closures = (struct route_map_closure *) (program->steps + nsteps);
+
+  step = program->steps;
+  closure = program->closures;
+  for (index = map->head; index; index = index->next, step++)
     {
-      for (match = match_list->head; match; match = match->next)
-        {
-          /* Try each match statement in turn, If any do not return
-             RMAP_MATCH, return, otherwise continue on to next match 
-             statement. All match statements must match for end-result
-             to be a match. */
-          ret = (*match->cmd->func_apply) (match->value, prefix,
-                                           type, object);
-          if (ret != RMAP_MATCH)
-            return ret;
-        }
+      step->index = index;
+
+      step->match = closure;
+      for (rule = index->match_list.head; rule; rule = rule->next, closure++)
+	{
+	  closure->func_apply = rule->cmd->func_apply;
+	  closure->value = rule->value;
+	  closure->hitcnt = &rule->hitcnt;
+	}
+      step->nmatch = closure - step->match;
+
+      step->set = closure;
+      for (rule = index->set_list.head; rule; rule = rule->next, closure++)
+	{
+	  closure->func_apply = rule->cmd->func_apply;
+	  closure->value = rule->value;
+	  closure->hitcnt = &rule->hitcnt;
+	}
+      step->nset = closure - step->set;
+
+      if (index->nextrm)
+	{
+	  step->call = 1;
+	  step->nextrm = route_map_lookup_by_name (index->nextrm);
+	}
+    }
+
+  /* Resolve the exit policies.  A goto is to the first entry after
+     this one whose preference is at least the one given. */
+  for (i = 0; i < (int) nsteps; i++)
+    {
+      step = &program->steps[i];
+      switch (step->index->exitpolicy)
+	{
+	case RMAP_EXIT:
+	  step->next = -1;
+	  break;
+	case RMAP_NEXT:
+	  step->next = i + 1;
+	  break;
+	case RMAP_GOTO:
+	  for (j = i + 1; j < (int) nsteps; j++)
+	    if (program->steps[j].index->pref >= step->index->nextpref)
+	      break;
+	  step->next = j < (int) nsteps ? j : -1;
+	  break;
+	}
     }
-  return ret;
+
+  return program;
+}
+
+/* Route map MAP's program, compiled again if route maps have changed
+   since it was. */
+static struct route_map_program *
+route_map_program_get (struct route_map *map)
+{
+  if (map->program == NULL
+      || map->program->generation != route_map_master.generation)
+    {
+      route_map_program_free (map);
+      map->program = route_map_compile (map);
+    }
+  return map->program;
 }
 
 /* Apply route map to the object. */
@@ -776,8 +960,10 @@ route_map_apply (struct route_map *map, struct prefix *prefix,
 {
   static int recursion = 0;
   int ret = 0;
-  struct route_map_index *index;
-  struct route_map_rule *set;
+  struct route_map_program *program;
+  struct route_map_step *step;
+  unsigned int j;
+  int i;
 
   if (recursion > RMAP_RECURSION_LIMIT)
     {
@@ -791,74 +977,63 @@ route_map_apply (struct route_map *map, struct prefix *prefix,
   if (map == NULL)
     return RMAP_DENYMATCH;
 
-  for (index = map->head; index; index = index->next)
+  program = route_map_program_get (map);
+
+  for (i = 0; i < (int) program->nsteps; )
     {
-      /* Apply this index. */
-      ret = route_map_apply_match (&index->match_list, prefix, type, object);
+      step = &program->steps[i];
+      step->index->applycnt++;
+
+      /* Apply this index.  Try each match statement in turn: all must
+         return RMAP_MATCH for the index to match, which it does if
+         there are none. */
+      ret = RMAP_MATCH;
+      for (j = 0; j < step->nmatch && ret == RMAP_MATCH; j++)
+        if ((ret = (*step->match[j].func_apply) (step->match[j].value, prefix,
+                                                 type, object)) == RMAP_MATCH)
+          (*step->match[j].hitcnt)++;
 
       /* Now we apply the matrix from above */
-      if (ret == RMAP_NOMATCH)
-        /* 'cont' from matrix - continue to next route-map sequence */
-        continue;
-      else if (ret == RMAP_MATCH)
+      if (ret != RMAP_MATCH)
         {
-          if (index->type == RMAP_PERMIT)
-            /* 'action' */
-            {
-              /* permit+match must execute sets */
-              for (set = index->set_list.head; set; set = set->next)
-                ret = (*set->cmd->func_apply) (set->value, prefix,
-                                               type, object);
-
-              /* Call another route-map if available */
-              if (index->nextrm)
-                {
-                  struct route_map *nextrm =
-                                    route_map_lookup_by_name (index->nextrm);
-
-                  if (nextrm) /* Target route-map found, jump to it */
-                    {
-                      recursion++;
-                      ret = route_map_apply (nextrm, prefix, type, object);
-                      recursion--;
-                    }
-
-                  /* If nextrm returned 'deny', finish. */
-                  if (ret == RMAP_DENYMATCH)
-                    return ret;
-                }
-                
-              switch (index->exitpolicy)
-                {
-                  case RMAP_EXIT:
-                    return ret;
-                  case RMAP_NEXT:
-                    continue;
-                  case RMAP_GOTO:
-                    {
-                      /* Find the next clause to jump to */
-                      struct route_map_index *next = index->next;
-                      int nextpref = index->nextpref;
-
-                      while (next && next->pref < nextpref)
-                        {
-                          index = next;
-                          next = next->next;
-                        }
-                      if (next == NULL)
-                        {
-                          /* No clauses match! */
-                          return ret;
-                        }
-                    }
-                }
-            }
-          else if (index->type == RMAP_DENY)
-            /* 'deny' */
+          /* 'cont' from matrix - continue to next route-map sequence */
+          i++;
+          continue;
+        }
+
+      step->index->hitcnt++;
+
+      if (step->index->type == RMAP_DENY)
+        /* 'deny' */
+        return RMAP_DENYMATCH;
+
+      /* 'action': permit+match must execute sets */
+      for (j = 0; j < step->nset; j++)
+        {
+          ret = (*step->set[j].func_apply) (step->set[j].value, prefix,
+                                            type, object);
+          (*step->set[j].hitcnt)++;
+        }
+
+      /* Call another route-map if available */
+      if (step->call)
+        {
+          if (step->nextrm) /* Target route-map found, jump to it */
             {
-                return RMAP_DENYMATCH;
+              recursion++;
+              ret = route_map_apply (step->nextrm, prefix, type, object);
+              recursion--;
             }
+
+          /* If nextrm returned 'deny', finish. */
+          if (ret == RMAP_DENYMATCH)
+            return ret;
         }
+
+      /* Go on as the exit policy says, or finish. */
+      if (step->next < 0)
+        return ret;
+      i = step->next;
     }
   /* Finally route-map does not match at all. */
   return RMAP_DENYMATCH;
@@ -888,6 +1063,9 @@ route_map_init (void)
   /* Make vector for match and set. */
   route_match_vec = vector_init (1);
   route_set_vec = vector_init (1);
+
+  route_map_master.hash = hash_create (route_map_hash_key,
+				       route_map_hash_cmp);
 }
 
 void
@@ -897,6 +1075,10 @@ route_map_finish (void)
   route_match_vec = NULL;
   vector_free (route_set_vec);
   route_set_vec = NULL;
+
+  hash_clean (route_map_master.hash, NULL);
+  hash_free (route_map_master.hash);
+  route_map_master.hash = NULL;
 }
 
 /* VTY related functions. */
@@ -1051,7 +1233,10 @@ DEFUN (rmap_onmatch_next,
   index = vty->index;
 
   if (index)
-    index->exitpolicy = RMAP_NEXT;
+    {
+      index->exitpolicy = RMAP_NEXT;
+      route_map_master.generation++;
+    }
 
   return CMD_SUCCESS;
 }
@@ -1068,7 +1253,10 @@ DEFUN (no_rmap_onmatch_next,
   index = vty->index;
   
   if (index)
-    index->exitpolicy = RMAP_EXIT;
+    {
+      index->exitpolicy = RMAP_EXIT;
+      route_map_master.generation++;
+    }
 
   return CMD_SUCCESS;
 }
@@ -1101,6 +1289,7 @@ DEFUN (rmap_onmatch_goto,
 	{
 	  index->exitpolicy = RMAP_GOTO;
 	  index->nextpref = d;
+	  route_map_master.generation++;
 	}
     }
   return CMD_SUCCESS;
@@ -1118,7 +1307,10 @@ DEFUN (no_rmap_onmatch_goto,
   index = vty->index;
 
   if (index)
-    index->exitpolicy = RMAP_EXIT;
+    {
+      index->exitpolicy = RMAP_EXIT;
+      route_map_master.generation++;
+    }
   
   return CMD_SUCCESS;
 }
@@ -1162,6 +1354,49 @@ DEFUN (rmap_show_name,
     return vty_show_route_map (vty, name);
 }
 
+static void
+route_map_clear_counters (struct route_map *map)
+{
+  struct route_map_index *index;
+  struct route_map_rule *rule;
+
+  for (index = map->head; index; index = index->next)
+    {
+      index->applycnt = index->hitcnt = 0;
+      for (rule = index->match_list.head; rule; rule = rule->next)
+        rule->hitcnt = 0;
+      for (rule = index->set_list.head; rule; rule = rule->next)
+        rule->hitcnt = 0;
+    }
+}
+
+DEFUN (clear_route_map_counters,
+       clear_route_map_counters_cmd,
+       "clear route-map counters [WORD]",
+       CLEAR_STR
+       "route-map information\n"
+       "Route map match counters\n"
+       "route-map name\n")
+{
+  struct route_map *map;
+
+  if (argc)
+    {
+      map = route_map_lookup_by_name (argv[0]);
+      if (map == NULL)
+        {
+          vty_out (vty, "%%route-map %s not found%s", argv[0], VTY_NEWLINE);
+          return CMD_WARNING;
+        }
+      route_map_clear_counters (map);
+    }
+  else
+    for (map = route_map_master.head; map; map = map->next)
+      route_map_clear_counters (map);
+
+  return CMD_SUCCESS;
+}
+
 ALIAS (rmap_onmatch_goto,
       rmap_continue_index_cmd,
       "continue <1-65536>",
@@ -1182,6 +1417,7 @@ DEFUN (rmap_call,
       if (index->nextrm)
           XFREE (MTYPE_ROUTE_MAP_NAME, index->nextrm);
       index->nextrm = XSTRDUP (MTYPE_ROUTE_MAP_NAME, argv[0]);
+      route_map_master.generation++;
     }
   return CMD_SUCCESS;
 }
@@ -1200,6 +1436,7 @@ DEFUN (no_rmap_call,
     {
       XFREE (MTYPE_ROUTE_MAP_NAME, index->nextrm);
       index->nextrm = NULL;
+      route_map_master.generation++;
     }
 
   return CMD_SUCCESS;
@@ -1331,4 +1568,5 @@ route_map_init_vty (void)
    
   /* Install show command */
   install_element (ENABLE_NODE, &rmap_show_name_cmd);
+  install_element (ENABLE_NODE, &clear_route_map_counters_cmd);
 }
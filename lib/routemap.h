@@ -131,6 +131,10 @@ struct route_map_index
   struct route_map_rule_list match_list;
   struct route_map_rule_list set_list;
 
+  /* Routes this entry was applied to, and those that matched it. */
+  unsigned long applycnt;
+  unsigned long hitcnt;
+
   /* Make linked list. */
   struct route_map_index *next;
   struct route_map_index *prev;
@@ -146,6 +150,9 @@ struct route_map
   struct route_map_index *head;
   struct route_map_index *tail;
 
+  /* The entries as applied, compiled on first use after a change. */
+  struct route_map_program *program;
+
   /* Make linked list. */
   struct route_map *next;
   struct route_map *prev;
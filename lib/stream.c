@@ -85,6 +85,8 @@
       } \
   } while (0);
 
+unsigned long long stream_copied;
+
 /* Make stream buffer. */
 struct stream *
 stream_new (size_t size)
@@ -137,6 +139,7 @@ stream_copy (struct stream *new, struct stream *src)
   new->getp = src->getp;
   
   memcpy (new->data, src->data, src->endp);
+  stream_copied += src->endp;
   
   return new;
 }
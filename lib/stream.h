@@ -219,4 +219,7 @@ extern struct stream *stream_fifo_head (struct stream_fifo *fifo);
 extern void stream_fifo_clean (struct stream_fifo *fifo);
 extern void stream_fifo_free (struct stream_fifo *fifo);
 
+/* Bytes copied from one stream to another by stream_copy(). */
+extern unsigned long long stream_copied;
+
 #endif /* _ZEBRA_STREAM_H */
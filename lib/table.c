@@ -64,6 +64,7 @@ route_node_set (struct route_table *table, struct prefix *prefix)
 
   prefix_copy (&node->p, prefix);
   node->table = table;
+  table->count++;
 
   return node;
 }
@@ -192,6 +193,14 @@ route_unlock_node (struct route_node *node)
     route_node_delete (node);
 }
 
+/* The closest node above node, whose prefix contains node's.  It is
+   not locked, and it may have no info. */
+struct route_node *
+route_node_parent (struct route_node *node)
+{
+  return node->parent;
+}
+
 /* Find matched prefix. */
 struct route_node *
 route_node_match (const struct route_table *table, const struct prefix *p)
@@ -273,6 +282,26 @@ route_node_lookup (struct route_table *table, struct prefix *p)
   return NULL;
 }
 
+/* Get the first node, locked, of the subtree of p: p's own node or
+   the first node whose prefix p contains.  Return NULL when there is
+   none.  Nodes without info are returned as well. */
+struct route_node *
+route_subtree_top (struct route_table *table, struct prefix *p)
+{
+  struct route_node *node;
+
+  node = table->top;
+
+  while (node && node->p.prefixlen < p->prefixlen &&
+	 prefix_match (&node->p, p))
+    node = node->link[prefix_bit(&p->u.prefix, node->p.prefixlen)];
+
+  if (node && prefix_match (p, &node->p))
+    return route_lock_node (node);
+
+  return NULL;
+}
+
 /* Add node to routing table. */
 struct route_node *
 route_node_get (struct route_table *table, struct prefix *p)
@@ -307,6 +336,7 @@ route_node_get (struct route_table *table, struct prefix *p)
       route_common (&node->p, p, &new->p);
       new->p.family = p->family;
       new->table = table;
+      table->count++;
       set_link (new, node);
 
       if (match)
@@ -359,6 +389,7 @@ route_node_delete (struct route_node *node)
   else
     node->table->top = child;
 
+  node->table->count--;
   route_node_free (node);
 
   /* If parent node is stub then delete it also. */
@@ -421,6 +452,35 @@ route_next (struct route_node *node)
   return NULL;
 }
 
+/* Unlock current node and lock the node before it, in the order of
+   route_next, then return it. */
+struct route_node *
+route_prev (struct route_node *node)
+{
+  struct route_node *end;
+  struct route_node *prev = NULL;
+
+  end = node;
+  node = node->parent;
+  if (node)
+    route_lock_node (node);
+  while (node)
+    {
+      prev = node;
+      node = route_next (node);
+      if (node == end)
+        {
+          route_unlock_node (node);
+          node = NULL;
+        }
+    }
+  route_unlock_node (end);
+  if (prev)
+    route_lock_node (prev);
+
+  return prev;
+}
+
 /* Unlock current node and lock next node until limit. */
 struct route_node *
 route_next_until (struct route_node *node, struct route_node *limit)
@@ -461,3 +521,9 @@ route_next_until (struct route_node *node, struct route_node *limit)
   route_unlock_node (start);
   return NULL;
 }
+
+unsigned long
+route_table_count (const struct route_table *table)
+{
+  return table->count;
+}
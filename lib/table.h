@@ -23,10 +23,15 @@
 #ifndef _ZEBRA_TABLE_H
 #define _ZEBRA_TABLE_H
 
+#ifndef HAVE_MULTIBIT_TABLE
+
 /* Routing table top structure. */
 struct route_table
 {
   struct route_node *top;
+
+  /* Number of nodes, those without info included. */
+  unsigned long count;
 };
 
 /* Each routing entry. */
@@ -52,6 +57,63 @@ struct route_node
   void *aggregate;
 };
 
+#else /* HAVE_MULTIBIT_TABLE */
+
+/* Bits of the prefix consumed at each level of the trie. */
+#define ROUTE_STRIDE            4
+#define ROUTE_STRIDE_FANOUT     (1 << ROUTE_STRIDE)
+
+/* A level of the multibit trie, covering prefix lengths depth to
+   depth + ROUTE_STRIDE - 1 below key.  The nodes of those lengths are
+   kept in a heap indexed by (1 << length) | bits, so the nodes a
+   lookup visits sit next to each other, and the subtries of longer
+   prefixes hang from child[].  A child with nothing but one child of
+   its own is skipped, so a child may start deeper than depth +
+   ROUTE_STRIDE. */
+struct route_stride
+{
+  struct route_stride *parent;
+  u_char depth;
+  u_char index;                 /* in the parent's child[] */
+  u_int16_t nodes;              /* bitmap of the node[] in use */
+  u_int16_t children;           /* bitmap of the child[] in use */
+  struct prefix key;            /* significant up to depth */
+
+  struct route_node *node[ROUTE_STRIDE_FANOUT];
+  struct route_stride *child[ROUTE_STRIDE_FANOUT];
+};
+
+/* Routing table top structure. */
+struct route_table
+{
+  struct route_stride *root;
+
+  /* Number of nodes, those without info included. */
+  unsigned long count;
+};
+
+/* Each routing entry. */
+struct route_node
+{
+  /* Actual prefix of this node. */
+  struct prefix p;
+
+  /* The table and the level holding the node. */
+  struct route_table *table;
+  struct route_stride *stride;
+
+  /* Lock of this node */
+  unsigned int lock;
+
+  /* Each node of route. */
+  void *info;
+
+  /* Aggregation. */
+  void *aggregate;
+};
+
+#endif /* HAVE_MULTIBIT_TABLE */
+
 /* Prototypes. */
 extern struct route_table *route_table_init (void);
 extern void route_table_finish (struct route_table *);
@@ -61,10 +123,15 @@ extern struct route_node *route_top (struct route_table *);
 extern struct route_node *route_next (struct route_node *);
 extern struct route_node *route_next_until (struct route_node *,
                                             struct route_node *);
+extern struct route_node *route_prev (struct route_node *);
+extern struct route_node *route_node_parent (struct route_node *);
 extern struct route_node *route_node_get (struct route_table *,
                                           struct prefix *);
 extern struct route_node *route_node_lookup (struct route_table *,
                                              struct prefix *);
+extern struct route_node *route_subtree_top (struct route_table *,
+                                             struct prefix *);
+extern unsigned long route_table_count (const struct route_table *);
 extern struct route_node *route_lock_node (struct route_node *node);
 extern struct route_node *route_node_match (const struct route_table *,
                                             const struct prefix *);
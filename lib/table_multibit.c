@@ -0,0 +1,716 @@
+/*
+ * Routing Table functions, multibit trie.
+ *
+ * This file is part of GNU Zebra.
+ *
+ * GNU Zebra is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * GNU Zebra is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Zebra; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+/* A drop-in replacement for table.c, selected by configure
+ * --enable-multibit-table.  Instead of one binary node per prefix and
+ * per branching point, the trie consumes ROUTE_STRIDE bits of the
+ * prefix per level (see struct route_stride), so an IPv4 lookup visits
+ * at most 9 levels and an IPv6 one at most 33, fewer where levels are
+ * skipped.  Route nodes exist only for prefixes that were asked for:
+ * there are no glue nodes.
+ *
+ * Nodes are visited by route_next() in the same order as table.c
+ * visits them: a prefix comes before the prefixes it contains, and a 0
+ * bit before a 1 bit. */
+
+#include <zebra.h>
+
+#include "prefix.h"
+#include "table.h"
+#include "memory.h"
+#include "sockunion.h"
+
+void route_node_delete (struct route_node *);
+void route_table_free (struct route_table *);
+
+/* Utility mask array. */
+static const u_char maskbit[] =
+{
+  0x00, 0x80, 0xc0, 0xe0, 0xf0, 0xf8, 0xfc, 0xfe, 0xff
+};
+
+/* The ROUTE_STRIDE bits of key following the first depth ones: the
+   code below takes them to be a nibble. */
+static inline unsigned int
+route_key_chunk (const u_char *key, int depth)
+{
+  return (depth % 8) ? key[depth / 8] & 0x0f : key[depth / 8] >> 4;
+}
+
+/* Whether keys a and b have the same bits from bit from to bit to. */
+static int
+route_key_match (const u_char *a, const u_char *b, int from, int to)
+{
+  int i = from / 8;
+  u_char diff;
+
+  if (from >= to)
+    return 1;
+
+  for (; i < to / 8; i++)
+    {
+      diff = a[i] ^ b[i];
+      if (i == from / 8)
+        diff &= 0xff >> (from % 8);
+      if (diff)
+        return 0;
+    }
+
+  if (to % 8)
+    {
+      diff = (a[i] ^ b[i]) & maskbit[to % 8];
+      if (i == from / 8)
+        diff &= 0xff >> (from % 8);
+      if (diff)
+        return 0;
+    }
+
+  return 1;
+}
+
+/* The first bit from bit from on where keys a and b differ, or to. */
+static int
+route_key_common (const u_char *a, const u_char *b, int from, int to)
+{
+  int i = from;
+
+  while (i < to)
+    {
+      if (i % 8 == 0 && to - i >= 8 && a[i / 8] == b[i / 8])
+        {
+          i += 8;
+          continue;
+        }
+      if ((a[i / 8] ^ b[i / 8]) & (0x80 >> (i % 8)))
+        break;
+      i++;
+    }
+
+  return i;
+}
+
+/* Where in the heap of a level starting at depth the node for p is. */
+static inline unsigned int
+route_stride_pos (int depth, const struct prefix *p)
+{
+  int len = p->prefixlen - depth;
+
+  if (len == 0)
+    return 1;
+  return (1 << len) |
+    (route_key_chunk (&p->u.prefix, depth) >> (ROUTE_STRIDE - len));
+}
+
+struct route_table *
+route_table_init (void)
+{
+  struct route_table *rt;
+
+  rt = XCALLOC (MTYPE_ROUTE_TABLE, sizeof (struct route_table));
+  return rt;
+}
+
+void
+route_table_finish (struct route_table *rt)
+{
+  route_table_free (rt);
+}
+
+/* Allocate new level starting at depth on the path of p. */
+static struct route_stride *
+route_stride_new (const struct prefix *p, int depth)
+{
+  struct route_stride *stride;
+
+  stride = XCALLOC (MTYPE_ROUTE_STRIDE, sizeof (struct route_stride));
+  stride->depth = depth;
+  stride->key.family = p->family;
+  stride->key.prefixlen = depth;
+  memcpy (&stride->key.u.prefix, &p->u.prefix, (depth + 7) / 8);
+
+  return stride;
+}
+
+static void
+route_stride_link (struct route_stride *parent, unsigned int index,
+                   struct route_stride *child)
+{
+  parent->children |= 1 << index;
+  parent->child[index] = child;
+  child->parent = parent;
+  child->index = index;
+}
+
+/* Free a level and everything below it. */
+static void
+route_stride_free (struct route_stride *stride)
+{
+  int i;
+
+  for (i = 1; i < ROUTE_STRIDE_FANOUT; i++)
+    if (stride->node[i])
+      XFREE (MTYPE_ROUTE_NODE, stride->node[i]);
+
+  for (i = 0; i < ROUTE_STRIDE_FANOUT; i++)
+    if (stride->child[i])
+      route_stride_free (stride->child[i]);
+
+  XFREE (MTYPE_ROUTE_STRIDE, stride);
+}
+
+/* Free route table. */
+void
+route_table_free (struct route_table *rt)
+{
+  if (rt == NULL)
+    return;
+
+  if (rt->root)
+    route_stride_free (rt->root);
+
+  XFREE (MTYPE_ROUTE_TABLE, rt);
+}
+
+/* Find the level holding the node for p.  When create is set, missing
+   levels are added, and a skipped stretch of levels p leaves is split
+   by a new level at the last stride boundary p and the skipped level
+   have in common. */
+static struct route_stride *
+route_stride_find (struct route_table *table, const struct prefix *p,
+                   int create)
+{
+  const u_char *key = &p->u.prefix;
+  struct route_stride *stride, *child, *new;
+  unsigned int index;
+  int len = p->prefixlen;
+  int depth;
+
+  if (table->root == NULL)
+    {
+      if (! create)
+        return NULL;
+      table->root = route_stride_new (p, 0);
+    }
+
+  stride = table->root;
+  while (len >= stride->depth + ROUTE_STRIDE)
+    {
+      index = route_key_chunk (key, stride->depth);
+      child = stride->child[index];
+
+      if (child && child->depth <= len &&
+          route_key_match (&child->key.u.prefix, key,
+                           stride->depth + ROUTE_STRIDE, child->depth))
+        {
+          stride = child;
+          continue;
+        }
+
+      if (! create)
+        return NULL;
+
+      if (child == NULL)
+        {
+          new = route_stride_new (p, len - len % ROUTE_STRIDE);
+          route_stride_link (stride, index, new);
+          return new;
+        }
+
+      depth = route_key_common (&child->key.u.prefix, key,
+                                stride->depth + ROUTE_STRIDE,
+                                MIN (len, child->depth));
+      depth -= depth % ROUTE_STRIDE;
+
+      new = route_stride_new (p, depth);
+      route_stride_link (stride, index, new);
+      route_stride_link (new, route_key_chunk (&child->key.u.prefix, depth),
+                         child);
+      stride = new;
+    }
+
+  return stride;
+}
+
+/* Remove levels left without nodes, and levels left with nothing but
+   one child, from stride up. */
+static void
+route_stride_compact (struct route_table *table, struct route_stride *stride)
+{
+  struct route_stride *parent, *child;
+
+  while (stride && stride->nodes == 0)
+    {
+      parent = stride->parent;
+
+      if (stride->children == 0)
+        {
+          if (parent)
+            {
+              parent->child[stride->index] = NULL;
+              parent->children &= ~(1 << stride->index);
+            }
+          else
+            table->root = NULL;
+          XFREE (MTYPE_ROUTE_STRIDE, stride);
+          stride = parent;
+          continue;
+        }
+
+      if ((stride->children & (stride->children - 1)) == 0 && parent)
+        {
+          child = stride->child[ffs (stride->children) - 1];
+          parent->child[stride->index] = child;
+          child->parent = parent;
+          child->index = stride->index;
+          XFREE (MTYPE_ROUTE_STRIDE, stride);
+        }
+      break;
+    }
+}
+
+/* The heap positions and the children below each heap position. */
+static const u_int16_t below_nodes[ROUTE_STRIDE_FANOUT] =
+{
+  0x0000, 0xfffc, 0x0f30, 0xf0c0, 0x0300, 0x0c00, 0x3000, 0xc000,
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+};
+
+static const u_int16_t below_children[ROUTE_STRIDE_FANOUT] =
+{
+  0x0000, 0xffff, 0x00ff, 0xff00, 0x000f, 0x00f0, 0x0f00, 0xf000,
+  0x0003, 0x000c, 0x0030, 0x00c0, 0x0300, 0x0c00, 0x3000, 0xc000,
+};
+
+/* Whether there are nodes or children below heap position pos of
+   stride, pos excluded. */
+static inline int
+route_stride_below (const struct route_stride *stride, unsigned int pos)
+{
+  return (stride->nodes & below_nodes[pos]) ||
+    (stride->children & below_children[pos]);
+}
+
+/* The node following heap position pos of stride in the order of
+   route_next().  Positions from ROUTE_STRIDE_FANOUT on stand for the
+   children, so the heap and the children form one binary tree walked
+   in preorder, skipping the subtrees the bitmaps show empty. */
+static struct route_node *
+route_stride_next (struct route_stride *stride, unsigned int pos)
+{
+  struct route_stride *child;
+  int down;
+
+  down = route_stride_below (stride, pos);
+  while (stride)
+    {
+      if (pos < ROUTE_STRIDE_FANOUT && down)
+        pos <<= 1;
+      else
+        {
+          while (pos & 1)
+            pos >>= 1;
+          if (pos == 0)
+            {
+              /* Done with this level, go on after it in the parent. */
+              pos = ROUTE_STRIDE_FANOUT + stride->index;
+              stride = stride->parent;
+              continue;
+            }
+          pos++;
+        }
+
+      if (pos < ROUTE_STRIDE_FANOUT)
+        {
+          if (stride->nodes & (1 << pos))
+            return stride->node[pos];
+          down = route_stride_below (stride, pos);
+        }
+      else if ((child = stride->child[pos - ROUTE_STRIDE_FANOUT]) != NULL)
+        {
+          stride = child;
+          pos = 1;
+          if (stride->nodes & (1 << pos))
+            return stride->node[pos];
+          down = 1;
+        }
+    }
+
+  return NULL;
+}
+
+/* The last node in the order of route_next() below heap position pos
+   of stride, pos included. */
+static struct route_node *
+route_stride_last (struct route_stride *stride, unsigned int pos)
+{
+  struct route_node *node;
+
+  if (pos >= ROUTE_STRIDE_FANOUT)
+    {
+      stride = stride->child[pos - ROUTE_STRIDE_FANOUT];
+      return stride ? route_stride_last (stride, 1) : NULL;
+    }
+  if (! route_stride_below (stride, pos))
+    return stride->node[pos];
+
+  if ((node = route_stride_last (stride, (pos << 1) | 1)) != NULL)
+    return node;
+  if ((node = route_stride_last (stride, pos << 1)) != NULL)
+    return node;
+  return stride->node[pos];
+}
+
+/* The node preceding heap position pos of stride in the order of
+   route_next(). */
+static struct route_node *
+route_stride_prev (struct route_stride *stride, unsigned int pos)
+{
+  struct route_node *node;
+
+  while (stride)
+    {
+      if (pos == 1)
+        {
+          /* First of this level, go on before it in the parent. */
+          pos = ROUTE_STRIDE_FANOUT + stride->index;
+          stride = stride->parent;
+          continue;
+        }
+
+      /* A right child comes after the subtree of its left sibling,
+         which comes after their parent. */
+      if ((pos & 1) && (node = route_stride_last (stride, pos - 1)) != NULL)
+        return node;
+      pos >>= 1;
+      if (stride->node[pos])
+        return stride->node[pos];
+    }
+
+  return NULL;
+}
+
+/* Lock node. */
+struct route_node *
+route_lock_node (struct route_node *node)
+{
+  node->lock++;
+  return node;
+}
+
+/* Unlock node. */
+void
+route_unlock_node (struct route_node *node)
+{
+  node->lock--;
+
+  if (node->lock == 0)
+    route_node_delete (node);
+}
+
+/* The closest node above node, whose prefix contains node's.  It is
+   not locked, and it may have no info. */
+struct route_node *
+route_node_parent (struct route_node *node)
+{
+  struct route_stride *stride = node->stride;
+  unsigned int pos;
+
+  pos = route_stride_pos (stride->depth, &node->p);
+  for (;;)
+    {
+      /* A child position halved is the heap position of the longest
+         prefixes above the child, as are heap positions. */
+      for (pos >>= 1; pos; pos >>= 1)
+        if (stride->nodes & (1 << pos))
+          return stride->node[pos];
+
+      if (stride->parent == NULL)
+        return NULL;
+      pos = ROUTE_STRIDE_FANOUT + stride->index;
+      stride = stride->parent;
+    }
+}
+
+/* Find matched prefix. */
+struct route_node *
+route_node_match (const struct route_table *table, const struct prefix *p)
+{
+  const u_char *key = &p->u.prefix;
+  const struct route_stride *stride;
+  struct route_node *node;
+  struct route_node *matched;
+  unsigned int chunk, pos;
+  int from = 0;
+  int len;
+
+  matched = NULL;
+  stride = table->root;
+
+  /* Walk down the levels, checking the bits of the skipped ones.  At
+     each level the heap holds one candidate per length. */
+  while (stride && stride->depth <= p->prefixlen &&
+         route_key_match (&stride->key.u.prefix, key, from, stride->depth))
+    {
+      len = p->prefixlen - stride->depth;
+      chunk = len ? route_key_chunk (key, stride->depth) : 0;
+
+      if (len > ROUTE_STRIDE - 1)
+        len = ROUTE_STRIDE - 1;
+      for (; len >= 0; len--)
+        {
+          pos = (1 << len) | (chunk >> (ROUTE_STRIDE - len));
+          if (! (stride->nodes & (1 << pos)))
+            continue;
+          node = stride->node[pos];
+          if (node->info)
+            {
+              matched = node;
+              break;
+            }
+        }
+
+      if (p->prefixlen < stride->depth + ROUTE_STRIDE)
+        break;
+
+      from = stride->depth + ROUTE_STRIDE;
+      stride = stride->child[chunk];
+    }
+
+  /* If matched route found, return it. */
+  if (matched)
+    return route_lock_node (matched);
+
+  return NULL;
+}
+
+struct route_node *
+route_node_match_ipv4 (const struct route_table *table,
+		       const struct in_addr *addr)
+{
+  struct prefix_ipv4 p;
+
+  memset (&p, 0, sizeof (struct prefix_ipv4));
+  p.family = AF_INET;
+  p.prefixlen = IPV4_MAX_PREFIXLEN;
+  p.prefix = *addr;
+
+  return route_node_match (table, (struct prefix *) &p);
+}
+
+#ifdef HAVE_IPV6
+struct route_node *
+route_node_match_ipv6 (const struct route_table *table,
+		       const struct in6_addr *addr)
+{
+  struct prefix_ipv6 p;
+
+  memset (&p, 0, sizeof (struct prefix_ipv6));
+  p.family = AF_INET6;
+  p.prefixlen = IPV6_MAX_PREFIXLEN;
+  p.prefix = *addr;
+
+  return route_node_match (table, (struct prefix *) &p);
+}
+#endif /* HAVE_IPV6 */
+
+/* Lookup same prefix node.  Return NULL when we can't find route. */
+struct route_node *
+route_node_lookup (struct route_table *table, struct prefix *p)
+{
+  struct route_stride *stride;
+  struct route_node *node;
+
+  stride = route_stride_find (table, p, 0);
+  if (stride == NULL)
+    return NULL;
+
+  node = stride->node[route_stride_pos (stride->depth, p)];
+  if (node && node->info)
+    return route_lock_node (node);
+
+  return NULL;
+}
+
+/* Get the first node, locked, of the subtree of p: p's own node or
+   the first node whose prefix p contains.  Return NULL when there is
+   none.  Nodes without info are returned as well. */
+struct route_node *
+route_subtree_top (struct route_table *table, struct prefix *p)
+{
+  const u_char *key = &p->u.prefix;
+  struct route_stride *stride, *child;
+  struct route_node *node;
+  unsigned int pos;
+  int len = p->prefixlen;
+
+  stride = table->root;
+  if (stride == NULL)
+    return NULL;
+
+  while (len >= stride->depth + ROUTE_STRIDE)
+    {
+      child = stride->child[route_key_chunk (key, stride->depth)];
+      if (child == NULL ||
+          ! route_key_match (&child->key.u.prefix, key,
+                             stride->depth + ROUTE_STRIDE,
+                             MIN (len, child->depth)))
+        return NULL;
+
+      /* A skipped stretch p ends in: everything below is in p. */
+      if (child->depth > len)
+        {
+          node = child->node[1];
+          if (node == NULL)
+            node = route_stride_next (child, 1);
+          return route_lock_node (node);
+        }
+
+      stride = child;
+    }
+
+  pos = route_stride_pos (stride->depth, p);
+  node = stride->node[pos];
+  if (node == NULL)
+    node = route_stride_next (stride, pos);
+
+  if (node && prefix_match (p, &node->p))
+    return route_lock_node (node);
+
+  return NULL;
+}
+
+/* Add node to routing table. */
+struct route_node *
+route_node_get (struct route_table *table, struct prefix *p)
+{
+  struct route_stride *stride;
+  struct route_node *node;
+  unsigned int pos;
+
+  stride = route_stride_find (table, p, 1);
+  pos = route_stride_pos (stride->depth, p);
+
+  node = stride->node[pos];
+  if (node == NULL)
+    {
+      node = XCALLOC (MTYPE_ROUTE_NODE, sizeof (struct route_node));
+      prefix_copy (&node->p, p);
+      node->table = table;
+      node->stride = stride;
+
+      stride->node[pos] = node;
+      stride->nodes |= 1 << pos;
+      table->count++;
+    }
+
+  return route_lock_node (node);
+}
+
+/* Delete node from the routing table. */
+void
+route_node_delete (struct route_node *node)
+{
+  struct route_stride *stride = node->stride;
+  struct route_table *table = node->table;
+  unsigned int pos = route_stride_pos (stride->depth, &node->p);
+
+  assert (node->lock == 0);
+  assert (node->info == NULL);
+
+  stride->node[pos] = NULL;
+  stride->nodes &= ~(1 << pos);
+  table->count--;
+  XFREE (MTYPE_ROUTE_NODE, node);
+
+  route_stride_compact (table, stride);
+}
+
+/* Get fist node and lock it.  This function is useful when one want
+   to lookup all the node exist in the routing table. */
+struct route_node *
+route_top (struct route_table *table)
+{
+  struct route_node *node;
+
+  /* If there is no node in the routing table return NULL. */
+  if (table->root == NULL)
+    return NULL;
+
+  node = table->root->node[1];
+  if (node == NULL)
+    node = route_stride_next (table->root, 1);
+
+  /* Lock the top node and return it. */
+  return route_lock_node (node);
+}
+
+/* Unlock current node and lock next node then return it. */
+struct route_node *
+route_next (struct route_node *node)
+{
+  struct route_node *next;
+
+  /* Node may be deleted from route_unlock_node so we have to preserve
+     next node's pointer. */
+  next = route_stride_next (node->stride,
+                            route_stride_pos (node->stride->depth, &node->p));
+  if (next)
+    route_lock_node (next);
+  route_unlock_node (node);
+  return next;
+}
+
+/* Unlock current node and lock the node before it, in the order of
+   route_next, then return it. */
+struct route_node *
+route_prev (struct route_node *node)
+{
+  struct route_node *prev;
+
+  prev = route_stride_prev (node->stride,
+                            route_stride_pos (node->stride->depth, &node->p));
+  if (prev)
+    route_lock_node (prev);
+  route_unlock_node (node);
+  return prev;
+}
+
+/* Unlock current node and lock next node until limit. */
+struct route_node *
+route_next_until (struct route_node *node, struct route_node *limit)
+{
+  struct route_node *next;
+
+  next = route_stride_next (node->stride,
+                            route_stride_pos (node->stride->depth, &node->p));
+  if (next && ! prefix_match (&limit->p, &next->p))
+    next = NULL;
+  if (next)
+    route_lock_node (next);
+  route_unlock_node (node);
+  return next;
+}
+
+unsigned long
+route_table_count (const struct route_table *table)
+{
+  return table->count;
+}
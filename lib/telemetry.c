@@ -0,0 +1,816 @@
+/* Telemetry export of daemon counters
+ *
+ * This file is part of GNU Zebra.
+ *
+ * GNU Zebra is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * GNU Zebra is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Zebra; see the file COPYING.  If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <zebra.h>
+#include <sys/un.h>
+
+#include "thread.h"
+#include "memory.h"
+#include "linklist.h"
+#include "hash.h"
+#include "jhash.h"
+#include "buffer.h"
+#include "stream.h"
+#include "network.h"
+#include "command.h"
+#include "vty.h"
+#include "log.h"
+#include "privs.h"
+#include "telemetry.h"
+
+#define TELEMETRY_SOURCES_MAX     16
+#define TELEMETRY_COMMAND_MAX     64
+
+/* A line of a report.  The text of the lines is kept one after the
+   other, without the timestamp, which is only added when sent. */
+struct telemetry_line
+{
+  size_t start;                 /* of the measurement */
+  size_t fields;                /* of the space before the fields */
+  size_t end;
+  u_int32_t hash;               /* of the measurement and tags */
+};
+
+struct telemetry
+{
+  char *buf;
+  size_t len;
+  size_t size;
+
+  struct telemetry_line *lines;
+  unsigned int count;
+  unsigned int max;
+
+  /* The line being built. */
+  struct telemetry_line line;
+  unsigned int nfields;
+};
+
+/* An object as last sent to a subscribed client. */
+struct telemetry_series
+{
+  u_int32_t hash;
+  size_t keylen;
+  size_t len;                   /* of the key and fields */
+  char *text;
+};
+
+struct telemetry_client
+{
+  int fd;
+  struct buffer *obuf;
+
+  char ibuf[TELEMETRY_COMMAND_MAX];
+  size_t ilen;
+
+  unsigned long interval;       /* msec, 0 unless subscribed */
+  struct hash *series;
+
+  unsigned long reports;
+  unsigned long skipped;        /* reports not sent for want of room */
+
+  struct thread *t_read;
+  struct thread *t_write;
+  struct thread *t_report;
+};
+
+static struct
+{
+  struct thread_master *master;
+  char *path;
+  int sock;
+  struct thread *t_accept;
+  struct list *clients;
+
+  telemetry_source_t sources[TELEMETRY_SOURCES_MAX];
+  unsigned int nsources;
+
+  /* The report last collected, reused for the next one. */
+  struct telemetry report;
+} telemetry;
+
+static int telemetry_accept (struct thread *);
+static int telemetry_read (struct thread *);
+static int telemetry_write (struct thread *);
+static int telemetry_timer (struct thread *);
+
+static void
+telemetry_grow (struct telemetry *t, size_t len)
+{
+  if (t->len + len <= t->size)
+    return;
+  while (t->len + len > t->size)
+    t->size = t->size ? t->size * 2 : 16384;
+  t->buf = XREALLOC (MTYPE_TELEMETRY, t->buf, t->size);
+}
+
+static void
+telemetry_append (struct telemetry *t, const char *str, size_t len)
+{
+  telemetry_grow (t, len);
+  memcpy (t->buf + t->len, str, len);
+  t->len += len;
+}
+
+/* Append STR with the characters line protocol separates by escaped.
+   Measurements need only commas and spaces escaped, but escaping an
+   equals sign as well is harmless. */
+static void
+telemetry_append_escaped (struct telemetry *t, const char *str)
+{
+  size_t len = strlen (str);
+  const char *p;
+
+  telemetry_grow (t, 2 * len);
+  for (p = str; *p; p++)
+    {
+      if (*p == ',' || *p == '=' || *p == ' ' || *p == '\\')
+	t->buf[t->len++] = '\\';
+      t->buf[t->len++] = *p;
+    }
+}
+
+void
+telemetry_begin (struct telemetry *t, const char *measurement)
+{
+  t->line.start = t->len;
+  t->nfields = 0;
+  telemetry_append_escaped (t, measurement);
+}
+
+void
+telemetry_tag (struct telemetry *t, const char *key, const char *value)
+{
+  /* Empty tag values are not allowed. */
+  if (value == NULL || *value == '\0')
+    return;
+  telemetry_append (t, ",", 1);
+  telemetry_append_escaped (t, key);
+  telemetry_append (t, "=", 1);
+  telemetry_append_escaped (t, value);
+}
+
+void
+telemetry_field (struct telemetry *t, const char *key,
+		 unsigned long long value)
+{
+  char num[32];
+  int len;
+
+  if (t->nfields++ == 0)
+    {
+      t->line.fields = t->len;
+      telemetry_append (t, " ", 1);
+    }
+  else
+    telemetry_append (t, ",", 1);
+  telemetry_append_escaped (t, key);
+  len = snprintf (num, sizeof (num), "=%llui", value);
+  telemetry_append (t, num, len);
+}
+
+void
+telemetry_end (struct telemetry *t)
+{
+  struct telemetry_line *line;
+
+  /* A line needs at least one field. */
+  if (t->nfields == 0)
+    {
+      t->len = t->line.start;
+      return;
+    }
+
+  if (t->count == t->max)
+    {
+      t->max = t->max ? t->max * 2 : 256;
+      t->lines = XREALLOC (MTYPE_TELEMETRY, t->lines,
+			   t->max * sizeof (struct telemetry_line));
+    }
+  line = &t->lines[t->count++];
+  *line = t->line;
+  line->end = t->len;
+  line->hash = jhash (t->buf + line->start, line->fields - line->start,
+		      0x74656c65);
+}
+
+/* Live objects of every memory type in use, or used before. */
+static void
+telemetry_memory (struct telemetry *t)
+{
+  static u_char seen[MTYPE_MAX];
+  struct mlist *ml;
+  struct memory_list *m;
+
+  for (ml = mlists; ml->list; ml++)
+    for (m = ml->list; m->index >= 0; m++)
+      {
+	unsigned long alloc;
+
+	if (m->index == 0)
+	  continue;
+	alloc = mtype_stats_alloc (m->index);
+	if (alloc == 0 && ! seen[m->index])
+	  continue;
+	seen[m->index] = 1;
+
+	telemetry_begin (t, "memory");
+	telemetry_tag (t, "module", ml->name);
+	telemetry_tag (t, "type", m->format);
+	telemetry_field (t, "live", alloc);
+	telemetry_end (t);
+      }
+}
+
+/* The non-empty latency buckets, as fields named for their bounds in
+   usecs: lt_1, lt_2, lt_4, ... and ge_N for the last one. */
+static void
+telemetry_latency (struct telemetry *t, const unsigned long *latency)
+{
+  unsigned int i;
+  char key[32];
+
+  for (i = 0; i < THREAD_LATENCY_BUCKETS; i++)
+    if (latency[i])
+      {
+	if (i < THREAD_LATENCY_BUCKETS - 1)
+	  snprintf (key, sizeof (key), "lt_%lu", 1UL << i);
+	else
+	  snprintf (key, sizeof (key), "ge_%lu", 1UL << (i - 1));
+	telemetry_field (t, key, latency[i]);
+      }
+}
+
+static void
+telemetry_thread_func (const struct cpu_thread_history *h, void *arg)
+{
+  struct telemetry *t = arg;
+
+  telemetry_begin (t, "thread");
+  telemetry_tag (t, "func", h->funcname);
+  telemetry_field (t, "calls", h->total_calls);
+  telemetry_field (t, "real_usec", h->real.total);
+  telemetry_field (t, "real_max_usec", h->real.max);
+#ifdef HAVE_RUSAGE
+  telemetry_field (t, "cpu_usec", h->cpu.total);
+  telemetry_field (t, "cpu_max_usec", h->cpu.max);
+#endif /* HAVE_RUSAGE */
+  telemetry_end (t);
+
+  telemetry_begin (t, "thread_latency");
+  telemetry_tag (t, "func", h->funcname);
+  telemetry_latency (t, h->latency);
+  telemetry_end (t);
+}
+
+/* Run time of every function run as a thread, as "show thread cpu",
+   and the latencies of "show thread latency". */
+static void
+telemetry_thread (struct telemetry *t)
+{
+  thread_type type;
+
+  thread_cpu_iterate (telemetry_thread_func, t);
+
+  for (type = 0; type <= THREAD_EXECUTE; type++)
+    {
+      const char *name = thread_type_name (type);
+      const unsigned long *lag;
+
+      if (name == NULL)
+	continue;
+
+      telemetry_begin (t, "thread_latency");
+      telemetry_tag (t, "type", name);
+      telemetry_latency (t, thread_type_latency (type));
+      telemetry_end (t);
+
+      if ((lag = thread_timer_lag (type)) != NULL)
+	{
+	  telemetry_begin (t, "thread_lag");
+	  telemetry_tag (t, "type", name);
+	  telemetry_latency (t, lag);
+	  telemetry_end (t);
+	}
+    }
+}
+
+/* What the buffers wrote and what the buffers and streams copied. */
+static void
+telemetry_io (struct telemetry *t)
+{
+  telemetry_begin (t, "io");
+  telemetry_field (t, "buffer_copied", buffer_stats.copied);
+  telemetry_field (t, "buffer_direct", buffer_stats.direct);
+  telemetry_field (t, "writevs", buffer_stats.writevs);
+  telemetry_field (t, "iovecs", buffer_stats.iovecs);
+  telemetry_field (t, "stream_copied", stream_copied);
+  telemetry_end (t);
+}
+
+/* Collect a report from every source. */
+static struct telemetry *
+telemetry_collect (void)
+{
+  struct telemetry *t = &telemetry.report;
+  unsigned int i;
+
+  t->len = 0;
+  t->count = 0;
+
+  telemetry_memory (t);
+  telemetry_thread (t);
+  telemetry_io (t);
+  for (i = 0; i < telemetry.nsources; i++)
+    (*telemetry.sources[i]) (t);
+
+  return t;
+}
+
+void
+telemetry_register (telemetry_source_t func)
+{
+  assert (telemetry.nsources < TELEMETRY_SOURCES_MAX);
+  telemetry.sources[telemetry.nsources++] = func;
+}
+
+static unsigned int
+telemetry_series_hash_key (void *data)
+{
+  struct telemetry_series *s = data;
+
+  return s->hash;
+}
+
+static int
+telemetry_series_hash_cmp (const void *a, const void *b)
+{
+  const struct telemetry_series *s1 = a;
+  const struct telemetry_series *s2 = b;
+
+  return s1->keylen == s2->keylen
+    && memcmp (s1->text, s2->text, s1->keylen) == 0;
+}
+
+static void *
+telemetry_series_alloc (void *data)
+{
+  struct telemetry_series *key = data;
+  struct telemetry_series *s;
+
+  s = XCALLOC (MTYPE_TELEMETRY_SERIES, sizeof (struct telemetry_series));
+  s->hash = key->hash;
+  s->keylen = key->keylen;
+  return s;
+}
+
+static void
+telemetry_series_free (void *data)
+{
+  struct telemetry_series *s = data;
+
+  if (s->text)
+    XFREE (MTYPE_TELEMETRY_SERIES, s->text);
+  XFREE (MTYPE_TELEMETRY_SERIES, s);
+}
+
+/* Whether LINE differs from what was last sent for its object, which
+   is updated when it does. */
+static int
+telemetry_series_changed (struct telemetry_client *c, struct telemetry *t,
+			  struct telemetry_line *line)
+{
+  struct telemetry_series key, *s;
+  size_t len = line->end - line->start;
+
+  key.hash = line->hash;
+  key.keylen = line->fields - line->start;
+  key.text = t->buf + line->start;
+  s = hash_get (c->series, &key, telemetry_series_alloc);
+
+  if (s->text && s->len == len
+      && memcmp (s->text + s->keylen, t->buf + line->fields,
+		 len - s->keylen) == 0)
+    return 0;
+
+  if (s->len != len)
+    s->text = XREALLOC (MTYPE_TELEMETRY_SERIES, s->text, len);
+  memcpy (s->text, t->buf + line->start, len);
+  s->len = len;
+  return 1;
+}
+
+static void
+telemetry_client_flush (struct telemetry_client *c)
+{
+  switch (buffer_flush_available (c->obuf, c->fd))
+    {
+    case BUFFER_PENDING:
+      if (! c->t_write)
+	c->t_write = thread_add_write (telemetry.master, telemetry_write,
+				       c, c->fd);
+      break;
+    case BUFFER_ERROR:
+      /* Closed when the error is read. */
+      buffer_reset (c->obuf);
+      break;
+    case BUFFER_EMPTY:
+      break;
+    }
+}
+
+/* Send a report to C: every line when FULL, otherwise the lines of the
+   objects changed since the last report. */
+static void
+telemetry_send (struct telemetry_client *c, int full)
+{
+  struct telemetry *t = telemetry_collect ();
+  struct timeval now;
+  char stamp[40];
+  int stamplen;
+  unsigned int i;
+
+  quagga_gettime (QUAGGA_CLK_REALTIME, &now);
+  stamplen = snprintf (stamp, sizeof (stamp), " %lld%06ld000\n",
+		       (long long) now.tv_sec, (long) now.tv_usec);
+
+  for (i = 0; i < t->count; i++)
+    {
+      struct telemetry_line *line = &t->lines[i];
+
+      if (c->series && ! telemetry_series_changed (c, t, line) && ! full)
+	continue;
+      buffer_put (c->obuf, t->buf + line->start, line->end - line->start);
+      buffer_put (c->obuf, stamp, stamplen);
+    }
+  buffer_putc (c->obuf, '\n');
+  c->reports++;
+
+  telemetry_client_flush (c);
+}
+
+static void
+telemetry_unsubscribe (struct telemetry_client *c)
+{
+  c->interval = 0;
+  THREAD_OFF (c->t_report);
+  if (c->series)
+    {
+      hash_clean (c->series, telemetry_series_free);
+      hash_free (c->series);
+      c->series = NULL;
+    }
+}
+
+static void
+telemetry_client_close (struct telemetry_client *c)
+{
+  telemetry_unsubscribe (c);
+  THREAD_OFF (c->t_read);
+  THREAD_OFF (c->t_write);
+  buffer_free (c->obuf);
+  close (c->fd);
+  listnode_delete (telemetry.clients, c);
+  XFREE (MTYPE_TELEMETRY_CLIENT, c);
+}
+
+static void
+telemetry_error (struct telemetry_client *c, const char *msg)
+{
+  buffer_putstr (c->obuf, "# ");
+  buffer_putstr (c->obuf, msg);
+  buffer_putstr (c->obuf, "\n\n");
+  telemetry_client_flush (c);
+}
+
+static void
+telemetry_command (struct telemetry_client *c, char *cmd)
+{
+  char *arg, *end;
+  unsigned long interval;
+
+  arg = cmd + strcspn (cmd, " \t");
+  if (*arg)
+    *arg++ = '\0';
+  arg += strspn (arg, " \t");
+
+  if (strcmp (cmd, "get") == 0)
+    telemetry_send (c, 1);
+  else if (strcmp (cmd, "subscribe") == 0)
+    {
+      interval = strtoul (arg, &end, 10);
+      if (end == arg || *end != '\0'
+	  || interval < TELEMETRY_INTERVAL_MIN
+	  || interval > TELEMETRY_INTERVAL_MAX)
+	{
+	  telemetry_error (c, "interval must be 100 to 3600000 msec");
+	  return;
+	}
+      telemetry_unsubscribe (c);
+      c->interval = interval;
+      c->series = hash_create (telemetry_series_hash_key,
+			       telemetry_series_hash_cmp);
+      telemetry_send (c, 1);
+      c->t_report = thread_add_timer_msec (telemetry.master, telemetry_timer,
+					   c, c->interval);
+    }
+  else if (strcmp (cmd, "unsubscribe") == 0)
+    telemetry_unsubscribe (c);
+  else if (*cmd)
+    telemetry_error (c, "unknown command");
+}
+
+static int
+telemetry_read (struct thread *thread)
+{
+  struct telemetry_client *c = THREAD_ARG (thread);
+  char *nl;
+  ssize_t nbytes;
+
+  c->t_read = NULL;
+
+  nbytes = read (c->fd, c->ibuf + c->ilen, sizeof (c->ibuf) - 1 - c->ilen);
+  if (nbytes < 0 && ERRNO_IO_RETRY (errno))
+    {
+      c->t_read = thread_add_read (telemetry.master, telemetry_read, c, c->fd);
+      return 0;
+    }
+  if (nbytes <= 0)
+    {
+      telemetry_client_close (c);
+      return 0;
+    }
+  c->ilen += nbytes;
+  c->ibuf[c->ilen] = '\0';
+
+  while ((nl = strchr (c->ibuf, '\n')) != NULL)
+    {
+      *nl = '\0';
+      if (nl > c->ibuf && nl[-1] == '\r')
+	nl[-1] = '\0';
+      telemetry_command (c, c->ibuf);
+      c->ilen -= nl + 1 - c->ibuf;
+      memmove (c->ibuf, nl + 1, c->ilen + 1);
+    }
+
+  if (c->ilen == sizeof (c->ibuf) - 1)
+    {
+      telemetry_client_close (c);
+      return 0;
+    }
+
+  c->t_read = thread_add_read (telemetry.master, telemetry_read, c, c->fd);
+  return 0;
+}
+
+static int
+telemetry_write (struct thread *thread)
+{
+  struct telemetry_client *c = THREAD_ARG (thread);
+
+  c->t_write = NULL;
+  telemetry_client_flush (c);
+  return 0;
+}
+
+static int
+telemetry_timer (struct thread *thread)
+{
+  struct telemetry_client *c = THREAD_ARG (thread);
+
+  c->t_report = thread_add_timer_msec (telemetry.master, telemetry_timer,
+				       c, c->interval);
+
+  /* A client still reading the last report misses this one; the next
+     includes whatever changed meanwhile. */
+  if (buffer_length (c->obuf))
+    {
+      c->skipped++;
+      return 0;
+    }
+  telemetry_send (c, 0);
+  return 0;
+}
+
+static int
+telemetry_accept (struct thread *thread)
+{
+  struct telemetry_client *c;
+  int sock;
+
+  telemetry.t_accept = thread_add_read (telemetry.master, telemetry_accept,
+					NULL, telemetry.sock);
+
+  sock = accept (telemetry.sock, NULL, NULL);
+  if (sock < 0)
+    {
+      zlog_warn ("can't accept telemetry socket: %s", safe_strerror (errno));
+      return -1;
+    }
+  if (set_nonblocking (sock) < 0)
+    {
+      zlog_warn ("telemetry_accept: could not set socket %d to non-blocking,"
+		 " %s, closing", sock, safe_strerror (errno));
+      close (sock);
+      return -1;
+    }
+
+  c = XCALLOC (MTYPE_TELEMETRY_CLIENT, sizeof (struct telemetry_client));
+  c->fd = sock;
+  c->obuf = buffer_new (0);
+  listnode_add (telemetry.clients, c);
+  c->t_read = thread_add_read (telemetry.master, telemetry_read, c, sock);
+  return 0;
+}
+
+static void
+telemetry_close (void)
+{
+  if (telemetry.sock < 0)
+    return;
+  THREAD_OFF (telemetry.t_accept);
+  close (telemetry.sock);
+  unlink (telemetry.path);
+  telemetry.sock = -1;
+  XFREE (MTYPE_TELEMETRY, telemetry.path);
+}
+
+/* Listen on PATH, instead of the socket before if there was one.
+   Clients connected already stay. */
+static int
+telemetry_open (const char *path)
+{
+  struct sockaddr_un serv;
+  struct zprivs_ids_t ids;
+  mode_t old_mask;
+  int sock, len;
+
+  if (strlen (path) >= sizeof (serv.sun_path))
+    {
+      zlog_err ("Telemetry socket path too long: %s", path);
+      return -1;
+    }
+
+  telemetry_close ();
+  unlink (path);
+
+  sock = socket (AF_UNIX, SOCK_STREAM, 0);
+  if (sock < 0)
+    {
+      zlog_err ("Cannot create unix stream socket: %s", safe_strerror (errno));
+      return -1;
+    }
+
+  memset (&serv, 0, sizeof (struct sockaddr_un));
+  serv.sun_family = AF_UNIX;
+  strcpy (serv.sun_path, path);
+#ifdef HAVE_STRUCT_SOCKADDR_UN_SUN_LEN
+  len = serv.sun_len = SUN_LEN (&serv);
+#else
+  len = sizeof (serv.sun_family) + strlen (serv.sun_path);
+#endif /* HAVE_STRUCT_SOCKADDR_UN_SUN_LEN */
+
+  old_mask = umask (0007);
+  if (bind (sock, (struct sockaddr *) &serv, len) < 0)
+    {
+      zlog_err ("Cannot bind path %s: %s", path, safe_strerror (errno));
+      umask (old_mask);
+      close (sock);
+      return -1;
+    }
+  umask (old_mask);
+
+  if (listen (sock, 5) < 0 || set_nonblocking (sock) < 0)
+    {
+      zlog_err ("listen(fd %d) failed: %s", sock, safe_strerror (errno));
+      close (sock);
+      unlink (path);
+      return -1;
+    }
+
+  zprivs_get_ids (&ids);
+  if (ids.gid_vty > 0 && chown (path, -1, ids.gid_vty))
+    zlog_err ("telemetry_open: could not chown socket, %s",
+	      safe_strerror (errno));
+
+  telemetry.sock = sock;
+  telemetry.path = XSTRDUP (MTYPE_TELEMETRY, path);
+  telemetry.t_accept = thread_add_read (telemetry.master, telemetry_accept,
+					NULL, sock);
+  return 0;
+}
+
+DEFUN (telemetry_socket,
+       telemetry_socket_cmd,
+       "telemetry socket PATH",
+       "Telemetry export\n"
+       "Report counters on a unix stream socket\n"
+       "Path of the socket\n")
+{
+  if (telemetry.path && strcmp (telemetry.path, argv[0]) == 0)
+    return CMD_SUCCESS;
+  if (telemetry_open (argv[0]) < 0)
+    {
+      vty_out (vty, "%% Cannot listen on %s%s", argv[0], VTY_NEWLINE);
+      return CMD_WARNING;
+    }
+  return CMD_SUCCESS;
+}
+
+DEFUN (no_telemetry_socket,
+       no_telemetry_socket_cmd,
+       "no telemetry socket",
+       NO_STR
+       "Telemetry export\n"
+       "Report counters on a unix stream socket\n")
+{
+  struct telemetry_client *c;
+  struct listnode *node, *nnode;
+
+  telemetry_close ();
+  for (ALL_LIST_ELEMENTS (telemetry.clients, node, nnode, c))
+    telemetry_client_close (c);
+  return CMD_SUCCESS;
+}
+
+ALIAS (no_telemetry_socket,
+       no_telemetry_socket_path_cmd,
+       "no telemetry socket PATH",
+       NO_STR
+       "Telemetry export\n"
+       "Report counters on a unix stream socket\n"
+       "Path of the socket\n")
+
+DEFUN (show_telemetry,
+       show_telemetry_cmd,
+       "show telemetry",
+       SHOW_STR
+       "Telemetry export\n")
+{
+  struct telemetry_client *c;
+  struct listnode *node;
+
+  if (telemetry.path)
+    vty_out (vty, "Telemetry socket %s, %u clients%s", telemetry.path,
+	     listcount (telemetry.clients), VTY_NEWLINE);
+  else
+    vty_out (vty, "Telemetry socket not configured, %u clients%s",
+	     listcount (telemetry.clients), VTY_NEWLINE);
+
+  for (ALL_LIST_ELEMENTS_RO (telemetry.clients, node, c))
+    {
+      vty_out (vty, "  fd %d: ", c->fd);
+      if (c->interval)
+	vty_out (vty, "subscribed every %lu msec, %lu objects, ",
+		 c->interval, c->series->count);
+      vty_out (vty, "%lu reports, %lu skipped, %lu bytes queued%s",
+	       c->reports, c->skipped, (unsigned long) buffer_length (c->obuf),
+	       VTY_NEWLINE);
+    }
+
+  if (telemetry.report.count)
+    vty_out (vty, "Last report: %u objects, %lu bytes%s",
+	     telemetry.report.count, (unsigned long) telemetry.report.len,
+	     VTY_NEWLINE);
+
+  return CMD_SUCCESS;
+}
+
+int
+telemetry_config_write (struct vty *vty)
+{
+  if (telemetry.path)
+    vty_out (vty, "telemetry socket %s%s", telemetry.path, VTY_NEWLINE);
+  return 0;
+}
+
+void
+telemetry_init (struct thread_master *master)
+{
+  telemetry.master = master;
+  telemetry.sock = -1;
+  telemetry.clients = list_new ();
+
+  install_element (VIEW_NODE, &show_telemetry_cmd);
+  install_element (ENABLE_NODE, &show_telemetry_cmd);
+  install_element (CONFIG_NODE, &telemetry_socket_cmd);
+  install_element (CONFIG_NODE, &no_telemetry_socket_cmd);
+  install_element (CONFIG_NODE, &no_telemetry_socket_path_cmd);
+}
@@ -0,0 +1,65 @@
+/* Telemetry export of daemon counters
+ *
+ * This file is part of GNU Zebra.
+ *
+ * GNU Zebra is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * GNU Zebra is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Zebra; see the file COPYING.  If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef _ZEBRA_TELEMETRY_H
+#define _ZEBRA_TELEMETRY_H
+
+/* A daemon configured with "telemetry socket PATH" reports its
+   counters to clients of a unix stream socket, one line per object in
+   line protocol:
+
+     measurement,tag=value,... field=123i,... timestamp
+
+   with the timestamp in nanoseconds since the epoch.  A report ends
+   with an empty line.  Clients send one command per line:
+
+     get                 a report of every object
+     subscribe MSEC      a report of every object, then every MSEC
+                         milliseconds one of the objects whose fields
+                         changed since the report before
+     unsubscribe         stop the reports
+
+   The library reports memory per type and thread function statistics;
+   daemons register sources for their own objects.  An object that
+   goes away is simply no longer reported. */
+
+#define TELEMETRY_INTERVAL_MIN    100
+#define TELEMETRY_INTERVAL_MAX    3600000
+
+struct telemetry;
+struct thread_master;
+struct vty;
+
+/* Called to add the lines of a source to a report. */
+typedef void (*telemetry_source_t) (struct telemetry *);
+
+extern void telemetry_init (struct thread_master *);
+extern void telemetry_register (telemetry_source_t);
+extern int telemetry_config_write (struct vty *);
+
+/* One line: a measurement, its tags, then its fields. */
+extern void telemetry_begin (struct telemetry *, const char *measurement);
+extern void telemetry_tag (struct telemetry *, const char *key,
+			   const char *value);
+extern void telemetry_field (struct telemetry *, const char *key,
+			     unsigned long long value);
+extern void telemetry_end (struct telemetry *);
+
+#endif /* _ZEBRA_TELEMETRY_H */
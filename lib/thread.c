@@ -40,6 +40,15 @@ static struct timeval relative_time_base;
 static unsigned short timers_inited;
 
 static struct hash *cpu_record = NULL;
+
+/* Every thread master, for "show thread lanes". */
+static struct thread_master *thread_masters;
+
+/* Latencies by the type threads were added as, and timer lag. */
+int thread_latency = 0;
+static unsigned long type_latency[THREAD_EXECUTE + 1][THREAD_LATENCY_BUCKETS];
+static unsigned long timer_lag[THREAD_LATENCY_BUCKETS];
+static unsigned long background_lag[THREAD_LATENCY_BUCKETS];
 
 /* Struct timeval's tv_usec one second value.  */
 #define TIMER_SECOND_MICRO 1000000L
@@ -237,6 +246,17 @@ timersub_msec (struct timeval *a, struct timeval *b)
 
   return (long) delta.tv_sec * 1000 + (long) delta.tv_usec / 1000;
 }
+
+/* subtract b from a and return the number of microseconds */
+long
+timersub_usec (struct timeval *a, struct timeval *b)
+{
+  struct timeval delta;
+
+  timersub (a, b, &delta);
+
+  return (long) delta.tv_sec * TIMER_SECOND_MICRO + (long) delta.tv_usec;
+}
 
 static unsigned int
 cpu_record_hash_key (struct cpu_thread_history *a)
@@ -345,6 +365,31 @@ cpu_record_print(struct vty *vty, thread_type filter)
     vty_out_cpu_thread_history(vty, &tmp);
 }
 
+struct cpu_record_walk
+{
+  void (*func) (const struct cpu_thread_history *, void *);
+  void *arg;
+};
+
+static void
+cpu_record_hash_iterate (struct hash_backet *bucket, struct cpu_record_walk *w)
+{
+  (*w->func) (bucket->data, w->arg);
+}
+
+/* Call FUNC with the statistics of every function run as a thread. */
+void
+thread_cpu_iterate (void (*func) (const struct cpu_thread_history *, void *),
+		    void *arg)
+{
+  struct cpu_record_walk w = {func, arg};
+
+  if (cpu_record)
+    hash_iterate (cpu_record,
+		  (void (*) (struct hash_backet *, void *))
+		  cpu_record_hash_iterate, &w);
+}
+
 DEFUN(show_thread_cpu,
       show_thread_cpu_cmd,
       "show thread cpu [FILTER]",
@@ -423,9 +468,19 @@ static void
 cpu_record_clear (thread_type filter)
 {
   thread_type *tmp = &filter;
+  thread_type type;
+
   hash_iterate (cpu_record,
 	        (void (*) (struct hash_backet*,void*)) cpu_record_hash_clear,
 	        tmp);
+
+  for (type = 0; type <= THREAD_EXECUTE; type++)
+    if (filter & (1 << type))
+      memset (type_latency[type], 0, sizeof (type_latency[type]));
+  if (filter & (1 << THREAD_TIMER))
+    memset (timer_lag, 0, sizeof (timer_lag));
+  if (filter & (1 << THREAD_BACKGROUND))
+    memset (background_lag, 0, sizeof (background_lag));
 }
 
 DEFUN(clear_thread_cpu,
@@ -488,6 +543,319 @@ DEFUN(clear_thread_cpu,
   return CMD_SUCCESS;
 }
 
+const char *
+thread_type_name (thread_type type)
+{
+  switch (type)
+    {
+    case THREAD_READ:
+      return "read";
+    case THREAD_WRITE:
+      return "write";
+    case THREAD_TIMER:
+      return "timer";
+    case THREAD_EVENT:
+      return "event";
+    case THREAD_BACKGROUND:
+      return "background";
+    case THREAD_EXECUTE:
+      return "execute";
+    default:
+      return NULL;
+    }
+}
+
+const unsigned long *
+thread_type_latency (thread_type type)
+{
+  if (type > THREAD_EXECUTE || thread_type_name (type) == NULL)
+    return NULL;
+  return type_latency[type];
+}
+
+const unsigned long *
+thread_timer_lag (thread_type type)
+{
+  switch (type)
+    {
+    case THREAD_TIMER:
+      return timer_lag;
+    case THREAD_BACKGROUND:
+      return background_lag;
+    default:
+      return NULL;
+    }
+}
+
+static unsigned int
+thread_latency_bucket (unsigned long usec)
+{
+  unsigned int bucket = 0;
+
+  while (usec && bucket < THREAD_LATENCY_BUCKETS - 1)
+    {
+      usec >>= 1;
+      bucket++;
+    }
+  return bucket;
+}
+
+/* Count a run of THREAD that took REALTIME usecs. */
+static void
+thread_latency_add (struct thread *thread, unsigned long realtime)
+{
+  unsigned int bucket = thread_latency_bucket (realtime);
+  unsigned long *lag;
+
+  thread->hist->latency[bucket]++;
+  if (thread->add_type <= THREAD_EXECUTE)
+    type_latency[thread->add_type][bucket]++;
+
+  /* A timer is late by the time from when it was due to when it
+     started running. */
+  if (thread->add_type == THREAD_TIMER)
+    lag = timer_lag;
+  else if (thread->add_type == THREAD_BACKGROUND)
+    lag = background_lag;
+  else
+    return;
+  if (timeval_cmp (thread->ru.real, thread->u.sands) > 0)
+    lag[thread_latency_bucket (timeval_elapsed (thread->ru.real,
+						thread->u.sands))]++;
+}
+
+/* Print the bound of the bucket reached by PERMILLE of the TOTAL
+   counts of LATENCY. */
+static void
+vty_out_latency_percentile (struct vty *vty, const unsigned long *latency,
+			    unsigned long total, unsigned int permille)
+{
+  unsigned long long want = ((unsigned long long) total * permille + 999) / 1000;
+  unsigned long long sum = 0;
+  unsigned int i;
+  char buf[16];
+
+  for (i = 0; i < THREAD_LATENCY_BUCKETS - 1; i++)
+    if ((sum += latency[i]) >= want)
+      break;
+  if (i < THREAD_LATENCY_BUCKETS - 1)
+    snprintf (buf, sizeof (buf), "%lu", 1UL << i);
+  else
+    snprintf (buf, sizeof (buf), ">%lu", 1UL << (i - 1));
+  vty_out (vty, " %9s", buf);
+}
+
+static void
+vty_out_latency (struct vty *vty, const unsigned long *latency,
+		 const char *type, const char *name)
+{
+  unsigned long total = 0;
+  unsigned int i;
+
+  for (i = 0; i < THREAD_LATENCY_BUCKETS; i++)
+    total += latency[i];
+  if (total == 0)
+    return;
+
+  vty_out (vty, "%9lu", total);
+  vty_out_latency_percentile (vty, latency, total, 500);
+  vty_out_latency_percentile (vty, latency, total, 900);
+  vty_out_latency_percentile (vty, latency, total, 990);
+  vty_out_latency_percentile (vty, latency, total, 999);
+  vty_out (vty, "  %-10s %s%s", type, name, VTY_NEWLINE);
+}
+
+static void
+cpu_record_hash_print_latency (struct hash_backet *bucket, void *args[])
+{
+  struct vty *vty = args[0];
+  thread_type *filter = args[1];
+  struct cpu_thread_history *a = bucket->data;
+  char types[7];
+
+  if (!(a->types & *filter))
+    return;
+  snprintf (types, sizeof (types), "%c%c%c%c%c%c",
+	    a->types & (1 << THREAD_READ) ? 'R' : ' ',
+	    a->types & (1 << THREAD_WRITE) ? 'W' : ' ',
+	    a->types & (1 << THREAD_TIMER) ? 'T' : ' ',
+	    a->types & (1 << THREAD_EVENT) ? 'E' : ' ',
+	    a->types & (1 << THREAD_EXECUTE) ? 'X' : ' ',
+	    a->types & (1 << THREAD_BACKGROUND) ? 'B' : ' ');
+  vty_out_latency (vty, a->latency, types, a->funcname);
+}
+
+static void
+latency_print (struct vty *vty, thread_type filter)
+{
+  void *args[2] = {vty, &filter};
+  thread_type type;
+
+  if (!thread_latency)
+    vty_out (vty, "Thread latency is not being measured%s", VTY_NEWLINE);
+
+  vty_out (vty, "%19s%s%s", "",
+	   "Real (wall-clock) uSecs, at most:", VTY_NEWLINE);
+  vty_out (vty, "  Invoked       50%%       90%%       99%%     99.9%%"
+	   "  Type       Thread%s", VTY_NEWLINE);
+  hash_iterate (cpu_record,
+		(void (*) (struct hash_backet *, void *))
+		cpu_record_hash_print_latency, args);
+
+  vty_out (vty, "%s", VTY_NEWLINE);
+  for (type = 0; type <= THREAD_EXECUTE; type++)
+    if ((filter & (1 << type)) && thread_type_name (type))
+      vty_out_latency (vty, type_latency[type], thread_type_name (type),
+		       "(all)");
+  if (filter & (1 << THREAD_TIMER))
+    vty_out_latency (vty, timer_lag, "timer", "(lag)");
+  if (filter & (1 << THREAD_BACKGROUND))
+    vty_out_latency (vty, background_lag, "background", "(lag)");
+}
+
+DEFUN(show_thread_latency,
+      show_thread_latency_cmd,
+      "show thread latency [FILTER]",
+      SHOW_STR
+      "Thread information\n"
+      "Thread latency distribution\n"
+      "Display filter (rwtexb)\n")
+{
+  int i = 0;
+  thread_type filter = (thread_type) -1U;
+
+  if (argc > 0)
+    {
+      filter = 0;
+      while (argv[0][i] != '\0')
+	{
+	  switch ( argv[0][i] )
+	    {
+	    case 'r':
+	    case 'R':
+	      filter |= (1 << THREAD_READ);
+	      break;
+	    case 'w':
+	    case 'W':
+	      filter |= (1 << THREAD_WRITE);
+	      break;
+	    case 't':
+	    case 'T':
+	      filter |= (1 << THREAD_TIMER);
+	      break;
+	    case 'e':
+	    case 'E':
+	      filter |= (1 << THREAD_EVENT);
+	      break;
+	    case 'x':
+	    case 'X':
+	      filter |= (1 << THREAD_EXECUTE);
+	      break;
+	    case 'b':
+	    case 'B':
+	      filter |= (1 << THREAD_BACKGROUND);
+	      break;
+	    default:
+	      break;
+	    }
+	  ++i;
+	}
+      if (filter == 0)
+	{
+	  vty_out(vty, "Invalid filter \"%s\" specified,"
+                  " must contain at least one of 'RWTEXB'%s",
+		  argv[0], VTY_NEWLINE);
+	  return CMD_WARNING;
+	}
+    }
+
+  latency_print (vty, filter);
+  return CMD_SUCCESS;
+}
+
+DEFUN(config_thread_latency,
+      config_thread_latency_cmd,
+      "thread latency",
+      "Thread scheduler\n"
+      "Count how long threads run and how late timers fire\n")
+{
+  thread_latency = 1;
+  return CMD_SUCCESS;
+}
+
+DEFUN(no_config_thread_latency,
+      no_config_thread_latency_cmd,
+      "no thread latency",
+      NO_STR
+      "Thread scheduler\n"
+      "Count how long threads run and how late timers fire\n")
+{
+  thread_latency = 0;
+  return CMD_SUCCESS;
+}
+
+static const char *
+thread_priority_name (u_char priority)
+{
+  switch (priority)
+    {
+    case THREAD_PRIORITY_HIGH:
+      return "high";
+    case THREAD_PRIORITY_NORMAL:
+      return "normal";
+    case THREAD_PRIORITY_BACKGROUND:
+      return "background";
+    default:
+      return "?";
+    }
+}
+
+/* Count the threads of LIST in each lane. */
+static void
+thread_list_waiting (struct thread_list *list, unsigned long *waiting)
+{
+  struct thread *thread;
+
+  for (thread = list->head; thread; thread = thread->next)
+    waiting[thread->priority]++;
+}
+
+DEFUN(show_thread_lanes,
+      show_thread_lanes_cmd,
+      "show thread lanes",
+      SHOW_STR
+      "Thread information\n"
+      "Threads waiting and ready in each priority lane\n")
+{
+  struct thread_master *m;
+  u_char priority;
+
+  for (m = thread_masters; m; m = m->next)
+    {
+      unsigned long waiting[THREAD_PRIORITIES];
+
+      memset (waiting, 0, sizeof (waiting));
+      thread_list_waiting (&m->read, waiting);
+      thread_list_waiting (&m->write, waiting);
+      thread_list_waiting (&m->timer, waiting);
+      thread_list_waiting (&m->event, waiting);
+      thread_list_waiting (&m->background, waiting);
+
+      vty_out (vty, "Lane        Waiting   Ready  Max ready        Run"
+	       "      Turns%s", VTY_NEWLINE);
+      for (priority = 0; priority < THREAD_PRIORITIES; priority++)
+	{
+	  struct thread_lane *lane = &m->lanes[priority];
+
+	  vty_out (vty, "%-10s %8lu %7d %10d %10lu %10lu%s",
+		   thread_priority_name (priority), waiting[priority],
+		   lane->ready.count, lane->max_ready, lane->run, lane->turns,
+		   VTY_NEWLINE);
+	}
+    }
+  return CMD_SUCCESS;
+}
+
 /* List allocation and head/tail print out. */
 static void
 thread_list_debug (struct thread_list *list)
@@ -509,6 +877,10 @@ thread_master_debug (struct thread_master *m)
   thread_list_debug (&m->timer);
   printf ("eventlist : ");
   thread_list_debug (&m->event);
+  printf ("readylist : ");
+  thread_list_debug (&m->lanes[THREAD_PRIORITY_HIGH].ready);
+  thread_list_debug (&m->lanes[THREAD_PRIORITY_NORMAL].ready);
+  thread_list_debug (&m->lanes[THREAD_PRIORITY_BACKGROUND].ready);
   printf ("unuselist : ");
   thread_list_debug (&m->unuse);
   printf ("bgndlist : ");
@@ -521,13 +893,17 @@ thread_master_debug (struct thread_master *m)
 struct thread_master *
 thread_master_create ()
 {
+  struct thread_master *m;
+
   if (cpu_record == NULL) 
     cpu_record 
       = hash_create_size (1011, (unsigned int (*) (void *))cpu_record_hash_key, 
                           (int (*) (const void *, const void *))cpu_record_hash_cmp);
     
-  return (struct thread_master *) XCALLOC (MTYPE_THREAD_MASTER,
-					   sizeof (struct thread_master));
+  m = XCALLOC (MTYPE_THREAD_MASTER, sizeof (struct thread_master));
+  m->next = thread_masters;
+  thread_masters = m;
+  return m;
 }
 
 /* Add a new thread to the list.  */
@@ -611,13 +987,24 @@ thread_list_free (struct thread_master *m, struct thread_list *list)
 void
 thread_master_free (struct thread_master *m)
 {
+  struct thread_master **mp;
+  u_char priority;
+
   thread_list_free (m, &m->read);
   thread_list_free (m, &m->write);
   thread_list_free (m, &m->timer);
   thread_list_free (m, &m->event);
-  thread_list_free (m, &m->ready);
+  for (priority = 0; priority < THREAD_PRIORITIES; priority++)
+    thread_list_free (m, &m->lanes[priority].ready);
   thread_list_free (m, &m->unuse);
   thread_list_free (m, &m->background);
+
+  for (mp = &thread_masters; *mp; mp = &(*mp)->next)
+    if (*mp == m)
+      {
+	*mp = m->next;
+	break;
+      }
   
   XFREE (MTYPE_THREAD_MASTER, m);
 
@@ -704,6 +1091,8 @@ thread_get (struct thread_master *m, u_char type,
     }
   thread->type = type;
   thread->add_type = type;
+  thread->priority = (type == THREAD_BACKGROUND ?
+		      THREAD_PRIORITY_BACKGROUND : THREAD_PRIORITY_NORMAL);
   thread->master = m;
   thread->func = func;
   thread->arg = arg;
@@ -713,6 +1102,19 @@ thread_get (struct thread_master *m, u_char type,
   return thread;
 }
 
+/* Count THREAD in or out of the high priority events and timers
+   waiting, by ADD. */
+static void
+thread_high_waiting (struct thread *thread, int add)
+{
+  if (thread->priority != THREAD_PRIORITY_HIGH)
+    return;
+  if (thread->type == THREAD_EVENT)
+    thread->master->high_events += add;
+  else if (thread->type == THREAD_TIMER)
+    thread->master->high_timers += add;
+}
+
 /* Add new read thread. */
 struct thread *
 funcname_thread_add_read (struct thread_master *m, 
@@ -913,7 +1315,7 @@ thread_cancel (struct thread *thread)
       list = &thread->master->event;
       break;
     case THREAD_READY:
-      list = &thread->master->ready;
+      list = &thread->master->lanes[thread->priority].ready;
       break;
     case THREAD_BACKGROUND:
       list = &thread->master->background;
@@ -922,6 +1324,7 @@ thread_cancel (struct thread *thread)
       return;
       break;
     }
+  thread_high_waiting (thread, -1);
   thread_list_delete (list, thread);
   thread->type = THREAD_UNUSED;
   thread_add_unuse (thread->master, thread);
@@ -945,6 +1348,7 @@ thread_cancel_event (struct thread_master *m, void *arg)
       if (t->arg == arg)
         {
           ret++;
+          thread_high_waiting (t, -1);
           thread_list_delete (&m->event, t);
           t->type = THREAD_UNUSED;
           thread_add_unuse (m, t);
@@ -975,6 +1379,117 @@ thread_run (struct thread_master *m, struct thread *thread,
   return fetch;
 }
 
+/* Make THREAD ready in its lane. */
+static void
+thread_add_ready (struct thread_master *m, struct thread *thread)
+{
+  struct thread_lane *lane = &m->lanes[thread->priority];
+
+  thread_high_waiting (thread, -1);
+  thread->type = THREAD_READY;
+  thread_list_add (&lane->ready, thread);
+  if (lane->max_ready < lane->ready.count)
+    lane->max_ready = lane->ready.count;
+}
+
+/* Set the lane THREAD runs in once ready. */
+void
+thread_set_priority (struct thread *thread, u_char priority)
+{
+  assert (priority < THREAD_PRIORITIES);
+
+  if (thread == NULL || thread->priority == priority)
+    return;
+
+  if (thread->type == THREAD_READY)
+    {
+      thread_list_delete (&thread->master->lanes[thread->priority].ready,
+			  thread);
+      thread->priority = priority;
+      thread_add_ready (thread->master, thread);
+      return;
+    }
+
+  thread_high_waiting (thread, -1);
+  thread->priority = priority;
+  thread_high_waiting (thread, 1);
+}
+
+/* Make ready the high priority events, and the high priority timers
+   come due, so that they run ahead of the threads already ready
+   instead of after them. */
+static void
+thread_promote (struct thread_master *m)
+{
+  struct thread *thread;
+  struct thread *next;
+
+  for (thread = m->event.head; thread && m->high_events; thread = next)
+    {
+      next = thread->next;
+      if (thread->priority == THREAD_PRIORITY_HIGH)
+	{
+	  thread_list_delete (&m->event, thread);
+	  thread_add_ready (m, thread);
+	}
+    }
+
+  for (thread = m->timer.head; thread && m->high_timers; thread = next)
+    {
+      next = thread->next;
+      if (timeval_cmp (relative_time, thread->u.sands) < 0)
+	break;
+      if (thread->priority == THREAD_PRIORITY_HIGH)
+	{
+	  thread_list_delete (&m->timer, thread);
+	  thread_add_ready (m, thread);
+	}
+    }
+}
+
+/* The number of threads ready in every lane. */
+static int
+thread_ready_count (struct thread_master *m)
+{
+  u_char priority;
+  int count = 0;
+
+  for (priority = 0; priority < THREAD_PRIORITIES; priority++)
+    count += m->lanes[priority].ready.count;
+  return count;
+}
+
+/* Take the next ready thread: from the highest lane with any, unless a
+   lower lane has been passed over THREAD_LANE_BURST times in a row. */
+static struct thread *
+thread_lane_next (struct thread_master *m)
+{
+  struct thread_lane *lane;
+  struct thread_lane *first = NULL;
+  struct thread_lane *run = NULL;
+
+  for (lane = m->lanes; lane < m->lanes + THREAD_PRIORITIES; lane++)
+    if (lane->ready.head)
+      {
+	if (first == NULL)
+	  first = run = lane;
+	else if (lane->passed >= THREAD_LANE_BURST)
+	  run = lane;
+      }
+  if (run == NULL)
+    return NULL;
+
+  for (lane = m->lanes; lane < m->lanes + THREAD_PRIORITIES; lane++)
+    if (lane != run && lane->ready.head)
+      lane->passed++;
+  if (run != first)
+    run->turns++;
+  run->passed = 0;
+  run->run++;
+
+  return thread_trim_head (&run->ready);
+}
+
 static int
 thread_process_fd (struct thread_list *list, fd_set *fdset, fd_set *mfdset)
 {
@@ -993,8 +1508,7 @@ thread_process_fd (struct thread_list *list, fd_set *fdset, fd_set *mfdset)
           assert (FD_ISSET (THREAD_FD (thread), mfdset));
           FD_CLR(THREAD_FD (thread), mfdset);
           thread_list_delete (list, thread);
-          thread_list_add (&thread->master->ready, thread);
-          thread->type = THREAD_READY;
+          thread_add_ready (thread->master, thread);
           ready++;
         }
     }
@@ -1015,8 +1529,7 @@ thread_timer_process (struct thread_list *list, struct timeval *timenow)
       if (timeval_cmp (*timenow, thread->u.sands) < 0)
         return ready;
       thread_list_delete (list, thread);
-      thread->type = THREAD_READY;
-      thread_list_add (&thread->master->ready, thread);
+      thread_add_ready (thread->master, thread);
       ready++;
     }
   return ready;
@@ -1034,8 +1547,7 @@ thread_process (struct thread_list *list)
     {
       next = thread->next;
       thread_list_delete (list, thread);
-      thread->type = THREAD_READY;
-      thread_list_add (&thread->master->ready, thread);
+      thread_add_ready (thread->master, thread);
       ready++;
     }
   return ready;
@@ -1063,9 +1575,11 @@ thread_fetch (struct thread_master *m, struct thread *fetch)
       quagga_sigevent_process ();
        
       /* Drain the ready queue of already scheduled jobs, before scheduling
-       * more.
+       * more, except that high priority events and timers join it.
        */
-      if ((thread = thread_trim_head (&m->ready)) != NULL)
+      if (thread_ready_count (m))
+        thread_promote (m);
+      if ((thread = thread_lane_next (m)) != NULL)
         return thread_run (m, thread, fetch);
       
       /* To be fair to all kinds of threads, and avoid starvation, we
@@ -1082,7 +1596,7 @@ thread_fetch (struct thread_master *m, struct thread *fetch)
       exceptfd = m->exceptfd;
       
       /* Calculate select wait timer if nothing else to do */
-      if (m->ready.count == 0)
+      if (thread_ready_count (m) == 0)
         {
           quagga_get_relative (NULL);
           timer_wait = thread_timer_wait (&m->timer, &timer_val);
@@ -1124,14 +1638,14 @@ thread_fetch (struct thread_master *m, struct thread *fetch)
          perhaps we should avoid adding background timers to the ready
 	 list at this time.  If this is code is uncommented, then background
 	 timer threads will not run unless there is nothing else to do. */
-      if ((thread = thread_trim_head (&m->ready)) != NULL)
+      if ((thread = thread_lane_next (m)) != NULL)
         return thread_run (m, thread, fetch);
 #endif
 
       /* Background timer/events, lowest priority */
       thread_timer_process (&m->background, &relative_time);
       
-      if ((thread = thread_trim_head (&m->ready)) != NULL)
+      if ((thread = thread_lane_next (m)) != NULL)
         return thread_run (m, thread, fetch);
     }
 }
@@ -1157,11 +1671,18 @@ thread_consumed_time (RUSAGE_T *now, RUSAGE_T *start, unsigned long *cputime)
    or whether the system is heavily loaded with other processes competing
    for CPU time.  On balance, wall clock time seems to make sense. 
    Plus it has the added benefit that gettimeofday should be faster
-   than calling getrusage. */
+   than calling getrusage.  Threads other than high priority ones also
+   yield as soon as high priority ones are waiting to run. */
 int
 thread_should_yield (struct thread *thread)
 {
   quagga_get_relative (NULL);
+  if (thread->master && thread->priority != THREAD_PRIORITY_HIGH)
+    {
+      thread_promote (thread->master);
+      if (thread->master->lanes[THREAD_PRIORITY_HIGH].ready.count)
+	return 1;
+    }
   return (timeval_elapsed(relative_time, thread->ru.real) >
   	  THREAD_YIELD_TIME_SLOT);
 }
@@ -1229,6 +1750,9 @@ thread_call (struct thread *thread)
   ++(thread->hist->total_calls);
   thread->hist->types |= (1 << thread->add_type);
 
+  if (thread_latency)
+    thread_latency_add (thread, realtime);
+
 #ifdef CONSUMED_TIME_CHECK
   if (realtime > CONSUMED_TIME_CHECK)
     {
@@ -1261,6 +1785,7 @@ funcname_thread_execute (struct thread_master *m,
 
   dummy.type = THREAD_EVENT;
   dummy.add_type = THREAD_EXECUTE;
+  dummy.priority = THREAD_PRIORITY_NORMAL;
   dummy.master = NULL;
   dummy.func = func;
   dummy.arg = arg;
@@ -54,6 +54,26 @@ struct thread_list
   int count;
 };
 
+/* Ready threads run from the highest priority lane first, except that
+   a lane passed over THREAD_LANE_BURST times in a row while it had
+   threads ready then gets a turn.  Threads are normal priority unless
+   background, and high priority when set so after being added. */
+#define THREAD_PRIORITY_HIGH        0
+#define THREAD_PRIORITY_NORMAL      1
+#define THREAD_PRIORITY_BACKGROUND  2
+#define THREAD_PRIORITIES           3
+
+#define THREAD_LANE_BURST 32
+
+struct thread_lane
+{
+  struct thread_list ready;
+  unsigned int passed;		/* times passed over while ready */
+  unsigned long run;		/* threads run from the lane */
+  unsigned long turns;		/* of those, run ahead of higher lanes */
+  int max_ready;		/* most threads ready at once */
+};
+
 /* Master of the theads. */
 struct thread_master
 {
@@ -61,7 +81,9 @@ struct thread_master
   struct thread_list write;
   struct thread_list timer;
   struct thread_list event;
-  struct thread_list ready;
+  struct thread_lane lanes[THREAD_PRIORITIES];
+  unsigned int high_events;	/* high priority events waiting */
+  unsigned int high_timers;	/* high priority timers waiting */
   struct thread_list unuse;
   struct thread_list background;
   fd_set readfd;
@@ -69,6 +91,7 @@ struct thread_master
   fd_set exceptfd;
   unsigned long alloc;
   void *data;
+  struct thread_master *next;	/* of all masters, for "show thread" */
 };
 
 typedef unsigned char thread_type;
@@ -78,6 +101,7 @@ struct thread
 {
   thread_type type;		/* thread type */
   thread_type add_type;		/* thread type */
+  u_char priority;		/* lane when ready */
   struct thread *next;		/* next pointer of the thread */   
   struct thread *prev;		/* previous pointer of the thread */
   struct thread_master *master;	/* pointer to the struct thread_master. */
@@ -94,6 +118,12 @@ struct thread
   void *data;
 };
 
+/* With "thread latency" configured, how long threads run and how late
+   timers fire are counted in buckets of powers of two microseconds:
+   bucket 0 counts times under 1 usec, bucket i those from 2^(i-1) up
+   to 2^i usecs and the last bucket all longer ones. */
+#define THREAD_LATENCY_BUCKETS 24
+
 struct cpu_thread_history 
 {
   int (*func)(struct thread *);
@@ -107,6 +137,7 @@ struct cpu_thread_history
   struct time_stats cpu;
 #endif
   thread_type types;
+  unsigned long latency[THREAD_LATENCY_BUCKETS];
 };
 
 /* Clocks supported by Quagga */
@@ -214,11 +245,26 @@ extern struct thread *thread_fetch (struct thread_master *, struct thread *);
 extern void thread_call (struct thread *);
 extern unsigned long thread_timer_remain_second (struct thread *);
 extern int thread_should_yield (struct thread *);
+extern void thread_set_priority (struct thread *, u_char);
 
 /* Internal libzebra exports */
 extern void thread_getrusage (RUSAGE_T *);
 extern struct cmd_element show_thread_cpu_cmd;
 extern struct cmd_element clear_thread_cpu_cmd;
+extern struct cmd_element show_thread_latency_cmd;
+extern struct cmd_element show_thread_lanes_cmd;
+extern struct cmd_element config_thread_latency_cmd;
+extern struct cmd_element no_config_thread_latency_cmd;
+extern void thread_cpu_iterate (void (*) (const struct cpu_thread_history *,
+					 void *), void *);
+
+/* Whether latencies are counted.  For a thread type, its name, the
+   latency buckets of the threads added as it and those of how late its
+   timers fired, NULL if it has none. */
+extern int thread_latency;
+extern const char *thread_type_name (thread_type);
+extern const unsigned long *thread_type_latency (thread_type);
+extern const unsigned long *thread_timer_lag (thread_type);
 
 /* replacements for the system gettimeofday(), clock_gettime() and
  * time() functions, providing support for non-decrementing clock on
@@ -240,4 +286,5 @@ extern struct timeval recent_relative_time (void);
 
 extern long timersub_sec (struct timeval *a, struct timeval *b);
 extern long timersub_msec (struct timeval *a, struct timeval *b);
+extern long timersub_usec (struct timeval *a, struct timeval *b);
 #endif /* _ZEBRA_THREAD_H */
@@ -36,6 +36,7 @@
 #include "vty.h"
 #include "privs.h"
 #include "network.h"
+#include "telemetry.h"
 
 #include <arpa/telnet.h>
 
@@ -327,6 +328,78 @@ vty_new ()
   return new;
 }
 
+/* Drop the rest of a show command's output. */
+static void
+vty_output_stop (struct vty *vty)
+{
+  if (vty->output_func == NULL)
+    return;
+
+  (*vty->output_clean) (vty->output_arg);
+  vty->output_func = NULL;
+  vty->output_clean = NULL;
+  vty->output_arg = NULL;
+}
+
+/* Show output a chunk at a time.  Rather than putting out a large
+   table in one go, a show command may hand the walk over it to FUNC,
+   which puts out entries until vty_output_full() and returns 1 while
+   there are more to show, or 0 when it is done.  FUNC is called again
+   whenever the vty has written out what it was given, and must then
+   find its place again in a table that may have changed meanwhile.
+   CLEAN frees ARG, when the output is done or the vty closed. */
+void
+vty_output_start (struct vty *vty, int (*func) (struct vty *, void *),
+		  void (*clean) (void *), void *arg)
+{
+  vty_output_stop (vty);
+
+  /* Files and stdout take all of the output at once. */
+  if (vty->type != VTY_TERM && vty->type != VTY_SHELL_SERV)
+    {
+      while ((*func) (vty, arg))
+	;
+      (*clean) (arg);
+      return;
+    }
+
+  if (! (*func) (vty, arg))
+    {
+      (*clean) (arg);
+      return;
+    }
+
+  vty->output_func = func;
+  vty->output_clean = clean;
+  vty->output_arg = arg;
+}
+
+/* Whether a show command generating its output a chunk at a time
+   should stop for now. */
+int
+vty_output_full (struct vty *vty)
+{
+  if (vty->type != VTY_TERM && vty->type != VTY_SHELL_SERV)
+    return 0;
+  return buffer_length (vty->obuf) >= VTY_OUTPUT_CHUNK;
+}
+
+/* Generate the next chunk of a show command's output, if the vty has
+   written out what it had.  Returns 0 once the output is done. */
+static int
+vty_output_continue (struct vty *vty)
+{
+  if (vty->output_func == NULL)
+    return 0;
+
+  if (vty_output_full (vty)
+      || (*vty->output_func) (vty, vty->output_arg))
+    return 1;
+
+  vty_output_stop (vty);
+  return 0;
+}
+
 /* Authentication of vty */
 static void
 vty_auth (struct vty *vty, char *buf)
@@ -1300,7 +1373,8 @@ vty_execute (struct vty *vty)
   vty->cp = vty->length = 0;
   vty_clear_buf (vty);
 
-  if (vty->status != VTY_CLOSE )
+  /* A show command still putting out its output prompts when done. */
+  if (vty->status != VTY_CLOSE && ! vty->output_func)
     vty_prompt (vty);
 
   return ret;
@@ -1341,6 +1415,7 @@ vty_escape_map (unsigned char c, struct vty *vty)
 static void
 vty_buffer_reset (struct vty *vty)
 {
+  vty_output_stop (vty);
   buffer_reset (vty->obuf);
   vty_prompt (vty);
   vty_redraw_line (vty);
@@ -1410,7 +1485,8 @@ vty_read (struct thread *thread)
 	}
 	        
 
-      if (vty->status == VTY_MORE)
+      /* Keys only page through output, until it is all generated. */
+      if (vty->status == VTY_MORE || vty->output_func)
 	{
 	  switch (buf[i])
 	    {
@@ -1577,6 +1653,10 @@ vty_flush (struct thread *thread)
   /* Function execution continue. */
   erase = ((vty->status == VTY_MORE || vty->status == VTY_MORELINE));
 
+  /* Generate more of a show command's output as this is written. */
+  if (vty->output_func && ! vty_output_continue (vty))
+    vty_prompt (vty);
+
   /* N.B. if width is 0, that means we don't know the window size. */
   if ((vty->lines == 0) || (vty->width == 0))
     flushrc = buffer_flush_available(vty->obuf, vty->fd);
@@ -1600,6 +1680,11 @@ vty_flush (struct thread *thread)
     case BUFFER_EMPTY:
       if (vty->status == VTY_CLOSE)
 	vty_close (vty);
+      else if (vty->output_func)
+	{
+	  vty->status = VTY_NORMAL;
+	  vty_event (VTY_WRITE, vty_sock, vty);
+	}
       else
 	{
 	  vty->status = VTY_NORMAL;
@@ -2055,21 +2140,73 @@ vtysh_flush(struct vty *vty)
       return -1;
       break;
     case BUFFER_EMPTY:
+      /* More of a show command's output to generate. */
+      if (vty->output_func)
+	vty_event(VTYSH_WRITE, vty->fd, vty);
       break;
     }
   return 0;
 }
 
+/* Execute the commands in input from vtysh.  Should one of them
+   generate its output a chunk at a time, the rest of the input is
+   held in the command buffer until that is done.  Returns -1 if the
+   vty was closed. */
 static int
-vtysh_read (struct thread *thread)
+vtysh_input (struct vty *vty, const unsigned char *buf, int nbytes)
 {
   int ret;
+  const unsigned char *p;
+  u_char header[4] = {0, 0, 0, 0};
+
+  for (p = buf; p < buf+nbytes; p++)
+    {
+      vty_ensure(vty, vty->length+1);
+      vty->buf[vty->length++] = *p;
+      if (*p == '\0')
+	{
+	  /* Pass this line to parser. */
+	  ret = vty_execute (vty);
+	  /* Note that vty_execute clears the command buffer and resets
+	     vty->length to 0. */
+
+	  /* Return result. */
+#ifdef VTYSH_DEBUG
+	  printf ("result: %d\n", ret);
+	  printf ("vtysh node: %d\n", vty->node);
+#endif /* VTYSH_DEBUG */
+
+	  /* The result follows the output, once it is all out. */
+	  if (vty->output_func)
+	    {
+	      p++;
+	      vty_ensure (vty, buf + nbytes - p);
+	      memcpy (vty->buf, p, buf + nbytes - p);
+	      vty->length = buf + nbytes - p;
+	      if (!vty->t_write)
+		vty_event (VTYSH_WRITE, vty->fd, vty);
+	      return 0;
+	    }
+
+	  header[3] = ret;
+	  buffer_put(vty->obuf, header, 4);
+
+	  if (!vty->t_write && (vtysh_flush(vty) < 0))
+	    /* Try to flush results; exit if a write error occurs. */
+	    return -1;
+	}
+    }
+
+  return 0;
+}
+
+static int
+vtysh_read (struct thread *thread)
+{
   int sock;
   int nbytes;
   struct vty *vty;
   unsigned char buf[VTY_READ_BUFSIZ];
-  unsigned char *p;
-  u_char header[4] = {0, 0, 0, 0};
 
   sock = THREAD_FD (thread);
   vty = THREAD_ARG (thread);
@@ -2100,33 +2237,12 @@ vtysh_read (struct thread *thread)
   printf ("line: %.*s\n", nbytes, buf);
 #endif /* VTYSH_DEBUG */
 
-  for (p = buf; p < buf+nbytes; p++)
-    {
-      vty_ensure(vty, vty->length+1);
-      vty->buf[vty->length++] = *p;
-      if (*p == '\0')
-	{
-	  /* Pass this line to parser. */
-	  ret = vty_execute (vty);
-	  /* Note that vty_execute clears the command buffer and resets
-	     vty->length to 0. */
-
-	  /* Return result. */
-#ifdef VTYSH_DEBUG
-	  printf ("result: %d\n", ret);
-	  printf ("vtysh node: %d\n", vty->node);
-#endif /* VTYSH_DEBUG */
-
-	  header[3] = ret;
-	  buffer_put(vty->obuf, header, 4);
+  if (vtysh_input (vty, buf, nbytes) < 0)
+    return 0;
 
-	  if (!vty->t_write && (vtysh_flush(vty) < 0))
-	    /* Try to flush results; exit if a write error occurs. */
-	    return 0;
-	}
-    }
-
-  vty_event (VTYSH_READ, sock, vty);
+  /* Reading waits for a show command's output to be done. */
+  if (!vty->output_func)
+    vty_event (VTYSH_READ, sock, vty);
 
   return 0;
 }
@@ -2135,9 +2251,28 @@ static int
 vtysh_write (struct thread *thread)
 {
   struct vty *vty = THREAD_ARG (thread);
+  unsigned char buf[VTY_READ_BUFSIZ];
+  u_char header[4] = {0, 0, 0, CMD_SUCCESS};
+  int nbytes;
 
   vty->t_write = NULL;
-  vtysh_flush(vty);
+
+  if (vty->output_func && ! vty_output_continue (vty))
+    {
+      /* The output is done: return the result and carry on with the
+	 input held meanwhile, which is never more than one read. */
+      buffer_put(vty->obuf, header, 4);
+      nbytes = vty->length;
+      memcpy (buf, vty->buf, nbytes);
+      vty->length = 0;
+      if (vtysh_input (vty, buf, nbytes) < 0)
+	return 0;
+      if (!vty->output_func)
+	vty_event (VTYSH_READ, vty->fd, vty);
+    }
+
+  if (!vty->t_write)
+    vtysh_flush(vty);
   return 0;
 }
 
@@ -2185,6 +2320,8 @@ vty_close (struct vty *vty)
   if (vty->t_timeout)
     thread_cancel (vty->t_timeout);
 
+  vty_output_stop (vty);
+
   /* Flush buffer. */
   buffer_flush_all (vty->obuf, vty->fd);
 
@@ -3006,6 +3143,9 @@ vty_init (struct thread_master *master_thread)
   install_element (VTY_NODE, &vty_ipv6_access_class_cmd);
   install_element (VTY_NODE, &no_vty_ipv6_access_class_cmd);
 #endif /* HAVE_IPV6 */
+
+  /* Counters for monitoring, on a socket of their own. */
+  telemetry_init (master);
 }
 
 void
@@ -118,6 +118,12 @@ struct vty
   /* Timeout seconds and thread. */
   unsigned long v_timeout;
   struct thread *t_timeout;
+
+  /* Output of a show command still being generated, a chunk at a
+     time as the vty is written to: see vty_output_start(). */
+  int (*output_func) (struct vty *, void *);
+  void (*output_clean) (void *);
+  void *output_arg;
 };
 
 /* Integrated configuration file. */
@@ -133,6 +139,9 @@ struct vty
 /* Vty read buffer size. */
 #define VTY_READ_BUFSIZ 512
 
+/* Output generated ahead of what the vty has written. */
+#define VTY_OUTPUT_CHUNK 16384
+
 /* Directory separator. */
 #ifndef DIRECTORY_SEP
 #define DIRECTORY_SEP '/'
@@ -213,6 +222,9 @@ extern void vty_read_config (char *, char *);
 extern void vty_time_print (struct vty *, int);
 extern void vty_serv_sock (const char *, unsigned short, const char *);
 extern void vty_close (struct vty *);
+extern void vty_output_start (struct vty *, int (*) (struct vty *, void *),
+                              void (*) (void *), void *);
+extern int vty_output_full (struct vty *);
 extern char *vty_get_cwd (void);
 extern void vty_log (const char *level, const char *proto, 
                      const char *fmt, struct timestamp_control *, va_list);
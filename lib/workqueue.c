@@ -173,23 +173,28 @@ DEFUN(show_work_queues,
   struct listnode *node;
   struct work_queue *wq;
   
+  unsigned long units;
+
   vty_out (vty, 
-           "%c %8s %5s %8s %21s%s",
-           ' ', "List","(ms) ","Q. Runs","Cycle Counts   ",
+           "%c %8s %5s %8s %21s %8s%s",
+           ' ', "List","(ms) ","Q. Runs","Cycle Counts   ","Work",
            VTY_NEWLINE);
   vty_out (vty,
-           "%c %8s %5s %8s %7s %6s %6s %s%s",
+           "%c %8s %5s %8s %7s %6s %6s %8s %s%s",
            'P',
            "Items",
            "Hold",
            "Total",
            "Best","Gran.","Avg.", 
+           "Per sec",
            "Name", 
            VTY_NEWLINE);
  
   for (ALL_LIST_ELEMENTS_RO ((&work_queues), node, wq))
     {
-      vty_out (vty,"%c %8d %5d %8ld %7d %6d %6u %s%s",
+      /* items processed, unless the work function counts units */
+      units = wq->units ? wq->units : wq->cycles.total;
+      vty_out (vty,"%c %8d %5d %8ld %7d %6d %6u %8lu %s%s",
                (CHECK_FLAG (wq->flags, WQ_UNPLUGGED) ? ' ' : 'P'),
                listcount (wq->items),
                wq->spec.hold,
@@ -197,6 +202,8 @@ DEFUN(show_work_queues,
                wq->cycles.best, wq->cycles.granularity,
                  (wq->runs) ? 
                    (unsigned int) (wq->cycles.total / wq->runs) : 0,
+               wq->usec ?
+                 (unsigned long) (units * 1000000ULL / wq->usec) : 0,
                wq->name,
                VTY_NEWLINE);
     }
@@ -243,9 +250,11 @@ work_queue_run (struct thread *thread)
   unsigned int cycles = 0;
   struct listnode *node, *nnode;
   char yielded = 0;
+  struct timeval start, end;
 
   wq = THREAD_ARG (thread);
   wq->thread = NULL;
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
 
   assert (wq && wq->items);
 
@@ -366,6 +375,8 @@ stats:
   
   wq->runs++;
   wq->cycles.total += cycles;
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &end);
+  wq->usec += timersub_usec (&end, &start);
 
 #if 0
   printf ("%s: cycles %d, new: best %d, worst %d\n",
@@ -95,6 +95,12 @@ struct work_queue
     unsigned int granularity;
     unsigned long total;
   } cycles;	/* cycle counts */
+
+  /* Work done, for queues whose items stand for more than one unit of
+   * work and whose work function counts them here, and the time spent
+   * running the queue. */
+  unsigned long units;
+  unsigned long long usec;
   
   /* private state */
   u_int16_t flags;		/* user set flag */
@@ -32,6 +32,8 @@
 #include "zclient.h"
 #include "memory.h"
 #include "table.h"
+#include "rib_shm.h"
+#include "zebra_linkmetrics.h"
 
 /* Zebra client events. */
 enum event {ZCLIENT_SCHEDULE, ZCLIENT_READ, ZCLIENT_CONNECT};
@@ -39,6 +41,11 @@ enum event {ZCLIENT_SCHEDULE, ZCLIENT_READ, ZCLIENT_CONNECT};
 /* Prototype for event manager. */
 static void zclient_event (enum event, struct zclient *);
 
+static void zclient_rib_shm_read (struct zclient *);
+static void zclient_rib_shm_record (struct zclient *, uint16_t);
+static void zclient_rib_shm_redistribute (struct zclient *, int, int);
+static void zclient_rib_shm_finish (struct zclient *);
+
 extern struct thread_master *master;
 
 const char *zclient_serv_path = NULL;
@@ -68,6 +75,8 @@ zclient_new ()
 void
 zclient_free (struct zclient *zclient)
 {
+  zclient_rib_shm_finish (zclient);
+
   if (zclient->ibuf)
     stream_free(zclient->ibuf);
   if (zclient->obuf)
@@ -386,6 +395,10 @@ zclient_start (struct zclient *zclient)
   /* We need interface information. */
   zebra_message_send (zclient, ZEBRA_INTERFACE_ADD);
 
+  /* Before any redistribution, which zebra then leaves to the file. */
+  if (zclient->rib_shm_subscribe)
+    zebra_message_send (zclient, ZEBRA_RIB_SHM_SUBSCRIBE);
+
   /* Flush all redistribute request. */
   for (i = 0; i < ZEBRA_ROUTE_MAX; i++)
     if (i != zclient->redist_default && zclient->redist[i])
@@ -398,6 +411,9 @@ zclient_start (struct zclient *zclient)
   if (zclient->linkmetrics_subscribe)
     zclient_send_linkmetrics_subscribe (zclient, ZEBRA_LINKMETRICS_SUBSCRIBE);
 
+  if (zclient->zebra_connected)
+    (*zclient->zebra_connected) (zclient);
+
   return 0;
 }
 
@@ -596,7 +612,14 @@ zebra_redistribute_send (int command, struct zclient *zclient, int type)
   
   stream_putw_at (s, 0, stream_get_endp (s));
   
-  return zclient_send_message(zclient);
+  if (zclient_send_message(zclient) < 0)
+    return -1;
+
+  /* zebra sends no routes of the type when they are in the file */
+  if (zclient->rib_shm)
+    zclient_rib_shm_redistribute (zclient, command == ZEBRA_REDISTRIBUTE_ADD,
+                                  type);
+  return 0;
 }
 
 int
@@ -614,6 +637,8 @@ zclient_send_linkmetrics_subscribe (struct zclient *zclient, uint16_t cmd)
   stream_reset (s);
 
   zclient_create_header (s, cmd);
+  if (cmd == ZEBRA_LINKMETRICS_SUBSCRIBE && zclient->linkmetrics_batch)
+    stream_putc (s, ZEBRA_LINKMETRICS_SUBSCRIBE_BATCH);
 
   stream_putw_at (s, 0, stream_get_endp (s));
 
@@ -653,6 +678,491 @@ zclient_linkmetrics_subscribe (struct zclient *zclient, uint16_t cmd)
   return zclient_send_linkmetrics_subscribe (zclient, cmd);
 }
 
+/* Ask zebra for (or stop) ZEBRA_RIB_SHM_UPDATE notifications.  zebra
+   answers a subscription with the current version at once. */
+int
+zclient_rib_shm_subscribe (struct zclient *zclient, uint16_t cmd)
+{
+  switch (cmd)
+    {
+    case ZEBRA_RIB_SHM_SUBSCRIBE:
+      if (zclient->rib_shm_subscribe)
+	return 0;
+      zclient->rib_shm_subscribe = 1;
+      break;
+
+    case ZEBRA_RIB_SHM_UNSUBSCRIBE:
+      if (!zclient->rib_shm_subscribe)
+	return 0;
+      zclient->rib_shm_subscribe = 0;
+      /* zebra sends the routes again */
+      zclient_rib_shm_finish (zclient);
+      break;
+
+    default:
+      zlog_err ("%s: unknown zebra rib shm subscribe command: %u",
+		__func__, cmd);
+      return -1;
+    }
+
+  if (zclient->sock < 0)
+    return 0;                   /* sent by zclient_start() */
+  return zebra_message_send (zclient, cmd);
+}
+
+/* Ask zebra to track (or stop tracking) the resolution of a nexthop
+   address.  zebra sends a ZEBRA_NEXTHOP_UPDATE at once and whenever
+   the resolution changes.  Registrations don't outlive the
+   connection, see zebra_connected. */
+int
+zclient_nexthop_register (struct zclient *zclient, uint16_t cmd,
+                          struct prefix *p)
+{
+  struct stream *s;
+
+  if (zclient->sock < 0)
+    return -1;
+
+  s = zclient->obuf;
+  stream_reset (s);
+
+  zclient_create_header (s, cmd);
+  stream_putc (s, p->family);
+  stream_put (s, &p->u.prefix, prefix_blen (p));
+
+  stream_putw_at (s, 0, stream_get_endp (s));
+
+  return zclient_send_message (zclient);
+}
+
+/* Nexthop tracking update from zebra daemon: reads the address and
+   metric and returns the number of nexthops, which follow in the
+   stream as in a ZEBRA_IPV4_NEXTHOP_LOOKUP reply. */
+u_char
+zebra_nexthop_update_read (struct stream *s, struct prefix *p,
+                           u_int32_t *metric)
+{
+  memset (p, 0, sizeof (struct prefix));
+  p->family = stream_getc (s);
+  p->prefixlen = p->family == AF_INET ? IPV4_MAX_BITLEN : IPV6_MAX_BITLEN;
+  stream_get (&p->u.prefix, s, prefix_blen (p));
+  *metric = stream_getl (s);
+  return stream_getc (s);
+}
+
+/* Shared-memory RIB notification from zebra daemon: an empty path
+   means the RIB isn't exported. */
+void
+zebra_rib_shm_update_read (struct stream *s, u_int32_t *generation,
+                           u_int32_t *version, char *path, size_t size)
+{
+  u_int16_t len;
+
+  *generation = stream_getl (s);
+  *version = stream_getl (s);
+  len = stream_getw (s);
+  if (len >= size)
+    {
+      stream_forward_getp (s, len);
+      len = 0;
+    }
+  else
+    stream_get (path, s, len);
+  path[len] = '\0';
+}
+
+/* A redistributed route of a subscriber, by prefix: the type it was
+   delivered with, for the deletes the file can't tell the type of. */
+struct zclient_rib_route
+{
+  u_char type;
+  u_int32_t walk;               /* zclient->rib_shm_walks when last read */
+};
+
+static void
+zclient_rib_route_set (struct zclient *zclient, struct prefix *p,
+                       u_char type)
+{
+  struct zclient_rib_route *zr;
+  struct route_node *rn;
+  afi_t afi = family2afi (p->family);
+
+  if (zclient->rib_shm_routes[afi] == NULL)
+    zclient->rib_shm_routes[afi] = route_table_init ();
+
+  rn = route_node_get (zclient->rib_shm_routes[afi], p);
+  if ((zr = rn->info) != NULL)
+    route_unlock_node (rn);
+  else
+    zr = rn->info = XCALLOC (MTYPE_ZCLIENT_ROUTE,
+                             sizeof (struct zclient_rib_route));
+  zr->type = type;
+  zr->walk = zclient->rib_shm_walks;
+}
+
+static void
+zclient_rib_route_unset (struct route_node *rn)
+{
+  XFREE (MTYPE_ZCLIENT_ROUTE, rn->info);
+  rn->info = NULL;
+  route_unlock_node (rn);
+}
+
+static struct route_node *
+zclient_rib_route_lookup (struct zclient *zclient, struct prefix *p)
+{
+  struct route_node *rn;
+  afi_t afi = family2afi (p->family);
+
+  if (zclient->rib_shm_routes[afi] == NULL)
+    return NULL;
+  rn = route_node_lookup (zclient->rib_shm_routes[afi], p);
+  if (rn)
+    route_unlock_node (rn);
+  return rn;
+}
+
+/* Note a route zebra sent in the message being read, so that it can be
+   deleted once the file no longer has it. */
+static void
+zclient_rib_shm_record (struct zclient *zclient, uint16_t command)
+{
+  struct stream *s = zclient->ibuf;
+  size_t getp = stream_get_getp (s);
+  struct route_node *rn;
+  struct prefix p;
+  u_char type;
+
+  memset (&p, 0, sizeof (struct prefix));
+  if (command == ZEBRA_IPV4_ROUTE_ADD || command == ZEBRA_IPV4_ROUTE_DELETE)
+    p.family = AF_INET;
+  else
+    p.family = AF_INET6;
+  type = stream_getc (s);
+  stream_forward_getp (s, 2);   /* flags, message */
+  p.prefixlen = stream_getc (s);
+  if (p.prefixlen > prefix_blen (&p) * 8)
+    p.prefixlen = prefix_blen (&p) * 8;
+  stream_get (&p.u.prefix, s, PSIZE (p.prefixlen));
+  stream_set_getp (s, getp);
+
+  if (command == ZEBRA_IPV4_ROUTE_ADD || command == ZEBRA_IPV6_ROUTE_ADD)
+    zclient_rib_route_set (zclient, &p, type);
+  else if ((rn = zclient_rib_route_lookup (zclient, &p)) != NULL)
+    zclient_rib_route_unset (rn);
+}
+
+/* Hand a route read from the file to the route add or delete callback,
+   in the message zebra would have sent.  A delete carries only the
+   type and prefix.  The message is built in a stream of its own, lent
+   to the callback as zclient->ibuf, since a message of zebra may still
+   be being read from ibuf. */
+static void
+zclient_rib_shm_deliver (struct zclient *zclient, int add, u_char type,
+                         struct prefix *p, const struct rib_shm_route *route)
+{
+  static const u_char any[IPV6_MAX_BYTELEN];
+  int (*func) (int, struct zclient *, uint16_t);
+  struct stream *s, *ibuf;
+  u_char message = 0;
+  int command;
+
+  if (p->family == AF_INET)
+    {
+      command = add ? ZEBRA_IPV4_ROUTE_ADD : ZEBRA_IPV4_ROUTE_DELETE;
+      func = add ? zclient->ipv4_route_add : zclient->ipv4_route_delete;
+    }
+  else
+    {
+      command = add ? ZEBRA_IPV6_ROUTE_ADD : ZEBRA_IPV6_ROUTE_DELETE;
+      func = add ? zclient->ipv6_route_add : zclient->ipv6_route_delete;
+    }
+  if (func == NULL)
+    return;
+
+  if (add)
+    {
+      message = ZAPI_MESSAGE_DISTANCE | ZAPI_MESSAGE_METRIC;
+      if (route->ifindex || memcmp (route->gate, any, prefix_blen (p)))
+        message |= ZAPI_MESSAGE_NEXTHOP | ZAPI_MESSAGE_IFINDEX;
+    }
+
+  if (zclient->rib_shm_buf == NULL)
+    zclient->rib_shm_buf = stream_new (ZEBRA_MAX_PACKET_SIZ);
+  s = zclient->rib_shm_buf;
+  stream_reset (s);
+  stream_putc (s, type);
+  stream_putc (s, add ? route->flags : 0);
+  stream_putc (s, message);
+  stream_putc (s, p->prefixlen);
+  stream_write (s, (u_char *) &p->u.prefix, PSIZE (p->prefixlen));
+  if (CHECK_FLAG (message, ZAPI_MESSAGE_NEXTHOP))
+    {
+      stream_putc (s, 1);
+      stream_write (s, route->gate, prefix_blen (p));
+      stream_putc (s, 1);
+      stream_putl (s, route->ifindex);
+    }
+  if (add)
+    {
+      stream_putc (s, route->distance);
+      stream_putl (s, route->metric);
+    }
+
+  ibuf = zclient->ibuf;
+  zclient->ibuf = s;
+  (*func) (command, zclient, stream_get_endp (s));
+  zclient->ibuf = ibuf;
+}
+
+/* Whether zebra would redistribute the route to the client, as in
+   zebra_redistribute() and redistribute_add(). */
+static int
+zclient_rib_shm_wanted (struct zclient *zclient,
+                        const struct rib_shm_route *route, struct prefix *p)
+{
+  if (! CHECK_FLAG (route->state, RIB_SHM_ROUTE_ACTIVE)
+      || route->type >= ZEBRA_ROUTE_MAX
+      || route->type == zclient->redist_default)
+    return 0;
+  if (! zclient->redist[route->type]
+      && ! (p->prefixlen == 0 && zclient->default_information))
+    return 0;
+
+  if (p->family == AF_INET)
+    {
+      u_int32_t addr = ntohl (p->u.prefix4.s_addr);
+
+      if (IPV4_NET127 (addr) || IN_CLASSD (addr) || IPV4_LINKLOCAL (addr))
+        return 0;
+    }
+#ifdef HAVE_IPV6
+  if (p->family == AF_INET6
+      && (IN6_IS_ADDR_LOOPBACK (&p->u.prefix6)
+          || IN6_IS_ADDR_LINKLOCAL (&p->u.prefix6)))
+    return 0;
+#endif /* HAVE_IPV6 */
+  return 1;
+}
+
+/* rib_shm_func: deliver a route of the file, or its deletion. */
+static void
+zclient_rib_shm_route (const struct rib_shm_route *route, void *arg)
+{
+  struct zclient *zclient = arg;
+  struct zclient_rib_route *zr;
+  struct route_node *rn;
+  struct prefix p;
+
+  rib_shm_route_prefix (route, &p);
+  if (p.family != AF_INET && p.family != AF_INET6)
+    return;
+  rn = zclient_rib_route_lookup (zclient, &p);
+  zr = rn ? rn->info : NULL;
+
+  if (zclient_rib_shm_wanted (zclient, route, &p))
+    {
+      if (zr && zr->type != route->type)
+        zclient_rib_shm_deliver (zclient, 0, zr->type, &p, NULL);
+      zclient_rib_route_set (zclient, &p, route->type);
+      zclient_rib_shm_deliver (zclient, 1, route->type, &p, route);
+    }
+  else if (zr)
+    {
+      zclient_rib_shm_deliver (zclient, 0, zr->type, &p, NULL);
+      zclient_rib_route_unset (rn);
+    }
+}
+
+/* Delete the routes not read since walk number WALK. */
+static void
+zclient_rib_shm_sweep (struct zclient *zclient, u_int32_t walk)
+{
+  struct zclient_rib_route *zr;
+  struct route_node *rn;
+  afi_t afi;
+
+  for (afi = AFI_IP; afi < AFI_MAX; afi++)
+    if (zclient->rib_shm_routes[afi])
+      for (rn = route_top (zclient->rib_shm_routes[afi]); rn;
+           rn = route_next (rn))
+        if ((zr = rn->info) != NULL && zr->walk != walk)
+          {
+            zclient_rib_shm_deliver (zclient, 0, zr->type, &rn->p, NULL);
+            zclient_rib_route_unset (rn);
+          }
+}
+
+/* What a walk on a redistribution change delivers: the routes of
+   TYPE, or the default routes when TYPE is ZEBRA_ROUTE_MAX. */
+struct zclient_rib_redist
+{
+  struct zclient *zclient;
+  int type;
+};
+
+/* rib_shm_func: deliver a route newly redistributed. */
+static void
+zclient_rib_shm_redist_route (const struct rib_shm_route *route, void *arg)
+{
+  struct zclient_rib_redist *redist = arg;
+  struct prefix p;
+
+  rib_shm_route_prefix (route, &p);
+  if (p.family != AF_INET && p.family != AF_INET6)
+    return;
+  if (redist->type == ZEBRA_ROUTE_MAX
+      ? p.prefixlen != 0 : route->type != redist->type)
+    return;
+  if (! zclient_rib_shm_wanted (redist->zclient, route, &p))
+    return;
+
+  zclient_rib_route_set (redist->zclient, &p, route->type);
+  zclient_rib_shm_deliver (redist->zclient, 1, route->type, &p, route);
+}
+
+/* Follow a redistribution change as zebra would over the socket: on
+   an add deliver the routes of TYPE (the default routes when TYPE is
+   ZEBRA_ROUTE_MAX), and on a delete only forget them, since zebra
+   sends no deletes then. */
+static void
+zclient_rib_shm_redistribute (struct zclient *zclient, int add, int type)
+{
+  struct zclient_rib_redist redist;
+  struct zclient_rib_route *zr;
+  struct route_node *rn;
+  u_int32_t version;
+  afi_t afi;
+
+  if (add)
+    {
+      /* The changes since zclient->rib_shm_version are still to be
+         read, so the version walked to is not kept.  If the file was
+         replaced meanwhile, the routes come with the next update. */
+      redist.zclient = zclient;
+      redist.type = type;
+      rib_shm_walk (zclient->rib_shm, zclient_rib_shm_redist_route, &redist,
+                    &version);
+      return;
+    }
+
+  for (afi = AFI_IP; afi < AFI_MAX; afi++)
+    if (zclient->rib_shm_routes[afi])
+      for (rn = route_top (zclient->rib_shm_routes[afi]); rn;
+           rn = route_next (rn))
+        if ((zr = rn->info) != NULL
+            && (type == ZEBRA_ROUTE_MAX
+                ? rn->p.prefixlen == 0 && ! zclient->redist[zr->type]
+                : zr->type == type
+                  && ! (rn->p.prefixlen == 0
+                        && zclient->default_information)))
+          zclient_rib_route_unset (rn);
+}
+
+/* Catch up with the file: read the changes since the version last
+   read, or every route when WALK or when the changes are no longer
+   logged. */
+static void
+zclient_rib_shm_sync (struct zclient *zclient, int walk)
+{
+  struct rib_shm *shm;
+
+  if (! walk && rib_shm_changes (zclient->rib_shm, zclient->rib_shm_version,
+                                 zclient_rib_shm_route, zclient,
+                                 &zclient->rib_shm_version) == 0)
+    return;
+
+  zclient->rib_shm_walks++;
+  if (rib_shm_walk (zclient->rib_shm, zclient_rib_shm_route, zclient,
+                    &zclient->rib_shm_version) < 0)
+    {
+      /* replaced meanwhile */
+      if ((shm = rib_shm_open (zclient->rib_shm->path)) == NULL
+          || rib_shm_walk (shm, zclient_rib_shm_route, zclient,
+                           &zclient->rib_shm_version) < 0)
+        {
+          zlog_warn ("%s: can't read the RIB exported in %s", __func__,
+                     zclient->rib_shm->path);
+          if (shm)
+            rib_shm_close (shm);
+          return;
+        }
+      rib_shm_close (zclient->rib_shm);
+      zclient->rib_shm = shm;
+      zclient->rib_shm_generation = shm->header->generation;
+    }
+  zclient_rib_shm_sweep (zclient, zclient->rib_shm_walks);
+}
+
+/* A ZEBRA_RIB_SHM_UPDATE: map the file exported, or stop reading it
+   when it no longer is.  zebra then sends the routes itself again. */
+static void
+zclient_rib_shm_read (struct zclient *zclient)
+{
+  u_int32_t generation, version;
+  char path[MAXPATHLEN];
+  struct rib_shm *shm;
+
+  zebra_rib_shm_update_read (zclient->ibuf, &generation, &version,
+                             path, sizeof (path));
+
+  if (path[0] == '\0')
+    {
+      if (zclient->rib_shm)
+        {
+          rib_shm_close (zclient->rib_shm);
+          zclient->rib_shm = NULL;
+          zclient_rib_shm_sweep (zclient, ++zclient->rib_shm_walks);
+        }
+      return;
+    }
+
+  if (zclient->rib_shm && generation == zclient->rib_shm_generation
+      && strcmp (zclient->rib_shm->path, path) == 0)
+    {
+      zclient_rib_shm_sync (zclient, 0);
+      return;
+    }
+
+  if ((shm = rib_shm_open (path)) == NULL)
+    {
+      zlog_warn ("%s: can't map the RIB exported in %s: %s", __func__,
+                 path, safe_strerror (errno));
+      return;
+    }
+  if (zclient->rib_shm)
+    rib_shm_close (zclient->rib_shm);
+  zclient->rib_shm = shm;
+  zclient->rib_shm_generation = shm->header->generation;
+  zclient_rib_shm_sync (zclient, 1);
+}
+
+static void
+zclient_rib_shm_finish (struct zclient *zclient)
+{
+  struct route_node *rn;
+  afi_t afi;
+
+  if (zclient->rib_shm)
+    rib_shm_close (zclient->rib_shm);
+  zclient->rib_shm = NULL;
+
+  for (afi = AFI_IP; afi < AFI_MAX; afi++)
+    if (zclient->rib_shm_routes[afi])
+      {
+        for (rn = route_top (zclient->rib_shm_routes[afi]); rn;
+             rn = route_next (rn))
+          if (rn->info)
+            zclient_rib_route_unset (rn);
+        route_table_finish (zclient->rib_shm_routes[afi]);
+        zclient->rib_shm_routes[afi] = NULL;
+      }
+
+  if (zclient->rib_shm_buf)
+    stream_free (zclient->rib_shm_buf);
+  zclient->rib_shm_buf = NULL;
+}
+
 /* Router-id update from zebra daemon. */
 void
 zebra_router_id_update_read (struct stream *s, struct prefix *rid)
@@ -781,7 +1291,7 @@ void
 zebra_interface_if_set_value (struct stream *s, struct interface *ifp)
 {
   /* Read interface's index. */
-  ifp->ifindex = stream_getl (s);
+  if_set_index (ifp, stream_getl (s));
   ifp->status = stream_getc (s);
 
   /* Read interface's value. */
@@ -999,18 +1509,26 @@ zclient_read (struct thread *thread)
 	(*zclient->interface_down) (command, zclient, length);
       break;
     case ZEBRA_IPV4_ROUTE_ADD:
+      if (zclient->rib_shm_subscribe)
+	zclient_rib_shm_record (zclient, command);
       if (zclient->ipv4_route_add)
 	(*zclient->ipv4_route_add) (command, zclient, length);
       break;
     case ZEBRA_IPV4_ROUTE_DELETE:
+      if (zclient->rib_shm_subscribe)
+	zclient_rib_shm_record (zclient, command);
       if (zclient->ipv4_route_delete)
 	(*zclient->ipv4_route_delete) (command, zclient, length);
       break;
     case ZEBRA_IPV6_ROUTE_ADD:
+      if (zclient->rib_shm_subscribe)
+	zclient_rib_shm_record (zclient, command);
       if (zclient->ipv6_route_add)
 	(*zclient->ipv6_route_add) (command, zclient, length);
       break;
     case ZEBRA_IPV6_ROUTE_DELETE:
+      if (zclient->rib_shm_subscribe)
+	zclient_rib_shm_record (zclient, command);
       if (zclient->ipv6_route_delete)
 	(*zclient->ipv6_route_delete) (command, zclient, length);
       break;
@@ -1026,6 +1544,20 @@ zclient_read (struct thread *thread)
       if (zclient->linkstatus)
         (*zclient->linkstatus) (command, zclient, length);
       break;
+    case ZEBRA_LINKMETRICS_BATCH:
+      if (zclient->linkmetrics_batch)
+        (*zclient->linkmetrics_batch) (command, zclient, length);
+      break;
+    case ZEBRA_NEXTHOP_UPDATE:
+      if (zclient->nexthop_update)
+        (*zclient->nexthop_update) (command, zclient, length);
+      break;
+    case ZEBRA_RIB_SHM_UPDATE:
+      if (zclient->rib_shm_update)
+        (*zclient->rib_shm_update) (command, zclient, length);
+      else
+        zclient_rib_shm_read (zclient);
+      break;
     default:
       break;
     }
@@ -1081,7 +1613,13 @@ zclient_redistribute_default (int command, struct zclient *zclient)
     }
 
   if (zclient->sock > 0)
-    zebra_message_send (zclient, command);
+    {
+      zebra_message_send (zclient, command);
+      if (zclient->rib_shm)
+        zclient_rib_shm_redistribute (zclient,
+                                      command == ZEBRA_REDISTRIBUTE_DEFAULT_ADD,
+                                      ZEBRA_ROUTE_MAX);
+    }
 }
 
 static void
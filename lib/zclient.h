@@ -31,6 +31,9 @@
 /* For input/output buffer to zebra. */
 #define ZEBRA_MAX_PACKET_SIZ          4096
 
+struct route_table;
+struct rib_shm;
+
 /* Zebra header size. */
 #define ZEBRA_HEADER_SIZE             6
 
@@ -90,6 +93,29 @@ struct zclient
   int (*linkmetrics) (int, struct zclient *, uint16_t);
   int (*linkmetrics_request) (int, struct zclient *, uint16_t);
   int (*linkstatus) (int, struct zclient *, uint16_t);
+  /* if set, updates may also arrive as ZEBRA_LINKMETRICS_BATCH */
+  int (*linkmetrics_batch) (int, struct zclient *, uint16_t);
+
+  /* nonzero to be notified of changes to the shared-memory RIB.
+     Unless rib_shm_update is set, redistributed routes are then read
+     from the file while zebra exports it, and delivered through the
+     route add and delete callbacks as if zebra had sent them. */
+  u_char rib_shm_subscribe;
+  int (*rib_shm_update) (int, struct zclient *, uint16_t);
+
+  /* the file read, and the redistributed routes delivered by type */
+  struct rib_shm *rib_shm;
+  u_int32_t rib_shm_generation;
+  u_int32_t rib_shm_version;
+  u_int32_t rib_shm_walks;
+  struct route_table *rib_shm_routes[AFI_MAX];
+  struct stream *rib_shm_buf;   /* the route messages delivered */
+
+  /* nexthop tracking */
+  int (*nexthop_update) (int, struct zclient *, uint16_t);
+
+  /* called once connected, to register with zebra again */
+  void (*zebra_connected) (struct zclient *);
 };
 
 /* Zebra API message flag. */
@@ -202,5 +228,14 @@ extern int zclient_send_linkmetrics_subscribe (struct zclient *zclient,
 					       uint16_t cmd);
 extern int zclient_linkmetrics_subscribe (struct zclient *zclient,
 					  uint16_t cmd);
+extern int zclient_rib_shm_subscribe (struct zclient *zclient, uint16_t cmd);
+extern int zclient_nexthop_register (struct zclient *zclient, uint16_t cmd,
+                                     struct prefix *p);
+extern u_char zebra_nexthop_update_read (struct stream *s, struct prefix *p,
+                                         u_int32_t *metric);
+extern void zebra_rib_shm_update_read (struct stream *s,
+                                       u_int32_t *generation,
+                                       u_int32_t *version,
+                                       char *path, size_t size);
 
 #endif /* _ZEBRA_ZCLIENT_H */
@@ -423,7 +423,14 @@ struct in_pktinfo
 #define ZEBRA_LINKMETRICS_METRICS         26
 #define ZEBRA_LINKMETRICS_STATUS          27
 #define ZEBRA_LINKMETRICS_METRICS_REQUEST 28
-#define ZEBRA_MESSAGE_MAX                 29
+#define ZEBRA_RIB_SHM_SUBSCRIBE           29
+#define ZEBRA_RIB_SHM_UNSUBSCRIBE         30
+#define ZEBRA_RIB_SHM_UPDATE              31
+#define ZEBRA_NEXTHOP_REGISTER            32
+#define ZEBRA_NEXTHOP_UNREGISTER          33
+#define ZEBRA_NEXTHOP_UPDATE              34
+#define ZEBRA_LINKMETRICS_BATCH           35
+#define ZEBRA_MESSAGE_MAX                 36
 
 /* Marker value used in new Zserv, in the byte location corresponding
  * the command value in the old zserv header. To allow old and new
@@ -49,16 +49,10 @@ zebra_linkmetrics_logdebug (const struct zebra_linkmetrics *metrics)
   return;
 }
 
-/* serialize a link metrics structure */
-int
-zapi_write_linkmetrics (struct stream *s,
-                        const struct zebra_linkmetrics *metrics)
+static void
+zapi_put_linkmetrics (struct stream *s,
+                      const struct zebra_linkmetrics *metrics)
 {
-  /* initialize the stream */
-  stream_reset (s);
-  zclient_create_header (s, ZEBRA_LINKMETRICS_METRICS);
-
-  /* write the linkmetrics structure */
   stream_putl (s, metrics->ifindex);
   stream_put_in_addr (s, &metrics->nbr_addr4);
   stream_write (s, &metrics->nbr_addr6, sizeof (metrics->nbr_addr6));
@@ -69,6 +63,34 @@ zapi_write_linkmetrics (struct stream *s,
   stream_putw (s, metrics->metrics.latency);
   stream_putq (s, metrics->metrics.current_datarate);
   stream_putq (s, metrics->metrics.max_datarate);
+}
+
+static void
+zapi_get_linkmetrics (struct zebra_linkmetrics *metrics, struct stream *s)
+{
+  metrics->ifindex = stream_getl (s);
+  metrics->nbr_addr4.s_addr = stream_get_ipv4 (s);
+  stream_get (&metrics->nbr_addr6, s, sizeof (metrics->nbr_addr6));
+
+  metrics->metrics.flags = stream_getl (s);
+  metrics->metrics.rlq = stream_getc (s);
+  metrics->metrics.resource = stream_getc (s);
+  metrics->metrics.latency = stream_getw (s);
+  metrics->metrics.current_datarate = stream_getq (s);
+  metrics->metrics.max_datarate = stream_getq (s);
+}
+
+/* serialize a link metrics structure */
+int
+zapi_write_linkmetrics (struct stream *s,
+                        const struct zebra_linkmetrics *metrics)
+{
+  /* initialize the stream */
+  stream_reset (s);
+  zclient_create_header (s, ZEBRA_LINKMETRICS_METRICS);
+
+  /* write the linkmetrics structure */
+  zapi_put_linkmetrics (s, metrics);
 
   /* put length at beginning of stream */
   if (stream_putw_at (s, 0, stream_get_endp (s)) != 2)
@@ -88,16 +110,7 @@ zapi_read_linkmetrics (struct zebra_linkmetrics *metrics,
       return -1;
     }
 
-  metrics->ifindex = stream_getl (s);
-  metrics->nbr_addr4.s_addr = stream_get_ipv4 (s);
-  stream_get (&metrics->nbr_addr6, s, sizeof (metrics->nbr_addr6));
-
-  metrics->metrics.flags = stream_getl (s);
-  metrics->metrics.rlq = stream_getc (s);
-  metrics->metrics.resource = stream_getc (s);
-  metrics->metrics.latency = stream_getw (s);
-  metrics->metrics.current_datarate = stream_getq (s);
-  metrics->metrics.max_datarate = stream_getq (s);
+  zapi_get_linkmetrics (metrics, s);
 
   return 0;
 }
@@ -119,6 +132,24 @@ zebra_linkstatus_logdebug (const struct zebra_linkstatus *status)
   return;
 }
 
+static void
+zapi_put_linkstatus (struct stream *s, const struct zebra_linkstatus *status)
+{
+  stream_putl (s, status->ifindex);
+  stream_put_in_addr (s, &status->nbr_addr4);
+  stream_write (s, &status->nbr_addr6, sizeof (status->nbr_addr6));
+  stream_putc (s, status->status);
+}
+
+static void
+zapi_get_linkstatus (struct zebra_linkstatus *status, struct stream *s)
+{
+  status->ifindex = stream_getl (s);
+  status->nbr_addr4.s_addr = stream_get_ipv4 (s);
+  stream_get (&status->nbr_addr6, s, sizeof (status->nbr_addr6));
+  status->status = stream_getc (s);
+}
+
 /* serialize a link status structure */
 int
 zapi_write_linkstatus (struct stream *s,
@@ -129,10 +160,7 @@ zapi_write_linkstatus (struct stream *s,
   zclient_create_header (s, ZEBRA_LINKMETRICS_STATUS);
 
   /* write the linkstatus structure */
-  stream_putl (s, status->ifindex);
-  stream_put_in_addr (s, &status->nbr_addr4);
-  stream_write (s, &status->nbr_addr6, sizeof (status->nbr_addr6));
-  stream_putc (s, status->status);
+  zapi_put_linkstatus (s, status);
 
   /* put length at beginning of stream */
   if (stream_putw_at (s, 0, stream_get_endp (s)) != 2)
@@ -152,10 +180,7 @@ zapi_read_linkstatus (struct zebra_linkstatus *status,
       return -1;
     }
 
-  status->ifindex = stream_getl (s);
-  status->nbr_addr4.s_addr = stream_get_ipv4 (s);
-  stream_get (&status->nbr_addr6, s, sizeof (status->nbr_addr6));
-  status->status = stream_getc (s);
+  zapi_get_linkstatus (status, s);
 
   return 0;
 }
@@ -214,3 +239,125 @@ zapi_read_linkmetrics_request (struct zebra_linkmetrics_request *request,
 
   return 0;
 }
+
+/* A ZEBRA_LINKMETRICS_BATCH message carries a count followed by that
+ * many link metrics and link status updates, each preceded by its
+ * message type (ZEBRA_LINKMETRICS_METRICS or ZEBRA_LINKMETRICS_STATUS)
+ * and encoded as in the single update messages.  Updates appear in the
+ * order they are to be applied. */
+
+/* start a link metrics batch */
+int
+zapi_linkmetrics_batch_start (struct stream *s)
+{
+  stream_reset (s);
+  zclient_create_header (s, ZEBRA_LINKMETRICS_BATCH);
+  stream_putw (s, 0);
+
+  return 0;
+}
+
+static int
+zapi_linkmetrics_batch_add (struct stream *s, u_char type, size_t len)
+{
+  if (STREAM_WRITEABLE (s) < 1 + len)
+    return -1;
+
+  stream_putw_at (s, ZEBRA_HEADER_SIZE,
+                  stream_getw_from (s, ZEBRA_HEADER_SIZE) + 1);
+  stream_putc (s, type);
+
+  return 0;
+}
+
+/* append link metrics to a batch, returns -1 if the batch is full */
+int
+zapi_linkmetrics_batch_add_metrics (struct stream *s,
+                                    const struct zebra_linkmetrics *metrics)
+{
+  if (zapi_linkmetrics_batch_add (s, ZEBRA_LINKMETRICS_METRICS,
+                                  ZAPI_LINKMETRICS_LEN))
+    return -1;
+
+  zapi_put_linkmetrics (s, metrics);
+
+  return 0;
+}
+
+/* append a link status to a batch, returns -1 if the batch is full */
+int
+zapi_linkmetrics_batch_add_status (struct stream *s,
+                                   const struct zebra_linkstatus *status)
+{
+  if (zapi_linkmetrics_batch_add (s, ZEBRA_LINKMETRICS_STATUS,
+                                  ZAPI_LINKSTATUS_LEN))
+    return -1;
+
+  zapi_put_linkstatus (s, status);
+
+  return 0;
+}
+
+/* finish a link metrics batch and return the number of updates in it */
+int
+zapi_linkmetrics_batch_finish (struct stream *s)
+{
+  /* put length at beginning of stream */
+  if (stream_putw_at (s, 0, stream_get_endp (s)) != 2)
+    zlog_err ("%s: stream_putw_at() failed for setting length", __func__);
+
+  return stream_getw_from (s, ZEBRA_HEADER_SIZE);
+}
+
+/* read the number of updates in a link metrics batch; length is
+ * updated to what remains of the message */
+int
+zapi_read_linkmetrics_batch (struct stream *s, u_short *length)
+{
+  if (*length < 2)
+    {
+      zlog_err ("%s: invalid length: %u", __func__, *length);
+      return -1;
+    }
+
+  *length -= 2;
+  return stream_getw (s);
+}
+
+/* unserialize the next update of a link metrics batch, into metrics
+ * or status depending on the type returned; length is what remains of
+ * the message and is updated.  Returns -1 on error. */
+int
+zapi_read_linkmetrics_batch_entry (struct zebra_linkmetrics *metrics,
+                                   struct zebra_linkstatus *status,
+                                   struct stream *s, u_short *length)
+{
+  u_char type;
+
+  if (*length < 1)
+    return -1;
+
+  type = stream_getc (s);
+  switch (type)
+    {
+    case ZEBRA_LINKMETRICS_METRICS:
+      if (*length < 1 + ZAPI_LINKMETRICS_LEN)
+        return -1;
+      zapi_get_linkmetrics (metrics, s);
+      *length -= 1 + ZAPI_LINKMETRICS_LEN;
+      break;
+
+    case ZEBRA_LINKMETRICS_STATUS:
+      if (*length < 1 + ZAPI_LINKSTATUS_LEN)
+        return -1;
+      zapi_get_linkstatus (status, s);
+      *length -= 1 + ZAPI_LINKSTATUS_LEN;
+      break;
+
+    default:
+      zlog_err ("%s: invalid update type: %u", __func__, type);
+      return -1;
+    }
+
+  return type;
+}
@@ -89,4 +89,19 @@ int zapi_write_linkmetrics_request (struct stream *s,
 int zapi_read_linkmetrics_request (struct zebra_linkmetrics_request *request,
                                    struct stream *s, u_short length);
 
+/* ZEBRA_LINKMETRICS_SUBSCRIBE option: the client accepts
+   ZEBRA_LINKMETRICS_BATCH messages */
+#define ZEBRA_LINKMETRICS_SUBSCRIBE_BATCH (1 << 0)
+
+int zapi_linkmetrics_batch_start (struct stream *s);
+int zapi_linkmetrics_batch_add_metrics (struct stream *s,
+                                        const struct zebra_linkmetrics *metrics);
+int zapi_linkmetrics_batch_add_status (struct stream *s,
+                                       const struct zebra_linkstatus *status);
+int zapi_linkmetrics_batch_finish (struct stream *s);
+int zapi_read_linkmetrics_batch (struct stream *s, u_short *length);
+int zapi_read_linkmetrics_batch_entry (struct zebra_linkmetrics *metrics,
+                                       struct zebra_linkstatus *status,
+                                       struct stream *s, u_short *length);
+
 #endif	/* _ZEBRA_LINKMETRICS_H_ */
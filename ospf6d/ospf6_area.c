@@ -258,6 +258,7 @@ ospf6_area_delete (struct ospf6_area *oa)
   ospf6_route_table_delete (oa->route_table);
 
   THREAD_OFF (oa->thread_spf_calculation);
+  oa->spf_pending = 0;
   THREAD_OFF (oa->thread_router_lsa);
   THREAD_OFF (oa->thread_intra_prefix_lsa);
 
@@ -445,6 +446,7 @@ ospf6_area_disable (struct ospf6_area *oa)
   UNSET_FLAG (oa->flag, OSPF6_AREA_ENABLE);
 
   THREAD_OFF (oa->thread_spf_calculation);
+  oa->spf_pending = 0;
   THREAD_OFF (oa->thread_router_lsa);
   THREAD_OFF (oa->thread_intra_prefix_lsa);
 
@@ -473,6 +475,10 @@ ospf6_area_show (struct vty *vty, struct ospf6_area *oa)
   vty_out (vty, " Area %s%s", oa->name, VNL);
   vty_out (vty, "     Number of Area scoped LSAs is %u%s",
            oa->lsdb->count, VNL);
+  vty_out (vty, "     SPF algorithm executed %u times%s",
+           oa->spf_count, VNL);
+  vty_out (vty, "     Router-LSA originated %u times%s",
+           oa->router_lsa_count, VNL);
 
   vty_out (vty, "     Interface attached to this area:");
   for (ALL_LIST_ELEMENTS_RO (oa->if_list, i, oi))
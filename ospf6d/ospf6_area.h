@@ -57,6 +57,7 @@ struct ospf6_area
   struct ospf6_route_table *route_table;
 
   struct thread  *thread_spf_calculation;
+  u_char spf_pending;           /* waiting for a parallel SPF batch */
   struct timeval last_spftime;
   unsigned int spf_delay_msec;
   unsigned int spf_holdtime_msec;
@@ -65,6 +66,12 @@ struct ospf6_area
   struct thread *thread_intra_prefix_lsa;
   u_int32_t router_lsa_size_limit;
 
+  /* Statistics */
+  u_int32_t spf_count;
+  unsigned long spf_usec;        /* SPF trees, all told */
+  unsigned long spf_usec_max;
+  u_int32_t router_lsa_count;
+
   /* Area announce list */
   struct
   {
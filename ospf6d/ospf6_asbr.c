@@ -1019,7 +1019,7 @@ ospf6_routemap_rule_match_address_prefixlist (void *rule,
   if (type != RMAP_OSPF6)
     return RMAP_NOMATCH;
 
-  plist = prefix_list_lookup (AFI_IP6, (char *) rule);
+  plist = prefix_list_ref_lookup (rule);
   if (plist == NULL)
     return RMAP_NOMATCH;
 
@@ -1030,13 +1030,13 @@ ospf6_routemap_rule_match_address_prefixlist (void *rule,
 static void *
 ospf6_routemap_rule_match_address_prefixlist_compile (const char *arg)
 {
-  return XSTRDUP (MTYPE_ROUTE_MAP_COMPILED, arg);
+  return prefix_list_ref_new (AFI_IP6, arg);
 }
 
 static void
 ospf6_routemap_rule_match_address_prefixlist_free (void *rule)
 {
-  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+  prefix_list_ref_free (rule);
 }
 
 struct route_map_rule_cmd
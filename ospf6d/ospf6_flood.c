@@ -41,6 +41,7 @@
 #include "ospf6_neighbor.h"
 
 #include "ospf6_mdr_flood.h"
+#include "ospf6_mdr_ack.h"
 #include "ospf6_flood.h"
 
 unsigned char conf_debug_ospf6_flooding;
@@ -332,6 +333,7 @@ ospf6_flood_interface (struct ospf6_neighbor *from,
                 {
                   if (is_debug)
                     zlog_debug ("Requesting the same, remove it, next neighbor");
+                  ospf6_lsreq_answered (on, req, lsa);
                   ospf6_lsdb_remove (req, on->request_list);
                   continue;
                 }
@@ -341,6 +343,7 @@ ospf6_flood_interface (struct ospf6_neighbor *from,
                 {
                   if (is_debug)
                     zlog_debug ("Received is newer, remove requesting");
+                  ospf6_lsreq_answered (on, req, lsa);
                   ospf6_lsdb_remove (req, on->request_list);
                   /* fall through */
                 }
@@ -969,7 +972,7 @@ ospf6_receive_lsa (struct ospf6_lsa_header *lsa_header,
     }
 
   if (from->ospf6_if->type == OSPF6_IFTYPE_MDR)
-    ospf6_mdr_neighbor_store_ack (from, new);
+    ospf6_mdr_neighbor_store_ack (from, new, OSPF6_MDR_ACK_IMPLICIT);
 
   /* if no database copy or received is more recent */
   if (old == NULL || ismore_recent < 0)
@@ -1119,6 +1119,7 @@ interface_up (struct thread *thread)
       THREAD_OFF (oi->thread_send_hello);
       oi->thread_send_hello =
 	thread_add_event (master, ospf6_hello_send, oi, 0);
+      thread_set_priority (oi->thread_send_hello, THREAD_PRIORITY_HIGH);
     }
 
   return 0;
@@ -23,6 +23,7 @@
 #define OSPF6_INTERFACE_H
 
 #include "if.h"
+#include "ospf6_message.h"
 #include "ospf6_mdr_interface.h"
 
 /* Debug option */
@@ -134,6 +135,12 @@ struct ospf6_interface
 
   struct ospf6_mdr_interface mdr;
 
+  /* Statistics */
+  struct ospf6_message_stats rx;
+  struct ospf6_message_stats tx;
+  u_int32_t lsa_retransmits;
+  u_int32_t mdr_calculations;
+
   struct list *private_data_list;
 };
 
@@ -106,6 +106,7 @@ ospf6_linkstatus_update (struct ospf6_interface *oi,
           THREAD_OFF (oi->thread_send_hello);
           oi->thread_send_hello =
             thread_add_event (master, ospf6_hello_send, oi, 0);
+          thread_set_priority (oi->thread_send_hello, THREAD_PRIORITY_HIGH);
         }
       break;
 
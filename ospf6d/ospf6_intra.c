@@ -238,6 +238,7 @@ ospf6_router_lsa_originate (struct thread *thread)
 
           /* Originate */
           ospf6_lsa_originate_area (lsa, oa);
+          oa->router_lsa_count++;
 
           /* Reset setting for consecutive origination */
           memset ((caddr_t) router_lsa + sizeof (struct ospf6_router_lsa),
@@ -329,6 +330,7 @@ ospf6_router_lsa_originate (struct thread *thread)
 
       /* Originate */
       ospf6_lsa_originate_area (lsa, oa);
+      oa->router_lsa_count++;
 
       link_state_id ++;
     }
@@ -47,6 +47,14 @@
 
 static vector ospf6_lsa_handler_vector;
 
+/* LSA contents sharing statistics */
+static struct
+{
+  unsigned long shared;         /* copies currently sharing contents */
+  unsigned long bytes_saved;    /* bytes not duplicated by those copies */
+  unsigned long unshared;       /* copies made private before modification */
+} ospf6_lsa_data_stats;
+
 static int
 ospf6_unknown_lsa_show (struct vty *vty, struct ospf6_lsa *lsa)
 {
@@ -122,7 +130,7 @@ ospf6_get_lsa_handler (u_int16_t type)
 const char *
 ospf6_lstype_name (u_int16_t type)
 {
-  static char buf[8];
+  static OSPF6_THREAD_LOCAL char buf[8];
   struct ospf6_lsa_handler *handler;
 
   handler = ospf6_get_lsa_handler (type);
@@ -152,19 +160,16 @@ ospf6_lsa_is_differ (struct ospf6_lsa *lsa1,
 
   /* XXX, Options ??? */
 
-  ospf6_lsa_age_current (lsa1);
-  ospf6_lsa_age_current (lsa2);
-  if (ntohs (lsa1->header->age) == MAXAGE &&
-      ntohs (lsa2->header->age) != MAXAGE)
-    return 1;
-  if (ntohs (lsa1->header->age) != MAXAGE &&
-      ntohs (lsa2->header->age) == MAXAGE)
+  if (OSPF6_LSA_IS_MAXAGE (lsa1) != OSPF6_LSA_IS_MAXAGE (lsa2))
     return 1;
 
   /* compare body */
   if (ntohs (lsa1->header->length) != ntohs (lsa2->header->length))
     return 1;
 
+  if (lsa1->data == lsa2->data)
+    return 0;
+
   len = ntohs (lsa1->header->length) - sizeof (struct ospf6_lsa_header);
   return memcmp (lsa1->header + 1, lsa2->header + 1, len);
 }
@@ -187,6 +192,8 @@ ospf6_lsa_is_changed (struct ospf6_lsa *lsa1,
   }
   if (CHECK_FLAG (lsa1->flag, OSPF6_LSA_HEADERONLY))
     return 0;
+  if (lsa1->data == lsa2->data)
+    return 0;
 
   length = OSPF6_LSA_SIZE (lsa1->header) - sizeof (struct ospf6_lsa_header);
   /* Once upper layer verifies LSAs received, length underrun should become a warning. */
@@ -216,8 +223,10 @@ ospf6_lsa_age_set (struct ospf6_lsa *lsa)
   return;
 }
 
-/* this function calculates current age from its birth,
-   then update age field of LSA header. return value is current age */
+/* this function calculates current age from its birth and returns it;
+   the LSA header is left untouched since its contents may be shared,
+   and read from the SPF workers, so only ospf6_lsa_copy_to_send ()
+   writes the age into the copy sent */
 u_int16_t
 ospf6_lsa_age_current (struct ospf6_lsa *lsa)
 {
@@ -238,7 +247,6 @@ ospf6_lsa_age_current (struct ospf6_lsa *lsa)
       /* ospf6_lsa_premature_aging () sets age to MAXAGE; when using
          relative time, we cannot compare against lsa birth time, so
          we catch this special case here. */
-      lsa->header->age = htons (MAXAGE);
       return MAXAGE;
     }
   /* calculate age */
@@ -247,26 +255,33 @@ ospf6_lsa_age_current (struct ospf6_lsa *lsa)
   /* if over MAXAGE, set to it */
   age = (ulage > MAXAGE ? MAXAGE : ulage);
 
-  lsa->header->age = htons (age);
   return age;
 }
 
-/* update age field of LSA header with adding InfTransDelay */
+/* copy LSA into an outgoing packet, updating the age field of the
+   copy with adding InfTransDelay; the LSA contents may be shared so
+   they are left untouched */
 void
-ospf6_lsa_age_update_to_send (struct ospf6_lsa *lsa, u_int32_t transdelay)
+ospf6_lsa_copy_to_send (struct ospf6_lsa *lsa, void *buf, size_t size,
+                        u_int32_t transdelay)
 {
-  unsigned short age;
+  struct ospf6_lsa_header *header = buf;
+  u_int32_t age;
+
+  assert (size >= sizeof (struct ospf6_lsa_header));
 
   age = ospf6_lsa_age_current (lsa) + transdelay;
   if (age > MAXAGE)
     age = MAXAGE;
-  lsa->header->age = htons (age);
+
+  memcpy (buf, lsa->header, size);
+  header->age = htons (age);
 }
 
 void
 ospf6_lsa_premature_aging (struct ospf6_lsa *lsa)
 {
-  if (lsa->header->age == htons (MAXAGE))
+  if (OSPF6_LSA_IS_MAXAGE (lsa))
     {
       if (IS_OSPF6_DEBUG_LSA_TYPE (lsa->header->type))
 	zlog_debug ("%s: Ignoring MaxAge LSA: %s", __func__, lsa->name);
@@ -280,6 +295,7 @@ ospf6_lsa_premature_aging (struct ospf6_lsa *lsa)
   THREAD_OFF (lsa->expire);
   THREAD_OFF (lsa->refresh);
 
+  ospf6_lsa_unshare (lsa);
   lsa->header->age = htons (MAXAGE);
   thread_execute (master, ospf6_lsa_expire, lsa, 0);
 }
@@ -289,16 +305,35 @@ ospf6_lsa_premature_aging (struct ospf6_lsa *lsa)
 int
 ospf6_lsa_compare (struct ospf6_lsa *a, struct ospf6_lsa *b)
 {
-  int seqnuma, seqnumb;
-  u_int16_t cksuma, cksumb;
-  u_int16_t agea, ageb;
+  u_int16_t agea = 0, ageb = 0;
 
   assert (a && a->header);
   assert (b && b->header);
   assert (OSPF6_LSA_IS_SAME (a, b));
 
-  seqnuma = (int) ntohl (a->header->seqnum);
-  seqnumb = (int) ntohl (b->header->seqnum);
+  /* ages only tell apart instances of the same sequence number and
+     checksum */
+  if (a->header->seqnum == b->header->seqnum &&
+      a->header->checksum == b->header->checksum)
+    {
+      agea = ospf6_lsa_age_current (a);
+      ageb = ospf6_lsa_age_current (b);
+    }
+
+  return ospf6_lsa_compare_instance (a->header, agea, b->header, ageb);
+}
+
+/* the same as ospf6_lsa_compare () for two instances given by their
+   headers and current ages */
+int
+ospf6_lsa_compare_instance (struct ospf6_lsa_header *a, u_int16_t agea,
+                            struct ospf6_lsa_header *b, u_int16_t ageb)
+{
+  int seqnuma, seqnumb;
+  u_int16_t cksuma, cksumb;
+
+  seqnuma = (int) ntohl (a->seqnum);
+  seqnumb = (int) ntohl (b->seqnum);
 
   /* compare by sequence number */
   if (seqnuma > seqnumb)
@@ -307,17 +342,13 @@ ospf6_lsa_compare (struct ospf6_lsa *a, struct ospf6_lsa *b)
     return 1;
 
   /* Checksum */
-  cksuma = ntohs (a->header->checksum);
-  cksumb = ntohs (b->header->checksum);
+  cksuma = ntohs (a->checksum);
+  cksumb = ntohs (b->checksum);
   if (cksuma > cksumb)
     return -1;
   if (cksuma < cksumb)
     return 1;
 
-  /* Update Age */
-  agea = ospf6_lsa_age_current (a);
-  ageb = ospf6_lsa_age_current (b);
-
   /* MaxAge check */
   if (agea == MAXAGE && ageb != MAXAGE)
     return -1;
@@ -361,8 +392,11 @@ ospf6_lsa_header_print_raw (struct ospf6_lsa_header *header)
 void
 ospf6_lsa_header_print (struct ospf6_lsa *lsa)
 {
-  ospf6_lsa_age_current (lsa);
-  ospf6_lsa_header_print_raw (lsa->header);
+  struct ospf6_lsa_header header;
+
+  header = *lsa->header;
+  header.age = htons (ospf6_lsa_age_current (lsa));
+  ospf6_lsa_header_print_raw (&header);
 }
 
 void
@@ -480,33 +514,94 @@ ospf6_lsa_show (struct vty *vty, struct ospf6_lsa *lsa)
   vty_out (vty, "%s", VNL);
 }
 
+/* OSPFv3 LSA contents */
+static struct ospf6_lsa_data *
+ospf6_lsa_data_new (struct ospf6_lsa_header *header, u_int16_t size)
+{
+  struct ospf6_lsa_data *data;
+
+  data = XMALLOC (MTYPE_OSPF6_LSA_DATA, sizeof (struct ospf6_lsa_data) + size);
+  data->refcnt = 0;
+  data->size = size;
+  data->name[0] = '\0';
+
+  /* copy LSA from original header */
+  memcpy (OSPF6_LSA_DATA_HEADER (data), header, size);
+
+  return data;
+}
+
+static void
+ospf6_lsa_data_attach (struct ospf6_lsa *lsa, struct ospf6_lsa_data *data)
+{
+  if (data->refcnt++ > 0)
+    {
+      ospf6_lsa_data_stats.shared++;
+      ospf6_lsa_data_stats.bytes_saved +=
+        sizeof (struct ospf6_lsa_data) + data->size;
+    }
+
+  lsa->data = data;
+  lsa->header = OSPF6_LSA_DATA_HEADER (data);
+  lsa->name = data->name;
+}
+
+static void
+ospf6_lsa_data_detach (struct ospf6_lsa *lsa)
+{
+  struct ospf6_lsa_data *data = lsa->data;
+
+  assert (data->refcnt > 0);
+  if (--data->refcnt > 0)
+    {
+      ospf6_lsa_data_stats.shared--;
+      ospf6_lsa_data_stats.bytes_saved -=
+        sizeof (struct ospf6_lsa_data) + data->size;
+    }
+  else
+    XFREE (MTYPE_OSPF6_LSA_DATA, data);
+
+  lsa->data = NULL;
+  lsa->header = NULL;
+  lsa->name = NULL;
+}
+
+/* give the LSA private contents before modifying them */
+void
+ospf6_lsa_unshare (struct ospf6_lsa *lsa)
+{
+  struct ospf6_lsa_data *data;
+
+  if (lsa->data->refcnt == 1)
+    return;
+
+  data = ospf6_lsa_data_new (lsa->header, lsa->data->size);
+  memcpy (data->name, lsa->data->name, sizeof (data->name));
+
+  ospf6_lsa_data_detach (lsa);
+  ospf6_lsa_data_attach (lsa, data);
+  ospf6_lsa_data_stats.unshared++;
+}
+
 /* OSPFv3 LSA creation/deletion function */
 struct ospf6_lsa *
 ospf6_lsa_create (struct ospf6_lsa_header *header)
 {
   struct ospf6_lsa *lsa = NULL;
-  struct ospf6_lsa_header *new_header = NULL;
   u_int16_t lsa_size = 0;
 
   /* size of the entire LSA */
   lsa_size = ntohs (header->length);   /* XXX vulnerable */
 
-  /* allocate memory for this LSA */
-  new_header = (struct ospf6_lsa_header *)
-    XMALLOC (MTYPE_OSPF6_LSA, lsa_size);
-
-  /* copy LSA from original header */
-  memcpy (new_header, header, lsa_size);
-
   /* LSA information structure */
   /* allocate memory */
   lsa = (struct ospf6_lsa *)
     XCALLOC (MTYPE_OSPF6_LSA, sizeof (struct ospf6_lsa));
 
-  lsa->header = (struct ospf6_lsa_header *) new_header;
+  ospf6_lsa_data_attach (lsa, ospf6_lsa_data_new (header, lsa_size));
 
   /* dump string */
-  ospf6_lsa_printbuf (lsa, lsa->name, sizeof (lsa->name));
+  ospf6_lsa_printbuf (lsa, lsa->data->name, sizeof (lsa->data->name));
 
   /* calculate birth of this lsa */
   ospf6_lsa_age_set (lsa);
@@ -520,25 +615,18 @@ struct ospf6_lsa *
 ospf6_lsa_create_headeronly (struct ospf6_lsa_header *header)
 {
   struct ospf6_lsa *lsa = NULL;
-  struct ospf6_lsa_header *new_header = NULL;
-
-  /* allocate memory for this LSA */
-  new_header = (struct ospf6_lsa_header *)
-    XMALLOC (MTYPE_OSPF6_LSA, sizeof (struct ospf6_lsa_header));
-
-  /* copy LSA from original header */
-  memcpy (new_header, header, sizeof (struct ospf6_lsa_header));
 
   /* LSA information structure */
   /* allocate memory */
   lsa = (struct ospf6_lsa *)
     XCALLOC (MTYPE_OSPF6_LSA, sizeof (struct ospf6_lsa));
 
-  lsa->header = (struct ospf6_lsa_header *) new_header;
+  ospf6_lsa_data_attach (lsa, ospf6_lsa_data_new (header,
+                                                  sizeof (struct ospf6_lsa_header)));
   SET_FLAG (lsa->flag, OSPF6_LSA_HEADERONLY);
 
   /* dump string */
-  ospf6_lsa_printbuf (lsa, lsa->name, sizeof (lsa->name));
+  ospf6_lsa_printbuf (lsa, lsa->data->name, sizeof (lsa->data->name));
 
   /* calculate birth of this lsa */
   ospf6_lsa_age_set (lsa);
@@ -558,21 +646,22 @@ ospf6_lsa_delete (struct ospf6_lsa *lsa)
   ospf6_backupwait_lsa_delete (lsa);
 
   /* do free */
-  XFREE (MTYPE_OSPF6_LSA, lsa->header);
+  ospf6_lsa_data_detach (lsa);
   XFREE (MTYPE_OSPF6_LSA, lsa);
 }
 
+/* copies share the contents of the original LSA; only the per-copy
+   state (lists, timers, flags) is allocated */
 struct ospf6_lsa *
 ospf6_lsa_copy (struct ospf6_lsa *lsa)
 {
   struct ospf6_lsa *copy = NULL;
 
-  ospf6_lsa_age_current (lsa);
+  copy = (struct ospf6_lsa *)
+    XCALLOC (MTYPE_OSPF6_LSA, sizeof (struct ospf6_lsa));
+  ospf6_lsa_data_attach (copy, lsa->data);
   if (CHECK_FLAG (lsa->flag, OSPF6_LSA_HEADERONLY))
-    copy = ospf6_lsa_create_headeronly (lsa->header);
-  else
-    copy = ospf6_lsa_create (lsa->header);
-  assert (copy->lock == 0);
+    SET_FLAG (copy->flag, OSPF6_LSA_HEADERONLY);
 
   copy->birth = lsa->birth;
   copy->originated = lsa->originated;
@@ -670,6 +759,7 @@ ospf6_lsa_refresh (struct thread *thread)
     }
 
   /* Reset age, increment LS sequence number. */
+  ospf6_lsa_unshare (self);
   self->header->age = htons (0);
   self->header->seqnum =
     ospf6_new_ls_seqnum (self->header->type, self->header->id,
@@ -742,9 +832,25 @@ ospf6_lsa_checksum (struct ospf6_lsa_header *lsa_header)
   return (lsa_header->checksum);
 }
 
+static int
+ospf6_lsa_show_memory (struct vty *vty)
+{
+  char buf[MTYPE_MEMSTR_LEN];
+
+  vty_out (vty, "%-30s: %10lu\r\n", "OSPF6 LSA shared copies",
+           ospf6_lsa_data_stats.shared);
+  vty_out (vty, "%-30s: %10s\r\n", "OSPF6 LSA bytes saved",
+           mtype_memstr (buf, sizeof (buf), ospf6_lsa_data_stats.bytes_saved));
+  vty_out (vty, "%-30s: %10lu\r\n", "OSPF6 LSA copy-on-write",
+           ospf6_lsa_data_stats.unshared);
+  return 1;
+}
+
 void
 ospf6_lsa_init (void)
 {
+  memory_show_hook_set (memory_list_ospf6, ospf6_lsa_show_memory);
+
   ospf6_lsa_handler_vector = vector_init (0);
   ospf6_install_lsa_handler (&unknown_handler);
 }
@@ -758,9 +864,9 @@ ospf6_lsa_terminate (void)
 static char *
 ospf6_lsa_handler_name (struct ospf6_lsa_handler *h)
 {
-  static char buf[64];
+  static OSPF6_THREAD_LOCAL char buf[64];
   unsigned int i; 
-  unsigned int size = strlen (h->name);
+  unsigned int size = MIN (strlen (h->name), sizeof (buf) - 1);
 
   if (!strcmp(h->name, "Unknown") &&
       h->type != OSPF6_LSTYPE_UNKNOWN)
@@ -769,7 +875,7 @@ ospf6_lsa_handler_name (struct ospf6_lsa_handler *h)
       return buf;
     }
 
-  for (i = 0; i < MIN (size, sizeof (buf)); i++)
+  for (i = 0; i < size; i++)
     {
       if (! islower (h->name[i]))
         buf[i] = tolower (h->name[i]);
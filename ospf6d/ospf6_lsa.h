@@ -111,9 +111,21 @@ struct ospf6_lsa_header
 #define OSPF6_LSA_IS_MAXAGE(L) (ospf6_lsa_age_current (L) == MAXAGE)
 #define OSPF6_LSA_IS_CHANGED(L1, L2) ospf6_lsa_is_changed (L1, L2)
 
+/* LSA contents, shared (read-only) by all copies of an LSA instance.
+   The LSA itself (header and body) immediately follows this structure. */
+struct ospf6_lsa_data
+{
+  unsigned int      refcnt;         /* number of struct ospf6_lsa using it */
+  u_int16_t         size;           /* bytes of LSA stored */
+  char              name[64];       /* dump string */
+};
+
+#define OSPF6_LSA_DATA_HEADER(d) \
+  ((struct ospf6_lsa_header *) ((struct ospf6_lsa_data *) (d) + 1))
+
 struct ospf6_lsa
 {
-  char              name[64];   /* dump string */
+  char             *name;           /* dump string (in shared data) */
 
   struct ospf6_lsa *prev;
   struct ospf6_lsa *next;
@@ -134,6 +146,7 @@ struct ospf6_lsa
   struct ospf6_lsdb *lsdb;
 
   /* lsa instance */
+  struct ospf6_lsa_data   *data;
   struct ospf6_lsa_header *header;
 
   struct timeval rxmt_time;     /* start of rxmt interval */
@@ -231,9 +244,12 @@ extern u_char ospf6_lstype_debug (u_int16_t type);
 extern int ospf6_lsa_is_differ (struct ospf6_lsa *lsa1, struct ospf6_lsa *lsa2);
 extern int ospf6_lsa_is_changed (struct ospf6_lsa *lsa1, struct ospf6_lsa *lsa2);
 extern u_int16_t ospf6_lsa_age_current (struct ospf6_lsa *);
-extern void ospf6_lsa_age_update_to_send (struct ospf6_lsa *, u_int32_t);
+extern void ospf6_lsa_copy_to_send (struct ospf6_lsa *, void *, size_t,
+                                    u_int32_t);
 extern void ospf6_lsa_premature_aging (struct ospf6_lsa *);
 extern int ospf6_lsa_compare (struct ospf6_lsa *, struct ospf6_lsa *);
+extern int ospf6_lsa_compare_instance (struct ospf6_lsa_header *, u_int16_t,
+                                       struct ospf6_lsa_header *, u_int16_t);
 
 extern char *ospf6_lsa_printbuf (struct ospf6_lsa *lsa, char *buf, int size);
 extern void ospf6_lsa_header_print_raw (struct ospf6_lsa_header *header);
@@ -248,6 +264,7 @@ extern struct ospf6_lsa *ospf6_lsa_create (struct ospf6_lsa_header *header);
 extern struct ospf6_lsa *ospf6_lsa_create_headeronly (struct ospf6_lsa_header *header);
 extern void ospf6_lsa_delete (struct ospf6_lsa *lsa);
 extern struct ospf6_lsa *ospf6_lsa_copy (struct ospf6_lsa *);
+extern void ospf6_lsa_unshare (struct ospf6_lsa *);
 
 extern void ospf6_lsa_lock (struct ospf6_lsa *);
 extern void ospf6_lsa_unlock (struct ospf6_lsa *);
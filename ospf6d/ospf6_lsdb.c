@@ -92,6 +92,21 @@ _lsdb_count_assert (struct ospf6_lsdb *lsdb)
 #define ospf6_lsdb_count_assert(t) ((void) 0)
 #endif /*NDEBUG*/
 
+/* Compare LSAs in the order LSDBs are walked: by type, advertising
+   router and link state ID. */
+int
+ospf6_lsdb_key_cmp (struct ospf6_lsa *a, struct ospf6_lsa *b)
+{
+  if (a->header->type != b->header->type)
+    return (ntohs (a->header->type) < ntohs (b->header->type) ? -1 : 1);
+  if (a->header->adv_router != b->header->adv_router)
+    return (ntohl (a->header->adv_router) < ntohl (b->header->adv_router) ?
+            -1 : 1);
+  if (a->header->id != b->header->id)
+    return (ntohl (a->header->id) < ntohl (b->header->id) ? -1 : 1);
+  return 0;
+}
+
 void
 ospf6_lsdb_add (struct ospf6_lsa *lsa, struct ospf6_lsdb *lsdb)
 {
@@ -109,6 +124,7 @@ ospf6_lsdb_add (struct ospf6_lsa *lsa, struct ospf6_lsdb *lsdb)
   old = current->info;
   current->info = lsa;
   ospf6_lsa_lock (lsa);
+  lsdb->version++;
 
   if (old)
     {
@@ -118,6 +134,20 @@ ospf6_lsdb_add (struct ospf6_lsa *lsa, struct ospf6_lsdb *lsdb)
         old->next->prev = lsa;
       lsa->next = old->next;
       lsa->prev = old->prev;
+      if (lsdb->tail == old)
+        lsdb->tail = lsa;
+    }
+  else if (lsdb->tail == NULL || ospf6_lsdb_key_cmp (lsa, lsdb->tail) > 0)
+    {
+      /* LSAs added in key order (e.g. from a Database Description
+         packet) are appended without searching the table */
+      lsa->next = NULL;
+      lsa->prev = lsdb->tail;
+      if (lsdb->tail)
+        lsdb->tail->next = lsa;
+      lsdb->tail = lsa;
+
+      lsdb->count++;
     }
   else
     {
@@ -221,9 +251,12 @@ ospf6_lsdb_remove (struct ospf6_lsa *lsa, struct ospf6_lsdb *lsdb)
     lsa->prev->next = lsa->next;
   if (lsa->next)
     lsa->next->prev = lsa->prev;
+  if (lsdb->tail == lsa)
+    lsdb->tail = lsa->prev;
 
   node->info = NULL;
   lsdb->count--;
+  lsdb->version++;
 
   if (lsdb->hook_remove)
     (*lsdb->hook_remove) (lsa);
@@ -260,7 +293,6 @@ ospf6_lsdb_lookup_next (u_int16_t type, u_int32_t id, u_int32_t adv_router,
                         struct ospf6_lsdb *lsdb)
 {
   struct route_node *node;
-  struct route_node *matched = NULL;
   struct prefix_ipv6 key;
   struct prefix *p;
 
@@ -279,20 +311,8 @@ ospf6_lsdb_lookup_next (u_int16_t type, u_int32_t id, u_int32_t adv_router,
     zlog_debug ("lsdb_lookup_next: key: %s", buf);
   }
 
-  node = lsdb->table->top;
-  /* walk down tree. */
-  while (node && node->p.prefixlen <= p->prefixlen &&
-         prefix_match (&node->p, p))
-    {
-      matched = node;
-      node = node->link[prefix_bit(&p->u.prefix, node->p.prefixlen)];
-    }
-
-  if (matched)
-    node = matched;
-  else
-    node = lsdb->table->top;
-  route_lock_node (node);
+  /* a node created here is deleted again by route_next() */
+  node = route_node_get (lsdb->table, p);
 
   /* skip to real existing entry */
   while (node && node->info == NULL)
@@ -327,6 +347,32 @@ ospf6_lsdb_lookup_next (u_int16_t type, u_int32_t id, u_int32_t adv_router,
   return (struct ospf6_lsa *) node->info;
 }
 
+/* Resume an iteration: the first LSA in the lsdb whose key is not
+   less than that of the given LSA, which need not be in the lsdb. */
+struct ospf6_lsa *
+ospf6_lsdb_seek (struct ospf6_lsa *lsa, struct ospf6_lsdb *lsdb)
+{
+  struct route_node *node;
+  struct prefix_ipv6 key;
+
+  memset (&key, 0, sizeof (key));
+  ospf6_lsdb_set_key (&key, &lsa->header->type, sizeof (lsa->header->type));
+  ospf6_lsdb_set_key (&key, &lsa->header->adv_router,
+                      sizeof (lsa->header->adv_router));
+  ospf6_lsdb_set_key (&key, &lsa->header->id, sizeof (lsa->header->id));
+
+  /* a node created here is deleted again by route_next() */
+  node = route_node_get (lsdb->table, (struct prefix *) &key);
+  while (node && node->info == NULL)
+    node = route_next (node);
+  if (node == NULL)
+    return NULL;
+
+  route_unlock_node (node);
+  ospf6_lsa_lock ((struct ospf6_lsa *) node->info);
+  return (struct ospf6_lsa *) node->info;
+}
+
 /* Iteration function */
 struct ospf6_lsa *
 ospf6_lsdb_head (struct ospf6_lsdb *lsdb)
@@ -373,15 +419,7 @@ ospf6_lsdb_type_router_head (u_int16_t type, u_int32_t adv_router,
   ospf6_lsdb_set_key (&key, &type, sizeof (type));
   ospf6_lsdb_set_key (&key, &adv_router, sizeof (adv_router));
 
-  node = lsdb->table->top;
-
-  /* Walk down tree. */
-  while (node && node->p.prefixlen <= key.prefixlen &&
-	 prefix_match (&node->p, (struct prefix *) &key))
-    node = node->link[prefix6_bit(&key.prefix, node->p.prefixlen)];
-
-  if (node)
-    route_lock_node (node);
+  node = route_subtree_top (lsdb->table, (struct prefix *) &key);
   while (node && node->info == NULL)
     node = route_next (node);
 
@@ -428,14 +466,7 @@ ospf6_lsdb_type_head (u_int16_t type, struct ospf6_lsdb *lsdb)
   memset (&key, 0, sizeof (key));
   ospf6_lsdb_set_key (&key, &type, sizeof (type));
 
-  /* Walk down tree. */
-  node = lsdb->table->top;
-  while (node && node->p.prefixlen <= key.prefixlen &&
-	 prefix_match (&node->p, (struct prefix *) &key))
-    node = node->link[prefix6_bit(&key.prefix, node->p.prefixlen)];
-
-  if (node)
-    route_lock_node (node);
+  node = route_subtree_top (lsdb->table, (struct prefix *) &key);
   while (node && node->info == NULL)
     node = route_next (node);
 
@@ -478,22 +509,29 @@ ospf6_lsdb_remove_all (struct ospf6_lsdb *lsdb)
     ospf6_lsdb_remove (lsa, lsdb);
 }
 
+typedef void (*ospf6_lsdb_showfunc_t) (struct vty *, struct ospf6_lsa *);
+
+static ospf6_lsdb_showfunc_t
+ospf6_lsdb_showfunc (int level)
+{
+  if (level == OSPF6_LSDB_SHOW_LEVEL_DETAIL)
+    return ospf6_lsa_show;
+  else if (level == OSPF6_LSDB_SHOW_LEVEL_INTERNAL)
+    return ospf6_lsa_show_internal;
+  else if (level == OSPF6_LSDB_SHOW_LEVEL_DUMP)
+    return ospf6_lsa_show_dump;
+  return ospf6_lsa_show_summary;
+}
+
 void
 ospf6_lsdb_show (struct vty *vty, int level,
                  u_int16_t *type, u_int32_t *id, u_int32_t *adv_router,
                  struct ospf6_lsdb *lsdb)
 {
   struct ospf6_lsa *lsa;
-  void (*showfunc) (struct vty *, struct ospf6_lsa *) = NULL;
+  ospf6_lsdb_showfunc_t showfunc;
 
-  if (level == OSPF6_LSDB_SHOW_LEVEL_NORMAL)
-    showfunc = ospf6_lsa_show_summary;
-  else if (level == OSPF6_LSDB_SHOW_LEVEL_DETAIL)
-    showfunc = ospf6_lsa_show;
-  else if (level == OSPF6_LSDB_SHOW_LEVEL_INTERNAL)
-    showfunc = ospf6_lsa_show_internal;
-  else if (level == OSPF6_LSDB_SHOW_LEVEL_DUMP)
-    showfunc = ospf6_lsa_show_dump;
+  showfunc = ospf6_lsdb_showfunc (level);
 
   if (type && id && adv_router)
     {
@@ -532,6 +570,42 @@ ospf6_lsdb_show (struct vty *vty, int level,
     }
 }
 
+/* Show the whole lsdb as ospf6_lsdb_show() does, but only until the
+   vty has a chunk of output.  FROM is the LSA returned by the previous
+   call, or NULL to start at the head.  Returns the LSA, locked, to
+   carry on from, or NULL once all is shown. */
+struct ospf6_lsa *
+ospf6_lsdb_show_chunk (struct vty *vty, int level, struct ospf6_lsa *from,
+                       struct ospf6_lsdb *lsdb)
+{
+  struct ospf6_lsa *lsa;
+  ospf6_lsdb_showfunc_t showfunc;
+
+  showfunc = ospf6_lsdb_showfunc (level);
+
+  if (from == NULL)
+    {
+      if (level == OSPF6_LSDB_SHOW_LEVEL_NORMAL)
+        ospf6_lsa_show_summary_header (vty);
+      lsa = ospf6_lsdb_head (lsdb);
+    }
+  else
+    {
+      /* it may have gone from the lsdb meanwhile */
+      lsa = ospf6_lsdb_seek (from, lsdb);
+      ospf6_lsa_unlock (from);
+    }
+
+  while (lsa)
+    {
+      if (vty_output_full (vty))
+        return lsa;
+      (*showfunc) (vty, lsa);
+      lsa = ospf6_lsdb_next (lsa);
+    }
+  return NULL;
+}
+
 /* Decide new LS sequence number to originate.
    note return value is network byte order */
 u_int32_t
@@ -32,6 +32,9 @@ struct ospf6_lsdb
   void *data; /* data structure that holds this lsdb */
   struct route_table *table;
   u_int32_t count;
+  struct ospf6_lsa *tail;       /* last LSA in key order */
+  u_int32_t version;            /* changed whenever an LSA is added or
+                                   removed */
   void (*hook_add) (struct ospf6_lsa *);
   void (*hook_remove) (struct ospf6_lsa *);
   void (*hook_replace) (struct ospf6_lsa *, struct ospf6_lsa *);
@@ -70,6 +73,10 @@ extern struct ospf6_lsa *ospf6_lsdb_lookup_next (u_int16_t type, u_int32_t id,
                                                  u_int32_t adv_router,
                                                  struct ospf6_lsdb *lsdb);
 
+extern int ospf6_lsdb_key_cmp (struct ospf6_lsa *a, struct ospf6_lsa *b);
+extern struct ospf6_lsa *ospf6_lsdb_seek (struct ospf6_lsa *lsa,
+                                          struct ospf6_lsdb *lsdb);
+
 extern void ospf6_lsdb_add (struct ospf6_lsa *lsa, struct ospf6_lsdb *lsdb);
 extern void ospf6_lsdb_remove (struct ospf6_lsa *lsa, struct ospf6_lsdb *lsdb);
 
@@ -98,6 +105,9 @@ extern void ospf6_lsdb_remove_all (struct ospf6_lsdb *lsdb);
 extern void ospf6_lsdb_show (struct vty *vty, int level, u_int16_t *type,
                              u_int32_t *id, u_int32_t *adv_router,
                              struct ospf6_lsdb *lsdb);
+extern struct ospf6_lsa *ospf6_lsdb_show_chunk (struct vty *vty, int level,
+                                                struct ospf6_lsa *from,
+                                                struct ospf6_lsdb *lsdb);
 
 extern u_int32_t ospf6_new_ls_seqnum (u_int16_t type, u_int32_t id,
                                       u_int32_t adv_router,
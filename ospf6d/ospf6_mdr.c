@@ -161,6 +161,7 @@ ospf6_calculate_mdr (struct ospf6_interface *oi)
         return;
     }
 
+  oi->mdr_calculations++;
   tree = list_new ();
 
   // ######## PHASE 1 #########
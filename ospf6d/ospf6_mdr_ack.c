@@ -0,0 +1,288 @@
+/* -*-  c-file-style: "gnu" -*- */
+
+/*
+ * This file is part of GNU Zebra.
+ *
+ * GNU Zebra is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * GNU Zebra is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Zebra; see the file COPYING.  If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "zebra.h"
+
+#include "memory.h"
+#include "hash.h"
+#include "jhash.h"
+#include "thread.h"
+#include "command.h"
+
+#include "ospf6d.h"
+#include "ospf6_proto.h"
+#include "ospf6_lsa.h"
+#include "ospf6_interface.h"
+#include "ospf6_mdr_ack.h"
+
+#define OSPF6_MDR_ACK_CACHE_MINSIZE 64
+
+#define ACK_SLOT(cache, i) \
+  (&(cache)->ring[((cache)->head + (i)) & ((cache)->size - 1)])
+
+static unsigned int
+ospf6_mdr_ack_hash_key (void *data)
+{
+  struct ospf6_mdr_ack *ack = data;
+
+  return jhash_3words (ack->header.id, ack->header.adv_router,
+                       ack->router_id, ack->header.type);
+}
+
+static int
+ospf6_mdr_ack_hash_cmp (const void *a, const void *b)
+{
+  const struct ospf6_mdr_ack *acka = a, *ackb = b;
+
+  return (acka->router_id == ackb->router_id &&
+          acka->header.type == ackb->header.type &&
+          acka->header.id == ackb->header.id &&
+          acka->header.adv_router == ackb->header.adv_router);
+}
+
+void
+ospf6_mdr_ack_cache_create (struct ospf6_interface *oi)
+{
+  struct ospf6_mdr_ack_cache *cache;
+
+  cache = XCALLOC (MTYPE_OSPF6_MDR_ACK, sizeof (struct ospf6_mdr_ack_cache));
+  cache->size = OSPF6_MDR_ACK_CACHE_MINSIZE;
+  cache->ring = XCALLOC (MTYPE_OSPF6_MDR_ACK,
+                         cache->size * sizeof (struct ospf6_mdr_ack));
+  cache->index = hash_create (ospf6_mdr_ack_hash_key,
+                              ospf6_mdr_ack_hash_cmp);
+
+  oi->mdr.ack_cache = cache;
+}
+
+void
+ospf6_mdr_ack_cache_delete (struct ospf6_interface *oi)
+{
+  struct ospf6_mdr_ack_cache *cache = oi->mdr.ack_cache;
+
+  if (cache == NULL)
+    return;
+
+  THREAD_OFF (cache->thread_expire);
+  hash_clean (cache->index, NULL);
+  hash_free (cache->index);
+  XFREE (MTYPE_OSPF6_MDR_ACK, cache->ring);
+  XFREE (MTYPE_OSPF6_MDR_ACK, cache);
+
+  oi->mdr.ack_cache = NULL;
+}
+
+/* Copy the records still current, oldest first, into a ring big
+   enough for as many again */
+static void
+ospf6_mdr_ack_cache_resize (struct ospf6_mdr_ack_cache *cache)
+{
+  struct ospf6_mdr_ack *ring, *ack;
+  u_int32_t size, count, i;
+
+  size = OSPF6_MDR_ACK_CACHE_MINSIZE;
+  while (size < 2 * cache->index->count + 1)
+    size <<= 1;
+
+  ring = XCALLOC (MTYPE_OSPF6_MDR_ACK, size * sizeof (struct ospf6_mdr_ack));
+  hash_clean (cache->index, NULL);
+
+  for (i = 0, count = 0; i < cache->count; i++)
+    {
+      ack = ACK_SLOT (cache, i);
+      if (CHECK_FLAG (ack->flags, OSPF6_MDR_ACK_STALE))
+        continue;
+      ring[count] = *ack;
+      hash_get (cache->index, &ring[count], hash_alloc_intern);
+      count++;
+    }
+
+  XFREE (MTYPE_OSPF6_MDR_ACK, cache->ring);
+  cache->ring = ring;
+  cache->size = size;
+  cache->head = 0;
+  cache->count = count;
+}
+
+static u_int16_t
+ospf6_mdr_ack_age (struct ospf6_mdr_ack *ack, time_t now)
+{
+  u_int32_t age = ntohs (ack->header.age);
+
+  if (age < MAXAGE)
+    age += now - ack->received;
+  return age > MAXAGE ? MAXAGE : age;
+}
+
+static int
+ospf6_mdr_ack_expire (struct thread *thread)
+{
+  struct ospf6_interface *oi = THREAD_ARG (thread);
+  struct ospf6_mdr_ack_cache *cache = oi->mdr.ack_cache;
+  struct ospf6_mdr_ack *ack;
+  struct timeval now;
+  time_t timeout = oi->mdr.ack_cache_timeout;
+
+  cache->thread_expire = NULL;
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &now);
+
+  /* records are in the order received */
+  while (cache->count > 0)
+    {
+      ack = ACK_SLOT (cache, 0);
+      if (! CHECK_FLAG (ack->flags, OSPF6_MDR_ACK_STALE))
+        {
+          if (now.tv_sec - ack->received <= timeout)
+            break;
+          hash_release (cache->index, ack);
+          cache->expired_acks++;
+        }
+      cache->head = (cache->head + 1) & (cache->size - 1);
+      cache->count--;
+    }
+
+  if (cache->count > 0)
+    cache->thread_expire =
+      thread_add_timer (master, ospf6_mdr_ack_expire, oi,
+                        ACK_SLOT (cache, 0)->received + timeout + 1 -
+                        now.tv_sec);
+  else
+    cache->head = 0;
+
+  return 0;
+}
+
+// Section 3.4.3 bullet 2
+void
+ospf6_mdr_ack_store (struct ospf6_interface *oi, u_int32_t router_id,
+                     struct ospf6_lsa *lsa, u_char kind)
+{
+  struct ospf6_mdr_ack_cache *cache = oi->mdr.ack_cache;
+  struct ospf6_mdr_ack key, *ack;
+  struct timeval now;
+  int cmp;
+
+  if (kind == OSPF6_MDR_ACK_EXPLICIT)
+    cache->explicit_acks++;
+  else
+    cache->implicit_acks++;
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &now);
+
+  key.router_id = router_id;
+  key.header = *lsa->header;
+  ack = hash_lookup (cache->index, &key);
+  if (ack)
+    {
+      cmp = ospf6_lsa_compare_instance (lsa->header,
+                                        ospf6_lsa_age_current (lsa),
+                                        &ack->header,
+                                        ospf6_mdr_ack_age (ack, now.tv_sec));
+      if (cmp > 0)
+        return;                 /* an ack for an older instance */
+      if (cmp == 0)
+        {
+          /* the same instance acknowledged both ways */
+          if (! CHECK_FLAG (ack->flags, kind))
+            {
+              SET_FLAG (ack->flags, kind);
+              cache->merged_acks++;
+            }
+          return;
+        }
+
+      /* this ack is for a more recent instance */
+      hash_release (cache->index, ack);
+      SET_FLAG (ack->flags, OSPF6_MDR_ACK_STALE);
+    }
+
+  if (cache->count == cache->size)
+    ospf6_mdr_ack_cache_resize (cache);
+
+  ack = ACK_SLOT (cache, cache->count);
+  cache->count++;
+  ack->router_id = router_id;
+  ack->header = *lsa->header;
+  ack->received = now.tv_sec;
+  ack->flags = kind;
+  hash_get (cache->index, ack, hash_alloc_intern);
+
+  if (cache->thread_expire == NULL)
+    cache->thread_expire =
+      thread_add_timer (master, ospf6_mdr_ack_expire, oi,
+                        oi->mdr.ack_cache_timeout + 1);
+}
+
+/* whether the neighbor has acknowledged this instance of lsa (or a
+   more recent one) */
+bool
+ospf6_mdr_ack_lookup (struct ospf6_interface *oi, u_int32_t router_id,
+                      struct ospf6_lsa *lsa)
+{
+  struct ospf6_mdr_ack_cache *cache = oi->mdr.ack_cache;
+  struct ospf6_mdr_ack key, *ack;
+  struct timeval now;
+
+  key.router_id = router_id;
+  key.header = *lsa->header;
+  ack = hash_lookup (cache->index, &key);
+  if (ack == NULL)
+    return false;
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &now);
+  return ospf6_lsa_compare_instance (&ack->header,
+                                     ospf6_mdr_ack_age (ack, now.tv_sec),
+                                     lsa->header,
+                                     ospf6_lsa_age_current (lsa)) <= 0;
+}
+
+/* The neighbor is gone: its acks are no longer of use */
+void
+ospf6_mdr_ack_forget (struct ospf6_interface *oi, u_int32_t router_id)
+{
+  struct ospf6_mdr_ack_cache *cache = oi->mdr.ack_cache;
+  struct ospf6_mdr_ack *ack;
+  u_int32_t i;
+
+  for (i = 0; i < cache->count; i++)
+    {
+      ack = ACK_SLOT (cache, i);
+      if (ack->router_id != router_id ||
+          CHECK_FLAG (ack->flags, OSPF6_MDR_ACK_STALE))
+        continue;
+      hash_release (cache->index, ack);
+      SET_FLAG (ack->flags, OSPF6_MDR_ACK_STALE);
+    }
+}
+
+void
+ospf6_mdr_ack_show (struct vty *vty, struct ospf6_interface *oi)
+{
+  struct ospf6_mdr_ack_cache *cache = oi->mdr.ack_cache;
+
+  vty_out (vty, "    Ack cache: %lu acks (%u records of %u), "
+           "timeout %d sec%s", cache->index->count, cache->count,
+           cache->size, oi->mdr.ack_cache_timeout, VNL);
+  vty_out (vty, "      Received %u explicit, %u implicit, "
+           "%u merged, %u expired%s", cache->explicit_acks,
+           cache->implicit_acks, cache->merged_acks, cache->expired_acks,
+           VNL);
+}
@@ -0,0 +1,80 @@
+/* -*-  c-file-style: "gnu" -*- */
+
+/*
+ * This file is part of GNU Zebra.
+ *
+ * GNU Zebra is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * GNU Zebra is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Zebra; see the file COPYING.  If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef OSPF6_MDR_ACK_H
+#define OSPF6_MDR_ACK_H
+
+#include <stdbool.h>
+
+/* Acknowledgements received from MDR neighbors (RFC 5614, Section
+   3.4.3): an LSA is not retransmitted to a neighbor that has already
+   acknowledged it, explicitly in an LSAck or implicitly by sending
+   the LSA itself.  Both kinds are kept as one record per neighbor and
+   LSA instance in a per-interface ring, oldest first, so that they
+   expire from the head. */
+#define OSPF6_MDR_ACK_EXPLICIT  0x01
+#define OSPF6_MDR_ACK_IMPLICIT  0x02
+#define OSPF6_MDR_ACK_STALE     0x04  /* superseded or neighbor gone */
+
+struct ospf6_mdr_ack
+{
+  u_int32_t router_id;          /* acknowledging neighbor */
+  struct ospf6_lsa_header header;
+  time_t received;
+  u_char flags;
+};
+
+struct ospf6_mdr_ack_cache
+{
+  struct ospf6_mdr_ack *ring;
+  u_int32_t size;               /* a power of two */
+  u_int32_t head;
+  u_int32_t count;              /* stale records included */
+
+  /* current record of each neighbor and LSA */
+  struct hash *index;
+
+  struct thread *thread_expire;
+
+  /* statistics */
+  u_int32_t explicit_acks;
+  u_int32_t implicit_acks;
+  u_int32_t merged_acks;
+  u_int32_t expired_acks;
+};
+
+struct ospf6_interface;
+struct ospf6_lsa;
+struct vty;
+
+extern void ospf6_mdr_ack_cache_create (struct ospf6_interface *oi);
+extern void ospf6_mdr_ack_cache_delete (struct ospf6_interface *oi);
+extern void ospf6_mdr_ack_store (struct ospf6_interface *oi,
+                                 u_int32_t router_id,
+                                 struct ospf6_lsa *lsa, u_char kind);
+extern bool ospf6_mdr_ack_lookup (struct ospf6_interface *oi,
+                                  u_int32_t router_id,
+                                  struct ospf6_lsa *lsa);
+extern void ospf6_mdr_ack_forget (struct ospf6_interface *oi,
+                                  u_int32_t router_id);
+extern void ospf6_mdr_ack_show (struct vty *vty, struct ospf6_interface *oi);
+
+#endif /* OSPF6_MDR_ACK_H */
@@ -112,6 +112,7 @@ ospf6_flood_interface_mdr (struct ospf6_neighbor *from,
                   if (is_debug)
                     zlog_debug
                       ("Requesting the same, remove it, next neighbor");
+                  ospf6_lsreq_answered (on, req, lsa);
                   ospf6_lsdb_remove (req, on->request_list);
                   continue;
                 }
@@ -121,6 +122,7 @@ ospf6_flood_interface_mdr (struct ospf6_neighbor *from,
                 {
                   if (is_debug)
                     zlog_debug ("Received is newer, remove requesting");
+                  ospf6_lsreq_answered (on, req, lsa);
                   ospf6_lsdb_remove (req, on->request_list);
                   /* fall through */
                 }
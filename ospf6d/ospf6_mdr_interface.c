@@ -34,6 +34,7 @@
 #include "ospf6_lsdb.h"
 #include "ospf6_flood.h"
 #include "ospf6_mdr_interface.h"
+#include "ospf6_mdr_ack.h"
 
 void
 ospf6_mdr_interface_create (struct ospf6_interface *oi)
@@ -56,6 +57,8 @@ ospf6_mdr_interface_create (struct ospf6_interface *oi)
   oi->mdr.full_hello_count = 0;
 
   oi->mdr.update_routable_neighbors_immediately = false;
+
+  ospf6_mdr_ack_cache_create (oi);
 }
 
 /* set default values for MDR interfaces from RFC 5614, Section 3.2 */
@@ -86,6 +89,8 @@ ospf6_mdr_interface_delete (struct ospf6_interface *oi)
   struct ospf6_lnl_element *lnl_element;
   struct listnode *node, *nnode;
 
+  ospf6_mdr_ack_cache_delete (oi);
+
   if (!oi->mdr.lnl)
     return;
 
@@ -162,6 +167,12 @@ ospf6_mdr_interface_show (struct vty *vty, struct ospf6_interface *oi)
 	}
     }
   vty_out (vty, "%s", VTY_NEWLINE);
+
+  ospf6_mdr_ack_show (vty, oi);
+  vty_out (vty, "    Sent %u LSAck packets, %u acks (%u per packet)%s",
+	   oi->mdr.lsack_packets, oi->mdr.lsack_acks,
+	   oi->mdr.lsack_packets ?
+	   oi->mdr.lsack_acks / oi->mdr.lsack_packets : 0, VTY_NEWLINE);
 }
 
 DEFUN (ipv6_ospf6_ackinterval,
@@ -587,7 +598,7 @@ ospf6_update_adjacencies (struct ospf6_interface *oi)
         {
           ospf6_neighbor_state_change (OSPF6_NEIGHBOR_TWOWAY, on);
           // Clear retrans_list
-          ospf6_lsdb_remove_all (on->summary_list);
+          ospf6_summary_clear (on);
           ospf6_lsdb_remove_all (on->request_list);
           for (lsa = ospf6_lsdb_head (on->retrans_list); lsa;
                lsa = ospf6_lsdb_next (lsa))
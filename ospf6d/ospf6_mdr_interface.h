@@ -57,6 +57,10 @@ struct ospf6_mdr_interface
 {
   long ackInterval;
   int ack_cache_timeout;
+  struct ospf6_mdr_ack_cache *ack_cache;
+  /* LSAck packets sent on the interface and the acks in them */
+  u_int32_t lsack_packets;
+  u_int32_t lsack_acks;
   bool nonflooding_mdr;
   long BackupWaitInterval;
   int **cost_matrix;
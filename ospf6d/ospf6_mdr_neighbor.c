@@ -35,6 +35,7 @@
 #include "ospf6_lsdb.h"
 #include "ospf6_mdr.h"
 #include "ospf6_mdr_neighbor.h"
+#include "ospf6_mdr_ack.h"
 
 static struct ospf6_lnl_element *
 ospf6_mdr_lookup_lnl_element (struct ospf6_neighbor *on)
@@ -69,8 +70,6 @@ ospf6_mdr_neighbor_create (struct ospf6_neighbor *on)
   on->mdr.sel_adv = false;
   on->mdr.list_type = 0;
   on->mdr.consec_hellos = 0;
-
-  on->mdr.ack_list = ospf6_lsdb_create (on);
 }
 
 static void
@@ -117,9 +116,8 @@ ospf6_mdr_neighbor_delete (struct ospf6_neighbor *on)
   ospf6_mdr_delete_neighbor_list (on->mdr.dnl);
   ospf6_mdr_delete_neighbor_list (on->mdr.sanl);
 
-  THREAD_OFF (on->mdr.thread_ack_list_expire);
-  ospf6_lsdb_remove_all (on->mdr.ack_list);
-  ospf6_lsdb_delete (on->mdr.ack_list);
+  if (on->ospf6_if->mdr.ack_cache)
+    ospf6_mdr_ack_forget (on->ospf6_if, on->router_id);
 }
 
 void
@@ -337,90 +335,22 @@ ospf6_mdr_neighbor_init (void)
   install_element (VIEW_NODE, &show_ipv6_ospf6_neighbor_mdr_cmd);
 }
 
-static struct ospf6_lsa *
-ospf6_mdr_neighbor_lookup_ack (struct ospf6_neighbor *on,
-			       struct ospf6_lsa *lsa)
-{
-  return ospf6_lsdb_lookup (lsa->header->type, lsa->header->id,
-			    lsa->header->adv_router, on->mdr.ack_list);
-}
-
-static int
-ospf6_mdr_neighbor_ack_list_expire (struct thread *thread)
-{
-  struct ospf6_neighbor *on;
-  struct timeval now;
-  int ack_cache_timeout;
-  struct ospf6_lsa *ack;
-  unsigned int remaining;
-
-  on = THREAD_ARG (thread);
-  on->mdr.thread_ack_list_expire = NULL;
-
-  quagga_gettime (QUAGGA_CLK_MONOTONIC, &now);
-  ack_cache_timeout = on->ospf6_if->mdr.ack_cache_timeout;
-  remaining = 0;
-
-  for (ack = ospf6_lsdb_head (on->mdr.ack_list); ack != NULL;
-       ack = ospf6_lsdb_next (ack))
-    {
-      if (timersub_sec (&now, &ack->received) > ack_cache_timeout)
-	{
-	  assert (ack->lock == 2);
-	  ospf6_lsdb_remove (ack, on->mdr.ack_list);
-	}
-      else
-	{
-	  remaining++;
-	}
-  }
-
-  if (remaining > 0)
-    on->mdr.thread_ack_list_expire =
-      thread_add_timer (master, ospf6_mdr_neighbor_ack_list_expire,
-			on, ack_cache_timeout);
-
-  return 0;
-}
-
 // Section 3.4.3 bullet 2
 void
 ospf6_mdr_neighbor_store_ack (struct ospf6_neighbor *on,
-			      struct ospf6_lsa *lsa)
+			      struct ospf6_lsa *lsa, u_char kind)
 {
-  struct ospf6_lsa *ack;
-
   assert (on->ospf6_if->type == OSPF6_IFTYPE_MDR);
 
-  ack = ospf6_mdr_neighbor_lookup_ack (on, lsa);
-  if (ack == NULL || ospf6_lsa_compare (lsa, ack) < 0)
-    {
-      /* no existing ack or this ack is for a more recent lsa */
-      ack = ospf6_lsa_create_headeronly (lsa->header);
-      quagga_gettime (QUAGGA_CLK_MONOTONIC, &ack->received);
-
-      ospf6_lsdb_add (ack, on->mdr.ack_list);
-
-      if (on->mdr.thread_ack_list_expire == NULL)
-	on->mdr.thread_ack_list_expire =
-	  thread_add_timer (master, ospf6_mdr_neighbor_ack_list_expire,
-			    on, on->ospf6_if->mdr.ack_cache_timeout);
-    }
+  ospf6_mdr_ack_store (on->ospf6_if, on->router_id, lsa, kind);
 }
 
 bool
 ospf6_mdr_neighbor_has_acked (struct ospf6_neighbor *on, struct ospf6_lsa *lsa)
 {
-  struct ospf6_lsa *ack;
-
   assert (on->ospf6_if->type == OSPF6_IFTYPE_MDR);
 
-  ack = ospf6_mdr_neighbor_lookup_ack (on, lsa);
-
-  if (ack != NULL && ospf6_lsa_compare (ack, lsa) <= 0)
-    return true;
-
-  return false;
+  return ospf6_mdr_ack_lookup (on->ospf6_if, on->router_id, lsa);
 }
 
 void
@@ -32,9 +32,6 @@
 
 struct ospf6_mdr_neighbor
 {
-  struct ospf6_lsdb *ack_list;
-  struct thread *thread_ack_list_expire;
-
   bool routable;
   bool dependent;
   bool dependent_selector;
@@ -92,7 +89,7 @@ extern bool ospf6_mdr_delete_neighbor (struct list *, u_int32_t);
 extern void ospf6_mdr_add_neighbor (struct list *, u_int32_t);
 extern void ospf6_mdr_delete_all_neighbors (struct list *);
 extern void ospf6_mdr_neighbor_store_ack (struct ospf6_neighbor *on,
-					  struct ospf6_lsa *lsa);
+					  struct ospf6_lsa *lsa, u_char kind);
 extern bool ospf6_mdr_neighbor_has_acked (struct ospf6_neighbor *on,
 					  struct ospf6_lsa *lsa);
 
@@ -50,6 +50,7 @@
 #include "ospf6_lls.h"
 #include "ospf6_mdr_flood.h"
 #include "ospf6_mdr_message.h"
+#include "ospf6_mdr_ack.h"
 #include "ospf6_intra.h"
 
 #include <netinet/ip6.h>
@@ -578,27 +579,20 @@ ospf6_dbdesc_recv_master (struct ospf6_header *oh,
               else
                 zlog_debug ("Add request (Received MoreRecent)");
             }
-          ospf6_lsdb_add (his, on->request_list);
+          ospf6_lsreq_add (on, his);
         }
 
-      // If his is newer or same as mine, then remove mine
-      // from summary_list for neighbor
+      // If his is newer or same as mine, then mine need not
+      // be described to the neighbor
       if (mine != NULL && ospf6_lsa_compare (his, mine) <= 0)
-	{
-	  struct ospf6_lsa *mine_summary;
-
-	  mine_summary =
-	    ospf6_lsdb_lookup (his->header->type, his->header->id,
-			       his->header->adv_router, on->summary_list);
-	  if (mine_summary)
-	    ospf6_lsdb_remove (mine_summary, on->summary_list);
-	}
+	ospf6_summary_skip (on, his);
 
       if (!(mine == NULL || ospf6_lsa_compare (his, mine) < 0))
         {
           if (IS_OSPF6_DEBUG_MESSAGE (oh->type, RECV))
             zlog_debug ("Discard (Existing MoreRecent)");
-          ospf6_lsa_delete (his);
+          if (his->lock == 0)
+            ospf6_lsa_delete (his);
         }
     }
 
@@ -807,23 +801,16 @@ ospf6_dbdesc_recv_slave (struct ospf6_header *oh,
         {
           if (IS_OSPF6_DEBUG_MESSAGE (oh->type, RECV))
             zlog_debug ("Add request-list: %s", his->name);
-          ospf6_lsdb_add (his, on->request_list);
+          ospf6_lsreq_add (on, his);
         }
 
-      // If his is newer or same as mine, then remove mine
-      // from summary_list for neighbor
+      // If his is newer or same as mine, then mine need not
+      // be described to the neighbor
       if (mine != NULL && ospf6_lsa_compare (his, mine) <= 0)
-	{
-	  struct ospf6_lsa *mine_summary;
-
-	  mine_summary =
-	    ospf6_lsdb_lookup (his->header->type, his->header->id,
-			       his->header->adv_router, on->summary_list);
-	  if (mine_summary)
-	    ospf6_lsdb_remove (mine_summary, on->summary_list);
-	}
+	ospf6_summary_skip (on, his);
 
-      if (!(mine == NULL || ospf6_lsa_compare (his, mine) < 0))
+      if (!(mine == NULL || ospf6_lsa_compare (his, mine) < 0) &&
+          his->lock == 0)
         ospf6_lsa_delete (his);
     }
 
@@ -1503,10 +1490,12 @@ ospf6_lsupdate_recv (struct in6_addr *src, struct in6_addr *dst,
      with the proper Link State Update packet(s), the Link state request
      list is truncated and a new Link State Request packet is sent. */
   /* send new Link State Request packet if this LS Update packet
-     can be recognized as a response to our previous LS Request */
+     can be recognized as a response to our previous LS Request; while
+     the request window is full, wait for the rest of the responses */
   if (! IN6_IS_ADDR_MULTICAST (dst) &&
       (on->state == OSPF6_NEIGHBOR_EXCHANGE ||
-       on->state == OSPF6_NEIGHBOR_LOADING))
+       on->state == OSPF6_NEIGHBOR_LOADING) &&
+      (on->request_list->count == 0 || ospf6_lsreq_window_avail (on) > 0))
     {
       THREAD_OFF (on->thread_send_lsreq);
       on->thread_send_lsreq =
@@ -1578,7 +1567,7 @@ ospf6_lsack_recv (struct in6_addr *src, struct in6_addr *dst,
         zlog_debug ("%s acknowledged by %s", his->name, on->name);
 
       if (on->ospf6_if->type == OSPF6_IFTYPE_MDR)
-	ospf6_mdr_neighbor_store_ack (on, his);
+	ospf6_mdr_neighbor_store_ack (on, his, OSPF6_MDR_ACK_EXPLICIT);
 
       /* Find database copy */
       mine = ospf6_lsdb_lookup (his->header->type, his->header->id,
@@ -1686,6 +1675,22 @@ ospf6_message_terminate (void)
   iobuflen = 0;
 }
 
+/* Count a message of LEN bytes, LLS data included, in STATS. */
+static void
+ospf6_message_count (struct ospf6_message_stats *stats,
+                     struct ospf6_header *oh, unsigned int len)
+{
+  if (oh->type >= OSPF6_MESSAGE_TYPE_ALL)
+    return;
+  stats->packets[oh->type]++;
+  stats->bytes += len;
+  if (oh->type == OSPF6_MESSAGE_TYPE_LSUPDATE)
+    stats->lsas += ntohl (((struct ospf6_lsupdate *) (oh + 1))->lsa_number);
+  else if (oh->type == OSPF6_MESSAGE_TYPE_LSACK)
+    stats->acks += (ntohs (oh->length) - sizeof (struct ospf6_header)) /
+      sizeof (struct ospf6_lsa_header);
+}
+
 int
 ospf6_receive (struct thread *thread)
 {
@@ -1738,7 +1743,11 @@ ospf6_receive (struct thread *thread)
 
   oh = (struct ospf6_header *) recvbuf;
   if (ospf6_rxpacket_examin (oi, oh, len) != MSG_OK)
-    return 0;
+    {
+      oi->rx.drops++;
+      return 0;
+    }
+  ospf6_message_count (&oi->rx, oh, len);
 
   /* Being here means, that no sizing/alignment issues were detected in
      the input packet. This renders the additional checks performed below
@@ -1929,7 +1938,12 @@ ospf6_send (struct in6_addr *src, struct in6_addr *dst,
   /* send message */
   len = ospf6_sendmsg (src, dst, &oi->interface->ifindex, iovector);
   if (len != length)
-    zlog_err ("Could not send entire message length %d != %d", length, len);
+    {
+      zlog_err ("Could not send entire message length %d != %d", length, len);
+      oi->tx.drops++;
+    }
+  else
+    ospf6_message_count (&oi->tx, oh, length);
 }
 
 static uint32_t
@@ -1970,6 +1984,7 @@ ospf6_schedule_immediate_hello (struct ospf6_interface *oi)
   THREAD_OFF (oi->thread_send_hello);
   oi->thread_send_hello =
     thread_add_timer_msec (master, ospf6_hello_send, oi, msec);
+  thread_set_priority (oi->thread_send_hello, THREAD_PRIORITY_HIGH);
 }
 
 void
@@ -1983,6 +1998,7 @@ ospf6_schedule_hello (struct ospf6_interface *oi)
   THREAD_OFF (oi->thread_send_hello);
   oi->thread_send_hello =
     thread_add_timer_msec (master, ospf6_hello_send, oi, msec);
+  thread_set_priority (oi->thread_send_hello, THREAD_PRIORITY_HIGH);
 }
 
 int
@@ -2132,8 +2148,6 @@ ospf6_dbdesc_send (struct thread *thread)
       for (lsa = ospf6_lsdb_head (on->dbdesc_list); lsa;
            lsa = ospf6_lsdb_next (lsa))
         {
-          ospf6_lsa_age_update_to_send (lsa, on->ospf6_if->transdelay);
-
           /* MTU check */
           if (p - sendbuf + sizeof (struct ospf6_lsa_header) >
               ospf6_packet_max(on->ospf6_if))
@@ -2141,7 +2155,8 @@ ospf6_dbdesc_send (struct thread *thread)
               ospf6_lsa_unlock (lsa);
               break;
             }
-          memcpy (p, lsa->header, sizeof (struct ospf6_lsa_header));
+          ospf6_lsa_copy_to_send (lsa, p, sizeof (struct ospf6_lsa_header),
+                                  on->ospf6_if->transdelay);
           p += sizeof (struct ospf6_lsa_header);
         }
     }
@@ -2194,24 +2209,20 @@ ospf6_dbdesc_send_newone (struct thread *thread)
   on = (struct ospf6_neighbor *) THREAD_ARG (thread);
   ospf6_lsdb_remove_all (on->dbdesc_list);
 
-  /* move LSAs from summary_list to dbdesc_list (within neighbor structure)
-     so that ospf6_send_dbdesc () can send those LSAs */
+  /* copy the next LSAs of the database summary to dbdesc_list (within
+     neighbor structure) so that ospf6_send_dbdesc () can send those LSAs */
   size = sizeof (struct ospf6_lsa_header) + sizeof (struct ospf6_dbdesc);
-  for (lsa = ospf6_lsdb_head (on->summary_list); lsa;
-       lsa = ospf6_lsdb_next (lsa))
+  while ((lsa = ospf6_summary_current (on)) != NULL)
     {
       if (size + sizeof (struct ospf6_lsa_header) > ospf6_packet_max(on->ospf6_if))
-        {
-          ospf6_lsa_unlock (lsa);
-          break;
-        }
+        break;
 
       ospf6_lsdb_add (ospf6_lsa_copy (lsa), on->dbdesc_list);
-      ospf6_lsdb_remove (lsa, on->summary_list);
+      ospf6_summary_advance (on);
       size += sizeof (struct ospf6_lsa_header);
     }
 
-  if (on->summary_list->count == 0)
+  if (lsa == NULL)
     UNSET_FLAG (on->dbdesc_bits, OSPF6_DBDESC_MBIT);
 
   /* If slave, More bit check must be done here */
@@ -2234,8 +2245,9 @@ ospf6_lsreq_lsa_cmp (void *a, void *b)
 }
 
 static unsigned char *
-ospf6_lsreq_add_entries (unsigned char *p, size_t packet_max,
-			 struct list *lsalist, struct timeval *now)
+ospf6_lsreq_add_entries (struct ospf6_neighbor *on, unsigned char *p,
+			 size_t packet_max, struct list *lsalist,
+			 struct timeval *now)
 {
   struct listnode *head;
   struct ospf6_lsa *lsa;
@@ -2260,6 +2272,7 @@ ospf6_lsreq_add_entries (unsigned char *p, size_t packet_max,
       e->adv_router = lsa->header->adv_router;
       p += sizeof (struct ospf6_lsreq_entry);
 
+      ospf6_lsreq_window_release (on, lsa);
       lsa->retrans_count++;
       lsa->originated = *now;
     }
@@ -2272,9 +2285,9 @@ ospf6_lsreq_send (struct thread *thread)
 {
   struct ospf6_neighbor *on;
   struct ospf6_interface *oi;
-  unsigned int maxentries;
+  unsigned int maxentries, packets, sent, entries;
   struct ospf6_header *oh;
-  long request_rxmt_delay;
+  long request_rxmt_delay, expire;
   struct timeval now, min_originated;
   struct list *reqlist, *candidate_reqlist;
   struct ospf6_lsa *lsa;
@@ -2305,22 +2318,41 @@ ospf6_lsreq_send (struct thread *thread)
   if (IS_OSPF6_DEBUG_MESSAGE (OSPF6_MESSAGE_TYPE_LSREQ, SEND))
     zlog_debug ("LSReq total request list size: %u", on->request_list->count);
 
-  maxentries = (ospf6_packet_max (oi) - sizeof (struct ospf6_header)) /
-    sizeof (struct ospf6_lsreq_entry);
-  if (maxentries > on->request_list->count)
-    maxentries = on->request_list->count;
-
-  if (IS_OSPF6_DEBUG_MESSAGE (OSPF6_MESSAGE_TYPE_LSREQ, SEND))
-    zlog_debug ("Maximum number of entries in LSReq packet: %u", maxentries);
-
-  memset (sendbuf, 0, iobuflen);
-  oh = (struct ospf6_header *) sendbuf;
-
   /* assume an outstanding request was lost after this long */
   request_rxmt_delay = 1000 * oi->rxmt_interval / 4;
   if (request_rxmt_delay < oi->flood_delay)
     request_rxmt_delay = oi->flood_delay;
 
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &now);
+
+  /* up to a window of LSReq packets may be outstanding */
+  expire = ospf6_lsreq_window_expire (on, &now, request_rxmt_delay);
+  packets = ospf6_lsreq_window_avail (on);
+  if (packets == 0)
+    {
+      assert (expire > 0);
+
+      if (IS_OSPF6_DEBUG_MESSAGE (OSPF6_MESSAGE_TYPE_LSREQ, SEND))
+	zlog_debug ("LSReq window full (%u packets), "
+		    "scheduling next LSReq in %ld msec",
+		    on->lsreq_window.size, expire);
+
+      on->request_retrans_wait = true;
+      on->thread_send_lsreq =
+	thread_add_timer_msec (master, ospf6_lsreq_send, on, expire);
+      return 0;
+    }
+
+  maxentries = packets * ((ospf6_packet_max (oi) -
+			   sizeof (struct ospf6_header)) /
+			  sizeof (struct ospf6_lsreq_entry));
+  if (maxentries > on->request_list->count)
+    maxentries = on->request_list->count;
+
+  if (IS_OSPF6_DEBUG_MESSAGE (OSPF6_MESSAGE_TYPE_LSREQ, SEND))
+    zlog_debug ("Maximum number of entries in %u LSReq packets: %u",
+		packets, maxentries);
+
   /* for LSAs to request now */
   reqlist = list_new ();
 
@@ -2329,8 +2361,6 @@ ospf6_lsreq_send (struct thread *thread)
   /* LSAs requested the fewest number of times are sent first */
   candidate_reqlist->cmp = ospf6_lsreq_lsa_cmp;
 
-  quagga_gettime (QUAGGA_CLK_MONOTONIC, &now);
-
   min_originated = now;
   for (lsa = ospf6_lsdb_head (on->request_list); lsa;
        lsa = ospf6_lsdb_next (lsa))
@@ -2391,26 +2421,40 @@ ospf6_lsreq_send (struct thread *thread)
       return 0;
     }
 
-  /* set Request entries in lsreq */
-  p = (u_char *) ((caddr_t) oh + sizeof (struct ospf6_header));
+  /* never requested LSAs first, then those to request again */
+  for (sent = 0, entries = 0;
+       sent < packets &&
+	 (listcount (reqlist) > 0 || listcount (candidate_reqlist) > 0);
+       sent++)
+    {
+      memset (sendbuf, 0, iobuflen);
+      oh = (struct ospf6_header *) sendbuf;
 
-  p = ospf6_lsreq_add_entries (p, ospf6_packet_max (oi), reqlist, &now);
-  assert (listcount (reqlist) == 0);
+      /* set Request entries in lsreq */
+      p = (u_char *) ((caddr_t) oh + sizeof (struct ospf6_header));
 
-  p = ospf6_lsreq_add_entries (p, ospf6_packet_max (oi),
-			       candidate_reqlist, &now);
-  assert (listcount (candidate_reqlist) == 0 ||
-	  p + sizeof (struct ospf6_lsreq_entry) >
-	  sendbuf + ospf6_packet_max (oi));
+      p = ospf6_lsreq_add_entries (on, p, ospf6_packet_max (oi),
+				   reqlist, &now);
+      p = ospf6_lsreq_add_entries (on, p, ospf6_packet_max (oi),
+				   candidate_reqlist, &now);
 
-  oh->type = OSPF6_MESSAGE_TYPE_LSREQ;
-  oh->length = htons (p - sendbuf);
+      entries += (p - sendbuf - sizeof (struct ospf6_header)) /
+	sizeof (struct ospf6_lsreq_entry);
 
-  ospf6_send (oi->linklocal_addr, &on->linklocal_addr,
-	      oi, oh, ntohs (oh->length));
+      oh->type = OSPF6_MESSAGE_TYPE_LSREQ;
+      oh->length = htons (p - sendbuf);
+
+      ospf6_send (oi->linklocal_addr, &on->linklocal_addr,
+		  oi, oh, ntohs (oh->length));
+    }
+  assert (listcount (reqlist) == 0 && listcount (candidate_reqlist) == 0);
+
+  ospf6_lsreq_window_sent (on, &now, sent, entries);
 
   if (IS_OSPF6_DEBUG_MESSAGE (OSPF6_MESSAGE_TYPE_LSREQ, SEND))
-    zlog_debug ("Scheduling next LSReq in %u msec",
+    zlog_debug ("Sent %u LSReq packets, %u of %u outstanding; "
+		"scheduling next LSReq in %u msec", sent,
+		on->lsreq_window.outstanding, on->lsreq_window.size,
 		1000 * oi->rxmt_interval);
 
   /* set next thread */
@@ -2487,8 +2531,8 @@ ospf6_lsupdate_send_neighbor (struct thread *thread)
 	    }
         }
 
-      ospf6_lsa_age_update_to_send (lsa, on->ospf6_if->transdelay);
-      memcpy (p, lsa->header, OSPF6_LSA_SIZE (lsa->header));
+      ospf6_lsa_copy_to_send (lsa, p, OSPF6_LSA_SIZE (lsa->header),
+                              on->ospf6_if->transdelay);
       p += OSPF6_LSA_SIZE (lsa->header);
       num++;
 
@@ -2567,8 +2611,8 @@ ospf6_lsupdate_send_neighbor (struct thread *thread)
 		}
 	    }
 
-	  ospf6_lsa_age_update_to_send (lsa, on->ospf6_if->transdelay);
-	  memcpy (p, lsa->header, OSPF6_LSA_SIZE (lsa->header));
+	  ospf6_lsa_copy_to_send (lsa, p, OSPF6_LSA_SIZE (lsa->header),
+	                          on->ospf6_if->transdelay);
 	  p += OSPF6_LSA_SIZE (lsa->header);
 	  num++;
 	  rxmt++;
@@ -2584,6 +2628,7 @@ ospf6_lsupdate_send_neighbor (struct thread *thread)
     {
       ospf6_send (on->ospf6_if->linklocal_addr, &on->linklocal_addr,
                   on->ospf6_if, oh, ntohs (oh->length));
+      on->ospf6_if->lsa_retransmits += rxmt;
     }
 
   if (on->lsupdate_list->count != 0 || on->retrans_list->count != 0)
@@ -2679,8 +2724,8 @@ ospf6_lsupdate_send_interface (struct thread *thread)
 	    }
         }
 
-      ospf6_lsa_age_update_to_send (lsa, oi->transdelay);
-      memcpy (p, lsa->header, OSPF6_LSA_SIZE (lsa->header));
+      ospf6_lsa_copy_to_send (lsa, p, OSPF6_LSA_SIZE (lsa->header),
+                              oi->transdelay);
       p += OSPF6_LSA_SIZE (lsa->header);
       num++;
 
@@ -2765,8 +2810,8 @@ ospf6_lsack_send_neighbor (struct thread *thread)
           break;
         }
 
-      ospf6_lsa_age_update_to_send (lsa, on->ospf6_if->transdelay);
-      memcpy (p, lsa->header, sizeof (struct ospf6_lsa_header));
+      ospf6_lsa_copy_to_send (lsa, p, sizeof (struct ospf6_lsa_header),
+                              on->ospf6_if->transdelay);
       p += sizeof (struct ospf6_lsa_header);
 
       assert (lsa->lock == 2);
@@ -2781,11 +2826,41 @@ ospf6_lsack_send_neighbor (struct thread *thread)
   return 0;
 }
 
+static void
+ospf6_lsack_send_interface_packet (struct ospf6_interface *oi, u_char *p)
+{
+  struct ospf6_header *oh = (struct ospf6_header *) sendbuf;
+
+  oh->type = OSPF6_MESSAGE_TYPE_LSACK;
+  oh->length = htons (p - sendbuf);
+
+  if (oi->type == OSPF6_IFTYPE_BROADCAST || oi->type == OSPF6_IFTYPE_NBMA)
+    {
+      if (oi->state == OSPF6_INTERFACE_DR || oi->state == OSPF6_INTERFACE_BDR)
+        ospf6_send (oi->linklocal_addr, &allspfrouters6, oi, oh,
+                    ntohs (oh->length));
+      else
+        ospf6_send (oi->linklocal_addr, &alldrouters6, oi, oh,
+                    ntohs (oh->length));
+    }
+  else if ((unsigned int) (p - sendbuf) > sizeof (struct ospf6_header))
+    {
+      ospf6_send (oi->linklocal_addr, &allspfrouters6, oi, oh,
+                  ntohs (oh->length));
+
+      if (oi->type == OSPF6_IFTYPE_MDR)
+        {
+          oi->mdr.lsack_packets++;
+          oi->mdr.lsack_acks += (p - sendbuf - sizeof (struct ospf6_header)) /
+            sizeof (struct ospf6_lsa_header);
+        }
+    }
+}
+
 int
 ospf6_lsack_send_interface (struct thread *thread)
 {
   struct ospf6_interface *oi;
-  struct ospf6_header *oh;
   u_char *p;
   struct ospf6_lsa *lsa;
 
@@ -2805,26 +2880,13 @@ ospf6_lsack_send_interface (struct thread *thread)
     return 0;
 
   memset (sendbuf, 0, iobuflen);
-  oh = (struct ospf6_header *) sendbuf;
 
-  p = (u_char *)((caddr_t) oh + sizeof (struct ospf6_header));
+  p = (u_char *) (sendbuf + sizeof (struct ospf6_header));
 
+  /* all acks due are sent now, in as few packets as possible */
   for (lsa = ospf6_lsdb_head (oi->lsack_list); lsa;
        lsa = ospf6_lsdb_next (lsa))
     {
-      /* MTU check */
-      if (p - sendbuf + sizeof (struct ospf6_lsa_header) > ospf6_packet_max(oi))
-        {
-          /* if we run out of packet size/space here,
-             better to try again soon. */
-          THREAD_OFF (oi->thread_send_lsack);
-          oi->thread_send_lsack =
-            thread_add_event (master, ospf6_lsack_send_interface, oi, 0);
-
-          ospf6_lsa_unlock (lsa);
-          break;
-        }
-
       if (oi->type == OSPF6_IFTYPE_MDR)
         {
 	  long lsack_delay_msec;
@@ -2838,29 +2900,24 @@ ospf6_lsack_send_interface (struct thread *thread)
             continue;           // Not yet time to send lsack
         }
 
-      ospf6_lsa_age_update_to_send (lsa, oi->transdelay);
-      memcpy (p, lsa->header, sizeof (struct ospf6_lsa_header));
+      /* MTU check */
+      if (p - sendbuf + sizeof (struct ospf6_lsa_header) > ospf6_packet_max(oi))
+        {
+          /* the packet is full: send it and start another */
+          ospf6_lsack_send_interface_packet (oi, p);
+          memset (sendbuf, 0, sizeof (struct ospf6_header));
+          p = (u_char *) (sendbuf + sizeof (struct ospf6_header));
+        }
+
+      ospf6_lsa_copy_to_send (lsa, p, sizeof (struct ospf6_lsa_header),
+                              oi->transdelay);
       p += sizeof (struct ospf6_lsa_header);
 
       assert (lsa->lock == 2);
       ospf6_lsdb_remove (lsa, oi->lsack_list);
     }
 
-  oh->type = OSPF6_MESSAGE_TYPE_LSACK;
-  oh->length = htons (p - sendbuf);
-
-  if (oi->type == OSPF6_IFTYPE_BROADCAST || oi->type == OSPF6_IFTYPE_NBMA)
-    {
-      if (oi->state == OSPF6_INTERFACE_DR || oi->state == OSPF6_INTERFACE_BDR)
-        ospf6_send (oi->linklocal_addr, &allspfrouters6, oi, oh,
-                    ntohs (oh->length));
-      else
-        ospf6_send (oi->linklocal_addr, &alldrouters6, oi, oh,
-                    ntohs (oh->length));
-    }
-  else if ((unsigned int) (p - sendbuf) > sizeof (struct ospf6_header))
-    ospf6_send (oi->linklocal_addr, &allspfrouters6, oi, oh,
-                ntohs (oh->length));
+  ospf6_lsack_send_interface_packet (oi, p);
 
   if (oi->thread_send_lsack == NULL && oi->lsack_list->count > 0)
     {
@@ -117,6 +117,16 @@ struct ospf6_lsupdate
 #define OSPF6_LS_ACK_MIN_SIZE                  0U
 /* It is just a sequence of LSA Headers */
 
+/* Counters of the messages sent or received on an interface */
+struct ospf6_message_stats
+{
+  u_int32_t packets[OSPF6_MESSAGE_TYPE_ALL];   /* by type */
+  unsigned long bytes;
+  u_int32_t drops;              /* invalid, or not sent in full */
+  u_int32_t lsas;               /* in LSUpdates */
+  u_int32_t acks;               /* LSA headers in LSAcks */
+};
+
 struct thread;
 struct thread_master;
 struct vty;
@@ -103,8 +103,11 @@ ospf6_neighbor_create (u_int32_t router_id, struct ospf6_interface *oi)
   quagga_gettime (QUAGGA_CLK_MONOTONIC, &on->last_changed);
   on->router_id = router_id;
 
-  on->summary_list = ospf6_lsdb_create (on);
+  on->summary.scope = OSPF6_SUMMARY_SCOPE_DONE;
+  on->summary.skip = list_new ();
   on->request_list = ospf6_lsdb_create (on);
+  on->lsreq_window.size = OSPF6_LSREQ_WINDOW_INITIAL;
+  on->lsreq_window.min_rtt = -1;
   on->retrans_list = ospf6_lsdb_create (on);
 
   on->dbdesc_list = ospf6_lsdb_create (on);
@@ -157,7 +160,7 @@ ospf6_neighbor_delete (struct ospf6_neighbor *on)
 
   ospf6_neighbor_state_change (OSPF6_NEIGHBOR_DOWN, on);
 
-  ospf6_lsdb_remove_all (on->summary_list);
+  ospf6_summary_clear (on);
   ospf6_lsdb_remove_all (on->request_list);
   for (lsa = ospf6_lsdb_head (on->retrans_list); lsa;
        lsa = ospf6_lsdb_next (lsa))
@@ -171,7 +174,7 @@ ospf6_neighbor_delete (struct ospf6_neighbor *on)
   ospf6_lsdb_remove_all (on->lsupdate_list);
   ospf6_lsdb_remove_all (on->lsack_list);
 
-  ospf6_lsdb_delete (on->summary_list);
+  list_delete (on->summary.skip);
   ospf6_lsdb_delete (on->request_list);
   ospf6_lsdb_delete (on->retrans_list);
 
@@ -404,7 +407,13 @@ ospf6_neighbor_state_change (u_char next_state, struct ospf6_neighbor *on)
        prev_state == OSPF6_NEIGHBOR_LOADING) &&
       (next_state != OSPF6_NEIGHBOR_EXCHANGE &&
        next_state != OSPF6_NEIGHBOR_LOADING))
-    ospf6_maxage_remove (oi->area->ospf6);
+    {
+      /* requests still outstanding will not be answered */
+      on->lsreq_window.bursts = 0;
+      on->lsreq_window.outstanding = 0;
+      on->lsreq_window.sync_end = on->last_changed;
+      ospf6_maxage_remove (oi->area->ospf6);
+    }
 
   ifn = ospf6_get_interface_data (oi, neighbor_data_id);
   assert (ifn);
@@ -463,6 +472,7 @@ ospf6_neighbor_schedule_inactivity (struct ospf6_neighbor *on)
   THREAD_OFF (on->inactivity_timer);
   on->inactivity_timer =
     thread_add_timer_msec (master, inactivity_timer, on, msec);
+  thread_set_priority (on->inactivity_timer, THREAD_PRIORITY_HIGH);
 }
 
 int
@@ -573,73 +583,446 @@ ospf6_neighbor_exstart (struct ospf6_neighbor *on)
   __ospf6_neighbor_exstart (on, tv.tv_sec);
 }
 
-int
-negotiation_done (struct thread *thread)
+static struct ospf6_lsdb *
+ospf6_summary_lsdb (struct ospf6_neighbor *on, u_char scope)
 {
-  struct ospf6_neighbor *on;
-  struct ospf6_lsa *lsa;
+  switch (scope)
+    {
+    case OSPF6_SUMMARY_SCOPE_LINKLOCAL:
+      return on->ospf6_if->lsdb;
+    case OSPF6_SUMMARY_SCOPE_AREA:
+      return on->ospf6_if->area->lsdb;
+    case OSPF6_SUMMARY_SCOPE_AS:
+      return on->ospf6_if->area->ospf6->lsdb;
+    }
+  return NULL;
+}
 
-  on = (struct ospf6_neighbor *) THREAD_ARG (thread);
-  assert (on);
+static void
+ospf6_summary_start (struct ospf6_neighbor *on, u_char scope)
+{
+  struct ospf6_summary *summary = &on->summary;
+  struct ospf6_lsdb *lsdb;
 
-  if (on->state != OSPF6_NEIGHBOR_EXSTART)
-    return 0;
+  summary->scope = scope;
+  summary->lsa = NULL;
+  lsdb = ospf6_summary_lsdb (on, scope);
+  if (lsdb)
+    {
+      summary->lsa = ospf6_lsdb_head (lsdb);
+      summary->version = lsdb->version;
+    }
+}
 
-  if (IS_OSPF6_DEBUG_NEIGHBOR (EVENT))
-    zlog_debug ("Neighbor Event %s: *NegotiationDone*", on->name);
+void
+ospf6_summary_clear (struct ospf6_neighbor *on)
+{
+  struct ospf6_summary *summary = &on->summary;
+  struct listnode *node, *nnode;
+  struct ospf6_lsa *his;
 
-  /* clear ls-list */
-  ospf6_lsdb_remove_all (on->summary_list);
-  ospf6_lsdb_remove_all (on->request_list);
-  for (lsa = ospf6_lsdb_head (on->retrans_list); lsa;
-       lsa = ospf6_lsdb_next (lsa))
+  if (summary->lsa)
+    ospf6_lsa_unlock (summary->lsa);
+  summary->lsa = NULL;
+  summary->scope = OSPF6_SUMMARY_SCOPE_DONE;
+
+  for (ALL_LIST_ELEMENTS (summary->skip, node, nnode, his))
     {
-      ospf6_decrement_retrans_count (lsa);
-      ospf6_lsdb_remove (lsa, on->retrans_list);
+      ospf6_lsa_unlock (his);
+      list_delete_node (summary->skip, node);
     }
+}
 
-  /* Interface scoped LSAs */
-  for (lsa = ospf6_lsdb_head (on->ospf6_if->lsdb); lsa;
-       lsa = ospf6_lsdb_next (lsa))
+/* Make summary->lsa the first LSA still to be described at or after
+   the saved position, moving on to the next LSDB as each is done. */
+static void
+ospf6_summary_settle (struct ospf6_neighbor *on)
+{
+  struct ospf6_summary *summary = &on->summary;
+  struct ospf6_lsdb *lsdb;
+  struct ospf6_lsa *lsa;
+
+  while (summary->scope != OSPF6_SUMMARY_SCOPE_DONE)
     {
-      if (OSPF6_LSA_IS_MAXAGE (lsa))
+      lsdb = ospf6_summary_lsdb (on, summary->scope);
+      if (summary->lsa && summary->version != lsdb->version)
         {
-          quagga_gettime (QUAGGA_CLK_MONOTONIC, &lsa->rxmt_time);
-          ospf6_increment_retrans_count (lsa);
-          ospf6_lsdb_add (ospf6_lsa_copy (lsa), on->retrans_list);
+          lsa = ospf6_lsdb_seek (summary->lsa, lsdb);
+          ospf6_lsa_unlock (summary->lsa);
+          summary->lsa = lsa;
+          summary->version = lsdb->version;
         }
-      else
-        ospf6_lsdb_add (ospf6_lsa_copy (lsa), on->summary_list);
+
+      if (summary->lsa)
+        return;
+
+      ospf6_summary_start (on, summary->scope + 1);
     }
+}
 
-  /* Area scoped LSAs */
-  for (lsa = ospf6_lsdb_head (on->ospf6_if->area->lsdb); lsa;
-       lsa = ospf6_lsdb_next (lsa))
+/* Whether the neighbor has described an instance of lsa at least as
+   recent.  Both sides describe their LSDBs in key order, so the skip
+   list is merged with the summary; entries behind it are dropped. */
+static int
+ospf6_summary_skipped (struct ospf6_neighbor *on, struct ospf6_lsa *lsa)
+{
+  struct list *skip = on->summary.skip;
+  struct listnode *head;
+  struct ospf6_lsa *his;
+  int cmp, skipped;
+
+  while ((head = listhead (skip)) != NULL)
+    {
+      his = listgetdata (head);
+      cmp = ospf6_lsdb_key_cmp (his, lsa);
+      if (cmp > 0)
+        return 0;
+
+      skipped = (cmp == 0 && ospf6_lsa_compare (his, lsa) <= 0);
+      list_delete_node (skip, head);
+      ospf6_lsa_unlock (his);
+
+      if (cmp == 0)
+        return skipped;
+    }
+
+  return 0;
+}
+
+/* The next LSA to describe to the neighbor, or NULL once everything
+   has been described.  It stays the same until ospf6_summary_advance().
+   MaxAge LSAs are moved to the retransmission list instead of being
+   described. */
+struct ospf6_lsa *
+ospf6_summary_current (struct ospf6_neighbor *on)
+{
+  struct ospf6_lsa *lsa;
+
+  for (;;)
     {
+      ospf6_summary_settle (on);
+      lsa = on->summary.lsa;
+      if (lsa == NULL)
+        return NULL;
+
       if (OSPF6_LSA_IS_MAXAGE (lsa))
         {
           quagga_gettime (QUAGGA_CLK_MONOTONIC, &lsa->rxmt_time);
           ospf6_increment_retrans_count (lsa);
           ospf6_lsdb_add (ospf6_lsa_copy (lsa), on->retrans_list);
         }
-      else
-        ospf6_lsdb_add (ospf6_lsa_copy (lsa), on->summary_list);
+      else if (! ospf6_summary_skipped (on, lsa))
+        return lsa;
+
+      ospf6_summary_advance (on);
     }
+}
 
-  /* AS scoped LSAs */
-  for (lsa = ospf6_lsdb_head (on->ospf6_if->area->ospf6->lsdb); lsa;
-       lsa = ospf6_lsdb_next (lsa))
+void
+ospf6_summary_advance (struct ospf6_neighbor *on)
+{
+  ospf6_summary_settle (on);
+  if (on->summary.lsa)
+    on->summary.lsa = ospf6_lsdb_next (on->summary.lsa);
+}
+
+/* The neighbor described his as at least as recent as our instance:
+   ours need not be described if it has not been yet. */
+void
+ospf6_summary_skip (struct ospf6_neighbor *on, struct ospf6_lsa *his)
+{
+  struct ospf6_summary *summary = &on->summary;
+
+  if (summary->scope == OSPF6_SUMMARY_SCOPE_DONE ||
+      (summary->lsa && ospf6_lsdb_key_cmp (his, summary->lsa) < 0))
+    return;
+
+  ospf6_lsa_lock (his);
+  listnode_add (summary->skip, his);
+}
+
+/* First LSA of the given scope not yet described */
+static struct ospf6_lsa *
+ospf6_summary_first (struct ospf6_neighbor *on, u_char scope)
+{
+  struct ospf6_lsa *lsa;
+
+  if (scope == on->summary.scope)
+    return on->summary.lsa;
+
+  lsa = ospf6_lsdb_head (ospf6_summary_lsdb (on, scope));
+  if (lsa)
+    ospf6_lsa_unlock (lsa);     /* still held by the lsdb */
+  return lsa;
+}
+
+/* LSAs not yet described; some may still turn out to be MaxAge or
+   already known to the neighbor */
+static void
+ospf6_summary_show (struct vty *vty, struct ospf6_neighbor *on)
+{
+  struct ospf6_lsa *lsa;
+  unsigned int count = 0;
+  u_char scope;
+
+  ospf6_summary_settle (on);
+
+  for (scope = on->summary.scope; scope < OSPF6_SUMMARY_SCOPE_DONE; scope++)
+    for (lsa = ospf6_summary_first (on, scope); lsa; lsa = lsa->next)
+      count++;
+
+  vty_out (vty, "    Summary-List: %u LSAs%s", count, VNL);
+
+  for (scope = on->summary.scope; scope < OSPF6_SUMMARY_SCOPE_DONE; scope++)
+    for (lsa = ospf6_summary_first (on, scope); lsa; lsa = lsa->next)
+      vty_out (vty, "      %s%s", lsa->name, VNL);
+}
+
+/* A new database exchange starts */
+void
+ospf6_lsreq_window_reset (struct ospf6_neighbor *on)
+{
+  struct ospf6_lsreq_window *window = &on->lsreq_window;
+
+  memset (window, 0, sizeof (struct ospf6_lsreq_window));
+  window->size = OSPF6_LSREQ_WINDOW_INITIAL;
+  window->min_rtt = -1;
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &window->sync_start);
+}
+
+/* Number of LSReq packets that may be sent now */
+u_int
+ospf6_lsreq_window_avail (struct ospf6_neighbor *on)
+{
+  struct ospf6_lsreq_window *window = &on->lsreq_window;
+
+  if (window->outstanding >= window->size)
+    return 0;
+  return window->size - window->outstanding;
+}
+
+void
+ospf6_lsreq_window_sent (struct ospf6_neighbor *on, struct timeval *now,
+                         u_int packets, u_int entries)
+{
+  struct ospf6_lsreq_window *window = &on->lsreq_window;
+  struct ospf6_lsreq_burst *burst;
+
+  assert (window->bursts < OSPF6_LSREQ_WINDOW_MAX);
+  burst = &window->burst[window->bursts++];
+  burst->sent = *now;
+  burst->packets = packets;
+  burst->entries = entries;
+  window->outstanding += packets;
+}
+
+static struct ospf6_lsreq_burst *
+ospf6_lsreq_window_lookup (struct ospf6_lsreq_window *window,
+                           struct ospf6_lsa *req)
+{
+  u_int i;
+
+  if (! timerisset (&req->originated))
+    return NULL;
+
+  for (i = 0; i < window->bursts; i++)
+    if (timercmp (&window->burst[i].sent, &req->originated, ==))
+      return &window->burst[i];
+
+  return NULL;
+}
+
+static void
+ospf6_lsreq_window_remove (struct ospf6_lsreq_window *window,
+                           struct ospf6_lsreq_burst *burst)
+{
+  assert (window->outstanding >= burst->packets);
+  window->outstanding -= burst->packets;
+
+  window->bursts--;
+  memmove (burst, burst + 1,
+           (&window->burst[window->bursts] - burst) * sizeof (*burst));
+}
+
+/* The request is about to be sent again: it no longer counts against
+   the burst that requested it first */
+void
+ospf6_lsreq_window_release (struct ospf6_neighbor *on, struct ospf6_lsa *req)
+{
+  struct ospf6_lsreq_window *window = &on->lsreq_window;
+  struct ospf6_lsreq_burst *burst;
+
+  burst = ospf6_lsreq_window_lookup (window, req);
+  if (burst && --burst->entries == 0)
+    ospf6_lsreq_window_remove (window, burst);
+}
+
+/* The request req is done with, answered or replaced.  Once a whole
+   burst is done, its response time adjusts the window. */
+static void
+ospf6_lsreq_window_done (struct ospf6_neighbor *on, struct ospf6_lsa *req)
+{
+  struct ospf6_lsreq_window *window = &on->lsreq_window;
+  struct ospf6_lsreq_burst *burst;
+  struct timeval now;
+  long rtt;
+
+  burst = ospf6_lsreq_window_lookup (window, req);
+  if (burst == NULL || --burst->entries > 0)
+    return;
+
+  /* a burst of several packets takes longer to answer in full, so
+     compare the time per packet */
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &now);
+  rtt = timersub_msec (&now, &burst->sent) / burst->packets;
+  ospf6_lsreq_window_remove (window, burst);
+
+  if (window->min_rtt < 0)
     {
-      if (OSPF6_LSA_IS_MAXAGE (lsa))
+      window->srtt = rtt;
+      window->min_rtt = rtt;
+    }
+  else
+    {
+      window->srtt += (rtt - window->srtt) / 8;
+      if (rtt < window->min_rtt)
+        window->min_rtt = rtt;
+    }
+
+  if (rtt <= 2 * window->min_rtt + OSPF6_LSREQ_RTT_SLACK)
+    {
+      if (window->size < OSPF6_LSREQ_WINDOW_MAX)
+        window->size++;
+    }
+  else if (window->size > 1)
+    window->size--;
+}
+
+/* lsa, received from any neighbor, satisfies the request req on the
+   request list of on */
+void
+ospf6_lsreq_answered (struct ospf6_neighbor *on, struct ospf6_lsa *req,
+                      struct ospf6_lsa *lsa)
+{
+  struct ospf6_lsreq_window *window = &on->lsreq_window;
+
+  window->sync_lsas++;
+  window->sync_bytes += OSPF6_LSA_SIZE (lsa->header);
+
+  ospf6_lsreq_window_done (on, req);
+}
+
+/* Add req to the request list of on.  A request it replaces counts as
+   completed for its burst, which is not to be taken as lost. */
+void
+ospf6_lsreq_add (struct ospf6_neighbor *on, struct ospf6_lsa *req)
+{
+  struct ospf6_lsa *old;
+
+  old = ospf6_lsdb_lookup (req->header->type, req->header->id,
+                           req->header->adv_router, on->request_list);
+  if (old)
+    ospf6_lsreq_window_done (on, old);
+
+  ospf6_lsdb_add (req, on->request_list);
+}
+
+/* Bursts not answered within delay msec are taken as lost and halve
+   the window.  Returns the msec until the next burst would be taken
+   as lost, or -1 if none is outstanding. */
+long
+ospf6_lsreq_window_expire (struct ospf6_neighbor *on, struct timeval *now,
+                           long delay)
+{
+  struct ospf6_lsreq_window *window = &on->lsreq_window;
+  long elapsed, next = -1;
+  bool lost = false;
+  u_int i = 0;
+
+  while (i < window->bursts)
+    {
+      elapsed = timersub_msec (now, &window->burst[i].sent);
+      if (elapsed >= delay)
         {
-          quagga_gettime (QUAGGA_CLK_MONOTONIC, &lsa->rxmt_time);
-          ospf6_increment_retrans_count (lsa);
-          ospf6_lsdb_add (ospf6_lsa_copy (lsa), on->retrans_list);
+          window->sync_lost += window->burst[i].packets;
+          ospf6_lsreq_window_remove (window, &window->burst[i]);
+          lost = true;
+          continue;
         }
-      else
-        ospf6_lsdb_add (ospf6_lsa_copy (lsa), on->summary_list);
+      if (next < 0 || delay - elapsed < next)
+        next = delay - elapsed;
+      i++;
     }
 
+  if (lost)
+    window->size = MAX (window->size / 2, 1);
+
+  return next;
+}
+
+static void
+ospf6_lsreq_window_show (struct vty *vty, struct ospf6_neighbor *on)
+{
+  struct ospf6_lsreq_window *window = &on->lsreq_window;
+  struct timeval end, res;
+  long msec;
+
+  vty_out (vty, "    LSReq window: %u packets outstanding of %u%s",
+           window->outstanding, window->size, VNL);
+  if (window->min_rtt >= 0)
+    vty_out (vty, "      Response time %ld msec per packet, minimum %ld msec%s",
+             window->srtt, window->min_rtt, VNL);
+
+  if (! timerisset (&window->sync_start))
+    return;
+
+  if (timerisset (&window->sync_end))
+    end = window->sync_end;
+  else
+    quagga_gettime (QUAGGA_CLK_MONOTONIC, &end);
+  timersub (&end, &window->sync_start, &res);
+  msec = res.tv_sec * 1000 + res.tv_usec / 1000;
+
+  vty_out (vty, "    Database sync%s: %u LSAs (%u bytes) in %ld.%03ld sec, "
+           "%u requests lost%s",
+           timerisset (&window->sync_end) ? "" : " in progress",
+           window->sync_lsas, window->sync_bytes, msec / 1000, msec % 1000,
+           window->sync_lost, VNL);
+  if (msec > 0)
+    vty_out (vty, "      Throughput %lu LSAs/sec, %lu bytes/sec%s",
+             (u_long) window->sync_lsas * 1000 / msec,
+             (u_long) window->sync_bytes * 1000 / msec, VNL);
+}
+
+int
+negotiation_done (struct thread *thread)
+{
+  struct ospf6_neighbor *on;
+  struct ospf6_lsa *lsa;
+
+  on = (struct ospf6_neighbor *) THREAD_ARG (thread);
+  assert (on);
+
+  if (on->state != OSPF6_NEIGHBOR_EXSTART)
+    return 0;
+
+  if (IS_OSPF6_DEBUG_NEIGHBOR (EVENT))
+    zlog_debug ("Neighbor Event %s: *NegotiationDone*", on->name);
+
+  /* clear ls-list */
+  ospf6_summary_clear (on);
+  ospf6_lsdb_remove_all (on->request_list);
+  for (lsa = ospf6_lsdb_head (on->retrans_list); lsa;
+       lsa = ospf6_lsdb_next (lsa))
+    {
+      ospf6_decrement_retrans_count (lsa);
+      ospf6_lsdb_remove (lsa, on->retrans_list);
+    }
+
+  /* describe the interface, area and AS scoped LSAs */
+  ospf6_summary_start (on, OSPF6_SUMMARY_SCOPE_LINKLOCAL);
+  ospf6_lsreq_window_reset (on);
+
   UNSET_FLAG (on->dbdesc_bits, OSPF6_DBDESC_IBIT);
   ospf6_neighbor_state_change (OSPF6_NEIGHBOR_EXCHANGE, on);
 
@@ -719,7 +1102,7 @@ adj_ok (struct thread *thread)
            ! need_adjacency (on))
     {
       ospf6_neighbor_state_change (OSPF6_NEIGHBOR_TWOWAY, on);
-      ospf6_lsdb_remove_all (on->summary_list);
+      ospf6_summary_clear (on);
       ospf6_lsdb_remove_all (on->request_list);
       for (lsa = ospf6_lsdb_head (on->retrans_list); lsa;
            lsa = ospf6_lsdb_next (lsa))
@@ -754,7 +1137,7 @@ seqnumber_mismatch (struct thread *thread)
   if (IS_OSPF6_DEBUG_NEIGHBOR (EVENT))
     zlog_debug ("Neighbor Event %s: *SeqNumberMismatch*", on->name);
 
-  ospf6_lsdb_remove_all (on->summary_list);
+  ospf6_summary_clear (on);
   ospf6_lsdb_remove_all (on->request_list);
   for (lsa = ospf6_lsdb_head (on->retrans_list); lsa;
        lsa = ospf6_lsdb_next (lsa))
@@ -784,7 +1167,7 @@ bad_lsreq (struct thread *thread)
   if (IS_OSPF6_DEBUG_NEIGHBOR (EVENT))
     zlog_debug ("Neighbor Event %s: *BadLSReq*", on->name);
 
-  ospf6_lsdb_remove_all (on->summary_list);
+  ospf6_summary_clear (on);
   ospf6_lsdb_remove_all (on->request_list);
   for (lsa = ospf6_lsdb_head (on->retrans_list); lsa;
        lsa = ospf6_lsdb_next (lsa))
@@ -817,7 +1200,7 @@ oneway_received (struct thread *thread)
   ospf6_neighbor_state_change (OSPF6_NEIGHBOR_INIT, on);
   thread_add_event (master, neighbor_change, on->ospf6_if, 0);
 
-  ospf6_lsdb_remove_all (on->summary_list);
+  ospf6_summary_clear (on);
   ospf6_lsdb_remove_all (on->request_list);
   for (lsa = ospf6_lsdb_head (on->retrans_list); lsa;
        lsa = ospf6_lsdb_next (lsa))
@@ -995,17 +1378,14 @@ ospf6_neighbor_show_detail (struct vty *vty, struct ospf6_neighbor *on)
             "Master" : "Slave"), (u_long) ntohl (on->dbdesc_seqnum),
            VNL);
 
-  vty_out (vty, "    Summary-List: %d LSAs%s", on->summary_list->count,
-           VNL);
-  for (lsa = ospf6_lsdb_head (on->summary_list); lsa;
-       lsa = ospf6_lsdb_next (lsa))
-    vty_out (vty, "      %s%s", lsa->name, VNL);
+  ospf6_summary_show (vty, on);
 
   vty_out (vty, "    Request-List: %d LSAs%s", on->request_list->count,
            VNL);
   for (lsa = ospf6_lsdb_head (on->request_list); lsa;
        lsa = ospf6_lsdb_next (lsa))
     vty_out (vty, "      %s%s", lsa->name, VNL);
+  ospf6_lsreq_window_show (vty, on);
 
   vty_out (vty, "    Retrans-List: %d LSAs%s", on->retrans_list->count,
            VNL);
@@ -36,6 +36,64 @@ extern unsigned char conf_debug_ospf6_neighbor;
 #define IS_OSPF6_DEBUG_NEIGHBOR(level) \
   (conf_debug_ospf6_neighbor & OSPF6_DEBUG_NEIGHBOR_ ## level)
 
+/* Database summary list (RFC 2328 10.3).  Instead of copying the
+   LSDBs when the exchange starts, the neighbor keeps a cursor over the
+   interface, area and AS LSDBs, which are described in that order. */
+#define OSPF6_SUMMARY_SCOPE_LINKLOCAL 0
+#define OSPF6_SUMMARY_SCOPE_AREA      1
+#define OSPF6_SUMMARY_SCOPE_AS        2
+#define OSPF6_SUMMARY_SCOPE_DONE      3
+struct ospf6_summary
+{
+  /* LSDB being described */
+  u_char scope;
+
+  /* next LSA to describe, locked; looked up again by key if the LSDB
+     version has changed since */
+  struct ospf6_lsa *lsa;
+  u_int32_t version;
+
+  /* headers described by the neighbor as at least as recent as ours,
+     in the order received; matching LSAs are not described */
+  struct list *skip;
+};
+
+/* Link state requests are pipelined: up to size LSReq packets may be
+   outstanding at once.  The window grows while the neighbor answers
+   as quickly as it did at best, and shrinks when it answers slower or
+   a request goes unanswered. */
+#define OSPF6_LSREQ_WINDOW_INITIAL 2
+#define OSPF6_LSREQ_WINDOW_MAX     8
+/* answers within twice the minimum response time plus this (msec)
+   open the window */
+#define OSPF6_LSREQ_RTT_SLACK     10
+struct ospf6_lsreq_window
+{
+  u_int size;
+  u_int outstanding;
+
+  /* packets sent at the same time are answered as one; matched with
+     requested LSAs by their originated time */
+  struct ospf6_lsreq_burst
+  {
+    struct timeval sent;
+    u_int packets;
+    u_int entries;
+  } burst[OSPF6_LSREQ_WINDOW_MAX];
+  u_int bursts;
+
+  /* response times per packet, msec */
+  long srtt;
+  long min_rtt;
+
+  /* last (or current) database synchronization */
+  struct timeval sync_start;
+  struct timeval sync_end;
+  u_int32_t sync_lsas;
+  u_int32_t sync_bytes;
+  u_int32_t sync_lost;
+};
+
 /* Neighbor structure */
 struct ospf6_neighbor
 {
@@ -78,7 +136,7 @@ struct ospf6_neighbor
   struct ospf6_dbdesc  dbdesc_last;
 
   /* LS-list */
-  struct ospf6_lsdb *summary_list;
+  struct ospf6_summary summary;
   struct ospf6_lsdb *request_list;
   struct ospf6_lsdb *retrans_list;
 
@@ -90,6 +148,7 @@ struct ospf6_neighbor
 
   /* Waiting to resend a link state request */
   bool request_retrans_wait;
+  struct ospf6_lsreq_window lsreq_window;
 
   /* Inactivity timer */
   struct thread *inactivity_timer;
@@ -308,6 +367,25 @@ extern int bad_lsreq (struct thread *);
 extern int oneway_received (struct thread *);
 extern int inactivity_timer (struct thread *);
 extern int need_adjacency (struct ospf6_neighbor *);
+extern void ospf6_summary_clear (struct ospf6_neighbor *on);
+extern struct ospf6_lsa *ospf6_summary_current (struct ospf6_neighbor *on);
+extern void ospf6_summary_advance (struct ospf6_neighbor *on);
+extern void ospf6_summary_skip (struct ospf6_neighbor *on,
+                                struct ospf6_lsa *his);
+extern void ospf6_lsreq_window_reset (struct ospf6_neighbor *on);
+extern u_int ospf6_lsreq_window_avail (struct ospf6_neighbor *on);
+extern void ospf6_lsreq_window_sent (struct ospf6_neighbor *on,
+                                     struct timeval *now, u_int packets,
+                                     u_int entries);
+extern void ospf6_lsreq_window_release (struct ospf6_neighbor *on,
+                                        struct ospf6_lsa *req);
+extern void ospf6_lsreq_answered (struct ospf6_neighbor *on,
+                                  struct ospf6_lsa *req,
+                                  struct ospf6_lsa *lsa);
+extern void ospf6_lsreq_add (struct ospf6_neighbor *on,
+                             struct ospf6_lsa *req);
+extern long ospf6_lsreq_window_expire (struct ospf6_neighbor *on,
+                                       struct timeval *now, long delay);
 extern void ospf6_neighbor_exstart (struct ospf6_neighbor *);
 
 extern void ospf6_neighbor_init (void);
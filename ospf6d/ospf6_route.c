@@ -44,7 +44,7 @@ unsigned char conf_debug_ospf6_route = 0;
 static char *
 ospf6_route_table_name (struct ospf6_route_table *table)
 {
-  static char name[32];
+  static OSPF6_THREAD_LOCAL char name[32];
   switch (table->scope_type)
     {
       case OSPF6_SCOPE_TYPE_GLOBAL:
@@ -761,14 +761,7 @@ ospf6_route_match_head (struct prefix *prefix,
   struct route_node *node;
   struct ospf6_route *route;
 
-  /* Walk down tree. */
-  node = table->table->top;
-  while (node && node->p.prefixlen < prefix->prefixlen &&
-	 prefix_match (&node->p, prefix))
-    node = node->link[prefix_bit(&prefix->u.prefix, node->p.prefixlen)];
-
-  if (node)
-    route_lock_node (node);
+  node = route_subtree_top (table->table, prefix);
   while (node && node->info == NULL)
     node = route_next (node);
   if (node == NULL)
@@ -1149,6 +1142,112 @@ ospf6_route_show_table (struct vty *vty, int detail,
     }
 }
 
+/* A walk over one of the tables of ospf6, showing it a chunk at a
+   time.  The table is found again for every chunk by its type, and the
+   place in it by the prefix of the next route to show. */
+struct ospf6_route_walk
+{
+  int table_type;
+  int detail;
+  u_char type;                  /* path type to show, or 0 for all */
+  int started;
+  struct prefix prefix;
+};
+
+static struct ospf6_route_table *
+ospf6_route_walk_table (struct ospf6_route_walk *walk)
+{
+  switch (walk->table_type)
+    {
+    case OSPF6_TABLE_TYPE_ROUTES:
+      return ospf6->route_table;
+    case OSPF6_TABLE_TYPE_BORDER_ROUTERS:
+      return ospf6->brouter_table;
+    case OSPF6_TABLE_TYPE_EXTERNAL_ROUTES:
+      return ospf6->external_table;
+    }
+  return NULL;
+}
+
+/* The first route of the first prefix not less than the given one. */
+static struct ospf6_route *
+ospf6_route_seek (struct prefix *prefix, struct ospf6_route_table *table)
+{
+  struct route_node *node;
+  struct ospf6_route *route;
+
+  /* a node created here is deleted again by route_next() */
+  node = route_node_get (table->table, prefix);
+  while (node && node->info == NULL)
+    node = route_next (node);
+  if (node == NULL)
+    return NULL;
+
+  route_unlock_node (node);
+  route = (struct ospf6_route *) node->info;
+  ospf6_route_lock (route);
+  return route;
+}
+
+static int
+ospf6_route_walk_output (struct vty *vty, void *arg)
+{
+  struct ospf6_route_walk *walk = arg;
+  struct ospf6_route_table *table;
+  struct ospf6_route *route;
+
+  table = ospf6_route_walk_table (walk);
+  if (table == NULL)
+    return 0;
+
+  if (walk->started)
+    route = ospf6_route_seek (&walk->prefix, table);
+  else
+    route = ospf6_route_head (table);
+  walk->started = 1;
+
+  for (; route; route = ospf6_route_next (route))
+    {
+      /* the routes to a prefix are shown together */
+      if ((route->prev == NULL || ! ospf6_route_is_same (route->prev, route))
+          && vty_output_full (vty))
+        {
+          walk->prefix = route->prefix;
+          ospf6_route_unlock (route);
+          return 1;
+        }
+
+      if (walk->type && route->path.type != walk->type)
+        continue;
+      if (walk->detail)
+        ospf6_route_show_detail (vty, route);
+      else
+        ospf6_route_show (vty, route);
+    }
+
+  return 0;
+}
+
+static void
+ospf6_route_walk_clean (void *arg)
+{
+  XFREE (MTYPE_VTY_OUTPUT, arg);
+}
+
+static void
+ospf6_route_walk_start (struct vty *vty, int detail, u_char type,
+                        struct ospf6_route_table *table)
+{
+  struct ospf6_route_walk *walk;
+
+  walk = XCALLOC (MTYPE_VTY_OUTPUT, sizeof (struct ospf6_route_walk));
+  walk->table_type = table->table_type;
+  walk->detail = detail;
+  walk->type = type;
+  vty_output_start (vty, ospf6_route_walk_output, ospf6_route_walk_clean,
+                    walk);
+}
+
 int
 ospf6_route_table_show (struct vty *vty, int argc, const char *argv[],
                         struct ospf6_route_table *table)
@@ -1240,8 +1339,11 @@ ospf6_route_table_show (struct vty *vty, int argc, const char *argv[],
       return CMD_SUCCESS;
     }
 
+  /* The tables of ospf6 itself are the large ones */
   if (match)
     ospf6_route_show_table_match (vty, detail, &prefix, table);
+  else if (table->scope_type == OSPF6_SCOPE_TYPE_GLOBAL)
+    ospf6_route_walk_start (vty, detail, type, table);
   else if (type)
     ospf6_route_show_table_type (vty, detail, type, table);
   else
@@ -502,8 +502,7 @@ ospfv3AreaLsdbEntry (struct variable *v, oid *name, size_t *length,
       return SNMP_INTEGER (lsa->header->seqnum);
       break;
     case OSPFv3AREALSDBAGE:           /* 6 */
-      ospf6_lsa_age_current (lsa);
-      return SNMP_INTEGER (lsa->header->age);
+      return SNMP_INTEGER (ospf6_lsa_age_current (lsa));
       break;
     case OSPFv3AREALSDBCHECKSUM:      /* 7 */
       return SNMP_INTEGER (lsa->header->checksum);
@@ -23,6 +23,11 @@
 
 #include <zebra.h>
 
+#ifdef HAVE_PTHREADS
+#include <pthread.h>
+#endif /* HAVE_PTHREADS */
+
+
 #include "log.h"
 #include "memory.h"
 #include "command.h"
@@ -36,6 +41,7 @@
 #include "ospf6_lsdb.h"
 #include "ospf6_route.h"
 #include "ospf6_area.h"
+#include "ospf6_top.h"
 #include "ospf6_spf.h"
 #include "ospf6_intra.h"
 #include "ospf6_interface.h"
@@ -850,37 +856,30 @@ ospf6_spf_log_database (struct ospf6_area *oa)
   zlog_debug ("%s", buffer);
 }
 
-static int
-ospf6_spf_calculation_thread (struct thread *t)
+/* Everything after the SPF tree itself: intra-area routes, border
+   routers (and through the route table hooks, inter-area and external
+   routes), which must run in the main thread. */
+static void
+ospf6_spf_calculation_finish (struct ospf6_area *oa, struct timeval *runtime)
 {
-  struct ospf6_area *oa;
-  struct timeval start, end, runtime;
   struct listnode *node;
   struct ospf6_interface *oi;
+  unsigned long usec;
   int change;
 
-  oa = (struct ospf6_area *) THREAD_ARG (t);
-  oa->thread_spf_calculation = NULL;
-
-  if (IS_OSPF6_DEBUG_SPF (PROCESS))
-    zlog_debug ("SPF calculation for Area %s", oa->name);
-  if (IS_OSPF6_DEBUG_SPF (DATABASE))
-    ospf6_spf_log_database (oa);
-
-  /* execute SPF calculation */
-  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
-  ospf6_spf_calculation (oa->ospf6->router_id, oa->spf_table, oa);
-  quagga_gettime (QUAGGA_CLK_MONOTONIC, &end);
-  timersub (&end, &start, &runtime);
-
   if (IS_OSPF6_DEBUG_SPF (PROCESS) || IS_OSPF6_DEBUG_SPF (TIME))
     zlog_debug ("SPF runtime: %ld sec %ld usec",
-		runtime.tv_sec, runtime.tv_usec);
+		runtime->tv_sec, runtime->tv_usec);
 
   ospf6_intra_route_calculation (oa);
   ospf6_intra_brouter_calculation (oa);
 
   quagga_gettime (QUAGGA_CLK_MONOTONIC, &oa->last_spftime);
+  oa->spf_count++;
+  usec = runtime->tv_sec * 1000000UL + runtime->tv_usec;
+  oa->spf_usec += usec;
+  if (usec > oa->spf_usec_max)
+    oa->spf_usec_max = usec;
 
   change = 0;
   for (ALL_LIST_ELEMENTS_RO (oa->if_list, node, oi))
@@ -897,10 +896,280 @@ ospf6_spf_calculation_thread (struct thread *t)
   // rerun spf if the set of routable neighbors has changed
   if (change)
     {
+      oa->spf_count++;
       ospf6_spf_calculation (oa->ospf6->router_id, oa->spf_table, oa);
       ospf6_intra_route_calculation (oa);
       ospf6_intra_brouter_calculation (oa);
     }
+}
+
+static void
+ospf6_spf_calculation_start (struct ospf6_area *oa)
+{
+  if (IS_OSPF6_DEBUG_SPF (PROCESS))
+    zlog_debug ("SPF calculation for Area %s", oa->name);
+  if (IS_OSPF6_DEBUG_SPF (DATABASE))
+    ospf6_spf_log_database (oa);
+}
+
+/* A set of areas whose SPF trees are calculated together.  The trees
+   of different areas are independent: the calculation only reads the
+   area's LSDBs, interfaces and neighbors and only writes the area's
+   spf_table, so each area can be given to a different thread. */
+struct ospf6_spf_batch
+{
+  u_int32_t router_id;
+  struct ospf6_area **areas;
+  struct timeval *runtime;
+  unsigned int count;
+
+  /* next area to be picked up by a worker, and areas done */
+  unsigned int next;
+  unsigned int done;
+};
+
+/* The time of a worker thread.  quagga_gettime() updates the
+   library's relative time, which the main thread reads at any moment,
+   so the workers keep their times to themselves. */
+static void
+ospf6_spf_batch_gettime (struct timeval *tv)
+{
+#ifdef HAVE_CLOCK_MONOTONIC
+  struct timespec tp;
+
+  clock_gettime (CLOCK_MONOTONIC, &tp);
+  tv->tv_sec = tp.tv_sec;
+  tv->tv_usec = tp.tv_nsec / 1000;
+#else /* !HAVE_CLOCK_MONOTONIC */
+  gettimeofday (tv, NULL);
+#endif /* HAVE_CLOCK_MONOTONIC */
+}
+
+static void
+ospf6_spf_batch_calculate (struct ospf6_spf_batch *batch, unsigned int i)
+{
+  struct timeval start, end;
+
+  ospf6_spf_batch_gettime (&start);
+  ospf6_spf_calculation (batch->router_id, batch->areas[i]->spf_table,
+                         batch->areas[i]);
+  ospf6_spf_batch_gettime (&end);
+  timersub (&end, &start, &batch->runtime[i]);
+}
+
+#ifdef HAVE_PTHREADS
+/* The worker threads are started the first time they are needed and
+   then wait for the next batch.  The first "helpers" workers take part
+   in a batch, picking up its areas with the calling thread until none
+   is left. */
+static struct
+{
+  pthread_mutex_t mutex;
+  pthread_cond_t work;
+  pthread_cond_t done;
+
+  unsigned int threads;		/* workers started */
+  struct ospf6_spf_batch *batch;
+  unsigned int helpers;		/* workers taking part in the batch */
+} ospf6_spf_pool =
+{
+  PTHREAD_MUTEX_INITIALIZER,
+  PTHREAD_COND_INITIALIZER,
+  PTHREAD_COND_INITIALIZER,
+};
+
+/* Calculate areas of the batch until none is left; called with the
+   pool mutex held. */
+static void
+ospf6_spf_batch_run (struct ospf6_spf_batch *batch)
+{
+  unsigned int i;
+
+  while ((i = batch->next) < batch->count)
+    {
+      batch->next++;
+      pthread_mutex_unlock (&ospf6_spf_pool.mutex);
+      ospf6_spf_batch_calculate (batch, i);
+      pthread_mutex_lock (&ospf6_spf_pool.mutex);
+
+      if (++batch->done == batch->count)
+        pthread_cond_signal (&ospf6_spf_pool.done);
+    }
+}
+
+static void *
+ospf6_spf_worker (void *arg)
+{
+  unsigned int index = (unsigned long) arg;
+  struct ospf6_spf_batch *batch;
+
+  pthread_mutex_lock (&ospf6_spf_pool.mutex);
+  for (;;)
+    {
+      batch = ospf6_spf_pool.batch;
+      if (batch && batch->next < batch->count &&
+          index < ospf6_spf_pool.helpers)
+        ospf6_spf_batch_run (batch);
+      else
+        pthread_cond_wait (&ospf6_spf_pool.work, &ospf6_spf_pool.mutex);
+    }
+
+  return NULL;
+}
+
+/* Start workers until there are at least count of them. */
+static unsigned int
+ospf6_spf_pool_grow (unsigned int count)
+{
+  pthread_t tid;
+  sigset_t mask, oldmask;
+
+  /* signals are left to the main thread */
+  sigfillset (&mask);
+  pthread_sigmask (SIG_BLOCK, &mask, &oldmask);
+
+  while (ospf6_spf_pool.threads < count)
+    {
+      if (pthread_create (&tid, NULL, ospf6_spf_worker,
+                          (void *) (unsigned long) ospf6_spf_pool.threads))
+        {
+          zlog_warn ("%s: pthread_create() failed: %s",
+                     __func__, safe_strerror (errno));
+          break;
+        }
+      pthread_detach (tid);
+      ospf6_spf_pool.threads++;
+    }
+
+  pthread_sigmask (SIG_SETMASK, &oldmask, NULL);
+
+  return ospf6_spf_pool.threads;
+}
+#endif /* HAVE_PTHREADS */
+
+/* Calculate the SPF trees of the given areas, using up to workers
+   threads (the calling thread included), and store the time each took
+   in runtime[].  Only the trees are calculated; routes are left to
+   the caller.  Debugging output is not thread safe, so everything is
+   done in the calling thread while SPF or route debugging is on. */
+void
+ospf6_spf_calculation_areas (u_int32_t router_id, struct ospf6_area **areas,
+                             struct timeval *runtime, unsigned int count,
+                             unsigned int workers)
+{
+  struct ospf6_spf_batch batch;
+  unsigned int i;
+
+  memset (&batch, 0, sizeof (batch));
+  batch.router_id = router_id;
+  batch.areas = areas;
+  batch.runtime = runtime;
+  batch.count = count;
+
+  if (conf_debug_ospf6_spf || conf_debug_ospf6_route)
+    workers = 1;
+  if (workers > count)
+    workers = count;
+
+#ifdef HAVE_PTHREADS
+  if (workers > 1)
+    {
+      unsigned int helpers;
+
+      if (workers > OSPF6_SPF_WORKERS_MAX)
+        workers = OSPF6_SPF_WORKERS_MAX;
+
+      /* the calling thread is one of the workers */
+      helpers = MIN (workers - 1, ospf6_spf_pool_grow (workers - 1));
+
+      pthread_mutex_lock (&ospf6_spf_pool.mutex);
+      ospf6_spf_pool.batch = &batch;
+      ospf6_spf_pool.helpers = helpers;
+      pthread_cond_broadcast (&ospf6_spf_pool.work);
+
+      ospf6_spf_batch_run (&batch);
+
+      while (batch.done < batch.count)
+        pthread_cond_wait (&ospf6_spf_pool.done, &ospf6_spf_pool.mutex);
+      ospf6_spf_pool.batch = NULL;
+      pthread_mutex_unlock (&ospf6_spf_pool.mutex);
+      return;
+    }
+#endif /* HAVE_PTHREADS */
+
+  for (i = 0; i < count; i++)
+    ospf6_spf_batch_calculate (&batch, i);
+}
+
+/* Calculate all areas whose SPF timer has expired since the batch was
+   scheduled, then their routes one area at a time. */
+static int
+ospf6_spf_areas_thread (struct thread *t)
+{
+  struct ospf6 *o;
+  struct ospf6_area *oa, **areas;
+  struct timeval *runtime;
+  struct listnode *node;
+  unsigned int count, i;
+
+  o = (struct ospf6 *) THREAD_ARG (t);
+  o->thread_spf_areas = NULL;
+
+  areas = XCALLOC (MTYPE_TMP, listcount (o->area_list) * sizeof (*areas));
+  runtime = XCALLOC (MTYPE_TMP, listcount (o->area_list) * sizeof (*runtime));
+
+  count = 0;
+  for (ALL_LIST_ELEMENTS_RO (o->area_list, node, oa))
+    {
+      if (! oa->spf_pending)
+        continue;
+
+      oa->spf_pending = 0;
+      ospf6_spf_calculation_start (oa);
+      areas[count++] = oa;
+    }
+
+  ospf6_spf_calculation_areas (o->router_id, areas, runtime, count,
+                               o->spf_workers);
+
+  for (i = 0; i < count; i++)
+    ospf6_spf_calculation_finish (areas[i], &runtime[i]);
+
+  XFREE (MTYPE_TMP, areas);
+  XFREE (MTYPE_TMP, runtime);
+
+  return 0;
+}
+
+static int
+ospf6_spf_calculation_thread (struct thread *t)
+{
+  struct ospf6_area *oa;
+  struct timeval start, end, runtime;
+
+  oa = (struct ospf6_area *) THREAD_ARG (t);
+  oa->thread_spf_calculation = NULL;
+
+  /* Collect the areas whose timers expire in the same pass of the
+     event loop and calculate them together. */
+  if (oa->ospf6->spf_workers > 1)
+    {
+      oa->spf_pending = 1;
+      if (oa->ospf6->thread_spf_areas == NULL)
+        oa->ospf6->thread_spf_areas =
+          thread_add_event (master, ospf6_spf_areas_thread, oa->ospf6, 0);
+      return 0;
+    }
+
+  ospf6_spf_calculation_start (oa);
+
+  /* execute SPF calculation */
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  ospf6_spf_calculation (oa->ospf6->router_id, oa->spf_table, oa);
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &end);
+  timersub (&end, &start, &runtime);
+
+  ospf6_spf_calculation_finish (oa, &runtime);
 
   return 0;
 }
@@ -911,7 +1180,7 @@ ospf6_spf_schedule (struct ospf6_area *oa)
   struct timeval now, *since;
   long delay_msec;
 
-  if (oa->thread_spf_calculation)
+  if (oa->thread_spf_calculation || oa->spf_pending)
     return;
 
   if (timerisset (&oa->last_spftime))
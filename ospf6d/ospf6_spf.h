@@ -83,6 +83,11 @@ extern void ospf6_spf_table_finish (struct ospf6_route_table *result_table);
 extern void ospf6_spf_calculation (u_int32_t router_id,
                                    struct ospf6_route_table *result_table,
                                    struct ospf6_area *oa);
+extern void ospf6_spf_calculation_areas (u_int32_t router_id,
+                                         struct ospf6_area **areas,
+                                         struct timeval *runtime,
+                                         unsigned int count,
+                                         unsigned int workers);
 extern void ospf6_spf_schedule (struct ospf6_area *oa);
 
 extern void ospf6_spf_display_subtree (struct vty *vty, const char *prefix,
@@ -167,6 +167,8 @@ ospf6_create (void)
 
   o->auto_cost_reference_bandwidth = OSPF6_AUTO_COST_REFERENCE_BANDWIDTH;
 
+  o->spf_workers = OSPF6_SPF_WORKERS_DEFAULT;
+
   SET_FLAG (o->flag, OSPF6_DISABLED);
 
   return o;
@@ -228,7 +230,9 @@ ospf6_disable (struct ospf6 *o)
       SET_FLAG (o->flag, OSPF6_DISABLED);
 
       ospf6_asbr_redistribute_disable (o);
-      
+
+      THREAD_OFF (o->thread_spf_areas);
+
       for (ALL_LIST_ELEMENTS (o->area_list, node, nnode, oa))
         ospf6_area_disable (oa);
 
@@ -768,6 +772,40 @@ DEFUN (no_ospf6_auto_cost_reference_bandwidth,
   return CMD_SUCCESS;
 }
 
+#ifdef HAVE_PTHREADS
+DEFUN (ospf6_spf_worker_threads,
+       ospf6_spf_worker_threads_cmd,
+       "spf worker-threads <1-64>",
+       "SPF calculation\n"
+       "Calculate the SPF trees of different areas in parallel\n"
+       "Number of threads (1 calculates one area at a time)\n")
+{
+  struct ospf6 *o;
+
+  o = (struct ospf6 *) vty->index;
+
+  o->spf_workers = strtoul (argv[0], NULL, 10);
+
+  return CMD_SUCCESS;
+}
+
+DEFUN (no_ospf6_spf_worker_threads,
+       no_ospf6_spf_worker_threads_cmd,
+       "no spf worker-threads",
+       NO_STR
+       "SPF calculation\n"
+       "Calculate the SPF trees of different areas in parallel\n")
+{
+  struct ospf6 *o;
+
+  o = (struct ospf6 *) vty->index;
+
+  o->spf_workers = OSPF6_SPF_WORKERS_DEFAULT;
+
+  return CMD_SUCCESS;
+}
+#endif /* HAVE_PTHREADS */
+
 static void
 ospf6_show (struct vty *vty, struct ospf6 *o)
 {
@@ -796,6 +834,10 @@ ospf6_show (struct vty *vty, struct ospf6 *o)
   /* Redistribute configuration */
   /* XXX */
 
+  if (o->spf_workers > 1)
+    vty_out (vty, " Area SPF trees calculated by up to %u threads%s",
+             o->spf_workers, VNL);
+
   /* LSAs */
   vty_out (vty, " Number of AS scoped LSAs is %u%s",
            o->lsdb->count, VNL);
@@ -1001,6 +1043,8 @@ config_write_ospf6 (struct vty *vty)
       OSPF6_AUTO_COST_REFERENCE_BANDWIDTH)
     vty_out (vty, " auto-cost reference-bandwidth %u%s",
              ospf6->auto_cost_reference_bandwidth, VNL);
+  if (ospf6->spf_workers != OSPF6_SPF_WORKERS_DEFAULT)
+    vty_out (vty, " spf worker-threads %u%s", ospf6->spf_workers, VNL);
 
   if (ospf6->min_lsa_arrival != MIN_LS_ARRIVAL)
     vty_out (vty, " min-lsa-arrival %u%s", ospf6->min_lsa_arrival, VNL);
@@ -1072,4 +1116,8 @@ ospf6_top_init (void)
   install_element (OSPF6_NODE, &no_ospf6_mdr_tlv_interoperability_cmd);
   install_element (OSPF6_NODE, &ospf6_auto_cost_reference_bandwidth_cmd);
   install_element (OSPF6_NODE, &no_ospf6_auto_cost_reference_bandwidth_cmd);
+#ifdef HAVE_PTHREADS
+  install_element (OSPF6_NODE, &ospf6_spf_worker_threads_cmd);
+  install_element (OSPF6_NODE, &no_ospf6_spf_worker_threads_cmd);
+#endif /* HAVE_PTHREADS */
 }
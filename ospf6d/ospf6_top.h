@@ -78,12 +78,18 @@ struct ospf6
   bool mdr_tlv_interop;
 
   unsigned int auto_cost_reference_bandwidth; /* mbps */
+
+  /* number of threads calculating area SPF trees, 1 if sequential */
+  unsigned int spf_workers;
+  struct thread *thread_spf_areas;
 };
 
 #define OSPF6_DISABLED    0x01
 
 #define OSPF6_INSTANCE_ID 0
 #define OSPF6_AUTO_COST_REFERENCE_BANDWIDTH 100
+#define OSPF6_SPF_WORKERS_DEFAULT 1
+#define OSPF6_SPF_WORKERS_MAX 64
 
 /* global pointer for OSPF top data structure */
 extern struct ospf6 *ospf6;
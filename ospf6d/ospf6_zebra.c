@@ -123,7 +123,7 @@ ospf6_zebra_if_del (int command, struct zclient *zclient, zebra_size_t length)
 
   ospf6_interface_if_del (ifp);
 
-  ifp->ifindex = IFINDEX_INTERNAL;
+  if_set_index (ifp, IFINDEX_INTERNAL);
 
   if (if_is_transient (ifp))
     if_delete (ifp);
@@ -761,6 +761,9 @@ ospf6_zebra_init (void)
   zclient->linkmetrics_subscribe = 1; /* XXX this could be made configurable */
   zclient->linkmetrics = ospf6_zebra_linkmetrics;
   zclient->linkstatus = ospf6_zebra_linkstatus;
+  zclient->linkmetrics_batch = ospf6_zebra_linkmetrics_batch;
+  /* read redistributed routes from the RIB zebra exports, if it does */
+  zclient->rib_shm_subscribe = 1;
 
   /* redistribute connected route by default */
   /* ospf6_zebra_redistribute (ZEBRA_ROUTE_CONNECT); */
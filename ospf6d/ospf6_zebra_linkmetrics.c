@@ -152,43 +152,26 @@ ospf6_neighbor_lookup_by_ifaddr (struct in6_addr *linklocal_addr,
   return NULL;
 }
 
-int
-ospf6_zebra_linkmetrics (int command, struct zclient *zclient,
-			 zebra_size_t length)
+static int
+ospf6_linkmetrics_apply (struct zebra_linkmetrics *metrics,
+                         struct ospf6_interface *oi)
 {
-  struct zebra_linkmetrics metrics;
-  struct ospf6_interface *oi;
   struct ospf6_neighbor *on;
 
-  assert (command == ZEBRA_LINKMETRICS_METRICS);
-
-  if (zapi_read_linkmetrics (&metrics, zclient->ibuf, length))
-    {
-      zlog_err ("%s: zapi_read_linkmetrics() failed", __func__);
-      return -1;
-    }
-
-  if (IS_OSPF6_DEBUG_ZEBRA (RECV))
-    {
-      zlog_debug ("%s: received link metrics update", __func__);
-      zebra_linkmetrics_logdebug (&metrics);
-    }
-
-  oi = ospf6_interface_lookup_by_ifindex (metrics.ifindex);
   if (oi == NULL)
     {
       zlog_err ("%s: unknown interface index: %d",
-		__func__, metrics.ifindex);
+		__func__, metrics->ifindex);
       return -1;
     }
 
-  on = ospf6_neighbor_lookup_by_ifaddr (&metrics.nbr_addr6, oi);
+  on = ospf6_neighbor_lookup_by_ifaddr (&metrics->nbr_addr6, oi);
   if (on == NULL)
     {
       if (IS_OSPF6_DEBUG_ZEBRA (RECV))
 	{
 	  char lladdrstr[INET6_ADDRSTRLEN];
-	  ospf6_addr2str6 (&metrics.nbr_addr6,
+	  ospf6_addr2str6 (&metrics->nbr_addr6,
 			   lladdrstr, sizeof (lladdrstr));
           zlog_debug ("%s: neighbor %s not found for link metrics update "
                       "on interface %s",
@@ -197,18 +180,73 @@ ospf6_zebra_linkmetrics (int command, struct zclient *zclient,
       return -1;
     }
 
-  ospf6_zebra_update_linkmetrics (on, &metrics);
+  ospf6_zebra_update_linkmetrics (on, metrics);
+
+  return 0;
+}
+
+static int
+ospf6_linkstatus_apply (struct zebra_linkstatus *status,
+                        struct ospf6_interface *oi)
+{
+  struct ospf6_neighbor *on;
+
+  if (oi == NULL)
+    {
+      zlog_err ("%s: unknown interface index: %d",
+		__func__, status->ifindex);
+      return -1;
+    }
+
+  /* neighbor can be unknown only for STATUS_UP events */
+  on = ospf6_neighbor_lookup_by_ifaddr (&status->nbr_addr6, oi);
+  if (on == NULL && status->status != LM_STATUS_UP)
+    {
+      char lladdrstr[INET6_ADDRSTRLEN];
+
+      ospf6_addr2str6 (&status->nbr_addr6,
+                       lladdrstr, sizeof (lladdrstr));
+      zlog_debug ("%s: neighbor %s not found for link status %s update "
+                  "on interface %s", __func__, lladdrstr,
+                  status->status ? "up" : "down",  oi->interface->name);
+      return -1;
+    }
+
+  ospf6_run_linkstatus_hooks (oi, on, status);
 
   return 0;
 }
 
+int
+ospf6_zebra_linkmetrics (int command, struct zclient *zclient,
+			 zebra_size_t length)
+{
+  struct zebra_linkmetrics metrics;
+
+  assert (command == ZEBRA_LINKMETRICS_METRICS);
+
+  if (zapi_read_linkmetrics (&metrics, zclient->ibuf, length))
+    {
+      zlog_err ("%s: zapi_read_linkmetrics() failed", __func__);
+      return -1;
+    }
+
+  if (IS_OSPF6_DEBUG_ZEBRA (RECV))
+    {
+      zlog_debug ("%s: received link metrics update", __func__);
+      zebra_linkmetrics_logdebug (&metrics);
+    }
+
+  return ospf6_linkmetrics_apply (&metrics,
+                                  ospf6_interface_lookup_by_ifindex
+                                  (metrics.ifindex));
+}
+
 int
 ospf6_zebra_linkstatus (int command, struct zclient *zclient,
 			zebra_size_t length)
 {
   struct zebra_linkstatus status;
-  struct ospf6_interface *oi;
-  struct ospf6_neighbor *on;
 
   assert (command == ZEBRA_LINKMETRICS_STATUS);
 
@@ -224,29 +262,70 @@ ospf6_zebra_linkstatus (int command, struct zclient *zclient,
       zebra_linkstatus_logdebug (&status);
     }
 
-  oi = ospf6_interface_lookup_by_ifindex (status.ifindex);
-  if (oi == NULL)
+  return ospf6_linkstatus_apply (&status,
+                                 ospf6_interface_lookup_by_ifindex
+                                 (status.ifindex));
+}
+
+/* Apply a batch of link metrics and link status updates in order,
+   looking the interface up once for each run of updates about it. */
+int
+ospf6_zebra_linkmetrics_batch (int command, struct zclient *zclient,
+			       zebra_size_t length)
+{
+  struct zebra_linkmetrics metrics;
+  struct zebra_linkstatus status;
+  struct ospf6_interface *oi = NULL;
+  u_int32_t ifindex = 0;
+  u_short remain = length;
+  int count, type;
+
+  assert (command == ZEBRA_LINKMETRICS_BATCH);
+
+  count = zapi_read_linkmetrics_batch (zclient->ibuf, &remain);
+  if (count < 0)
     {
-      zlog_err ("%s: unknown interface index: %d",
-		__func__, status.ifindex);
+      zlog_err ("%s: zapi_read_linkmetrics_batch() failed", __func__);
       return -1;
     }
 
-  /* neighbor can be unknown only for STATUS_UP events */
-  on = ospf6_neighbor_lookup_by_ifaddr (&status.nbr_addr6, oi);
-  if (on == NULL && status.status != LM_STATUS_UP)
+  if (IS_OSPF6_DEBUG_ZEBRA (RECV))
+    zlog_debug ("%s: received %d link updates", __func__, count);
+
+  for (; count > 0; count--)
     {
-      char lladdrstr[INET6_ADDRSTRLEN];
+      type = zapi_read_linkmetrics_batch_entry (&metrics, &status,
+                                                zclient->ibuf, &remain);
+      if (type < 0)
+        {
+          zlog_err ("%s: zapi_read_linkmetrics_batch_entry() failed",
+                    __func__);
+          return -1;
+        }
 
-      ospf6_addr2str6 (&status.nbr_addr6,
-                       lladdrstr, sizeof (lladdrstr));
-      zlog_debug ("%s: neighbor %s not found for link status %s update "
-                  "on interface %s", __func__, lladdrstr,
-                  status.status ? "up" : "down",  oi->interface->name);
-      return -1;
+      if (type == ZEBRA_LINKMETRICS_METRICS)
+        {
+          if (IS_OSPF6_DEBUG_ZEBRA (RECV))
+            zebra_linkmetrics_logdebug (&metrics);
+          if (oi == NULL || metrics.ifindex != ifindex)
+            {
+              ifindex = metrics.ifindex;
+              oi = ospf6_interface_lookup_by_ifindex (ifindex);
+            }
+          ospf6_linkmetrics_apply (&metrics, oi);
+        }
+      else
+        {
+          if (IS_OSPF6_DEBUG_ZEBRA (RECV))
+            zebra_linkstatus_logdebug (&status);
+          if (oi == NULL || status.ifindex != ifindex)
+            {
+              ifindex = status.ifindex;
+              oi = ospf6_interface_lookup_by_ifindex (ifindex);
+            }
+          ospf6_linkstatus_apply (&status, oi);
+        }
     }
 
-  ospf6_run_linkstatus_hooks (oi, on, &status);
-
   return 0;
 }
@@ -46,6 +46,8 @@ int ospf6_zebra_linkmetrics (int command, struct zclient *zclient,
 			     zebra_size_t length);
 int ospf6_zebra_linkstatus (int command, struct zclient *zclient,
 			    zebra_size_t length);
+int ospf6_zebra_linkmetrics_batch (int command, struct zclient *zclient,
+				   zebra_size_t length);
 
 void ospf6_zebra_update_linkmetrics (struct ospf6_neighbor *on,
 				     struct zebra_linkmetrics *linkmetrics);
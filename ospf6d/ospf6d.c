@@ -23,8 +23,10 @@
 
 #include "thread.h"
 #include "linklist.h"
+#include "memory.h"
 #include "vty.h"
 #include "command.h"
+#include "telemetry.h"
 
 #include "ospf6_proto.h"
 #include "ospf6_network.h"
@@ -50,34 +52,6 @@
 #endif /*HAVE_SNMP*/
 
 char ospf6_daemon_version[] = OSPF6_DAEMON_VERSION;
-
-struct route_node *
-route_prev (struct route_node *node)
-{
-  struct route_node *end;
-  struct route_node *prev = NULL;
-
-  end = node;
-  node = node->parent;
-  if (node)
-    route_lock_node (node);
-  while (node)
-    {
-      prev = node;
-      node = route_next (node);
-      if (node == end)
-        {
-          route_unlock_node (node);
-          node = NULL;
-        }
-    }
-  route_unlock_node (end);
-  if (prev)
-    route_lock_node (prev);
-
-  return prev;
-}
-
 
 /* show database functions */
 DEFUN (show_version_ospf6,
@@ -165,45 +139,171 @@ parse_type_spec (int argc, const char *argv[])
   return type;
 }
 
-DEFUN (show_ipv6_ospf6_database,
-       show_ipv6_ospf6_database_cmd,
-       "show ipv6 ospf6 database",
-       SHOW_STR
-       IPV6_STR
-       OSPF6_STR
-       "Display Link state database\n"
-      )
+/* A walk over all of the lsdbs, area scoped ones first, then those of
+   interfaces, then the AS scoped one, showing them a chunk at a time.
+   Areas and interfaces are ordered by their ids, and found again by
+   them for every chunk, in case they have gone meanwhile. */
+struct ospf6_database_walk
 {
   int level;
+  u_int16_t scope;
+  u_int32_t area_id;            /* host byte order */
+  unsigned int ifindex;
+  int after;                    /* done with the lsdb of the ids above */
+  int title;                    /* the title of that lsdb is out */
+  struct ospf6_lsa *lsa;        /* locked, where to carry on from */
+};
+
+static struct ospf6_area *
+ospf6_database_walk_area (struct ospf6_database_walk *walk)
+{
+  struct listnode *node;
+  struct ospf6_area *oa;
+
+  for (ALL_LIST_ELEMENTS_RO (ospf6->area_list, node, oa))
+    if (ntohl (oa->area_id) > walk->area_id ||
+        (! walk->after && ntohl (oa->area_id) == walk->area_id))
+      return oa;
+  return NULL;
+}
+
+static struct ospf6_interface *
+ospf6_database_walk_interface (struct ospf6_database_walk *walk)
+{
   struct listnode *i, *j;
-  struct ospf6 *o = ospf6;
   struct ospf6_area *oa;
-  struct ospf6_interface *oi;
+  struct ospf6_interface *oi, *first;
+  unsigned int ifindex;
 
-  OSPF6_CMD_CHECK_RUNNING ();
+  for (ALL_LIST_ELEMENTS_RO (ospf6->area_list, i, oa))
+    {
+      if (ntohl (oa->area_id) < walk->area_id)
+        continue;
 
-  level = parse_show_level (argc, argv);
+      first = NULL;
+      for (ALL_LIST_ELEMENTS_RO (oa->if_list, j, oi))
+        {
+          ifindex = oi->interface->ifindex;
+          if (ntohl (oa->area_id) == walk->area_id &&
+              (ifindex < walk->ifindex ||
+               (walk->after && ifindex == walk->ifindex)))
+            continue;
+          if (first == NULL || ifindex < first->interface->ifindex)
+            first = oi;
+        }
+      if (first)
+        return first;
+    }
+  return NULL;
+}
 
-  for (ALL_LIST_ELEMENTS_RO (o->area_list, i, oa))
+/* Move on to the lsdb of the given ids, starting it afresh unless it
+   is the one being shown. */
+static void
+ospf6_database_walk_move (struct ospf6_database_walk *walk,
+                          u_int32_t area_id, unsigned int ifindex)
+{
+  if (walk->after || area_id != walk->area_id || ifindex != walk->ifindex)
     {
-      vty_out (vty, AREA_LSDB_TITLE_FORMAT, VNL, oa->name, VNL, VNL);
-      ospf6_lsdb_show (vty, level, NULL, NULL, NULL, oa->lsdb);
+      if (walk->lsa)
+        ospf6_lsa_unlock (walk->lsa);
+      walk->lsa = NULL;
+      walk->title = 0;
     }
+  walk->area_id = area_id;
+  walk->ifindex = ifindex;
+  walk->after = 0;
+}
 
-  for (ALL_LIST_ELEMENTS_RO (o->area_list, i, oa))
+static int
+ospf6_database_walk_output (struct vty *vty, void *arg)
+{
+  struct ospf6_database_walk *walk = arg;
+  struct ospf6_area *oa;
+  struct ospf6_interface *oi;
+  struct ospf6_lsdb *lsdb;
+
+  while (! vty_output_full (vty))
     {
-      for (ALL_LIST_ELEMENTS_RO (oa->if_list, j, oi))
+      switch (walk->scope)
         {
-          vty_out (vty, IF_LSDB_TITLE_FORMAT, VNL,
-                   oi->interface->name, oa->name, VNL, VNL);
-          ospf6_lsdb_show (vty, level, NULL, NULL, NULL, oi->lsdb);
+        case OSPF6_SCOPE_AREA:
+          if ((oa = ospf6_database_walk_area (walk)) == NULL)
+            {
+              ospf6_database_walk_move (walk, 0, 0);
+              walk->scope = OSPF6_SCOPE_LINKLOCAL;
+              continue;
+            }
+          ospf6_database_walk_move (walk, ntohl (oa->area_id), 0);
+          if (! walk->title)
+            vty_out (vty, AREA_LSDB_TITLE_FORMAT, VNL, oa->name, VNL, VNL);
+          lsdb = oa->lsdb;
+          break;
+
+        case OSPF6_SCOPE_LINKLOCAL:
+          if ((oi = ospf6_database_walk_interface (walk)) == NULL)
+            {
+              ospf6_database_walk_move (walk, 0, 0);
+              walk->scope = OSPF6_SCOPE_AS;
+              continue;
+            }
+          ospf6_database_walk_move (walk, ntohl (oi->area->area_id),
+                                    oi->interface->ifindex);
+          if (! walk->title)
+            vty_out (vty, IF_LSDB_TITLE_FORMAT, VNL,
+                     oi->interface->name, oi->area->name, VNL, VNL);
+          lsdb = oi->lsdb;
+          break;
+
+        default:
+          if (walk->after)
+            {
+              vty_out (vty, "%s", VNL);
+              return 0;
+            }
+          if (! walk->title)
+            vty_out (vty, AS_LSDB_TITLE_FORMAT, VNL, VNL, VNL);
+          lsdb = ospf6->lsdb;
+          break;
         }
+
+      walk->title = 1;
+      walk->lsa = ospf6_lsdb_show_chunk (vty, walk->level, walk->lsa, lsdb);
+      if (walk->lsa == NULL)
+        walk->after = 1;
     }
 
-  vty_out (vty, AS_LSDB_TITLE_FORMAT, VNL, VNL, VNL);
-  ospf6_lsdb_show (vty, level, NULL, NULL, NULL, o->lsdb);
+  return 1;
+}
 
-  vty_out (vty, "%s", VNL);
+static void
+ospf6_database_walk_clean (void *arg)
+{
+  struct ospf6_database_walk *walk = arg;
+
+  if (walk->lsa)
+    ospf6_lsa_unlock (walk->lsa);
+  XFREE (MTYPE_VTY_OUTPUT, walk);
+}
+
+DEFUN (show_ipv6_ospf6_database,
+       show_ipv6_ospf6_database_cmd,
+       "show ipv6 ospf6 database",
+       SHOW_STR
+       IPV6_STR
+       OSPF6_STR
+       "Display Link state database\n"
+      )
+{
+  struct ospf6_database_walk *walk;
+
+  OSPF6_CMD_CHECK_RUNNING ();
+
+  walk = XCALLOC (MTYPE_VTY_OUTPUT, sizeof (struct ospf6_database_walk));
+  walk->level = parse_show_level (argc, argv);
+  walk->scope = OSPF6_SCOPE_AREA;
+  vty_output_start (vty, ospf6_database_walk_output, ospf6_database_walk_clean,
+                    walk);
   return CMD_SUCCESS;
 }
 
@@ -1875,6 +1975,75 @@ DEFUN (show_ipv6_ospf6_linkstate_detail,
   return CMD_SUCCESS;
 }
 
+static void
+ospf6_telemetry_messages (struct telemetry *t, const char *dir,
+                          struct ospf6_message_stats *stats)
+{
+  static const char *names[OSPF6_MESSAGE_TYPE_ALL] =
+    { NULL, "hello", "dbdesc", "lsreq", "lsupdate", "lsack" };
+  char key[32];
+  int type;
+
+  for (type = OSPF6_MESSAGE_TYPE_HELLO; type < OSPF6_MESSAGE_TYPE_ALL; type++)
+    {
+      snprintf (key, sizeof (key), "%s_%s", dir, names[type]);
+      telemetry_field (t, key, stats->packets[type]);
+    }
+  snprintf (key, sizeof (key), "%s_bytes", dir);
+  telemetry_field (t, key, stats->bytes);
+  snprintf (key, sizeof (key), "%s_drops", dir);
+  telemetry_field (t, key, stats->drops);
+  snprintf (key, sizeof (key), "%s_lsas", dir);
+  telemetry_field (t, key, stats->lsas);
+  snprintf (key, sizeof (key), "%s_acks", dir);
+  telemetry_field (t, key, stats->acks);
+}
+
+/* Telemetry source: the instance, its areas and their interfaces. */
+static void
+ospf6_telemetry (struct telemetry *t)
+{
+  struct ospf6_area *oa;
+  struct ospf6_interface *oi;
+  struct listnode *node, *inode;
+
+  if (ospf6 == NULL)
+    return;
+
+  telemetry_begin (t, "ospf6");
+  telemetry_field (t, "lsas", ospf6->lsdb->count);
+  telemetry_field (t, "routes", ospf6->route_table->count);
+  telemetry_field (t, "border_routers", ospf6->brouter_table->count);
+  telemetry_field (t, "external_routes", ospf6->external_table->count);
+  telemetry_end (t);
+
+  for (ALL_LIST_ELEMENTS_RO (ospf6->area_list, node, oa))
+    {
+      telemetry_begin (t, "ospf6_area");
+      telemetry_tag (t, "area", oa->name);
+      telemetry_field (t, "lsas", oa->lsdb->count);
+      telemetry_field (t, "spf_runs", oa->spf_count);
+      telemetry_field (t, "spf_usec", oa->spf_usec);
+      telemetry_field (t, "spf_max_usec", oa->spf_usec_max);
+      telemetry_field (t, "router_lsas_originated", oa->router_lsa_count);
+      telemetry_end (t);
+
+      for (ALL_LIST_ELEMENTS_RO (oa->if_list, inode, oi))
+        {
+          telemetry_begin (t, "ospf6_interface");
+          telemetry_tag (t, "interface", oi->interface->name);
+          telemetry_tag (t, "area", oa->name);
+          telemetry_field (t, "state", oi->state);
+          telemetry_field (t, "neighbors", listcount (oi->neighbor_list));
+          ospf6_telemetry_messages (t, "rx", &oi->rx);
+          ospf6_telemetry_messages (t, "tx", &oi->tx);
+          telemetry_field (t, "lsa_retransmits", oi->lsa_retransmits);
+          telemetry_field (t, "mdr_calculations", oi->mdr_calculations);
+          telemetry_end (t);
+        }
+    }
+}
+
 /* Install ospf related commands. */
 int
 ospf6_init (void)
@@ -1893,6 +2062,8 @@ ospf6_init (void)
   ospf6_asbr_init ();
   ospf6_abr_init ();
 
+  telemetry_register (ospf6_telemetry);
+
 #ifdef HAVE_SNMP
   ospf6_snmp_init (master);
 #endif /*HAVE_SNMP*/
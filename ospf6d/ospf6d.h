@@ -52,6 +52,14 @@ extern struct thread_master *master;
 #define MSG_OK    0
 #define MSG_NG    1
 
+/* static storage of functions also called from the SPF worker threads,
+   such as the buffers of name functions, is private to each thread */
+#ifdef HAVE_PTHREADS
+#define OSPF6_THREAD_LOCAL __thread
+#else
+#define OSPF6_THREAD_LOCAL
+#endif /* HAVE_PTHREADS */
+
 /* cast macro: XXX - these *must* die, ick ick. */
 #define OSPF6_PROCESS(x) ((struct ospf6 *) (x))
 #define OSPF6_AREA(x) ((struct ospf6_area *) (x))
@@ -115,7 +123,6 @@ extern struct thread_master *master;
 
 
 /* Function Prototypes */
-extern struct route_node *route_prev (struct route_node *node);
 
 extern void ospf6_debug (void);
 extern int ospf6_init (void);
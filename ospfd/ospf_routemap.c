@@ -205,7 +205,7 @@ route_match_ip_nexthop (void *rule, struct prefix *prefix,
       p.prefix = ei->nexthop;
       p.prefixlen = IPV4_MAX_BITLEN;
 
-      alist = access_list_lookup (AFI_IP, (char *) rule);
+      alist = access_list_ref_lookup (rule);
       if (alist == NULL)
         return RMAP_NOMATCH;
 
@@ -220,14 +220,14 @@ route_match_ip_nexthop (void *rule, struct prefix *prefix,
 static void *
 route_match_ip_nexthop_compile (const char *arg)
 {
-  return XSTRDUP (MTYPE_ROUTE_MAP_COMPILED, arg);
+  return access_list_ref_new (AFI_IP, arg);
 }
 
 /* Free route map's compiled `ip address' value. */
 static void
 route_match_ip_nexthop_free (void *rule)
 {
-  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+  access_list_ref_free (rule);
 }
 
 /* Route map commands for metric matching. */
@@ -255,7 +255,7 @@ route_match_ip_next_hop_prefix_list (void *rule, struct prefix *prefix,
       p.prefix = ei->nexthop;
       p.prefixlen = IPV4_MAX_BITLEN;
 
-      plist = prefix_list_lookup (AFI_IP, (char *) rule);
+      plist = prefix_list_ref_lookup (rule);
       if (plist == NULL)
         return RMAP_NOMATCH;
 
@@ -268,13 +268,13 @@ route_match_ip_next_hop_prefix_list (void *rule, struct prefix *prefix,
 static void *
 route_match_ip_next_hop_prefix_list_compile (const char *arg)
 {
-  return XSTRDUP (MTYPE_ROUTE_MAP_COMPILED, arg);
+  return prefix_list_ref_new (AFI_IP, arg);
 }
 
 static void
 route_match_ip_next_hop_prefix_list_free (void *rule)
 {
-  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+  prefix_list_ref_free (rule);
 }
 
 struct route_map_rule_cmd route_match_ip_next_hop_prefix_list_cmd =
@@ -297,7 +297,7 @@ route_match_ip_address (void *rule, struct prefix *prefix,
 
   if (type == RMAP_OSPF)
     {
-      alist = access_list_lookup (AFI_IP, (char *) rule);
+      alist = access_list_ref_lookup (rule);
       if (alist == NULL)
         return RMAP_NOMATCH;
 
@@ -312,14 +312,14 @@ route_match_ip_address (void *rule, struct prefix *prefix,
 static void *
 route_match_ip_address_compile (const char *arg)
 {
-  return XSTRDUP (MTYPE_ROUTE_MAP_COMPILED, arg);
+  return access_list_ref_new (AFI_IP, arg);
 }
 
 /* Free route map's compiled `ip address' value. */
 static void
 route_match_ip_address_free (void *rule)
 {
-  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+  access_list_ref_free (rule);
 }
 
 /* Route map commands for ip address matching. */
@@ -340,7 +340,7 @@ route_match_ip_address_prefix_list (void *rule, struct prefix *prefix,
 
   if (type == RMAP_OSPF)
     {
-      plist = prefix_list_lookup (AFI_IP, (char *) rule);
+      plist = prefix_list_ref_lookup (rule);
       if (plist == NULL)
         return RMAP_NOMATCH;
 
@@ -353,13 +353,13 @@ route_match_ip_address_prefix_list (void *rule, struct prefix *prefix,
 static void *
 route_match_ip_address_prefix_list_compile (const char *arg)
 {
-  return XSTRDUP (MTYPE_ROUTE_MAP_COMPILED, arg);
+  return prefix_list_ref_new (AFI_IP, arg);
 }
 
 static void
 route_match_ip_address_prefix_list_free (void *rule)
 {
-  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+  prefix_list_ref_free (rule);
 }
 
 struct route_map_rule_cmd route_match_ip_address_prefix_list_cmd =
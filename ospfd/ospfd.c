@@ -650,7 +650,7 @@ ospf_area_check_free (struct ospf *ospf, struct in_addr area_id)
   area = ospf_area_lookup_by_area_id (ospf, area_id);
   if (area &&
       listcount (area->oiflist) == 0 &&
-      area->ranges->top == NULL &&
+      route_table_count (area->ranges) == 0 &&
       area->shortcut_configured == OSPF_SHORTCUT_DEFAULT &&
       area->external_routing == OSPF_AREA_DEFAULT &&
       area->no_summary == 0 &&
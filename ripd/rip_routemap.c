@@ -290,7 +290,7 @@ route_match_ip_next_hop (void *rule, struct prefix *prefix,
       p.prefix = (rinfo->nexthop.s_addr) ? rinfo->nexthop : rinfo->from;
       p.prefixlen = IPV4_MAX_BITLEN;
 
-      alist = access_list_lookup (AFI_IP, (char *) rule);
+      alist = access_list_ref_lookup (rule);
       if (alist == NULL)
 	return RMAP_NOMATCH;
 
@@ -305,14 +305,14 @@ route_match_ip_next_hop (void *rule, struct prefix *prefix,
 static void *
 route_match_ip_next_hop_compile (const char *arg)
 {
-  return XSTRDUP (MTYPE_ROUTE_MAP_COMPILED, arg);
+  return access_list_ref_new (AFI_IP, arg);
 }
 
 /* Free route map's compiled `. */
 static void
 route_match_ip_next_hop_free (void *rule)
 {
-  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+  access_list_ref_free (rule);
 }
 
 /* Route map commands for ip next-hop matching. */
@@ -341,7 +341,7 @@ route_match_ip_next_hop_prefix_list (void *rule, struct prefix *prefix,
       p.prefix = (rinfo->nexthop.s_addr) ? rinfo->nexthop : rinfo->from;
       p.prefixlen = IPV4_MAX_BITLEN;
 
-      plist = prefix_list_lookup (AFI_IP, (char *) rule);
+      plist = prefix_list_ref_lookup (rule);
       if (plist == NULL)
         return RMAP_NOMATCH;
 
@@ -354,13 +354,13 @@ route_match_ip_next_hop_prefix_list (void *rule, struct prefix *prefix,
 static void *
 route_match_ip_next_hop_prefix_list_compile (const char *arg)
 {
-  return XSTRDUP (MTYPE_ROUTE_MAP_COMPILED, arg);
+  return prefix_list_ref_new (AFI_IP, arg);
 }
 
 static void
 route_match_ip_next_hop_prefix_list_free (void *rule)
 {
-  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+  prefix_list_ref_free (rule);
 }
 
 static struct route_map_rule_cmd route_match_ip_next_hop_prefix_list_cmd =
@@ -383,7 +383,7 @@ route_match_ip_address (void *rule, struct prefix *prefix,
 
   if (type == RMAP_RIP)
     {
-      alist = access_list_lookup (AFI_IP, (char *) rule);
+      alist = access_list_ref_lookup (rule);
       if (alist == NULL)
 	return RMAP_NOMATCH;
     
@@ -398,14 +398,14 @@ route_match_ip_address (void *rule, struct prefix *prefix,
 static void *
 route_match_ip_address_compile (const char *arg)
 {
-  return XSTRDUP (MTYPE_ROUTE_MAP_COMPILED, arg);
+  return access_list_ref_new (AFI_IP, arg);
 }
 
 /* Free route map's compiled `ip address' value. */
 static void
 route_match_ip_address_free (void *rule)
 {
-  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+  access_list_ref_free (rule);
 }
 
 /* Route map commands for ip address matching. */
@@ -427,7 +427,7 @@ route_match_ip_address_prefix_list (void *rule, struct prefix *prefix,
 
   if (type == RMAP_RIP)
     {
-      plist = prefix_list_lookup (AFI_IP, (char *) rule);
+      plist = prefix_list_ref_lookup (rule);
       if (plist == NULL)
 	return RMAP_NOMATCH;
     
@@ -440,13 +440,13 @@ route_match_ip_address_prefix_list (void *rule, struct prefix *prefix,
 static void *
 route_match_ip_address_prefix_list_compile (const char *arg)
 {
-  return XSTRDUP (MTYPE_ROUTE_MAP_COMPILED, arg);
+  return prefix_list_ref_new (AFI_IP, arg);
 }
 
 static void
 route_match_ip_address_prefix_list_free (void *rule)
 {
-  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+  prefix_list_ref_free (rule);
 }
 
 static struct route_map_rule_cmd route_match_ip_address_prefix_list_cmd =
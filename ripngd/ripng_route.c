@@ -53,7 +53,7 @@ ripng_aggregate_increment (struct route_node *child, struct ripng_info *rinfo)
   struct route_node *np;
   struct ripng_aggregate *aggregate;
 
-  for (np = child; np; np = np->parent)
+  for (np = child; np; np = route_node_parent (np))
     if ((aggregate = np->aggregate) != NULL)
       {
 	aggregate->count++;
@@ -68,7 +68,7 @@ ripng_aggregate_decrement (struct route_node *child, struct ripng_info *rinfo)
   struct route_node *np;
   struct ripng_aggregate *aggregate;
 
-  for (np = child; np; np = np->parent)
+  for (np = child; np; np = route_node_parent (np))
     if ((aggregate = np->aggregate) != NULL)
       {
 	aggregate->count--;
@@ -1 +1 @@
-__all__ = ['mdr', 'grid']
+__all__ = ['mdr', 'grid', 'dbexchange', 'linkmetrics']
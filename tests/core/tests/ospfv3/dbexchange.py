@@ -0,0 +1,109 @@
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor,
+# Boston, MA  02110-1301, USA.
+
+import sys
+import time
+
+import quagga.test
+import quagga.topology.wlan
+import ospfv3
+
+from core.misc import ipaddr
+
+class TestOspfv3DbExchange(quagga.test.QuaggaTestCase):
+    '''measure the time for MDR adjacencies to become Full when every
+    node has a large link state database
+
+    Each node redistributes numroutes static routes, so every database
+    description exchange describes about numnodes * numroutes LSAs.
+    '''
+
+    numnodes = None
+    numroutes = None
+
+    fullWait = 120
+    pollInterval = 0.5
+
+    quagga_conf_template = '''\
+debug ospf6 neighbor state
+!
+interface eth0
+  ipv6 ospf6 network manet-designated-router
+!
+%(routes)s\
+!
+router ospf6
+  router-id %(routerid)s
+  redistribute static
+  interface eth0 area 0.0.0.0
+'''
+
+    def setUp(self):
+        assert self.numnodes is not None
+        assert self.numroutes is not None
+
+        self.topology = quagga.topology.wlan.Wlan(self.numnodes, seed = 1)
+
+        for i in xrange(self.numnodes):
+            routes = ''
+            for j in xrange(self.numroutes):
+                routes += 'ipv6 route b:%x:%x::/64 eth0\n' % (i + 1, j)
+            d = {'routes': routes,
+                 'routerid': quagga.node.RouterId(i + 1),
+                 }
+            self.topology.n[i].quagga_conf = self.quagga_conf_template % d
+
+        self.start = time.time()
+        self.topology.startup()
+
+    def AdjacenciesFull(self):
+        for n in self.topology.n:
+            nbrs = n.Ospfv3Neighbors()
+            full = False
+            for nbr in nbrs.values():
+                if nbr.InState('ExStart', 'Exchange', 'Loading'):
+                    return False
+                if nbr.InState('Full'):
+                    full = True
+            if not full:
+                return False
+        return True
+
+    def test_dbexchange(self):
+        'ospfv3 mdr: time until adjacencies with large databases are Full'
+
+        while not self.AdjacenciesFull():
+            assert time.time() - self.start < self.fullWait, \
+                'adjacencies not Full after %s seconds' % self.fullWait
+            time.sleep(self.pollInterval)
+
+        sys.stderr.write('%d nodes, %d LSAs: adjacencies Full after '
+                         '%.1f seconds\n' %
+                         (self.numnodes, self.numnodes * self.numroutes,
+                          time.time() - self.start))
+
+class TestOspfv3DbExchangeSmall(TestOspfv3DbExchange):
+    numnodes = 10
+    numroutes = 100
+
+class TestOspfv3DbExchangeLarge(TestOspfv3DbExchange):
+    numnodes = 30
+    numroutes = 1000
+
+    fullWait = 300
+
+def suite():
+    return quagga.test.makeSuite(TestOspfv3DbExchangeSmall,
+                                 TestOspfv3DbExchangeLarge)
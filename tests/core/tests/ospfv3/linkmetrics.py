@@ -0,0 +1,129 @@
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor,
+# Boston, MA  02110-1301, USA.
+
+import os
+import re
+import sys
+
+import quagga.test
+import quagga.topology.wlan
+import ospfv3
+
+# the link metrics generator, built in tests/ unless LMGEN names it
+LMGEN = os.environ.get('LMGEN',
+                       os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                    '..', '..', '..', 'lmgen'))
+
+class TestOspfv3LinkMetrics(quagga.test.QuaggaTestCase):
+    '''measure what RFC 4938 link metrics updates cost ospf6d
+
+    Every node is a neighbor of the first one, where lmgen sends rate
+    link metrics updates per second for each neighbor during duration
+    seconds.  The ospf6d CPU time used, router-LSAs originated and SPF
+    calculations run on that node meanwhile are reported.
+    '''
+
+    numnodes = None
+    rate = None
+    duration = 30
+
+    stableDuration = 10
+    stableWait = 60
+
+    quagga_conf_template = '''\
+interface eth0
+  ipv6 ospf6 network manet-designated-router
+  ipv6 ospf6 linkmetric-formula cisco
+!
+router ospf6
+  router-id %(routerid)s
+  interface eth0 area 0.0.0.0
+'''
+
+    def setUp(self):
+        assert self.numnodes is not None
+        assert self.rate is not None
+
+        if not os.access(LMGEN, os.X_OK):
+            self.skipTest('lmgen not found: %s' % LMGEN)
+
+        self.topology = quagga.topology.wlan.Wlan(self.numnodes,
+                                                  linkprob = 1.0, seed = 1)
+
+        for i in xrange(self.numnodes):
+            d = {'routerid': quagga.node.RouterId(i + 1)}
+            self.topology.n[i].quagga_conf = self.quagga_conf_template % d
+
+        self.topology.startup()
+
+    def LinkLocalAddress(self, n):
+        cmd = ('ip', '-6', 'addr', 'show', 'dev', 'eth0', 'scope', 'link')
+        m = re.search(r'inet6 ([0-9a-f:]+)/', n.cmdoutput(cmd))
+        assert m, '%s: no link-local address' % n.name
+        return m.group(1)
+
+    def Ospf6dCounters(self, n):
+        'return the ospf6d CPU seconds, router-LSAs and SPF runs'
+        pid = n.cmdoutput(('pidof', 'ospf6d')).split()[0]
+        stat = n.cmdoutput(('cat', '/proc/%s/stat' % pid)).split()
+        cpu = float(int(stat[13]) + int(stat[14])) / \
+            os.sysconf(os.sysconf_names['SC_CLK_TCK'])
+        output = n.cmdoutput(('vtysh', '-c', 'show ipv6 ospf6'))
+        spf = int(re.search(r'SPF algorithm executed (\d+)', output).group(1))
+        lsa = int(re.search(r'Router-LSA originated (\d+)', output).group(1))
+        return cpu, lsa, spf
+
+    def test_linkmetrics(self):
+        'ospfv3 link metrics: ospf6d load under link metrics updates'
+
+        stable = \
+            ospfv3.Ospfv3StableBarrier(self.topology,
+                                       stableDuration = self.stableDuration)
+        stable.Wait(self.stableWait)
+
+        n = self.topology.n[0]
+        nbrs = [self.LinkLocalAddress(m) for m in self.topology.n[1:]]
+
+        cpu0, lsa0, spf0 = self.Ospf6dCounters(n)
+        cmd = (LMGEN, '-i', 'eth0', '-r', str(self.rate),
+               '-d', str(self.duration)) + tuple(nbrs)
+        status, output = n.cmdresult(cmd)
+        assert status == 0, '%s: lmgen failed: %s' % (n.name, output)
+        cpu1, lsa1, spf1 = self.Ospf6dCounters(n)
+
+        sys.stderr.write('%d neighbors, %s updates/s each: ospf6d CPU %.1f%%, '
+                         '%.2f router-LSAs/s, %.2f SPF/s\n' %
+                         (len(nbrs), self.rate,
+                          100 * (cpu1 - cpu0) / self.duration,
+                          float(lsa1 - lsa0) / self.duration,
+                          float(spf1 - spf0) / self.duration))
+
+        # the adjacencies survive the load
+        nbrstates = n.Ospfv3Neighbors()
+        assert len(nbrstates) == len(nbrs), \
+            '%s: %d neighbors left of %d' % \
+            (n.name, len(nbrstates), len(nbrs))
+
+class TestOspfv3LinkMetricsSmall(TestOspfv3LinkMetrics):
+    numnodes = 10
+    rate = 10
+
+class TestOspfv3LinkMetricsLarge(TestOspfv3LinkMetrics):
+    numnodes = 30
+    rate = 10
+
+def suite():
+    return quagga.test.makeSuite(TestOspfv3LinkMetricsSmall,
+                                 TestOspfv3LinkMetricsLarge)
@@ -0,0 +1,379 @@
+/*
+ * This file is part of Quagga.
+ *
+ * Quagga is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * Quagga is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quagga; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+/* This programme measures the memory allocator under the churn of the
+ * objects daemons allocate and free most: list nodes, route nodes and
+ * streams, and fixed-size objects freed in random order, by one thread
+ * and by several at once.  Where it makes sense the same pattern is
+ * also run on malloc() and free() directly.  Last, list nodes are all
+ * reallocated in the middle of their churn, which sends them back to
+ * malloc().  With slabs, a string freed as a route node, as daemons
+ * may do, must not be handed out as one.  Build with and without
+ * --enable-slab-alloc to compare.
+ * Usage:
+ *
+ *   heavyalloc [operations [threads]]
+ */
+#include <zebra.h>
+
+#include "thread.h"
+#include "memory.h"
+#include "linklist.h"
+#include "prefix.h"
+#include "table.h"
+#include "stream.h"
+
+#include "tests.h"
+
+#ifdef HAVE_PTHREADS
+#include <pthread.h>
+#endif /* HAVE_PTHREADS */
+
+struct thread_master *master;
+
+#define LIVE		10000	/* objects kept allocated */
+#define OBJECT_SIZE	(sizeof (struct listnode))
+
+static unsigned long operations = 2000000;
+
+static u_int32_t
+rnd (u_int64_t *seed)
+{
+  *seed ^= *seed << 13;
+  *seed ^= *seed >> 7;
+  *seed ^= *seed << 17;
+  return (u_int32_t) (*seed >> 16);
+}
+
+#ifdef HAVE_SLAB_ALLOC
+/* Free a string as a route node, route nodes being allocated from
+   slabs, and check it is not handed out as one. */
+static void
+check_foreign (void)
+{
+  void **live;
+  char *str, *freed;
+  unsigned long i;
+
+  live = XCALLOC (MTYPE_TMP, LIVE * sizeof (void *));
+  for (i = 0; i < LIVE; i++)
+    live[i] = XMALLOC (MTYPE_ROUTE_NODE, sizeof (struct route_node));
+  for (i = 0; i < LIVE; i++)
+    XFREE (MTYPE_ROUTE_NODE, live[i]);
+
+  freed = str = XSTRDUP (MTYPE_TMP, "foreign");
+  XFREE (MTYPE_ROUTE_NODE, str);
+  for (i = 0; i < LIVE; i++)
+    if ((live[i] = XMALLOC (MTYPE_ROUTE_NODE,
+                            sizeof (struct route_node))) == freed)
+      fail ("a string freed as a route node was handed out as one");
+  for (i = 0; i < LIVE; i++)
+    XFREE (MTYPE_ROUTE_NODE, live[i]);
+  XFREE (MTYPE_TMP, live);
+}
+#endif /* HAVE_SLAB_ALLOC */
+
+static void
+report (const char *what, double xms, double ms, unsigned long ops)
+{
+  printf ("%-10s %12.1f", what, xms * 1000000.0 / ops);
+  if (ms >= 0)
+    printf (" %12.1f", ms * 1000000.0 / ops);
+  printf ("\n");
+}
+
+/* Replace a random one of LIVE objects, OPS times. */
+static void
+churn_xmalloc (unsigned long ops, u_int64_t seed)
+{
+  void **live;
+  unsigned long i;
+
+  live = XCALLOC (MTYPE_TMP, LIVE * sizeof (void *));
+  for (i = 0; i < LIVE; i++)
+    live[i] = XMALLOC (MTYPE_LINK_NODE, OBJECT_SIZE);
+  for (i = 0; i < ops; i++)
+    {
+      unsigned int j = rnd (&seed) % LIVE;
+
+      XFREE (MTYPE_LINK_NODE, live[j]);
+      live[j] = XMALLOC (MTYPE_LINK_NODE, OBJECT_SIZE);
+    }
+  for (i = 0; i < LIVE; i++)
+    XFREE (MTYPE_LINK_NODE, live[i]);
+  XFREE (MTYPE_TMP, live);
+}
+
+/* Check that OBJECT still holds its own address. */
+static void
+check_object (void *object)
+{
+  if (*(void **) object != object)
+    {
+      fprintf (stderr, "an object was handed out twice\n");
+      exit (1);
+    }
+}
+
+/* Churn as churn_xmalloc() does, but reallocate every object halfway,
+   which sends the type back to malloc() while objects of it are in
+   slabs and magazines.  Each object holds its own address, so that one
+   handed out twice is caught. */
+static void
+churn_realloc (unsigned long ops, u_int64_t seed)
+{
+  void **live;
+  unsigned long i, k;
+
+  live = XCALLOC (MTYPE_TMP, LIVE * sizeof (void *));
+  for (i = 0; i < LIVE; i++)
+    {
+      live[i] = XMALLOC (MTYPE_LINK_NODE, OBJECT_SIZE);
+      *(void **) live[i] = live[i];
+    }
+  for (i = 0; i < ops; i++)
+    {
+      unsigned int j = rnd (&seed) % LIVE;
+
+      if (i == ops / 2)
+        for (k = 0; k < LIVE; k++)
+          {
+            check_object (live[k]);
+            live[k] = XREALLOC (MTYPE_LINK_NODE, live[k], 2 * OBJECT_SIZE);
+            *(void **) live[k] = live[k];
+          }
+
+      check_object (live[j]);
+      XFREE (MTYPE_LINK_NODE, live[j]);
+      live[j] = XMALLOC (MTYPE_LINK_NODE, OBJECT_SIZE);
+      *(void **) live[j] = live[j];
+    }
+  for (i = 0; i < LIVE; i++)
+    {
+      check_object (live[i]);
+      XFREE (MTYPE_LINK_NODE, live[i]);
+    }
+  XFREE (MTYPE_TMP, live);
+}
+
+static void
+churn_malloc (unsigned long ops, u_int64_t seed)
+{
+  void **live;
+  unsigned long i;
+
+  live = calloc (LIVE, sizeof (void *));
+  for (i = 0; i < LIVE; i++)
+    live[i] = malloc (OBJECT_SIZE);
+  for (i = 0; i < ops; i++)
+    {
+      unsigned int j = rnd (&seed) % LIVE;
+
+      free (live[j]);
+      live[j] = malloc (OBJECT_SIZE);
+    }
+  for (i = 0; i < LIVE; i++)
+    free (live[i]);
+  free (live);
+}
+
+#ifdef HAVE_PTHREADS
+struct worker
+{
+  pthread_t thread;
+  void (*func) (unsigned long, u_int64_t);
+  unsigned long ops;
+  u_int64_t seed;
+};
+
+static void *
+worker_run (void *arg)
+{
+  struct worker *w = arg;
+
+  (*w->func) (w->ops, w->seed);
+  return NULL;
+}
+
+/* Run FUNC in NTHREADS threads at once, sharing OPS between them. */
+static double
+run_threads (void (*func) (unsigned long, u_int64_t), unsigned long ops,
+             unsigned int nthreads)
+{
+  struct worker *workers;
+  struct timeval start;
+  unsigned int i;
+
+  workers = calloc (nthreads, sizeof (struct worker));
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  for (i = 0; i < nthreads; i++)
+    {
+      workers[i].func = func;
+      workers[i].ops = ops / nthreads;
+      workers[i].seed = 88172645463325252ULL + i;
+      pthread_create (&workers[i].thread, NULL, worker_run, &workers[i]);
+    }
+  for (i = 0; i < nthreads; i++)
+    pthread_join (workers[i].thread, NULL);
+  free (workers);
+  return elapsed (&start);
+}
+#endif /* HAVE_PTHREADS */
+
+static double
+run (void (*func) (unsigned long, u_int64_t), unsigned long ops)
+{
+  struct timeval start;
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  (*func) (ops, 88172645463325252ULL);
+  return elapsed (&start);
+}
+
+/* Add to and delete from the ends of a list of LIVE nodes. */
+static double
+churn_list (unsigned long ops)
+{
+  struct list *list = list_new ();
+  struct timeval start;
+  unsigned long i;
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  for (i = 0; i < LIVE; i++)
+    listnode_add (list, list);
+  for (i = 0; i < ops; i++)
+    {
+      list_delete_node (list, listhead (list));
+      listnode_add (list, list);
+    }
+  list_delete (list);
+  return elapsed (&start);
+}
+
+/* Add random prefixes to a table of about LIVE routes and delete
+   others. */
+static double
+churn_table (unsigned long ops)
+{
+  struct route_table *table = route_table_init ();
+  struct route_node **live;
+  struct timeval start;
+  struct prefix p;
+  u_int64_t seed = 88172645463325252ULL;
+  unsigned long i;
+
+  live = calloc (LIVE, sizeof (struct route_node *));
+  memset (&p, 0, sizeof (p));
+  p.family = AF_INET;
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  for (i = 0; i < ops; i++)
+    {
+      unsigned int j = rnd (&seed) % LIVE;
+
+      if (live[j])
+        route_unlock_node (live[j]);
+      p.prefixlen = 16 + rnd (&seed) % 17;
+      p.u.prefix4.s_addr = htonl (rnd (&seed) << 16 | (rnd (&seed) & 0xffff));
+      apply_mask (&p);
+      live[j] = route_node_get (table, &p);
+    }
+  for (i = 0; i < LIVE; i++)
+    if (live[i])
+      route_unlock_node (live[i]);
+  route_table_finish (table);
+  free (live);
+  return elapsed (&start);
+}
+
+/* Make and free a stream per packet, the way daemons read them. */
+static double
+churn_stream (unsigned long ops)
+{
+  struct timeval start;
+  unsigned long i;
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  for (i = 0; i < ops; i++)
+    {
+      struct stream *s = stream_new (1500);
+
+      stream_putl (s, i);
+      stream_free (s);
+    }
+  return elapsed (&start);
+}
+
+int
+main (int argc, char **argv)
+{
+  unsigned int nthreads = 4;
+
+  if (argc > 1)
+    operations = strtoul (argv[1], NULL, 10);
+  if (argc > 2)
+    nthreads = strtoul (argv[2], NULL, 10);
+  if (operations < 1 || nthreads < 1)
+    {
+      fprintf (stderr, "usage: %s [operations [threads]]\n", argv[0]);
+      exit (1);
+    }
+
+  master = thread_master_create ();
+
+#ifdef HAVE_SLAB_ALLOC
+  printf ("slab allocation, %lu operations\n", operations);
+#else
+  printf ("malloc allocation, %lu operations\n", operations);
+#endif /* HAVE_SLAB_ALLOC */
+  printf ("%-10s %12s %12s\n", "", "ns/op", "malloc ns/op");
+
+  /* Once first, so that types are past learning their sizes. */
+  run (churn_xmalloc, LIVE);
+
+  report ("churn", run (churn_xmalloc, operations),
+          run (churn_malloc, operations), operations);
+#ifdef HAVE_PTHREADS
+  {
+    char what[32];
+
+    snprintf (what, sizeof (what), "churn x%u", nthreads);
+    report (what, run_threads (churn_xmalloc, operations, nthreads),
+            run_threads (churn_malloc, operations, nthreads), operations);
+  }
+#endif /* HAVE_PTHREADS */
+  report ("list", churn_list (operations), -1, operations);
+  report ("table", churn_table (operations), -1, operations);
+  report ("stream", churn_stream (operations), -1, operations);
+#ifdef HAVE_SLAB_ALLOC
+  check_foreign ();
+#endif /* HAVE_SLAB_ALLOC */
+
+  /* Last, as it leaves list nodes with malloc(). */
+#ifdef HAVE_PTHREADS
+  report ("realloc", run_threads (churn_realloc, operations, nthreads), -1,
+          operations);
+#else
+  report ("realloc", run (churn_realloc, operations), -1, operations);
+#endif /* HAVE_PTHREADS */
+  if (mtype_stats_alloc (MTYPE_LINK_NODE) != 0)
+    fail ("a list node was not freed");
+
+  return 0;
+}
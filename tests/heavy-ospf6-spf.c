@@ -0,0 +1,196 @@
+/*
+ * This file is part of Quagga.
+ *
+ * Quagga is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * Quagga is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quagga; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+/* This programme measures how the ospf6d SPF calculation scales with
+ * the number of areas, calculating the areas one at a time and with
+ * worker threads ("spf worker-threads").
+ *
+ * Every area holds the router-LSAs of a grid of routers joined by
+ * point-to-point links.  Usage:
+ *
+ *   heavyospf6spf [grid-size [max-areas [threads]]]
+ */
+#include <zebra.h>
+
+#include "thread.h"
+#include "memory.h"
+#include "privs.h"
+#include "linklist.h"
+
+#include "ospf6d/ospf6_proto.h"
+#include "ospf6d/ospf6_lsa.h"
+#include "ospf6d/ospf6_lsdb.h"
+#include "ospf6d/ospf6_route.h"
+#include "ospf6d/ospf6_top.h"
+#include "ospf6d/ospf6_area.h"
+#include "ospf6d/ospf6_intra.h"
+#include "ospf6d/ospf6_spf.h"
+
+/* need these to link in libospf6 */
+struct zebra_privs_t ospf6d_privs;
+struct thread_master *master = NULL;
+
+#define ROUTER_ID(grid, x, y) ((y) * (grid) + (x) + 1)
+
+static void
+add_router_lsa (struct ospf6_area *oa, unsigned int grid,
+                unsigned int x, unsigned int y)
+{
+  char buf[OSPF6_MAX_LSASIZE];
+  struct ospf6_lsa_header *header;
+  struct ospf6_router_lsa *router_lsa;
+  struct ospf6_router_lsdesc *lsdesc;
+  struct ospf6_lsa *lsa;
+  int dx[] = { 1, -1, 0, 0 }, dy[] = { 0, 0, 1, -1 };
+  unsigned int i;
+
+  memset (buf, 0, sizeof (buf));
+  header = (struct ospf6_lsa_header *) buf;
+  router_lsa = (struct ospf6_router_lsa *) OSPF6_LSA_HEADER_END (header);
+  lsdesc = (struct ospf6_router_lsdesc *) (router_lsa + 1);
+
+  /* interface i of every router faces direction i; the neighbor's
+     interface facing back is i ^ 1 */
+  for (i = 0; i < 4; i++)
+    {
+      int nx = x + dx[i], ny = y + dy[i];
+
+      if (nx < 0 || ny < 0 || nx >= (int) grid || ny >= (int) grid)
+        continue;
+
+      lsdesc->type = OSPF6_ROUTER_LSDESC_POINTTOPOINT;
+      lsdesc->metric = htons (1 + (x + y + i) % 10);
+      lsdesc->interface_id = htonl (i + 1);
+      lsdesc->neighbor_interface_id = htonl ((i ^ 1) + 1);
+      lsdesc->neighbor_router_id = htonl (ROUTER_ID (grid, nx, ny));
+      lsdesc++;
+    }
+
+  header->type = htons (OSPF6_LSTYPE_ROUTER);
+  header->id = htonl (0);
+  header->adv_router = htonl (ROUTER_ID (grid, x, y));
+  header->seqnum = htonl (INITIAL_SEQUENCE_NUMBER);
+  header->length = htons ((caddr_t) lsdesc - buf);
+
+  lsa = ospf6_lsa_create (header);
+  ospf6_lsdb_add (lsa, oa->lsdb);
+}
+
+static struct ospf6_area *
+area_create (u_int32_t area_id, unsigned int grid)
+{
+  struct ospf6_area *oa;
+  unsigned int x, y;
+
+  oa = ospf6_area_create (htonl (area_id), ospf6);
+
+  /* only the SPF trees are calculated here */
+  oa->lsdb->hook_add = NULL;
+  oa->lsdb->hook_remove = NULL;
+  oa->lsdb->hook_replace = NULL;
+
+  for (y = 0; y < grid; y++)
+    for (x = 0; x < grid; x++)
+      add_router_lsa (oa, grid, x, y);
+
+  return oa;
+}
+
+static double
+calculate (struct ospf6_area **areas, unsigned int count,
+           unsigned int workers, unsigned int grid)
+{
+  struct timeval start, end, diff, runtime[count];
+  unsigned int i;
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  ospf6_spf_calculation_areas (htonl (ROUTER_ID (grid, 0, 0)), areas,
+                               runtime, count, workers);
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &end);
+  timersub (&end, &start, &diff);
+
+  for (i = 0; i < count; i++)
+    if (areas[i]->spf_table->count != grid * grid)
+      {
+        fprintf (stderr, "area %u: %u vertices in SPF tree, expected %u\n",
+                 i + 1, areas[i]->spf_table->count, grid * grid);
+        exit (1);
+      }
+
+  return diff.tv_sec * 1000.0 + diff.tv_usec / 1000.0;
+}
+
+int
+main (int argc, char **argv)
+{
+  unsigned int grid = 30, max_areas = 8, threads = 4;
+  struct ospf6_area **areas;
+  unsigned int count;
+  long ncpu;
+
+#ifdef _SC_NPROCESSORS_ONLN
+  ncpu = sysconf (_SC_NPROCESSORS_ONLN);
+  if (ncpu > 0)
+    threads = ncpu;
+#endif /* _SC_NPROCESSORS_ONLN */
+
+  if (argc > 1)
+    grid = strtoul (argv[1], NULL, 10);
+  if (argc > 2)
+    max_areas = strtoul (argv[2], NULL, 10);
+  if (argc > 3)
+    threads = strtoul (argv[3], NULL, 10);
+  if (grid < 2 || max_areas < 1 || threads < 1)
+    {
+      fprintf (stderr, "usage: %s [grid-size [max-areas [threads]]]\n",
+               argv[0]);
+      exit (1);
+    }
+  if (threads > OSPF6_SPF_WORKERS_MAX)
+    threads = OSPF6_SPF_WORKERS_MAX;
+
+  master = thread_master_create ();
+  ospf6_lsa_init ();
+  ospf6 = ospf6_create ();
+  /* differs from the SPF root, so no nexthops (and interfaces) needed */
+  ospf6->router_id = 0;
+
+#ifndef HAVE_PTHREADS
+  printf ("built without POSIX threads, areas are calculated one at a time\n");
+#endif /* HAVE_PTHREADS */
+  printf ("%u routers per area, up to %u threads\n", grid * grid, threads);
+  printf ("%6s %14s %14s %8s\n", "areas", "sequential ms", "parallel ms",
+          "speedup");
+
+  areas = XCALLOC (MTYPE_TMP, max_areas * sizeof (*areas));
+  for (count = 1; count <= max_areas; count++)
+    {
+      double seq, par;
+
+      areas[count - 1] = area_create (count, grid);
+
+      seq = calculate (areas, count, 1, grid);
+      par = calculate (areas, count, threads, grid);
+
+      printf ("%6u %14.2f %14.2f %8.2f\n", count, seq, par,
+              par > 0 ? seq / par : 0);
+    }
+
+  return 0;
+}
@@ -0,0 +1,386 @@
+/*
+ * This file is part of Quagga.
+ *
+ * Quagga is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * Quagga is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quagga; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+/* This programme stands in for an RFC 4938 link metrics source.  It
+ * connects to zebra like a routing daemon and sends the
+ * ZEBRA_LINKMETRICS_METRICS and ZEBRA_LINKMETRICS_STATUS messages the
+ * generic netlink receiver would, which zebra passes on to ospf6d.
+ * Usage:
+ *
+ *   lmgen [-z zserv] [-r rate] [-d seconds] [-S seed] [-p]
+ *         -i interface neighbor...
+ *   lmgen [-z zserv] [-n count] ... -i interface
+ *   lmgen [-z zserv] [-x speed] [-p] -t trace
+ *
+ * The first form sends rate metrics updates per second for each
+ * neighbor link-local address, for the given number of seconds, the
+ * values following a random walk.  The second makes up count
+ * neighbors fe80::1, fe80::2, ..., which only loads zebra as ospf6d
+ * knows none of them.  The third replays a trace, x times as fast,
+ * with one update per line:
+ *
+ *   <msec> metrics <interface> <neighbor> <rlq> <resource> <latency>
+ *          <current datarate> <maximum datarate>
+ *   <msec> status <interface> <neighbor> up|down
+ *
+ * where msec counts from the start of the trace and the datarates are
+ * in kbps.  With -p the updates sent are also printed in that format,
+ * so that a synthetic run can be replayed.
+ */
+#include <zebra.h>
+
+#include "log.h"
+#include "thread.h"
+#include "stream.h"
+#include "zclient.h"
+#include "zebra_linkmetrics.h"
+#include "lmgenl.h"
+
+struct thread_master *master;
+
+struct lmgen_neighbor
+{
+  struct in6_addr addr;
+  struct zebra_rfc4938_linkmetrics metrics;
+};
+
+static struct zclient *zclient;
+static int print_updates;
+static unsigned long sent_metrics, sent_status;
+
+static void
+usage (const char *progname)
+{
+  fprintf (stderr,
+	   "usage: %s [-z zserv] [-r rate] [-d seconds] [-S seed] [-p]\n"
+	   "          [-n count] -i interface [neighbor...]\n"
+	   "       %s [-z zserv] [-x speed] [-p] -t trace\n",
+	   progname, progname);
+  exit (1);
+}
+
+static double
+now (void)
+{
+  struct timeval tv;
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &tv);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static void
+sleep_until (double t)
+{
+  double d = t - now ();
+  struct timespec ts;
+
+  if (d <= 0)
+    return;
+  ts.tv_sec = (time_t) d;
+  ts.tv_nsec = (long) ((d - ts.tv_sec) * 1e9);
+  while (nanosleep (&ts, &ts) < 0 && errno == EINTR)
+    ;
+}
+
+static void
+send_stream (struct stream *s)
+{
+  const u_char *p = STREAM_DATA (s);
+  size_t left = stream_get_endp (s);
+  ssize_t n;
+
+  while (left > 0)
+    {
+      n = write (zclient->sock, p, left);
+      if (n < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  fprintf (stderr, "write to zebra failed: %s\n", safe_strerror (errno));
+	  exit (1);
+	}
+      p += n;
+      left -= n;
+    }
+}
+
+static unsigned int
+interface_index (const char *name)
+{
+  unsigned int ifindex;
+  char *end;
+
+  ifindex = strtoul (name, &end, 10);
+  if (*end != '\0')
+    ifindex = if_nametoindex (name);
+  if (ifindex == 0)
+    {
+      fprintf (stderr, "unknown interface: %s\n", name);
+      exit (1);
+    }
+  return ifindex;
+}
+
+static void
+send_metrics (double msec, const char *ifname,
+	      const struct zebra_linkmetrics *metrics)
+{
+  char buf[INET6_ADDRSTRLEN];
+
+  zapi_write_linkmetrics (zclient->obuf, metrics);
+  send_stream (zclient->obuf);
+  sent_metrics++;
+
+  if (print_updates)
+    printf ("%.0f metrics %s %s %u %u %u %" PRIu64 " %" PRIu64 "\n", msec,
+	    ifname, inet_ntop (AF_INET6, &metrics->nbr_addr6, buf, sizeof buf),
+	    metrics->metrics.rlq, metrics->metrics.resource,
+	    metrics->metrics.latency, metrics->metrics.current_datarate,
+	    metrics->metrics.max_datarate);
+}
+
+static void
+send_status (double msec, const char *ifname,
+	     const struct zebra_linkstatus *status)
+{
+  char buf[INET6_ADDRSTRLEN];
+
+  zapi_write_linkstatus (zclient->obuf, status);
+  send_stream (zclient->obuf);
+  sent_status++;
+
+  if (print_updates)
+    printf ("%.0f status %s %s %s\n", msec, ifname,
+	    inet_ntop (AF_INET6, &status->nbr_addr6, buf, sizeof buf),
+	    status->status == LM_STATUS_UP ? "up" : "down");
+}
+
+/* move v by up to step either way, staying within [min, max] */
+static long
+walk (long v, long step, long min, long max)
+{
+  v += random () % (2 * step + 1) - step;
+  if (v < min)
+    v = min;
+  if (v > max)
+    v = max;
+  return v;
+}
+
+static void
+synthetic (const char *ifname, struct lmgen_neighbor *nbrs, unsigned int n,
+	   double rate, double seconds)
+{
+  struct zebra_linkmetrics metrics;
+  struct lmgen_neighbor *nbr;
+  unsigned int ifindex = interface_index (ifname);
+  double start, t, interval;
+  unsigned long i;
+
+  /* spread the updates evenly over each period */
+  interval = 1.0 / (rate * n);
+
+  memset (&metrics, 0, sizeof (metrics));
+  metrics.ifindex = ifindex;
+
+  start = now ();
+  for (i = 0; (t = i * interval) < seconds; i++)
+    {
+      nbr = &nbrs[i % n];
+      nbr->metrics.rlq = walk (nbr->metrics.rlq, 5, 10, 100);
+      nbr->metrics.resource = walk (nbr->metrics.resource, 5, 0, 100);
+      nbr->metrics.latency = walk (nbr->metrics.latency, 2, 1, 500);
+      nbr->metrics.current_datarate =
+	walk (nbr->metrics.current_datarate,
+	      nbr->metrics.max_datarate / 20, nbr->metrics.max_datarate / 10,
+	      nbr->metrics.max_datarate);
+
+      metrics.nbr_addr6 = nbr->addr;
+      metrics.metrics = nbr->metrics;
+
+      sleep_until (start + t);
+      send_metrics (t * 1000, ifname, &metrics);
+    }
+}
+
+static void
+replay (const char *path, double speed)
+{
+  FILE *f;
+  char line[256], type[16], ifname[IFNAMSIZ + 1], addr[INET6_ADDRSTRLEN];
+  char state[8];
+  double start, msec;
+  unsigned int lineno = 0, rlq, resource, latency;
+  uint64_t cdr, mdr;
+  struct zebra_linkmetrics metrics;
+  struct zebra_linkstatus status;
+  struct in6_addr nbr;
+  int n;
+
+  if (strcmp (path, "-") == 0)
+    f = stdin;
+  else if ((f = fopen (path, "r")) == NULL)
+    {
+      fprintf (stderr, "%s: %s\n", path, safe_strerror (errno));
+      exit (1);
+    }
+
+  start = now ();
+  while (fgets (line, sizeof line, f))
+    {
+      lineno++;
+      if (line[0] == '#' || line[0] == '\n')
+	continue;
+
+      n = sscanf (line, "%lf %15s %16s %45s", &msec, type, ifname, addr);
+      if (n != 4 || inet_pton (AF_INET6, addr, &nbr) != 1)
+	{
+	  fprintf (stderr, "%s:%u: malformed update\n", path, lineno);
+	  exit (1);
+	}
+
+      sleep_until (start + msec / 1000 / speed);
+
+      if (strcmp (type, "metrics") == 0)
+	{
+	  n = sscanf (line, "%*f %*s %*s %*s %u %u %u %" SCNu64 " %" SCNu64,
+		      &rlq, &resource, &latency, &cdr, &mdr);
+	  if (n != 5)
+	    {
+	      fprintf (stderr, "%s:%u: malformed metrics\n", path, lineno);
+	      exit (1);
+	    }
+	  memset (&metrics, 0, sizeof (metrics));
+	  metrics.ifindex = interface_index (ifname);
+	  metrics.nbr_addr6 = nbr;
+	  metrics.metrics.rlq = rlq;
+	  metrics.metrics.resource = resource;
+	  metrics.metrics.latency = latency;
+	  metrics.metrics.current_datarate = cdr;
+	  metrics.metrics.max_datarate = mdr;
+	  send_metrics (msec, ifname, &metrics);
+	}
+      else if (strcmp (type, "status") == 0)
+	{
+	  n = sscanf (line, "%*f %*s %*s %*s %7s", state);
+	  if (n != 1 || (strcmp (state, "up") && strcmp (state, "down")))
+	    {
+	      fprintf (stderr, "%s:%u: malformed status\n", path, lineno);
+	      exit (1);
+	    }
+	  memset (&status, 0, sizeof (status));
+	  status.ifindex = interface_index (ifname);
+	  status.nbr_addr6 = nbr;
+	  status.status = strcmp (state, "up") ? LM_STATUS_DOWN : LM_STATUS_UP;
+	  send_status (msec, ifname, &status);
+	}
+      else
+	{
+	  fprintf (stderr, "%s:%u: unknown update type: %s\n",
+		   path, lineno, type);
+	  exit (1);
+	}
+    }
+
+  if (f != stdin)
+    fclose (f);
+}
+
+int
+main (int argc, char **argv)
+{
+  const char *zserv = NULL, *ifname = NULL, *trace = NULL;
+  double rate = 10, seconds = 10, speed = 1, start, elapsed;
+  unsigned int count = 0, n, i;
+  struct lmgen_neighbor *nbrs;
+  int c;
+
+  srandom (1);
+
+  while ((c = getopt (argc, argv, "z:r:d:S:pn:i:t:x:")) != -1)
+    switch (c)
+      {
+      case 'z': zserv = optarg; break;
+      case 'r': rate = atof (optarg); break;
+      case 'd': seconds = atof (optarg); break;
+      case 'S': srandom (atoi (optarg)); break;
+      case 'p': print_updates = 1; break;
+      case 'n': count = atoi (optarg); break;
+      case 'i': ifname = optarg; break;
+      case 't': trace = optarg; break;
+      case 'x': speed = atof (optarg); break;
+      default: usage (argv[0]);
+      }
+
+  if (trace == NULL && (ifname == NULL || rate <= 0 ||
+			(count == 0 && optind == argc)))
+    usage (argv[0]);
+  if (speed <= 0)
+    usage (argv[0]);
+
+  zclient = zclient_new ();
+  if (zserv)
+    zclient_serv_path_set (zserv);
+  if (zclient_socket_connect (zclient) < 0)
+    {
+      fprintf (stderr, "cannot connect to zebra\n");
+      return 1;
+    }
+
+  start = now ();
+  if (trace)
+    replay (trace, speed);
+  else
+    {
+      n = count + argc - optind;
+      nbrs = calloc (n, sizeof (*nbrs));
+      for (i = 0; i < n; i++)
+	{
+	  if (i < count)
+	    {
+	      nbrs[i].addr.s6_addr[0] = 0xfe;
+	      nbrs[i].addr.s6_addr[1] = 0x80;
+	      nbrs[i].addr.s6_addr[14] = (i + 1) >> 8;
+	      nbrs[i].addr.s6_addr[15] = (i + 1) & 0xff;
+	    }
+	  else if (inet_pton (AF_INET6, argv[optind + i - count],
+			      &nbrs[i].addr) != 1)
+	    {
+	      fprintf (stderr, "invalid neighbor address: %s\n",
+		       argv[optind + i - count]);
+	      return 1;
+	    }
+	  nbrs[i].metrics.rlq = 50 + random () % 51;
+	  nbrs[i].metrics.resource = random () % 101;
+	  nbrs[i].metrics.latency = 10 + random () % 90;
+	  nbrs[i].metrics.max_datarate = 1000 * (1 + random () % 54);
+	  nbrs[i].metrics.current_datarate = nbrs[i].metrics.max_datarate / 2;
+	}
+      synthetic (ifname, nbrs, n, rate, seconds);
+      free (nbrs);
+    }
+  elapsed = now () - start;
+
+  fprintf (stderr, "sent %lu metrics and %lu status updates in %.3f s, "
+	   "%.1f per second\n", sent_metrics, sent_status, elapsed,
+	   (sent_metrics + sent_status) / (elapsed > 0 ? elapsed : 1));
+
+  close (zclient->sock);
+  return 0;
+}
@@ -0,0 +1,331 @@
+/*
+ * This file is part of Quagga.
+ *
+ * Quagga is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * Quagga is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quagga; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+/* This programme measures how fast a daemon reads a large
+ * configuration.  Synthetic configurations of "ipv6 prefix-list"
+ * lines and of interfaces with "ipv6 ospf6 neighbor-cost" lines are
+ * read through vty_read_config(), with the library commands installed
+ * the way daemons install them and stand-ins for the commands of an
+ * ospf6d interface.  Every line must be executed.  Lines are first
+ * executed one at a time, with keywords abbreviated and not, to check
+ * what the commands match.  Usage:
+ *
+ *   testcmdload [lines]
+ *
+ * Without an argument configurations of 20000 lines are read.
+ */
+#include <zebra.h>
+
+#include "thread.h"
+#include "memory.h"
+#include "vty.h"
+#include "command.h"
+#include "prefix.h"
+#include "plist.h"
+#include "filter.h"
+#include "routemap.h"
+#include "if.h"
+#include "buffer.h"
+
+#include "tests.h"
+
+struct thread_master *master;
+
+#define NEIGHBORS_PER_INTERFACE	100
+
+static unsigned int executed;
+static int executed_argc;
+static unsigned int neighbor_costs;
+
+static struct cmd_node interface_node =
+{
+  INTERFACE_NODE,
+  "%s(config-if)# ",
+  1
+};
+
+static int
+standin (struct cmd_element *self, struct vty *vty, int argc,
+         const char *argv[])
+{
+  executed++;
+  executed_argc = argc;
+  return CMD_SUCCESS;
+}
+
+DEFUN (neighbor_cost,
+       neighbor_cost_cmd,
+       "ipv6 ospf6 neighbor-cost A.B.C.D <1-65535>",
+       IP6_STR
+       "Open Shortest Path First (OSPF) for IPv6\n"
+       "Interface neighbor cost\n"
+       "Neighbor router ID\n"
+       "Outgoing metric of this interface for the neighbor\n")
+{
+  neighbor_costs++;
+  return CMD_SUCCESS;
+}
+
+/* Interface commands of ospf6d. */
+static struct cmd_element interface_cmds[] =
+{
+  { .string = "ipv6 ospf6 cost <1-65535>", .func = standin },
+  { .string = "no ipv6 ospf6 cost", .func = standin },
+  { .string = "ipv6 ospf6 hello-interval <1-65535>", .func = standin },
+  { .string = "ipv6 ospf6 dead-interval <1-65535>", .func = standin },
+  { .string = "ipv6 ospf6 retransmit-interval <1-65535>", .func = standin },
+  { .string = "ipv6 ospf6 priority <0-255>", .func = standin },
+  { .string = "ipv6 ospf6 transmit-delay <1-3600>", .func = standin },
+  { .string = "ipv6 ospf6 instance-id <0-255>", .func = standin },
+  { .string = "ipv6 ospf6 passive", .func = standin },
+  { .string = "no ipv6 ospf6 passive", .func = standin },
+  { .string = "ipv6 ospf6 mtu-ignore", .func = standin },
+  { .string = "no ipv6 ospf6 mtu-ignore", .func = standin },
+  { .string = "ipv6 ospf6 advertise prefix-list WORD", .func = standin },
+  { .string = "no ipv6 ospf6 advertise prefix-list", .func = standin },
+  { .string = "ipv6 ospf6 network (broadcast|point-to-point|manet-designated-router|manet-mdr)",
+    .func = standin },
+  { .string = "no ipv6 ospf6 network", .func = standin },
+  { .string = "ipv6 ospf6 ackinterval <1-65535>", .func = standin },
+  { .string = "ipv6 ospf6 backupwaitinterval <1-65535>", .func = standin },
+  { .string = "ipv6 ospf6 adjacencyconnectivity (uniconnected|biconnected|fullyconnected)",
+    .func = standin },
+  { .string = "ipv6 ospf6 lsafullness (mincostlsa|mincost2lsa|mdrfulllsa|fulllsa)",
+    .func = standin },
+  { .string = "ipv6 ospf6 diffhellos", .func = standin },
+  { .string = "no ipv6 ospf6 diffhellos", .func = standin },
+  { .string = "ipv6 ospf6 consec-hello-threshold <1-65535>", .func = standin },
+  { .string = "ipv6 ospf6 flood-delay <1-65535>", .func = standin },
+  { .string = "no ipv6 ospf6 neighbor-cost [A.B.C.D]", .func = standin },
+  { .string = "description .LINE", .func = standin },
+  { .string = "no description", .func = standin },
+  { .string = "bandwidth <1-10000000>", .func = standin },
+  { .string = "shutdown", .func = standin },
+  { .string = "no shutdown", .func = standin },
+  { .string = "multicast", .func = standin },
+  { .string = "link-detect", .func = standin },
+  { .string = "ip address A.B.C.D/M", .func = standin },
+  { .string = "ipv6 address X:X::X:X/M", .func = standin },
+};
+
+/* Execute LINE on the interface node, keywords abbreviated unless
+   STRICT, and check the result is RET and, on success, that the
+   command was given ARGC arguments. */
+static void
+check_line (struct vty *vty, const char *line, int strict, int ret,
+            int argc)
+{
+  vector vline = cmd_make_strvec (line);
+  int r;
+
+  vty->node = INTERFACE_NODE;
+  executed_argc = -1;
+  if (strict)
+    r = cmd_execute_command_strict (vline, vty, NULL);
+  else
+    r = cmd_execute_command (vline, vty, NULL, 0);
+  cmd_free_strvec (vline);
+
+  if (r != ret || (ret == CMD_SUCCESS && executed_argc != argc))
+    {
+      fprintf (stderr, "\"%s\"%s: result %d with %d arguments, "
+               "%d with %d expected\n", line, strict ? " strictly" : "",
+               r, executed_argc, ret, argc);
+      exit (1);
+    }
+}
+
+/* Check LINE gives RET, and ARGC arguments on success, whether
+   keywords may be abbreviated or not. */
+static void
+check_both (struct vty *vty, const char *line, int ret, int argc)
+{
+  check_line (vty, line, 0, ret, argc);
+  check_line (vty, line, 1, ret, argc);
+}
+
+static void
+check_matching (void)
+{
+  struct vty *vty = vty_new ();
+
+  /* Keywords in full, abbreviated, and abbreviated ambiguously. */
+  check_both (vty, "ipv6 ospf6 cost 10", CMD_SUCCESS, 1);
+  check_line (vty, "ipv ospf6 cos 10", 0, CMD_SUCCESS, 1);
+  check_line (vty, "ipv ospf6 cos 10", 1, CMD_ERR_NO_MATCH, 0);
+  check_line (vty, "ipv6 ospf6 co 10", 0, CMD_ERR_AMBIGUOUS, 0);
+  check_line (vty, "ipv6 ospf6 co 10", 1, CMD_ERR_NO_MATCH, 0);
+  check_line (vty, "ipv6 ospf6 network point", 0, CMD_SUCCESS, 1);
+  check_line (vty, "ipv6 ospf6 network point", 1, CMD_ERR_NO_MATCH, 0);
+  check_line (vty, "ipv6 ospf6 network manet", 0, CMD_ERR_AMBIGUOUS, 0);
+  check_both (vty, "ipv6 ospf6 network manet-mdr", CMD_SUCCESS, 1);
+  check_both (vty, "ipv6 ospf6 bogus", CMD_ERR_NO_MATCH, 0);
+  check_both (vty, "ipv6 ospf6 passive now", CMD_ERR_NO_MATCH, 0);
+
+  /* Commands missing tokens, mandatory or optional. */
+  check_both (vty, "ipv6 ospf6 cost", CMD_ERR_INCOMPLETE, 0);
+  check_both (vty, "ipv6 ospf6", CMD_ERR_INCOMPLETE, 0);
+  check_both (vty, "no ipv6 ospf6 neighbor-cost", CMD_SUCCESS, 0);
+  check_both (vty, "no ipv6 ospf6 neighbor-cost 10.0.0.1", CMD_SUCCESS, 1);
+
+  /* Ranges. */
+  check_both (vty, "ipv6 ospf6 priority 0", CMD_SUCCESS, 1);
+  check_both (vty, "ipv6 ospf6 priority 255", CMD_SUCCESS, 1);
+  check_both (vty, "ipv6 ospf6 priority 256", CMD_ERR_NO_MATCH, 0);
+  check_both (vty, "ipv6 ospf6 cost 0", CMD_ERR_NO_MATCH, 0);
+  check_both (vty, "ipv6 ospf6 cost 1x", CMD_ERR_NO_MATCH, 0);
+
+  /* Prefixes, whole and partial. */
+  check_both (vty, "ip address 10.0.0.1/24", CMD_SUCCESS, 1);
+  check_both (vty, "ip address 10.0.0", CMD_ERR_NO_MATCH, 0);
+  check_both (vty, "ip address 10.0.0.1/", CMD_ERR_NO_MATCH, 0);
+  check_both (vty, "ip address 10.0.0.1/33", CMD_ERR_NO_MATCH, 0);
+  check_both (vty, "ipv6 address 2001:db8::1/64", CMD_SUCCESS, 1);
+  check_both (vty, "ipv6 address 2001:db8::1", CMD_ERR_NO_MATCH, 0);
+  check_both (vty, "ipv6 address 2001:db8::1/", CMD_ERR_NO_MATCH, 0);
+
+  /* A variable number of arguments. */
+  check_both (vty, "description uplink", CMD_SUCCESS, 1);
+  check_both (vty, "description uplink to the core", CMD_SUCCESS, 4);
+  check_line (vty, "desc uplink to the core", 0, CMD_SUCCESS, 4);
+  check_line (vty, "desc uplink to the core", 1, CMD_ERR_NO_MATCH, 0);
+  check_both (vty, "description", CMD_ERR_INCOMPLETE, 0);
+
+  buffer_free (vty->obuf);
+  XFREE (MTYPE_VTY, vty->buf);
+  XFREE (MTYPE_VTY, vty);
+}
+
+/* Read the configuration GEN writes with LINES lines. */
+static void
+load (const char *what, void (*gen) (FILE *, unsigned int),
+      unsigned int lines)
+{
+  char path[] = "/tmp/testcmdload.XXXXXX";
+  struct timeval start;
+  FILE *fp;
+  int fd;
+  double ms;
+
+  if ((fd = mkstemp (path)) < 0 || (fp = fdopen (fd, "w")) == NULL)
+    fail ("cannot create a temporary configuration");
+  (*gen) (fp, lines);
+  fclose (fp);
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  vty_read_config (path, NULL);
+  ms = elapsed (&start);
+  unlink (path);
+
+  printf ("%-26s %7u lines %9.2f ms %8.2f us/line\n", what, lines, ms,
+          ms * 1000.0 / lines);
+}
+
+static void
+gen_prefix_list (FILE *fp, unsigned int lines)
+{
+  unsigned int i;
+
+  for (i = 0; i < lines; i++)
+    fprintf (fp, "ipv6 prefix-list list%u seq %u permit "
+             "2001:db8:%x:%x::/64 le 128\n",
+             i % 10, 5 * (i / 10 + 1), i >> 16, i & 0xffff);
+}
+
+static void
+gen_neighbor_cost (FILE *fp, unsigned int lines)
+{
+  unsigned int i;
+
+  for (i = 0; i < lines; i++)
+    {
+      if (i % NEIGHBORS_PER_INTERFACE == 0)
+        fprintf (fp, "!\ninterface eth%u\n", i / NEIGHBORS_PER_INTERFACE);
+      fprintf (fp, " ipv6 ospf6 neighbor-cost 10.%u.%u.%u %u\n",
+               (i >> 16) & 0xff, (i >> 8) & 0xff, i & 0xff, 1 + i % 65535);
+    }
+  fprintf (fp, "!\n");
+}
+
+static void
+check_prefix_list (unsigned int lines)
+{
+  struct prefix_list *plist;
+  struct prefix p;
+  unsigned int last = lines - 1;
+  char buf[64];
+
+  plist = prefix_list_lookup (AFI_IP6, "list0");
+  if (plist == NULL)
+    fail ("prefix-list list0 was not configured");
+
+  snprintf (buf, sizeof (buf), "2001:db8:%x:%x::1/128",
+            (last - last % 10) >> 16, (last - last % 10) & 0xffff);
+  str2prefix (buf, &p);
+  if (prefix_list_apply (plist, &p) != PREFIX_PERMIT)
+    fail ("the last entry of prefix-list list0 is missing");
+
+  str2prefix ("2001:db9::1/128", &p);
+  if (prefix_list_apply (plist, &p) != PREFIX_DENY)
+    fail ("prefix-list list0 permits a prefix not configured");
+}
+
+int
+main (int argc, char **argv)
+{
+  unsigned int lines = 20000;
+  unsigned int i;
+
+  if (argc > 1)
+    {
+      lines = strtoul (argv[1], NULL, 10);
+      if (lines < 1)
+        fail ("usage: testcmdload [lines]");
+    }
+
+  master = thread_master_create ();
+
+  cmd_init (1);
+  vty_init (master);
+  memory_init ();
+  access_list_init ();
+  prefix_list_init ();
+  route_map_init ();
+  route_map_init_vty ();
+
+  if_init ();
+  install_node (&interface_node, NULL);
+  install_element (CONFIG_NODE, &interface_cmd);
+  install_element (CONFIG_NODE, &no_interface_cmd);
+  install_default (INTERFACE_NODE);
+  install_element (INTERFACE_NODE, &neighbor_cost_cmd);
+  for (i = 0; i < sizeof (interface_cmds) / sizeof (interface_cmds[0]); i++)
+    install_element (INTERFACE_NODE, &interface_cmds[i]);
+
+  check_matching ();
+
+  load ("ipv6 prefix-list", gen_prefix_list, lines);
+  check_prefix_list (lines);
+
+  load ("ipv6 ospf6 neighbor-cost", gen_neighbor_cost, lines);
+  if (neighbor_costs != lines)
+    fail ("not every neighbor-cost line was executed");
+
+  return 0;
+}
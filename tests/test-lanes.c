@@ -0,0 +1,177 @@
+/*
+ * This file is part of Quagga.
+ *
+ * Quagga is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * Quagga is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quagga; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+/* This programme measures how late a periodic timer runs, like the
+ * hello timer of ospf6d, while the thread scheduler is busy with bursts
+ * of events and a long work queue.  The timer runs at normal and then
+ * at high priority.  The bursts and the work queue must make progress
+ * either way.  Usage:
+ *
+ *   testlanes [msec]
+ *
+ * Without an argument each run lasts 2000 milliseconds.
+ */
+#include <zebra.h>
+
+#include "thread.h"
+#include "memory.h"
+#include "workqueue.h"
+
+#include "tests.h"
+
+struct thread_master *master;
+
+#define PROBE_MSEC		10	/* interval of the timer measured */
+#define BURST_MSEC		100	/* interval of the bursts of events */
+#define BURST_EVENTS		500
+#define EVENT_USEC		200	/* run time of an event */
+#define ITEM_USEC		50	/* run time of a work queue item */
+#define ITEMS			100000
+
+static struct
+{
+  u_char priority;
+  struct timeval end;
+  int done;
+
+  unsigned int probes;
+  unsigned long lag_total, lag_max;	/* usec */
+  unsigned long events;
+  unsigned long items;
+} run;
+
+static void
+spin (unsigned long usec)
+{
+  struct timeval start, now;
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  do
+    quagga_gettime (QUAGGA_CLK_MONOTONIC, &now);
+  while (timersub_usec (&now, &start) < (long) usec);
+}
+
+static int
+probe (struct thread *thread)
+{
+  struct timeval now;
+  long lag;
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &now);
+  if ((lag = timersub_usec (&now, &thread->u.sands)) < 0)
+    lag = 0;
+  run.probes++;
+  run.lag_total += lag;
+  if (run.lag_max < (unsigned long) lag)
+    run.lag_max = lag;
+
+  if (timercmp (&now, &run.end, >))
+    {
+      run.done = 1;
+      return 0;
+    }
+  thread_set_priority (thread_add_timer_msec (master, probe, NULL,
+					      PROBE_MSEC), run.priority);
+  return 0;
+}
+
+static int
+event (struct thread *thread)
+{
+  spin (EVENT_USEC);
+  run.events++;
+  return 0;
+}
+
+static int
+burst (struct thread *thread)
+{
+  unsigned int i;
+
+  for (i = 0; i < BURST_EVENTS; i++)
+    thread_add_event (master, event, NULL, 0);
+  thread_add_timer_msec (master, burst, NULL, BURST_MSEC);
+  return 0;
+}
+
+static wq_item_status
+item (struct work_queue *wq, void *data)
+{
+  spin (ITEM_USEC);
+  run.items++;
+  return WQ_SUCCESS;
+}
+
+static void
+measure (const char *what, u_char priority, unsigned long msec)
+{
+  struct work_queue *wq;
+  struct thread thread;
+  unsigned int i;
+
+  memset (&run, 0, sizeof (run));
+  run.priority = priority;
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &run.end);
+  run.end.tv_sec += msec / 1000;
+  run.end.tv_usec += (msec % 1000) * 1000;
+  if (run.end.tv_usec >= 1000000)
+    {
+      run.end.tv_sec++;
+      run.end.tv_usec -= 1000000;
+    }
+
+  master = thread_master_create ();
+  wq = work_queue_new (master, "testlanes");
+  wq->spec.workfunc = item;
+  for (i = 0; i < ITEMS; i++)
+    work_queue_add (wq, &run);
+
+  thread_add_event (master, burst, NULL, 0);
+  thread_set_priority (thread_add_timer_msec (master, probe, NULL,
+					      PROBE_MSEC), priority);
+
+  while (! run.done && thread_fetch (master, &thread))
+    thread_call (&thread);
+
+  printf ("%-7s timer: %4u runs, %8.1f us late on average, %8.1f us at "
+	  "most; %6lu events, %6lu work queue items\n", what, run.probes,
+	  (double) run.lag_total / run.probes, (double) run.lag_max,
+	  run.events, run.items);
+  if (run.events == 0 || run.items == 0)
+    fail ("the events or the work queue were starved");
+
+  work_queue_free (wq);
+  thread_master_free (master);
+}
+
+int
+main (int argc, char **argv)
+{
+  unsigned long msec = 2000;
+
+  if (argc > 1 && (msec = strtoul (argv[1], NULL, 10)) < 1)
+    fail ("usage: testlanes [msec]");
+
+  memory_init ();
+
+  measure ("normal", THREAD_PRIORITY_NORMAL, msec);
+  measure ("high", THREAD_PRIORITY_HIGH, msec);
+
+  return 0;
+}
@@ -0,0 +1,298 @@
+/*
+ * This file is part of Quagga.
+ *
+ * Quagga is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * Quagga is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quagga; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+/* This programme feeds batches of netlink link and address messages
+ * through the coalescing queue of zebra and checks what is applied and
+ * in which order.  Links are kept by name, the way zebra looks them up,
+ * so a link removed and created again under the same name within one
+ * batch must end up present with its new index.  Usage:
+ *
+ *   testnetlinkevent
+ */
+#include <zebra.h>
+
+#include "thread.h"
+#include "memory.h"
+#include "command.h"
+
+#include "zebra/netlink_event.h"
+
+#include "tests.h"
+
+struct thread_master *master;
+
+/* zebra/debug.h */
+unsigned long zebra_debug_kernel;
+
+#ifdef HAVE_NETLINK
+
+#define LINKS_MAX	8
+#define APPLIED_MAX	32
+
+/* The links known, by name as in zebra. */
+static struct
+{
+  char name[IFNAMSIZ];
+  int index;
+} links[LINKS_MAX];
+
+/* The messages applied, in order. */
+static struct
+{
+  u_int16_t type;
+  int index;
+} applied[APPLIED_MAX];
+static unsigned int napplied;
+
+static int
+link_find (const char *name)
+{
+  int i;
+
+  for (i = 0; i < LINKS_MAX; i++)
+    if (links[i].index && strcmp (links[i].name, name) == 0)
+      return i;
+  return -1;
+}
+
+/* Apply a message as zebra would: links by name, deletions only of the
+   link with the index deleted. */
+static int
+fetch (struct sockaddr_nl *snl, struct nlmsghdr *h)
+{
+  struct ifinfomsg *ifi = NLMSG_DATA (h);
+  struct ifaddrmsg *ifa = NLMSG_DATA (h);
+  struct rtattr *tb[IFLA_MAX + 1];
+  const char *name;
+  int i;
+
+  if (napplied == APPLIED_MAX)
+    fail ("too many messages applied");
+  applied[napplied].type = h->nlmsg_type;
+
+  switch (h->nlmsg_type)
+    {
+    case RTM_NEWLINK:
+    case RTM_DELLINK:
+      applied[napplied++].index = ifi->ifi_index;
+      memset (tb, 0, sizeof tb);
+      netlink_parse_rtattr (tb, IFLA_MAX, IFLA_RTA (ifi),
+			    h->nlmsg_len - NLMSG_LENGTH (sizeof (*ifi)));
+      if (tb[IFLA_IFNAME] == NULL)
+	fail ("a link message lost its name");
+      name = RTA_DATA (tb[IFLA_IFNAME]);
+      i = link_find (name);
+      if (h->nlmsg_type == RTM_NEWLINK)
+	{
+	  if (i < 0)
+	    for (i = 0; i < LINKS_MAX && links[i].index; i++)
+	      ;
+	  if (i == LINKS_MAX)
+	    fail ("too many links");
+	  strncpy (links[i].name, name, IFNAMSIZ - 1);
+	  links[i].index = ifi->ifi_index;
+	}
+      else if (i >= 0 && links[i].index == ifi->ifi_index)
+	links[i].index = 0;
+      break;
+
+    case RTM_NEWADDR:
+    case RTM_DELADDR:
+      applied[napplied++].index = ifa->ifa_index;
+      break;
+
+    default:
+      fail ("unexpected message type");
+    }
+
+  return 0;
+}
+
+static void
+queue (struct nlmsghdr *h)
+{
+  struct sockaddr_nl snl;
+
+  memset (&snl, 0, sizeof snl);
+  snl.nl_family = AF_NETLINK;
+  netlink_event_queue (&snl, h);
+}
+
+static void
+queue_link (u_int16_t type, int index, const char *name)
+{
+  char buf[NLMSG_SPACE (sizeof (struct ifinfomsg)) + RTA_SPACE (IFNAMSIZ)];
+  struct nlmsghdr *h = (struct nlmsghdr *) buf;
+  struct ifinfomsg *ifi;
+  struct rtattr *rta;
+
+  memset (buf, 0, sizeof buf);
+  h->nlmsg_len = NLMSG_LENGTH (sizeof (struct ifinfomsg));
+  h->nlmsg_type = type;
+  ifi = NLMSG_DATA (h);
+  ifi->ifi_family = AF_UNSPEC;
+  ifi->ifi_index = index;
+
+  rta = (struct rtattr *) (buf + NLMSG_ALIGN (h->nlmsg_len));
+  rta->rta_type = IFLA_IFNAME;
+  rta->rta_len = RTA_LENGTH (strlen (name) + 1);
+  strcpy (RTA_DATA (rta), name);
+  h->nlmsg_len = NLMSG_ALIGN (h->nlmsg_len) + RTA_ALIGN (rta->rta_len);
+
+  queue (h);
+}
+
+static void
+queue_addr (u_int16_t type, int index, u_int32_t addr)
+{
+  char buf[NLMSG_SPACE (sizeof (struct ifaddrmsg)) + RTA_SPACE (4)];
+  struct nlmsghdr *h = (struct nlmsghdr *) buf;
+  struct ifaddrmsg *ifa;
+  struct rtattr *rta;
+
+  memset (buf, 0, sizeof buf);
+  h->nlmsg_len = NLMSG_LENGTH (sizeof (struct ifaddrmsg));
+  h->nlmsg_type = type;
+  ifa = NLMSG_DATA (h);
+  ifa->ifa_family = AF_INET;
+  ifa->ifa_prefixlen = 24;
+  ifa->ifa_index = index;
+
+  rta = (struct rtattr *) (buf + NLMSG_ALIGN (h->nlmsg_len));
+  rta->rta_type = IFA_LOCAL;
+  rta->rta_len = RTA_LENGTH (4);
+  addr = htonl (addr);
+  memcpy (RTA_DATA (rta), &addr, 4);
+  h->nlmsg_len = NLMSG_ALIGN (h->nlmsg_len) + RTA_ALIGN (rta->rta_len);
+
+  queue (h);
+}
+
+/* Apply the batch queued and check the messages applied against the
+   type and index pairs given, ended by a type of 0. */
+static void
+apply (const char *what, ...)
+{
+  va_list ap;
+  unsigned int i;
+  int type;
+
+  napplied = 0;
+  if (netlink_event_apply () != napplied)
+    fail ("the number of events applied is wrong");
+
+  va_start (ap, what);
+  for (i = 0; (type = va_arg (ap, int)) != 0; i++)
+    if (i >= napplied || applied[i].type != type ||
+	applied[i].index != va_arg (ap, int))
+      {
+	fprintf (stderr, "%s: message %u applied wrongly\n", what, i);
+	exit (1);
+      }
+  va_end (ap);
+  if (i != napplied)
+    {
+      fprintf (stderr, "%s: %u messages applied, %u expected\n", what,
+	       napplied, i);
+      exit (1);
+    }
+}
+
+static void
+check_link (const char *name, int index)
+{
+  int i = link_find (name);
+
+  if (index ? (i < 0 || links[i].index != index) : i >= 0)
+    {
+      fprintf (stderr, "link %s has index %d, %d expected\n", name,
+	       i < 0 ? 0 : links[i].index, index);
+      exit (1);
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  master = thread_master_create ();
+  cmd_init (1);
+  memory_init ();
+  netlink_event_init (fetch);
+
+  queue_link (RTM_NEWLINK, 5, "tun0");
+  queue_addr (RTM_NEWADDR, 5, 0x0a000001);
+  apply ("create", RTM_NEWLINK, 5, RTM_NEWADDR, 5, 0);
+  check_link ("tun0", 5);
+
+  /* Only the last message about a link or address is applied, links
+     before addresses. */
+  queue_addr (RTM_NEWADDR, 5, 0x0a000002);
+  queue_link (RTM_NEWLINK, 5, "tun0");
+  queue_addr (RTM_DELADDR, 5, 0x0a000002);
+  queue_link (RTM_NEWLINK, 5, "tun0");
+  apply ("coalesce", RTM_NEWLINK, 5, RTM_DELADDR, 5, 0);
+  check_link ("tun0", 5);
+
+  /* Deleted and created again under the same name in one batch. */
+  queue_addr (RTM_DELADDR, 5, 0x0a000001);
+  queue_link (RTM_DELLINK, 5, "tun0");
+  queue_link (RTM_NEWLINK, 6, "tun0");
+  queue_addr (RTM_NEWADDR, 6, 0x0a000001);
+  apply ("recreate", RTM_DELLINK, 5, RTM_NEWLINK, 6,
+	 RTM_DELADDR, 5, RTM_NEWADDR, 6, 0);
+  check_link ("tun0", 6);
+
+  /* Changed, deleted, created and deleted again, then created once
+     more, all in one batch. */
+  queue_link (RTM_NEWLINK, 6, "tun0");
+  queue_link (RTM_DELLINK, 6, "tun0");
+  queue_link (RTM_NEWLINK, 7, "tun0");
+  queue_link (RTM_DELLINK, 7, "tun0");
+  queue_link (RTM_NEWLINK, 8, "tun0");
+  apply ("flap", RTM_DELLINK, 6, RTM_DELLINK, 7, RTM_NEWLINK, 8, 0);
+  check_link ("tun0", 8);
+
+  /* A deletion reported after the new link is not applied to it. */
+  queue_link (RTM_NEWLINK, 9, "tun0");
+  queue_link (RTM_DELLINK, 8, "tun0");
+  apply ("late", RTM_NEWLINK, 9, RTM_DELLINK, 8, 0);
+  check_link ("tun0", 9);
+
+  queue_link (RTM_DELLINK, 9, "tun0");
+  apply ("delete", RTM_DELLINK, 9, 0);
+  check_link ("tun0", 0);
+
+  /* only the array of the queue itself is kept */
+  if (mtype_stats_alloc (MTYPE_NETLINK_EVENT) != 1)
+    fail ("a queued event was not freed");
+
+  printf ("netlink events applied as expected\n");
+  return 0;
+}
+
+#else /* HAVE_NETLINK */
+
+int
+main (int argc, char **argv)
+{
+  printf ("built without netlink, nothing to check\n");
+  return 0;
+}
+
+#endif /* HAVE_NETLINK */
@@ -0,0 +1,289 @@
+/*
+ * This file is part of Quagga.
+ *
+ * Quagga is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * Quagga is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quagga; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+/* This programme checks prefix_list_apply() against an in-order walk
+ * of the entries, the way prefix lists were matched before they were
+ * indexed by prefix, and compares their throughput.  Lists of IPv4
+ * entries with random lengths, ge and le ranges and actions are built
+ * through the ORF interface, as it is the one not needing a vty, then
+ * a fifth of the entries are deleted and the list is checked again.
+ * Usage:
+ *
+ *   testplist [entries]
+ *
+ * Without an argument lists of 1000, 10000 and 100000 entries are
+ * used.
+ */
+#include <zebra.h>
+
+#include "thread.h"
+#include "memory.h"
+#include "prefix.h"
+#include "command.h"
+#include "plist.h"
+
+#include "tests.h"
+
+struct thread_master *master;
+
+#define PROBES		100000
+#define LINEAR_BUDGET	200000000	/* entries tried by the walk */
+
+struct entry
+{
+  struct orf_prefix orf;
+  int permit;
+  int deleted;
+};
+
+static u_int64_t seed = 88172645463325252ULL;
+
+static u_int32_t
+rnd (void)
+{
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return (u_int32_t) (seed >> 16);
+}
+
+static void
+report (const char *what, struct timeval *start, unsigned int ops)
+{
+  double ms = elapsed (start);
+
+  printf ("  %-8s %9.2f ms %8.1f ns/op %10.0f ops/s\n", what, ms,
+          ops ? ms * 1000000.0 / ops : 0, ms > 0 ? ops * 1000.0 / ms : 0);
+}
+
+static void
+random_prefix (struct prefix *p, int minlen, int maxlen)
+{
+  memset (p, 0, sizeof (*p));
+  p->family = AF_INET;
+  p->prefixlen = minlen + rnd () % (maxlen - minlen + 1);
+  p->u.prefix4.s_addr = htonl (rnd () << 16 | (rnd () & 0xffff));
+  apply_mask (p);
+}
+
+/* A prefix inside p, of length p's to 32. */
+static void
+longer_prefix (const struct prefix *p, struct prefix *q)
+{
+  u_int32_t host;
+
+  *q = *p;
+  q->prefixlen = p->prefixlen + rnd () % (IPV4_MAX_BITLEN - p->prefixlen + 1);
+  host = rnd () << 16 | (rnd () & 0xffff);
+  if (p->prefixlen)
+    host &= 0xffffffff >> p->prefixlen;
+  q->u.prefix4.s_addr |= htonl (host);
+  apply_mask (q);
+}
+
+static void
+make_entry (struct entry *e, int seq)
+{
+  struct orf_prefix *orf = &e->orf;
+  int len;
+
+  memset (e, 0, sizeof (*e));
+  random_prefix (&orf->p, 8, 24);
+  len = orf->p.prefixlen;
+  orf->seq = seq;
+  switch (rnd () % 4)
+    {
+    case 0:			/* exact */
+      break;
+    case 1:
+      orf->le = len + 1 + rnd () % (IPV4_MAX_BITLEN - len);
+      break;
+    case 2:
+      orf->ge = len + 1 + rnd () % (IPV4_MAX_BITLEN - len);
+      break;
+    case 3:
+      orf->ge = len + 1 + rnd () % (IPV4_MAX_BITLEN - len);
+      orf->le = orf->ge + rnd () % (IPV4_MAX_BITLEN - orf->ge + 1);
+      break;
+    }
+  e->permit = rnd () % 2;
+}
+
+static int
+entry_match (const struct entry *e, const struct prefix *p)
+{
+  const struct orf_prefix *orf = &e->orf;
+
+  if (! prefix_match (&orf->p, p))
+    return 0;
+  if (! orf->le && ! orf->ge)
+    return orf->p.prefixlen == p->prefixlen;
+  if (orf->le && p->prefixlen > orf->le)
+    return 0;
+  if (orf->ge && p->prefixlen < orf->ge)
+    return 0;
+  return 1;
+}
+
+/* First match by walking the entries in order, as plist.c did. */
+static enum prefix_list_type
+linear_apply (const struct entry *entries, unsigned int count,
+              const struct prefix *p)
+{
+  unsigned int i;
+
+  for (i = 0; i < count; i++)
+    if (! entries[i].deleted && entry_match (&entries[i], p))
+      return entries[i].permit ? PREFIX_PERMIT : PREFIX_DENY;
+  return PREFIX_DENY;
+}
+
+static void
+check (const char *what, struct prefix_list *plist,
+       const struct entry *entries, unsigned int count,
+       struct prefix *probes, enum prefix_list_type *expect)
+{
+  struct timeval start;
+  unsigned int nlinear, i, permits;
+
+  /* Keep the walk to about LINEAR_BUDGET entries tried. */
+  nlinear = MIN (PROBES, MAX (1000, LINEAR_BUDGET / count));
+
+  printf (" %s:\n", what);
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  for (i = 0; i < nlinear; i++)
+    expect[i] = linear_apply (entries, count, &probes[i]);
+  report ("walk", &start, nlinear);
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  for (i = 0, permits = 0; i < PROBES; i++)
+    if (prefix_list_apply (plist, &probes[i]) == PREFIX_PERMIT)
+      permits++;
+  report ("apply", &start, PROBES);
+
+  for (i = 0; i < nlinear; i++)
+    if (prefix_list_apply (plist, &probes[i]) != expect[i])
+      {
+        char buf[BUFSIZ];
+
+        prefix2str (&probes[i], buf, sizeof (buf));
+        fprintf (stderr, "%s: %s: wrong action\n", what, buf);
+        exit (1);
+      }
+  printf ("  %u of %u probes permitted, %u checked\n",
+          permits, PROBES, nlinear);
+}
+
+static void
+run (unsigned int count)
+{
+  char name[] = "testplist";
+  struct entry *entries;
+  struct prefix *probes;
+  enum prefix_list_type *expect;
+  struct prefix_list *plist;
+  struct timeval start;
+  unsigned int i, added, deleted;
+
+  entries = calloc (count, sizeof (*entries));
+  probes = calloc (PROBES, sizeof (*probes));
+  expect = calloc (PROBES, sizeof (*expect));
+  if (! entries || ! probes || ! expect)
+    fail ("out of memory");
+
+  printf ("%u entries:\n", count);
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  for (i = 0, added = 0; i < count; i++)
+    {
+      struct orf_prefix orf;
+
+      make_entry (&entries[i], (i + 1) * 5);
+      orf = entries[i].orf;
+      if (prefix_bgp_orf_set (name, AFI_IP, &orf, entries[i].permit, 1)
+          == CMD_SUCCESS)
+        {
+          entries[i].orf = orf;
+          added++;
+        }
+      else
+        entries[i].deleted = 1;	/* a duplicate */
+    }
+  report ("build", &start, count);
+
+  plist = prefix_list_lookup (AFI_ORF_PREFIX, name);
+  if (plist == NULL || plist->count != (int) added)
+    fail ("prefix list not built");
+
+  /* Most probes fall within an entry, the rest anywhere. */
+  for (i = 0; i < PROBES; i++)
+    if (rnd () % 4)
+      longer_prefix (&entries[rnd () % count].orf.p, &probes[i]);
+    else
+      random_prefix (&probes[i], 0, IPV4_MAX_BITLEN);
+
+  check ("all entries", plist, entries, count, probes, expect);
+
+  for (i = 0, deleted = 0; i < count; i++)
+    {
+      struct orf_prefix orf;
+
+      if (entries[i].deleted || rnd () % 5)
+        continue;
+      orf = entries[i].orf;
+      if (prefix_bgp_orf_set (name, AFI_IP, &orf, entries[i].permit, 0)
+          != CMD_SUCCESS)
+        fail ("entry not deleted");
+      entries[i].deleted = 1;
+      deleted++;
+    }
+  if (plist->count != (int) (added - deleted))
+    fail ("entries not deleted");
+
+  check ("a fifth deleted", plist, entries, count, probes, expect);
+
+  prefix_bgp_orf_remove_all (name);
+
+  free (entries);
+  free (probes);
+  free (expect);
+}
+
+int
+main (int argc, char **argv)
+{
+  unsigned int counts[] = { 1000, 10000, 100000 };
+  unsigned int ncounts = 3, c;
+
+  if (argc > 1)
+    {
+      counts[0] = strtoul (argv[1], NULL, 10);
+      ncounts = 1;
+      if (counts[0] < 1)
+        fail ("usage: testplist [entries]");
+    }
+
+  master = thread_master_create ();
+
+  for (c = 0; c < ncounts; c++)
+    run (counts[c]);
+
+  return 0;
+}
@@ -0,0 +1,363 @@
+/*
+ * This file is part of Quagga.
+ *
+ * Quagga is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * Quagga is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quagga; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+/* This programme checks the shared-memory RIB export and compares how
+ * long a client takes to learn a full table from it with how long it
+ * takes from ZEBRA_IPV4_ROUTE_ADD messages over a socket, as zebra
+ * redistributes routes.  Either way the client stores every route in
+ * a route table.  Usage:
+ *
+ *   testribshm [routes]
+ */
+#include <zebra.h>
+#include <sys/wait.h>
+
+#include "thread.h"
+#include "memory.h"
+#include "prefix.h"
+#include "table.h"
+#include "stream.h"
+#include "zclient.h"
+#include "rib_shm.h"
+
+#include "tests.h"
+
+struct thread_master *master;
+
+#define BUFSIZE 65536
+
+static void
+route_prefix (unsigned int i, struct prefix *p)
+{
+  memset (p, 0, sizeof (struct prefix));
+  p->family = AF_INET;
+  p->prefixlen = 28;
+  p->u.prefix4.s_addr = htonl (0x0a000000 + (i << 4));
+}
+
+static void
+route_make (unsigned int i, struct rib_shm_route *route)
+{
+  memset (route, 0, sizeof (struct rib_shm_route));
+  route->type = ZEBRA_ROUTE_OSPF6;
+  route->distance = 110;
+  route->metric = i;
+  route->ifindex = 1 + i % 4;
+  *(u_int32_t *) route->gate = htonl (0xc0a80001 + i % 200);
+}
+
+/* what a client does with every route it learns */
+static void
+table_add (struct route_table *table, struct prefix *p, u_int32_t metric)
+{
+  struct route_node *rn = route_node_get (table, p);
+
+  rn->info = (void *) (long) (metric + 1);
+}
+
+static void
+walk_func (const struct rib_shm_route *route, void *arg)
+{
+  struct prefix p;
+
+  rib_shm_route_prefix (route, &p);
+  table_add (arg, &p, route->metric);
+}
+
+struct changes
+{
+  unsigned int active;
+  unsigned int removed;
+};
+
+static void
+changes_func (const struct rib_shm_route *route, void *arg)
+{
+  struct changes *changes = arg;
+
+  if (CHECK_FLAG (route->state, RIB_SHM_ROUTE_ACTIVE))
+    changes->active++;
+  else
+    changes->removed++;
+}
+
+static unsigned long
+table_count (struct route_table *table)
+{
+  struct route_node *rn;
+  unsigned long count = 0;
+
+  for (rn = route_top (table); rn; rn = route_next (rn))
+    if (rn->info)
+      count++;
+  return count;
+}
+
+/* ZEBRA_IPV4_ROUTE_ADD as zsend_route_multipath() writes it */
+static void
+zapi_route_write (struct stream *s, struct prefix *p,
+                  struct rib_shm_route *route)
+{
+  size_t start = stream_get_endp (s);
+
+  stream_putw (s, ZEBRA_HEADER_SIZE);
+  stream_putc (s, ZEBRA_HEADER_MARKER);
+  stream_putc (s, ZSERV_VERSION);
+  stream_putw (s, ZEBRA_IPV4_ROUTE_ADD);
+  stream_putc (s, route->type);
+  stream_putc (s, route->flags);
+  stream_putc (s, ZAPI_MESSAGE_NEXTHOP | ZAPI_MESSAGE_IFINDEX |
+               ZAPI_MESSAGE_DISTANCE | ZAPI_MESSAGE_METRIC);
+  stream_putc (s, p->prefixlen);
+  stream_write (s, (u_char *) &p->u.prefix, PSIZE (p->prefixlen));
+  stream_putc (s, 1);
+  stream_write (s, route->gate, IPV4_MAX_BYTELEN);
+  stream_putc (s, 1);
+  stream_putl (s, route->ifindex);
+  stream_putc (s, route->distance);
+  stream_putl (s, route->metric);
+  stream_putw_at (s, start, stream_get_endp (s) - start);
+}
+
+/* the client side, as ospf6_zebra_read_ipv4() reads it */
+static void
+zapi_route_read (struct stream *s, struct route_table *table)
+{
+  struct prefix p;
+  u_char message;
+  u_int32_t metric = 0;
+
+  stream_getc (s);              /* type */
+  stream_getc (s);              /* flags */
+  message = stream_getc (s);
+
+  memset (&p, 0, sizeof (p));
+  p.family = AF_INET;
+  p.prefixlen = stream_getc (s);
+  stream_get (&p.u.prefix4, s, PSIZE (p.prefixlen));
+
+  if (CHECK_FLAG (message, ZAPI_MESSAGE_NEXTHOP))
+    {
+      stream_getc (s);
+      stream_get_ipv4 (s);      /* gate */
+    }
+  if (CHECK_FLAG (message, ZAPI_MESSAGE_IFINDEX))
+    {
+      stream_getc (s);
+      stream_getl (s);          /* ifindex */
+    }
+  if (CHECK_FLAG (message, ZAPI_MESSAGE_DISTANCE))
+    stream_getc (s);
+  if (CHECK_FLAG (message, ZAPI_MESSAGE_METRIC))
+    metric = stream_getl (s);
+
+  table_add (table, &p, metric);
+}
+
+static void
+socket_send (int fd, unsigned int count)
+{
+  struct stream *s = stream_new (BUFSIZE);
+  struct rib_shm_route route;
+  struct prefix p;
+  unsigned int i;
+
+  for (i = 0; i < count; i++)
+    {
+      route_prefix (i, &p);
+      route_make (i, &route);
+      zapi_route_write (s, &p, &route);
+      if (STREAM_WRITEABLE (s) < ZEBRA_MAX_PACKET_SIZ || i == count - 1)
+        {
+          if (write (fd, STREAM_DATA (s), stream_get_endp (s)) !=
+              (ssize_t) stream_get_endp (s))
+            fail ("socket write failed");
+          stream_reset (s);
+        }
+    }
+}
+
+static void
+socket_receive (int fd, unsigned int count, struct route_table *table)
+{
+  struct stream *s = stream_new (BUFSIZE);
+  unsigned int received = 0;
+  u_int16_t length;
+  size_t left;
+
+  while (received < count)
+    {
+      if (stream_read_try (s, fd, STREAM_WRITEABLE (s)) < 0)
+        fail ("socket read failed");
+
+      while (STREAM_READABLE (s) >= ZEBRA_HEADER_SIZE)
+        {
+          length = stream_getw_from (s, stream_get_getp (s));
+          if (STREAM_READABLE (s) < length)
+            break;
+          stream_forward_getp (s, ZEBRA_HEADER_SIZE);
+          zapi_route_read (s, table);
+          received++;
+        }
+
+      left = STREAM_READABLE (s);
+      memmove (STREAM_DATA (s), stream_pnt (s), left);
+      stream_set_getp (s, 0);
+      stream_set_endp (s, left);
+    }
+  stream_free (s);
+}
+
+static double
+socket_sync (unsigned int count)
+{
+  struct route_table *table = route_table_init ();
+  struct timeval start;
+  double ms;
+  int fds[2];
+  pid_t pid;
+
+  if (socketpair (AF_UNIX, SOCK_STREAM, 0, fds) < 0)
+    fail ("socketpair failed");
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  pid = fork ();
+  if (pid < 0)
+    fail ("fork failed");
+  if (pid == 0)
+    {
+      close (fds[0]);
+      socket_send (fds[1], count);
+      _exit (0);
+    }
+  close (fds[1]);
+  socket_receive (fds[0], count, table);
+  ms = elapsed (&start);
+
+  waitpid (pid, NULL, 0);
+  close (fds[0]);
+  if (table_count (table) != count)
+    fail ("socket: routes missing");
+  route_table_finish (table);
+  return ms;
+}
+
+static double
+shm_sync (const char *path, unsigned int count, u_int32_t *version)
+{
+  struct route_table *table = route_table_init ();
+  struct rib_shm *reader;
+  struct timeval start;
+  double ms;
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  reader = rib_shm_open (path);
+  if (reader == NULL || rib_shm_walk (reader, walk_func, table, version))
+    fail ("shared memory: walk failed");
+  ms = elapsed (&start);
+
+  rib_shm_close (reader);
+  if (table_count (table) != count)
+    fail ("shared memory: routes missing");
+  route_table_finish (table);
+  return ms;
+}
+
+int
+main (int argc, char **argv)
+{
+  char path[MAXPATHLEN];
+  struct rib_shm *shm, *early, *reader;
+  struct route_table *table;
+  struct rib_shm_route route;
+  struct changes changes;
+  struct prefix p;
+  u_int32_t version, since;
+  unsigned int count = 100000, i;
+  double shm_ms, socket_ms;
+
+  if (argc > 1)
+    count = strtoul (argv[1], NULL, 10);
+  if (count < 5000)
+    fail ("usage: testribshm [routes], at least 5000 routes");
+
+  master = thread_master_create ();
+  snprintf (path, sizeof (path), "/tmp/testribshm.%d", (int) getpid ());
+
+  shm = rib_shm_create (path, 1024, 4096);
+  if (shm == NULL)
+    fail ("can't create the export");
+
+  /* a reader mapping the first file is told to reopen once zebra
+     has replaced it by a larger one */
+  early = rib_shm_open (path);
+  if (early == NULL)
+    fail ("can't open the export");
+
+  for (i = 0; i < count; i++)
+    {
+      route_prefix (i, &p);
+      route_make (i, &route);
+      if (rib_shm_set (shm, &p, &route))
+        fail ("can't export a route");
+    }
+  table = route_table_init ();
+  if (rib_shm_walk (early, walk_func, table, &version) == 0)
+    fail ("replaced file not retired");
+  rib_shm_close (early);
+  route_table_finish (table);
+
+  /* full table */
+  shm_ms = shm_sync (path, count, &since);
+  socket_ms = socket_sync (count);
+
+  /* incremental: 100 changes and 100 removals */
+  for (i = 0; i < 200; i++)
+    {
+      route_prefix (i, &p);
+      route_make (i + 1, &route);
+      if ((i < 100 ? rib_shm_set (shm, &p, &route) :
+           rib_shm_unset (shm, &p)))
+        fail ("can't change a route");
+    }
+  reader = rib_shm_open (path);
+  memset (&changes, 0, sizeof (changes));
+  if (reader == NULL ||
+      rib_shm_changes (reader, since, changes_func, &changes, &version) ||
+      changes.active != 100 || changes.removed != 100 ||
+      version != since + 200)
+    fail ("changes not logged");
+
+  /* a reader too far behind has to walk again */
+  for (i = 200; i <= 200 + reader->header->log_size; i++)
+    {
+      route_prefix (i, &p);
+      rib_shm_unset (shm, &p);
+    }
+  if (rib_shm_changes (reader, version, changes_func, &changes,
+                       &version) == 0)
+    fail ("log overrun not noticed");
+  rib_shm_close (reader);
+
+  rib_shm_destroy (shm);
+
+  printf ("%u routes: shared memory %.2f ms, socket %.2f ms (%.1fx)\n",
+          count, shm_ms, socket_ms, shm_ms > 0 ? socket_ms / shm_ms : 0);
+  return 0;
+}
@@ -0,0 +1,624 @@
+/*
+ * This file is part of Quagga.
+ *
+ * Quagga is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * Quagga is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quagga; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+/* This programme checks route_map_apply() against a model of the
+ * route maps configured, and measures its throughput and that of
+ * route_map_lookup_by_name().  Route maps of random entries are
+ * configured through the vty commands, with match rules on the prefix
+ * length and on prefix lists, a set rule adding to a sum, and on-match
+ * next, on-match goto and call statements.  The maps and prefix lists
+ * are then changed and checked again.  Usage:
+ *
+ *   testroutemap [entries]
+ *
+ * Without an argument route maps of 10, 100 and 1000 entries are used.
+ */
+#include <zebra.h>
+
+#include "thread.h"
+#include "memory.h"
+#include "prefix.h"
+#include "command.h"
+#include "vty.h"
+#include "plist.h"
+#include "routemap.h"
+
+#include "tests.h"
+
+struct thread_master *master;
+
+#define PROBES		100000
+#define LOOKUPS		1000000
+#define NAMED_MAPS	1000
+#define PLISTS		4
+#define PLIST_OCTETS	16
+
+/* The object route maps are applied to. */
+struct object
+{
+  unsigned long sum;
+};
+
+/* A route map entry as configured. */
+struct entry
+{
+  int pref;
+  int deny;
+  int lo, hi;			/* prefix length range matched */
+  int plist;			/* prefix list matched, or -1 */
+  int add;			/* added to the sum, if not 0 */
+  int call;
+  route_map_end_t exitpolicy;
+  int nextpref;
+  unsigned long hitcnt;
+  int deleted;
+};
+
+struct map
+{
+  const char *name;
+  struct entry *entries;
+  unsigned int count;
+};
+
+static struct map callee;
+
+/* First octets each prefix list permits. */
+static u_char plist_octets[PLISTS][PLIST_OCTETS];
+static unsigned int plist_noctets[PLISTS];
+
+static struct vty *vty;
+
+static u_int64_t seed = 88172645463325252ULL;
+
+static u_int32_t
+rnd (void)
+{
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return (u_int32_t) (seed >> 16);
+}
+
+static void
+report (const char *what, struct timeval *start, unsigned int ops)
+{
+  double ms = elapsed (start);
+
+  printf ("  %-8s %9.2f ms %8.1f ns/op %10.0f ops/s\n", what, ms,
+          ops ? ms * 1000000.0 / ops : 0, ms > 0 ? ops * 1000.0 / ms : 0);
+}
+
+static void
+command (const char *fmt, ...)
+{
+  char line[BUFSIZ];
+  va_list args;
+  vector vline;
+  int ret;
+
+  va_start (args, fmt);
+  vsnprintf (line, sizeof (line), fmt, args);
+  va_end (args);
+
+  vline = cmd_make_strvec (line);
+  ret = cmd_execute_command (vline, vty, NULL, 0);
+  cmd_free_strvec (vline);
+  if (ret != CMD_SUCCESS)
+    {
+      fprintf (stderr, "%s: failed\n", line);
+      exit (1);
+    }
+}
+
+/* `match testlen LO-HI' */
+static route_map_result_t
+match_len (void *rule, struct prefix *p, route_map_object_t type,
+           void *object)
+{
+  int *range = rule;
+
+  return p->prefixlen >= range[0] && p->prefixlen <= range[1] ?
+    RMAP_MATCH : RMAP_NOMATCH;
+}
+
+static void *
+match_len_compile (const char *arg)
+{
+  int *range = XMALLOC (MTYPE_ROUTE_MAP_COMPILED, 2 * sizeof (int));
+
+  if (sscanf (arg, "%d-%d", &range[0], &range[1]) != 2)
+    {
+      XFREE (MTYPE_ROUTE_MAP_COMPILED, range);
+      return NULL;
+    }
+  return range;
+}
+
+static void
+match_len_free (void *rule)
+{
+  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+}
+
+static struct route_map_rule_cmd match_len_cmd =
+{
+  "testlen",
+  match_len,
+  match_len_compile,
+  match_len_free
+};
+
+/* `match testplist NAME' */
+static route_map_result_t
+match_plist (void *rule, struct prefix *p, route_map_object_t type,
+             void *object)
+{
+  struct prefix_list *plist;
+
+  plist = prefix_list_ref_lookup (rule);
+  if (plist == NULL)
+    return RMAP_NOMATCH;
+
+  return prefix_list_apply (plist, p) == PREFIX_DENY ?
+    RMAP_NOMATCH : RMAP_MATCH;
+}
+
+static void *
+match_plist_compile (const char *arg)
+{
+  return prefix_list_ref_new (AFI_IP, arg);
+}
+
+static void
+match_plist_free (void *rule)
+{
+  prefix_list_ref_free (rule);
+}
+
+static struct route_map_rule_cmd match_plist_cmd =
+{
+  "testplist",
+  match_plist,
+  match_plist_compile,
+  match_plist_free
+};
+
+/* `set testadd VALUE' */
+static route_map_result_t
+set_add (void *rule, struct prefix *p, route_map_object_t type,
+         void *object)
+{
+  struct object *obj = object;
+
+  obj->sum += *(int *) rule;
+  return RMAP_OKAY;
+}
+
+static void *
+set_add_compile (const char *arg)
+{
+  int *value = XMALLOC (MTYPE_ROUTE_MAP_COMPILED, sizeof (int));
+
+  *value = atoi (arg);
+  return value;
+}
+
+static void
+set_add_free (void *rule)
+{
+  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+}
+
+static struct route_map_rule_cmd set_add_cmd =
+{
+  "testadd",
+  set_add,
+  set_add_compile,
+  set_add_free
+};
+
+static int
+plist_permits (int plist, const struct prefix *p)
+{
+  u_char octet = ntohl (p->u.prefix4.s_addr) >> 24;
+  unsigned int i;
+
+  if (p->prefixlen < 8)
+    return 0;
+  for (i = 0; i < plist_noctets[plist]; i++)
+    if (plist_octets[plist][i] == octet)
+      return 1;
+  return 0;
+}
+
+/* Apply map to p the way route_map_apply() should. */
+static route_map_result_t
+model_apply (struct map *map, struct prefix *p, struct object *obj)
+{
+  unsigned int i, j;
+  route_map_result_t ret;
+
+  for (i = 0; i < map->count; )
+    {
+      struct entry *e = &map->entries[i];
+
+      if (e->deleted
+          || p->prefixlen < e->lo || p->prefixlen > e->hi
+          || (e->plist >= 0 && ! plist_permits (e->plist, p)))
+        {
+          i++;
+          continue;
+        }
+
+      e->hitcnt++;
+      if (e->deny)
+        return RMAP_DENYMATCH;
+
+      ret = RMAP_MATCH;
+      if (e->add)
+        {
+          obj->sum += e->add;
+          ret = RMAP_OKAY;
+        }
+      /* Calls to a route map that does not exist go on as though it
+         permitted. */
+      if (e->call && callee.entries)
+        {
+          ret = model_apply (&callee, p, obj);
+          if (ret == RMAP_DENYMATCH)
+            return ret;
+        }
+
+      switch (e->exitpolicy)
+        {
+        case RMAP_EXIT:
+          return ret;
+        case RMAP_NEXT:
+          i++;
+          break;
+        case RMAP_GOTO:
+          for (j = i + 1; j < map->count; j++)
+            if (! map->entries[j].deleted
+                && map->entries[j].pref >= e->nextpref)
+              break;
+          if (j == map->count)
+            return ret;
+          i = j;
+          break;
+        }
+    }
+  return RMAP_DENYMATCH;
+}
+
+static void
+configure_entry (struct map *map, struct entry *e)
+{
+  char buf[32];
+
+  command ("route-map %s %s %d", map->name, e->deny ? "deny" : "permit",
+           e->pref);
+
+  snprintf (buf, sizeof (buf), "%d-%d", e->lo, e->hi);
+  if (route_map_add_match (vty->index, "testlen", buf))
+    fail ("match testlen not added");
+  if (e->plist >= 0)
+    {
+      snprintf (buf, sizeof (buf), "L%d", e->plist);
+      if (route_map_add_match (vty->index, "testplist", buf))
+        fail ("match testplist not added");
+    }
+  if (e->add)
+    {
+      snprintf (buf, sizeof (buf), "%d", e->add);
+      if (route_map_add_set (vty->index, "testadd", buf))
+        fail ("set testadd not added");
+    }
+  if (e->call)
+    command ("call %s", callee.name);
+  if (e->exitpolicy == RMAP_NEXT)
+    command ("on-match next");
+  else if (e->exitpolicy == RMAP_GOTO)
+    command ("on-match goto %d", e->nextpref);
+  command ("exit");
+}
+
+static void
+make_map (struct map *map, const char *name, unsigned int count)
+{
+  unsigned int i;
+
+  map->name = name;
+  map->count = count;
+  map->entries = calloc (count, sizeof (struct entry));
+  if (map->entries == NULL)
+    fail ("out of memory");
+
+  for (i = 0; i < count; i++)
+    {
+      struct entry *e = &map->entries[i];
+
+      e->pref = (i + 1) * 10;
+      e->deny = rnd () % 4 == 0;
+      e->lo = 8 + rnd () % 25;
+      e->hi = e->lo + rnd () % (IPV4_MAX_BITLEN - e->lo + 1);
+      e->plist = rnd () % 2 ? (int) (rnd () % PLISTS) : -1;
+      e->add = rnd () % 3 ? 1 + rnd () % 100 : 0;
+      e->call = map != &callee && rnd () % 8 == 0;
+      switch (rnd () % 8)
+        {
+        case 0:
+        case 1:
+          e->exitpolicy = RMAP_NEXT;
+          break;
+        case 2:
+          e->exitpolicy = RMAP_GOTO;
+          e->nextpref = e->pref + 10 + rnd () % 50;
+          break;
+        default:
+          e->exitpolicy = RMAP_EXIT;
+          break;
+        }
+      configure_entry (map, e);
+    }
+}
+
+static void
+free_map (struct map *map)
+{
+  command ("no route-map %s", map->name);
+  free (map->entries);
+  map->entries = NULL;
+  map->count = 0;
+}
+
+static void
+add_plist_octet (int plist)
+{
+  u_char octet;
+  unsigned int i;
+
+  if (plist_noctets[plist] == PLIST_OCTETS)
+    return;
+ again:
+  octet = 1 + rnd () % 223;
+  for (i = 0; i < plist_noctets[plist]; i++)
+    if (plist_octets[plist][i] == octet)
+      goto again;
+  plist_octets[plist][plist_noctets[plist]++] = octet;
+  command ("ip prefix-list L%d permit %u.0.0.0/8 le 32", plist, octet);
+}
+
+static void
+random_prefix (struct prefix *p)
+{
+  memset (p, 0, sizeof (*p));
+  p->family = AF_INET;
+  p->prefixlen = 8 + rnd () % 25;
+  /* Mostly within the prefix lists. */
+  if (rnd () % 2)
+    {
+      int plist = rnd () % PLISTS;
+
+      p->u.prefix4.s_addr =
+        htonl (plist_octets[plist][rnd () % plist_noctets[plist]] << 24
+               | (rnd () & 0xffffff));
+    }
+  else
+    p->u.prefix4.s_addr = htonl (rnd () << 16 | (rnd () & 0xffff));
+  apply_mask (p);
+}
+
+static void
+clear_hitcnt (struct map *map)
+{
+  unsigned int i;
+
+  for (i = 0; i < map->count; i++)
+    map->entries[i].hitcnt = 0;
+}
+
+/* The counters route_map_apply() keeps should agree with the model's. */
+static void
+check_hitcnt (struct map *map)
+{
+  struct route_map *rmap;
+  struct route_map_index *index;
+  unsigned int i;
+
+  if (map->entries == NULL)
+    return;
+  rmap = route_map_lookup_by_name (map->name);
+  for (index = rmap->head, i = 0; index; index = index->next, i++)
+    {
+      while (map->entries[i].deleted)
+        i++;
+      if (index->pref != map->entries[i].pref
+          || index->hitcnt != map->entries[i].hitcnt)
+        {
+          fprintf (stderr, "%s %d: hit count %lu, expected %lu\n",
+                   map->name, index->pref, index->hitcnt,
+                   map->entries[i].hitcnt);
+          exit (1);
+        }
+    }
+}
+
+static void
+check (const char *what, struct map *map, struct prefix *probes)
+{
+  struct route_map *rmap;
+  struct timeval start;
+  unsigned int i, permits;
+  struct object obj, expect_obj;
+
+  printf (" %s:\n", what);
+
+  command ("do clear route-map counters");
+  clear_hitcnt (map);
+  clear_hitcnt (&callee);
+
+  rmap = route_map_lookup_by_name (map->name);
+  if (rmap == NULL)
+    fail ("route map not found");
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  for (i = 0, permits = 0, obj.sum = 0; i < PROBES; i++)
+    if (route_map_apply (rmap, &probes[i], RMAP_ZEBRA, &obj)
+        != RMAP_DENYMATCH)
+      permits++;
+  report ("apply", &start, PROBES);
+
+  command ("do clear route-map counters");
+  for (i = 0; i < PROBES; i++)
+    {
+      route_map_result_t ret, expect;
+
+      obj.sum = expect_obj.sum = 0;
+      ret = route_map_apply (rmap, &probes[i], RMAP_ZEBRA, &obj);
+      expect = model_apply (map, &probes[i], &expect_obj);
+      if (ret != expect || obj.sum != expect_obj.sum)
+        {
+          char buf[BUFSIZ];
+
+          prefix2str (&probes[i], buf, sizeof (buf));
+          fprintf (stderr, "%s: %s: result %d sum %lu, expected %d sum %lu\n",
+                   what, buf, ret, obj.sum, expect, expect_obj.sum);
+          exit (1);
+        }
+    }
+  check_hitcnt (map);
+  check_hitcnt (&callee);
+
+  printf ("  %u of %u probes permitted\n", permits, PROBES);
+}
+
+static void
+run (unsigned int count)
+{
+  struct prefix *probes;
+  struct map map;
+  unsigned int i;
+
+  probes = calloc (PROBES, sizeof (*probes));
+  if (! probes)
+    fail ("out of memory");
+
+  printf ("%u entries:\n", count);
+
+  make_map (&map, "testmap", count);
+  for (i = 0; i < PROBES; i++)
+    random_prefix (&probes[i]);
+
+  check ("configured", &map, probes);
+
+  /* Delete some entries, add to the prefix lists and change what the
+     callee does: all of which the compiled route maps must see. */
+  for (i = 0; i < count; i++)
+    {
+      struct entry *e = &map.entries[i];
+
+      if (rnd () % 5)
+        continue;
+      command ("no route-map %s %s %d", map.name,
+               e->deny ? "deny" : "permit", e->pref);
+      e->deleted = 1;
+    }
+  for (i = 0; i < PLISTS; i++)
+    add_plist_octet (i);
+  free_map (&callee);
+  make_map (&callee, "callee", 4);
+
+  check ("changed", &map, probes);
+
+  free_map (&callee);
+  check ("no callee", &map, probes);
+  make_map (&callee, "callee", 4);
+
+  free_map (&map);
+  free (probes);
+}
+
+static void
+lookups (void)
+{
+  struct timeval start;
+  char name[NAMED_MAPS][16];
+  unsigned int i, found;
+
+  for (i = 0; i < NAMED_MAPS; i++)
+    {
+      snprintf (name[i], sizeof (name[i]), "named%u", i);
+      command ("route-map %s permit 10", name[i]);
+      command ("exit");
+    }
+
+  printf ("%u route maps:\n", NAMED_MAPS);
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  for (i = 0, found = 0; i < LOOKUPS; i++)
+    if (route_map_lookup_by_name (name[rnd () % NAMED_MAPS]))
+      found++;
+  report ("lookup", &start, LOOKUPS);
+  if (found != LOOKUPS || route_map_lookup_by_name ("named") != NULL)
+    fail ("wrong lookup");
+
+  for (i = 0; i < NAMED_MAPS; i++)
+    command ("no route-map %s", name[i]);
+}
+
+int
+main (int argc, char **argv)
+{
+  unsigned int counts[] = { 10, 100, 1000 };
+  unsigned int ncounts = 3, c, i;
+
+  if (argc > 1)
+    {
+      counts[0] = strtoul (argv[1], NULL, 10);
+      ncounts = 1;
+      if (counts[0] < 1)
+        fail ("usage: testroutemap [entries]");
+    }
+
+  master = thread_master_create ();
+  cmd_init (1);
+  prefix_list_init ();
+  route_map_init ();
+  route_map_init_vty ();
+  route_map_install_match (&match_len_cmd);
+  route_map_install_match (&match_plist_cmd);
+  route_map_install_set (&set_add_cmd);
+
+  vty = vty_new ();
+  vty->node = CONFIG_NODE;
+
+  for (i = 0; i < PLISTS; i++)
+    {
+      add_plist_octet (i);
+      add_plist_octet (i);
+    }
+  make_map (&callee, "callee", 4);
+
+  for (c = 0; c < ncounts; c++)
+    run (counts[c]);
+
+  lookups ();
+
+  return 0;
+}
@@ -0,0 +1,410 @@
+/*
+ * This file is part of Quagga.
+ *
+ * Quagga is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * Quagga is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quagga; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+/* This programme checks the route table built into libzebra (the
+ * binary trie of table.c or, with --enable-multibit-table, the
+ * multibit trie of table_multibit.c) and times inserts, exact lookups,
+ * longest prefix matches, a full walk and deletes for three sets of
+ * prefixes:
+ *
+ *   random    IPv4 prefixes of random addresses and lengths /8 to /32
+ *   internet  IPv4 prefixes in allocation blocks, lengths as in a
+ *             full BGP table (mostly /24, /22 and /23)
+ *   ipv6      IPv6 prefixes in allocation blocks, mostly /48
+ *
+ * Usage:
+ *
+ *   testtable [prefixes]
+ *
+ * Without an argument the sets have 100000 and then 1000000 prefixes.
+ */
+#include <zebra.h>
+
+#include "thread.h"
+#include "memory.h"
+#include "prefix.h"
+#include "table.h"
+
+#include "tests.h"
+
+struct thread_master *master;
+
+#ifdef HAVE_MULTIBIT_TABLE
+#define TABLE_IMPL "multibit trie"
+#else
+#define TABLE_IMPL "binary trie"
+#endif
+
+static u_int64_t seed = 88172645463325252ULL;
+
+static u_int32_t
+rnd (void)
+{
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return (u_int32_t) (seed >> 16);
+}
+
+/* prefix lengths with their weight out of 1000 */
+struct length_weight
+{
+  int length;
+  int weight;
+};
+
+static const struct length_weight internet_lengths[] =
+{
+  { 24, 560 }, { 23, 100 }, { 22, 110 }, { 21, 60 }, { 20, 60 },
+  { 19, 50 }, { 18, 20 }, { 17, 15 }, { 16, 20 }, { 12, 5 },
+  { 0, 0 },
+};
+
+static const struct length_weight ipv6_lengths[] =
+{
+  { 48, 500 }, { 32, 100 }, { 40, 100 }, { 44, 100 }, { 56, 100 },
+  { 64, 100 },
+  { 0, 0 },
+};
+
+static int
+weighted_length (const struct length_weight *lengths)
+{
+  int r = rnd () % 1000;
+
+  for (; lengths->length; lengths++)
+    {
+      if (r < lengths->weight)
+        return lengths->length;
+      r -= lengths->weight;
+    }
+  return (lengths - 1)->length;
+}
+
+static void
+random_bytes (u_char *buf, int len)
+{
+  int i;
+
+  for (i = 0; i < len; i++)
+    buf[i] = rnd ();
+}
+
+enum dist { DIST_RANDOM, DIST_INTERNET, DIST_IPV6 };
+
+static const char *dist_name[] = { "random", "internet", "ipv6" };
+
+#define BLOCKS 4096
+
+static void
+make_prefixes (enum dist dist, struct prefix *prefixes, unsigned int count)
+{
+  static u_char blocks[BLOCKS][16];
+  unsigned int i;
+  struct prefix *p;
+
+  for (i = 0; i < BLOCKS; i++)
+    random_bytes (blocks[i], 16);
+
+  for (i = 0; i < count; i++)
+    {
+      p = &prefixes[i];
+      memset (p, 0, sizeof (struct prefix));
+      switch (dist)
+        {
+        case DIST_RANDOM:
+          p->family = AF_INET;
+          p->prefixlen = 8 + rnd () % 25;
+          random_bytes (&p->u.prefix, 4);
+          break;
+        case DIST_INTERNET:
+          /* a /12 allocation, more specifics at random within */
+          p->family = AF_INET;
+          p->prefixlen = weighted_length (internet_lengths);
+          random_bytes (&p->u.prefix, 4);
+          memcpy (&p->u.prefix, blocks[rnd () % BLOCKS], 1);
+          (&p->u.prefix)[1] = ((&p->u.prefix)[1] & 0x0f) |
+            (blocks[rnd () % BLOCKS][1] & 0xf0);
+          break;
+        case DIST_IPV6:
+          /* a /28 allocation under 2000::/3 */
+          p->family = AF_INET6;
+          p->prefixlen = weighted_length (ipv6_lengths);
+          random_bytes (&p->u.prefix, 16);
+          memcpy (&p->u.prefix, blocks[rnd () % BLOCKS], 3);
+          (&p->u.prefix)[0] = 0x20 | ((&p->u.prefix)[0] & 0x1f);
+          (&p->u.prefix)[3] &= 0x0f;
+          break;
+        }
+      apply_mask (p);
+    }
+}
+
+/* -1, 0 or 1 as a comes before, is or comes after b in the order of
+   route_next() */
+static int
+prefix_order (const struct prefix *a, const struct prefix *b)
+{
+  const u_char *pa = &a->u.prefix;
+  const u_char *pb = &b->u.prefix;
+  int len = MIN (a->prefixlen, b->prefixlen);
+  int i, bit;
+
+  for (i = 0; i < len; i++)
+    {
+      bit = 0x80 >> (i % 8);
+      if ((pa[i / 8] & bit) != (pb[i / 8] & bit))
+        return (pa[i / 8] & bit) ? 1 : -1;
+    }
+  return a->prefixlen < b->prefixlen ? -1 : a->prefixlen > b->prefixlen;
+}
+
+/* an address within p, as a host prefix */
+static void
+host_in (const struct prefix *p, struct prefix *host)
+{
+  u_char *h = &host->u.prefix;
+  int i;
+
+  *host = *p;
+  host->prefixlen = p->family == AF_INET ? IPV4_MAX_BITLEN : IPV6_MAX_BITLEN;
+  for (i = p->prefixlen; i < host->prefixlen; i++)
+    if (rnd () & 1)
+      h[i / 8] |= 0x80 >> (i % 8);
+}
+
+static void
+report (const char *what, struct timeval *start, unsigned int ops)
+{
+  double ms = elapsed (start);
+
+  printf ("  %-8s %9.2f ms %8.1f ns/op\n", what, ms,
+          ops ? ms * 1000000.0 / ops : 0);
+}
+
+/* The node with info before rn, by route_prev() */
+static struct route_node *
+check_prev (struct route_node *rn)
+{
+  struct route_node *prev = rn;
+
+  route_lock_node (prev);
+  do
+    prev = route_prev (prev);
+  while (prev && prev->info == NULL);
+
+  if (prev)
+    route_unlock_node (prev);
+  return prev;
+}
+
+/* Count the nodes with info below q, once by route_subtree_top() and
+   route_next() and once by route_next_until(). */
+static void
+check_subtree (struct route_table *table, struct prefix *q)
+{
+  struct route_node *rn, *top;
+  unsigned int count = 0, until = 0;
+
+  for (rn = route_subtree_top (table, q); rn; rn = route_next (rn))
+    {
+      if (! prefix_match (q, &rn->p))
+        {
+          route_unlock_node (rn);
+          break;
+        }
+      if (rn->info)
+        count++;
+    }
+
+  top = route_node_get (table, q);
+  route_lock_node (top);
+  for (rn = top; rn; rn = route_next_until (rn, top))
+    {
+      if (! prefix_match (q, &rn->p))
+        fail ("route_next_until() left the subtree");
+      if (rn->info)
+        until++;
+    }
+  route_unlock_node (top);
+
+  if (count != until)
+    fail ("subtree walks differ");
+}
+
+static void
+run (enum dist dist, unsigned int count)
+{
+  struct route_table *table;
+  struct route_node *rn, *prev, *check = NULL;
+  struct prefix *prefixes, *hosts, q;
+  struct timeval start;
+  unsigned int i, distinct = 0, walked = 0;
+  int len;
+
+  prefixes = malloc (count * sizeof (struct prefix));
+  hosts = malloc (count * sizeof (struct prefix));
+  if (prefixes == NULL || hosts == NULL)
+    fail ("out of memory");
+  make_prefixes (dist, prefixes, count);
+  for (i = 0; i < count; i++)
+    host_in (&prefixes[rnd () % count], &hosts[i]);
+
+  printf ("%s, %u prefixes:\n", dist_name[dist], count);
+  table = route_table_init ();
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  for (i = 0; i < count; i++)
+    {
+      rn = route_node_get (table, &prefixes[i]);
+      if (rn->info)
+        route_unlock_node (rn);
+      else
+        {
+          rn->info = &prefixes[i];
+          distinct++;
+        }
+    }
+  report ("insert", &start, count);
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  for (i = 0; i < count; i++)
+    {
+      rn = route_node_lookup (table, &prefixes[i]);
+      if (rn == NULL)
+        fail ("inserted prefix not found");
+      route_unlock_node (rn);
+    }
+  report ("lookup", &start, count);
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  for (i = 0; i < count; i++)
+    {
+      rn = route_node_match (table, &hosts[i]);
+      if (rn == NULL)
+        fail ("no match for an address within a prefix");
+      route_unlock_node (rn);
+    }
+  report ("match", &start, count);
+
+  /* a match is the longest of the prefixes found by exact lookups */
+  for (i = 0; i < count; i += 64)
+    {
+      rn = route_node_match (table, &hosts[i]);
+      q = hosts[i];
+      for (len = q.prefixlen; len >= 0; len--)
+        {
+          q.prefixlen = len;
+          apply_mask (&q);
+          if ((check = route_node_lookup (table, &q)) != NULL)
+            break;
+        }
+      if (check == NULL || check != rn || ! prefix_match (&rn->p, &hosts[i]))
+        fail ("match is not the longest prefix");
+      route_unlock_node (check);
+
+      /* the next shorter one is above it */
+      for (check = route_node_parent (rn); check && check->info == NULL;
+           check = route_node_parent (check))
+        ;
+      if (rn->p.prefixlen == 0)
+        q.prefixlen = 0;
+      else
+        {
+          q = rn->p;
+          q.prefixlen--;
+        }
+      prev = rn->p.prefixlen ? route_node_match (table, &q) : NULL;
+      if (prev != check)
+        fail ("route_node_parent() is not the next shorter prefix");
+      if (prev)
+        route_unlock_node (prev);
+      route_unlock_node (rn);
+    }
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  for (rn = route_top (table); rn; rn = route_next (rn))
+    if (rn->info)
+      walked++;
+  report ("walk", &start, walked);
+
+  if (walked != distinct)
+    fail ("walk missed prefixes");
+  for (i = 0, prev = NULL, rn = route_top (table); rn; rn = route_next (rn))
+    if (rn->info)
+      {
+        if (prev && prefix_order (&prev->p, &rn->p) >= 0)
+          fail ("walk out of order");
+        if (i++ % 64 == 0 && check_prev (rn) != prev)
+          fail ("route_prev() differs from the walk");
+        prev = rn;
+      }
+
+  for (i = 0; i < count; i += 1024)
+    {
+      q = prefixes[i];
+      q.prefixlen = q.prefixlen > 8 ? q.prefixlen - 8 : 0;
+      apply_mask (&q);
+      check_subtree (table, &q);
+    }
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  for (i = 0; i < count; i++)
+    {
+      rn = route_node_lookup (table, &prefixes[i]);
+      if (rn == NULL)
+        continue;
+      rn->info = NULL;
+      route_unlock_node (rn);
+      route_unlock_node (rn);
+    }
+  report ("delete", &start, count);
+
+  if (route_table_count (table) != 0 || route_top (table) != NULL)
+    fail ("nodes left after deleting every prefix");
+
+  route_table_finish (table);
+  free (prefixes);
+  free (hosts);
+}
+
+int
+main (int argc, char **argv)
+{
+  unsigned int counts[] = { 100000, 1000000 };
+  unsigned int ncounts = 2, c;
+  int dist;
+
+  if (argc > 1)
+    {
+      counts[0] = strtoul (argv[1], NULL, 10);
+      ncounts = 1;
+      if (counts[0] < 1000)
+        fail ("usage: testtable [prefixes], at least 1000 prefixes");
+    }
+
+  master = thread_master_create ();
+  printf ("route table: %s\n", TABLE_IMPL);
+
+  for (c = 0; c < ncounts; c++)
+    for (dist = DIST_RANDOM; dist <= DIST_IPV6; dist++)
+      run (dist, counts[c]);
+
+  return 0;
+}
@@ -0,0 +1,44 @@
+/*
+ * Helpers shared by the test programmes.
+ *
+ * This file is part of Quagga.
+ *
+ * Quagga is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * Quagga is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Quagga; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#ifndef _QUAGGA_TESTS_H
+#define _QUAGGA_TESTS_H
+
+/* Report MSG and end the programme as failed. */
+static inline void
+fail (const char *msg)
+{
+  fprintf (stderr, "%s\n", msg);
+  exit (1);
+}
+
+/* Milliseconds since START, on the monotonic clock. */
+static inline double
+elapsed (struct timeval *start)
+{
+  struct timeval now, diff;
+
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &now);
+  timersub (&now, start, &diff);
+  return diff.tv_sec * 1000.0 + diff.tv_usec / 1000.0;
+}
+
+#endif /* _QUAGGA_TESTS_H */
@@ -76,7 +76,7 @@ zebra_if_del_cb(int command, struct zclient *zclient, zebra_size_t length)
 
     zr->zebra_if_del(ifp);
 
-    ifp->ifindex = IFINDEX_INTERNAL;
+    if_set_index (ifp, IFINDEX_INTERNAL);
 
     if (if_is_transient (ifp))
         if_delete (ifp);
@@ -191,7 +191,7 @@ connected_up_ipv4 (struct interface *ifp, struct connected *ifc)
   rib_add_ipv4 (ZEBRA_ROUTE_CONNECT, 0, &p, NULL, NULL, ifp->ifindex,
 	RT_TABLE_MAIN, ifp->metric, 0, SAFI_UNICAST);
 
-  rib_update ();
+  rib_update_interface (ifp, (struct prefix *) &p);
 }
 
 /* Add connected IPv4 route to the interface. */
@@ -297,7 +297,7 @@ connected_down_ipv4 (struct interface *ifp, struct connected *ifc)
   /* Same logic as for connected_up_ipv4(): push the changes into the head. */
   rib_delete_ipv4 (ZEBRA_ROUTE_CONNECT, 0, &p, NULL, ifp->ifindex, 0, SAFI_UNICAST);
 
-  rib_update ();
+  rib_update_interface (ifp, (struct prefix *) &p);
 }
 
 /* Delete connected IPv4 route to the interface. */
@@ -319,7 +319,7 @@ connected_delete_ipv4 (struct interface *ifp, int flags, struct in_addr *addr,
     
   connected_withdraw (ifc);
 
-  rib_update();
+  rib_update_interface (ifp, (struct prefix *) &p);
 }
 
 #ifdef HAVE_IPV6
@@ -345,7 +345,7 @@ connected_up_ipv6 (struct interface *ifp, struct connected *ifc)
   rib_add_ipv6 (ZEBRA_ROUTE_CONNECT, 0, &p, NULL, ifp->ifindex, RT_TABLE_MAIN,
                 ifp->metric, 0, SAFI_UNICAST);
 
-  rib_update ();
+  rib_update_interface (ifp, (struct prefix *) &p);
 }
 
 /* Add connected IPv6 route to the interface. */
@@ -419,7 +419,7 @@ connected_down_ipv6 (struct interface *ifp, struct connected *ifc)
 
   rib_delete_ipv6 (ZEBRA_ROUTE_CONNECT, 0, &p, NULL, ifp->ifindex, 0, SAFI_UNICAST);
 
-  rib_update ();
+  rib_update_interface (ifp, (struct prefix *) &p);
 }
 
 void
@@ -440,6 +440,6 @@ connected_delete_ipv6 (struct interface *ifp, struct in6_addr *address,
 
   connected_withdraw (ifc);
 
-  rib_update();
+  rib_update_interface (ifp, (struct prefix *) &p);
 }
 #endif /* HAVE_IPV6 */
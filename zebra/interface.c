@@ -491,7 +491,7 @@ if_delete_update (struct interface *ifp)
      while processing the deletion.  Each client daemon is responsible
      for setting ifindex to IFINDEX_INTERNAL after processing the
      interface deletion message. */
-  ifp->ifindex = IFINDEX_INTERNAL;
+  if_set_index (ifp, IFINDEX_INTERNAL);
 
   if (if_is_transient (ifp))
     if_delete (ifp);
@@ -525,8 +525,8 @@ if_up (struct interface *ifp)
 	}
     }
 
-  /* Examine all static routes. */
-  rib_update ();
+  /* Examine the routes depending on the interface. */
+  rib_update_interface (ifp, NULL);
 }
 
 /* Interface goes down.  We have to manage different behavior of based
@@ -558,8 +558,8 @@ if_down (struct interface *ifp)
 	}
     }
 
-  /* Examine all static routes which direct to the interface. */
-  rib_update ();
+  /* Examine all routes which direct to the interface. */
+  rib_update_interface (ifp, NULL);
 }
 
 void
@@ -777,6 +777,10 @@ if_dump_vty (struct vty *vty, struct interface *ifp)
   nd_dump_vty (vty, ifp);
 #endif /* RTADV */
 
+  vty_out (vty, "  %u RIB updates, %u route nodes requeued (%u last)%s",
+	   zebra_if->rib_events, zebra_if->rib_requeued,
+	   zebra_if->rib_last_requeued, VTY_NEWLINE);
+
 #ifdef HAVE_PROC_NET_DEV
   /* Statistics print out using proc file system. */
   vty_out (vty, "    %lu input packets (%lu multicast), %lu bytes, "
@@ -196,6 +196,11 @@ struct zebra_if
   /* Installed addresses chains tree. */
   struct route_table *ipv4_subnets;
 
+  /* Route nodes requeued by events on this interface. */
+  u_int32_t rib_events;
+  u_int32_t rib_requeued;
+  u_int32_t rib_last_requeued;
+
 #ifdef RTADV
   struct rtadvconf rtadv;
 #endif /* RTADV */
@@ -0,0 +1,326 @@
+/* Coalescing of netlink kernel notifications.
+ *
+ * This file is part of GNU Zebra.
+ *
+ * GNU Zebra is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * GNU Zebra is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Zebra; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#include <zebra.h>
+
+#ifdef HAVE_NETLINK
+
+#include "log.h"
+#include "memory.h"
+#include "hash.h"
+#include "jhash.h"
+#include "command.h"
+
+#include "zebra/debug.h"
+#include "zebra/netlink_event.h"
+
+/* Utility function for parse rtattr. */
+void
+netlink_parse_rtattr (struct rtattr **tb, int max, struct rtattr *rta,
+                      int len)
+{
+  while (RTA_OK (rta, len))
+    {
+      if (rta->rta_type <= max)
+        tb[rta->rta_type] = rta;
+      rta = RTA_NEXT (rta, len);
+    }
+}
+
+/* Kernel notifications are read until the socket is drained and
+   coalesced per object, the last message about each one winning.
+   The survivors are applied in one pass, links first, then addresses,
+   then routes.  Links keep the order of their last messages: a link
+   may be removed and another created under the same name. */
+enum netlink_event_class
+{
+  NETLINK_EVENT_LINK,
+  NETLINK_EVENT_ADDR,
+  NETLINK_EVENT_ROUTE,
+  NETLINK_EVENT_MAX,
+};
+
+static const char *netlink_event_class_str[NETLINK_EVENT_MAX] = {
+  "links",
+  "addresses",
+  "routes",
+};
+
+struct netlink_event_key
+{
+  u_char class;
+  u_char family;
+  u_char prefixlen;
+  u_char protocol;
+  u_char type;
+  u_char pad[3];
+  u_int32_t index;			/* ifindex or routing table */
+  u_int32_t priority;
+  u_char addr[16];
+};
+
+struct netlink_event
+{
+  struct netlink_event_key key;
+  unsigned int slot;			/* in netlink_events */
+  struct nlmsghdr *h;			/* copy of the last message */
+};
+
+/* Applies a message, coalesced or not. */
+static int (*netlink_event_fetch) (struct sockaddr_nl *, struct nlmsghdr *);
+
+/* Events by object, and in the order of their last message. */
+static struct hash *netlink_event_hash;
+static struct netlink_event **netlink_events;
+static unsigned int netlink_events_count;
+static unsigned int netlink_events_size;
+
+static struct
+{
+  u_int32_t batches;
+  u_int32_t largest;
+  u_int32_t raw[NETLINK_EVENT_MAX];
+  u_int32_t applied[NETLINK_EVENT_MAX];
+} netlink_event_stats;
+
+static unsigned int
+netlink_event_hash_key (void *data)
+{
+  return jhash (data, sizeof (struct netlink_event_key), 0);
+}
+
+static int
+netlink_event_hash_cmp (const void *a, const void *b)
+{
+  return memcmp (a, b, sizeof (struct netlink_event_key)) == 0;
+}
+
+static void *
+netlink_event_alloc (void *data)
+{
+  struct netlink_event *event;
+
+  event = XCALLOC (MTYPE_NETLINK_EVENT, sizeof (struct netlink_event));
+  event->key = *(struct netlink_event_key *) data;
+  return event;
+}
+
+static void
+netlink_event_key_addr (struct netlink_event_key *key, struct rtattr *rta)
+{
+  unsigned int len;
+
+  if (rta == NULL)
+    return;
+  len = RTA_PAYLOAD (rta);
+  if (len > sizeof (key->addr))
+    len = sizeof (key->addr);
+  memcpy (key->addr, RTA_DATA (rta), len);
+}
+
+/* Identify the object a message is about.  Returns -1 for messages
+   that are not coalesced. */
+static int
+netlink_event_key (struct nlmsghdr *h, struct netlink_event_key *key)
+{
+  int len;
+
+  memset (key, 0, sizeof (*key));
+
+  switch (h->nlmsg_type)
+    {
+    case RTM_NEWLINK:
+    case RTM_DELLINK:
+      {
+	struct ifinfomsg *ifi = NLMSG_DATA (h);
+
+	if (h->nlmsg_len < NLMSG_LENGTH (sizeof (struct ifinfomsg)))
+	  return -1;
+	key->class = NETLINK_EVENT_LINK;
+	key->index = ifi->ifi_index;
+      }
+      break;
+
+    case RTM_NEWADDR:
+    case RTM_DELADDR:
+      {
+	struct ifaddrmsg *ifa = NLMSG_DATA (h);
+	struct rtattr *tb[IFA_MAX + 1];
+
+	len = h->nlmsg_len - NLMSG_LENGTH (sizeof (struct ifaddrmsg));
+	if (len < 0)
+	  return -1;
+	memset (tb, 0, sizeof tb);
+	netlink_parse_rtattr (tb, IFA_MAX, IFA_RTA (ifa), len);
+
+	key->class = NETLINK_EVENT_ADDR;
+	key->family = ifa->ifa_family;
+	key->prefixlen = ifa->ifa_prefixlen;
+	key->index = ifa->ifa_index;
+	netlink_event_key_addr (key, tb[IFA_LOCAL] ? tb[IFA_LOCAL] :
+				tb[IFA_ADDRESS]);
+      }
+      break;
+
+    case RTM_NEWROUTE:
+    case RTM_DELROUTE:
+      {
+	struct rtmsg *rtm = NLMSG_DATA (h);
+	struct rtattr *tb[RTA_MAX + 1];
+
+	len = h->nlmsg_len - NLMSG_LENGTH (sizeof (struct rtmsg));
+	if (len < 0)
+	  return -1;
+	memset (tb, 0, sizeof tb);
+	netlink_parse_rtattr (tb, RTA_MAX, RTM_RTA (rtm), len);
+
+	key->class = NETLINK_EVENT_ROUTE;
+	key->family = rtm->rtm_family;
+	key->prefixlen = rtm->rtm_dst_len;
+	key->protocol = rtm->rtm_protocol;
+	key->type = rtm->rtm_type;
+	key->index = rtm->rtm_table;
+	if (tb[RTA_PRIORITY])
+	  key->priority = *(u_int32_t *) RTA_DATA (tb[RTA_PRIORITY]);
+	netlink_event_key_addr (key, tb[RTA_DST]);
+      }
+      break;
+
+    default:
+      return -1;
+    }
+
+  return 0;
+}
+
+/* netlink_parse_info filter for the event socket: queue a copy of the
+   message, replacing any earlier one about the same object. */
+int
+netlink_event_queue (struct sockaddr_nl *snl, struct nlmsghdr *h)
+{
+  struct netlink_event_key key;
+  struct netlink_event *event;
+
+  if (snl->nl_pid != 0 || netlink_event_key (h, &key) < 0)
+    return (*netlink_event_fetch) (snl, h);
+
+  netlink_event_stats.raw[key.class]++;
+
+  event = hash_get (netlink_event_hash, &key, netlink_event_alloc);
+  if (event->h)
+    {
+      netlink_events[event->slot] = NULL;
+      XFREE (MTYPE_NETLINK_EVENT, event->h);
+    }
+  event->h = XMALLOC (MTYPE_NETLINK_EVENT, h->nlmsg_len);
+  memcpy (event->h, h, h->nlmsg_len);
+
+  if (netlink_events_count == netlink_events_size)
+    {
+      netlink_events_size = netlink_events_size ? netlink_events_size * 2 : 64;
+      netlink_events = XREALLOC (MTYPE_NETLINK_EVENT, netlink_events,
+				 netlink_events_size * sizeof (*netlink_events));
+    }
+  event->slot = netlink_events_count;
+  netlink_events[netlink_events_count++] = event;
+
+  return 0;
+}
+
+/* Apply the queued events, links then addresses then routes, and
+   forget them.  Returns the number of events applied. */
+unsigned int
+netlink_event_apply (void)
+{
+  struct sockaddr_nl snl;
+  struct netlink_event *event;
+  unsigned int i, applied = 0;
+  int class;
+
+  if (netlink_events_count == 0)
+    return 0;
+
+  memset (&snl, 0, sizeof snl);
+  snl.nl_family = AF_NETLINK;
+
+  for (class = 0; class < NETLINK_EVENT_MAX; class++)
+    for (i = 0; i < netlink_events_count; i++)
+      {
+	event = netlink_events[i];
+	if (event == NULL || event->key.class != class)
+	  continue;
+	(*netlink_event_fetch) (&snl, event->h);
+	netlink_event_stats.applied[event->key.class]++;
+	applied++;
+      }
+
+  if (IS_ZEBRA_DEBUG_KERNEL)
+    zlog_debug ("%s: %u messages coalesced to %u events", __func__,
+		netlink_events_count, applied);
+
+  netlink_event_stats.batches++;
+  if (netlink_events_count > netlink_event_stats.largest)
+    netlink_event_stats.largest = netlink_events_count;
+
+  for (i = 0; i < netlink_events_count; i++)
+    if ((event = netlink_events[i]) != NULL)
+      {
+	XFREE (MTYPE_NETLINK_EVENT, event->h);
+	XFREE (MTYPE_NETLINK_EVENT, event);
+      }
+  hash_clean (netlink_event_hash, NULL);
+  netlink_events_count = 0;
+
+  return applied;
+}
+
+DEFUN (show_zebra_netlink,
+       show_zebra_netlink_cmd,
+       "show zebra netlink",
+       SHOW_STR
+       "Zebra information\n"
+       "Kernel notification statistics\n")
+{
+  int i;
+
+  vty_out (vty, "Kernel notifications: %u batches, largest %u messages%s",
+	   netlink_event_stats.batches, netlink_event_stats.largest,
+	   VTY_NEWLINE);
+  vty_out (vty, "  %-10s %10s %10s%s", "", "Received", "Applied",
+	   VTY_NEWLINE);
+  for (i = 0; i < NETLINK_EVENT_MAX; i++)
+    vty_out (vty, "  %-10s %10u %10u%s", netlink_event_class_str[i],
+	     netlink_event_stats.raw[i], netlink_event_stats.applied[i],
+	     VTY_NEWLINE);
+
+  return CMD_SUCCESS;
+}
+
+void
+netlink_event_init (int (*fetch) (struct sockaddr_nl *, struct nlmsghdr *))
+{
+  netlink_event_fetch = fetch;
+  netlink_event_hash = hash_create (netlink_event_hash_key,
+				   netlink_event_hash_cmp);
+  install_element (VIEW_NODE, &show_zebra_netlink_cmd);
+  install_element (ENABLE_NODE, &show_zebra_netlink_cmd);
+}
+
+#endif /* HAVE_NETLINK */
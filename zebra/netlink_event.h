@@ -0,0 +1,36 @@
+/* Coalescing of netlink kernel notifications.
+ *
+ * This file is part of GNU Zebra.
+ *
+ * GNU Zebra is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * GNU Zebra is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Zebra; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#ifndef _ZEBRA_NETLINK_EVENT_H
+#define _ZEBRA_NETLINK_EVENT_H
+
+#ifdef HAVE_NETLINK
+
+extern void netlink_parse_rtattr (struct rtattr **tb, int max,
+				  struct rtattr *rta, int len);
+
+extern void netlink_event_init (int (*fetch) (struct sockaddr_nl *,
+					      struct nlmsghdr *));
+extern int netlink_event_queue (struct sockaddr_nl *, struct nlmsghdr *);
+extern unsigned int netlink_event_apply (void);
+
+#endif /* HAVE_NETLINK */
+
+#endif /* _ZEBRA_NETLINK_EVENT_H */
@@ -36,6 +36,8 @@
 #include "zebra/redistribute.h"
 #include "zebra/debug.h"
 #include "zebra/router-id.h"
+#include "zebra/zserv_rib_shm.h"
+#include "zebra/zebra_rnh.h"
 
 /* master zebra server structure */
 extern struct zebra_t zebrad;
@@ -95,6 +97,9 @@ zebra_redistribute_default (struct zserv *client)
   struct prefix_ipv6 p6;
 #endif /* HAVE_IPV6 */
 
+  /* The client reads it from the exported RIB. */
+  if (zserv_rib_shm_serves (client))
+    return;
 
   /* Lookup default route. */
   memset (&p, 0, sizeof (struct prefix_ipv4));
@@ -145,6 +150,9 @@ zebra_redistribute (struct zserv *client, int type)
   struct route_table *table;
   struct route_node *rn;
 
+  if (zserv_rib_shm_serves (client))
+    return;
+
   table = vrf_table (AFI_IP, SAFI_UNICAST, 0);
   if (table)
     for (rn = route_top (table); rn; rn = route_next (rn))
@@ -174,8 +182,14 @@ redistribute_add (struct prefix *p, struct rib *rib)
   struct listnode *node, *nnode;
   struct zserv *client;
 
+  zserv_rib_shm_add (p, rib);
+  zebra_rnh_changed (p);
+
   for (ALL_LIST_ELEMENTS (zebrad.client_list, node, nnode, client))
     {
+      if (zserv_rib_shm_serves (client))
+        continue;
+
       if (is_default (p))
         {
           if (client->redist_default || client->redist[rib->type])
@@ -210,8 +224,14 @@ redistribute_delete (struct prefix *p, struct rib *rib)
   if (rib->distance == DISTANCE_INFINITY)
     return;
 
+  zserv_rib_shm_delete (p, rib);
+  zebra_rnh_changed (p);
+
   for (ALL_LIST_ELEMENTS (zebrad.client_list, node, nnode, client))
     {
+      if (zserv_rib_shm_serves (client))
+	continue;
+
       if (is_default (p))
 	{
 	  if (client->redist_default || client->redist[rib->type])
@@ -238,6 +258,20 @@ redistribute_delete (struct prefix *p, struct rib *rib)
     }
 }
 
+/* Send the client every route it redistributes, as when it asked for
+   them. */
+void
+zebra_redistribute_all (struct zserv *client)
+{
+  int type;
+
+  for (type = 0; type < ZEBRA_ROUTE_MAX; type++)
+    if (client->redist[type])
+      zebra_redistribute (client, type);
+  if (client->redist_default)
+    zebra_redistribute_default (client);
+}
+
 void
 zebra_redistribute_add (int command, struct zserv *client, int length)
 {
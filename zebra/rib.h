@@ -91,10 +91,25 @@ struct rib
  * sub-queue 4: any other origin (if any)
  */
 #define MQ_SIZE 5
+
+/* A sub-queue is a ring of route nodes, its size a power of two. */
+struct meta_subq
+{
+  struct route_node **rn;
+  u_int32_t size;
+  u_int32_t head;
+  u_int32_t count;
+};
+
+/* Route nodes processed per run of the work queue, at most; a run also
+ * yields once it has taken THREAD_YIELD_TIME_SLOT. */
+#define MQ_BATCH_DEFAULT 100
+
 struct meta_queue
 {
-  struct list *subq[MQ_SIZE];
+  struct meta_subq subq[MQ_SIZE];
   u_int32_t size; /* sum of lengths of all subqueues */
+  u_int32_t batch;
 };
 
 /* Static route information. */
@@ -265,7 +280,11 @@ extern struct rib *rib_match_ipv4 (struct in_addr);
 
 extern struct rib *rib_lookup_ipv4 (struct prefix_ipv4 *);
 
-extern void rib_update (void);
+extern void rib_kernel_reject (struct prefix *);
+struct interface;
+extern void rib_update_interface (struct interface *, struct prefix *);
+extern void rib_update_batch_begin (void);
+extern void rib_update_batch_end (void);
 extern void rib_weed_tables (void);
 extern void rib_sweep_route (void);
 extern void rib_close (void);
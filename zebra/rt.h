@@ -33,6 +33,10 @@ extern int kernel_add_route (struct prefix_ipv4 *, struct in_addr *, int, int);
 extern int kernel_address_add_ipv4 (struct interface *, struct connected *);
 extern int kernel_address_delete_ipv4 (struct interface *, struct connected *);
 
+/* Route changes between these may be sent to the kernel together. */
+extern void kernel_batch_begin (void);
+extern void kernel_batch_end (void);
+
 #ifdef HAVE_IPV6
 extern int kernel_add_ipv6 (struct prefix *, struct rib *);
 extern int kernel_delete_ipv6 (struct prefix *, struct rib *);
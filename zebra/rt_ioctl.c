@@ -336,6 +336,17 @@ kernel_ioctl_ipv4 (u_long cmd, struct prefix *p, struct rib *rib, int family)
   return ret;
 }
 
+/* Routes are sent one message at a time. */
+void
+kernel_batch_begin (void)
+{
+}
+
+void
+kernel_batch_end (void)
+{
+}
+
 int
 kernel_add_ipv4 (struct prefix *p, struct rib *rib)
 {
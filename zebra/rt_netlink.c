@@ -43,6 +43,8 @@
 #include "zebra/interface.h"
 #include "zebra/debug.h"
 
+#include "zebra/netlink_event.h"
+
 #include "linkmetrics_netlink.h"
 
 #define NL_PKT_BUF_SIZE 4096
@@ -114,7 +116,7 @@ set_ifindex(struct interface *ifp, unsigned int ifi_index)
 	  if_delete_update(oifp);
         }
     }
-  ifp->ifindex = ifi_index;
+  if_set_index (ifp, ifi_index);
 }
 
 static int
@@ -273,6 +275,16 @@ netlink_request (int family, int type, struct nlsock *nl)
   return 0;
 }
 
+/* Errors that occur because of races in link handling. */
+static int
+netlink_error_ignored (struct nlsock *nl, int msg_type, int errnum)
+{
+  return (nl == &netlink_cmd
+	  && ((msg_type == RTM_DELROUTE &&
+	       (-errnum == ENODEV || -errnum == ESRCH))
+	      || (msg_type == RTM_NEWROUTE && -errnum == EEXIST)));
+}
+
 /* Receive message from netlink interface and pass those information
    to the given function. */
 static int
@@ -358,10 +370,7 @@ netlink_parse_info (int (*filter) (struct sockaddr_nl *, struct nlmsghdr *),
                 }
 
               /* Deal with errors that occur because of races in link handling */
-	      if (nl == &netlink_cmd
-		  && ((msg_type == RTM_DELROUTE &&
-		       (-errnum == ENODEV || -errnum == ESRCH))
-		      || (msg_type == RTM_NEWROUTE && -errnum == EEXIST)))
+	      if (netlink_error_ignored (nl, msg_type, errnum))
 		{
 		  if (IS_ZEBRA_DEBUG_KERNEL)
 		    zlog_debug ("%s: error: %s type=%s(%u), seq=%u, pid=%u",
@@ -421,19 +430,6 @@ netlink_parse_info (int (*filter) (struct sockaddr_nl *, struct nlmsghdr *),
   return ret;
 }
 
-/* Utility function for parse rtattr. */
-static void
-netlink_parse_rtattr (struct rtattr **tb, int max, struct rtattr *rta,
-                      int len)
-{
-  while (RTA_OK (rta, len))
-    {
-      if (rta->rta_type <= max)
-        tb[rta->rta_type] = rta;
-      rta = RTA_NEXT (rta, len);
-    }
-}
-
 /* Utility function to parse hardware link-layer address and update ifp */
 static void
 netlink_interface_update_hw_addr (struct rtattr **tb, struct interface *ifp)
@@ -1170,6 +1166,16 @@ netlink_link_change (struct sockaddr_nl *snl, struct nlmsghdr *h)
           return 0;
         }
 
+      /* An earlier link of the same name, already replaced. */
+      if (ifp->ifindex != (unsigned int) ifi->ifi_index)
+        {
+          if (IS_ZEBRA_DEBUG_KERNEL)
+            zlog_debug ("interface %s index %d is deleted but %s has "
+                        "index %u now", name, ifi->ifi_index, name,
+                        ifp->ifindex);
+          return 0;
+        }
+
       if_delete_update (ifp);
     }
 
@@ -1347,6 +1353,177 @@ netlink_talk_filter (struct sockaddr_nl *snl, struct nlmsghdr *h)
   return 0;
 }
 
+/* Route changes made between kernel_batch_begin() and
+   kernel_batch_end() are queued here and sent in one sendmsg(), their
+   acks being read afterwards.  The number of messages is bounded so
+   that the acks fit in the socket receive buffer. */
+#define NL_BATCH_MAX 64
+
+static struct
+{
+  int open;
+  u_int32_t count;
+  u_int32_t seq;		/* of the first message */
+  size_t len;
+  struct prefix p[NL_BATCH_MAX];
+  char buf[16 * NL_PKT_BUF_SIZE];
+} nl_batch;
+
+/* Read the acks of the messages of a batch. */
+static void
+netlink_batch_recv (void)
+{
+  u_int32_t acked = 0, i;
+  int status;
+
+  while (acked < nl_batch.count)
+    {
+      char buf[NL_PKT_BUF_SIZE];
+      struct iovec iov = { buf, sizeof buf };
+      struct sockaddr_nl snl;
+      struct msghdr msg = { (void *) &snl, sizeof snl, &iov, 1, NULL, 0, 0 };
+      struct nlmsghdr *h;
+
+      status = recvmsg (netlink_cmd.sock, &msg, 0);
+      if (status < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  zlog (NULL, LOG_ERR, "%s recvmsg error: %s, %u acks missing",
+		netlink_cmd.name, safe_strerror (errno),
+		nl_batch.count - acked);
+	  return;
+	}
+      if (status == 0)
+	{
+	  zlog (NULL, LOG_ERR, "%s EOF", netlink_cmd.name);
+	  return;
+	}
+
+      for (h = (struct nlmsghdr *) buf; NLMSG_OK (h, (unsigned int) status);
+	   h = NLMSG_NEXT (h, status))
+	{
+	  struct nlmsgerr *err = (struct nlmsgerr *) NLMSG_DATA (h);
+
+	  if (h->nlmsg_type != NLMSG_ERROR ||
+	      h->nlmsg_len < NLMSG_LENGTH (sizeof (struct nlmsgerr)))
+	    {
+	      netlink_talk_filter (&snl, h);
+	      continue;
+	    }
+
+	  i = err->msg.nlmsg_seq - nl_batch.seq;
+	  if (i >= nl_batch.count)
+	    continue;
+	  acked++;
+
+	  if (err->error == 0 ||
+	      netlink_error_ignored (&netlink_cmd, err->msg.nlmsg_type,
+				     err->error))
+	    {
+	      if (IS_ZEBRA_DEBUG_KERNEL)
+		zlog_debug ("%s: %s ACK: type=%s(%u), seq=%u, error %d",
+			    __func__, netlink_cmd.name,
+			    lookup (nlmsg_str, err->msg.nlmsg_type),
+			    err->msg.nlmsg_type, err->msg.nlmsg_seq,
+			    -err->error);
+	      continue;
+	    }
+
+	  zlog_err ("%s error: %s, type=%s(%u), seq=%u, pid=%u",
+		    netlink_cmd.name, safe_strerror (-err->error),
+		    lookup (nlmsg_str, err->msg.nlmsg_type),
+		    err->msg.nlmsg_type, err->msg.nlmsg_seq,
+		    err->msg.nlmsg_pid);
+	  if (err->msg.nlmsg_type == RTM_NEWROUTE)
+	    rib_kernel_reject (&nl_batch.p[i]);
+	}
+    }
+}
+
+static void
+netlink_batch_flush (void)
+{
+  struct sockaddr_nl snl;
+  struct iovec iov = { nl_batch.buf, nl_batch.len };
+  struct msghdr msg = { (void *) &snl, sizeof snl, &iov, 1, NULL, 0, 0 };
+  int status, save_errno;
+  struct nlmsghdr *h;
+  u_int32_t i;
+
+  if (nl_batch.count == 0)
+    return;
+
+  memset (&snl, 0, sizeof snl);
+  snl.nl_family = AF_NETLINK;
+
+  if (IS_ZEBRA_DEBUG_KERNEL)
+    zlog_debug ("%s: %s %u messages, %lu bytes, seq=%u", __func__,
+		netlink_cmd.name, nl_batch.count,
+		(unsigned long) nl_batch.len, nl_batch.seq);
+
+  if (zserv_privs.change (ZPRIVS_RAISE))
+    zlog (NULL, LOG_ERR, "Can't raise privileges");
+  status = sendmsg (netlink_cmd.sock, &msg, 0);
+  save_errno = errno;
+  if (zserv_privs.change (ZPRIVS_LOWER))
+    zlog (NULL, LOG_ERR, "Can't lower privileges");
+
+  if (status < 0)
+    {
+      zlog (NULL, LOG_ERR, "netlink_batch_flush sendmsg() error: %s",
+	    safe_strerror (save_errno));
+      for (i = 0, h = (struct nlmsghdr *) nl_batch.buf; i < nl_batch.count;
+	   i++, h = (struct nlmsghdr *) ((char *) h +
+					 NLMSG_ALIGN (h->nlmsg_len)))
+	if (h->nlmsg_type == RTM_NEWROUTE)
+	  rib_kernel_reject (&nl_batch.p[i]);
+    }
+  else
+    netlink_batch_recv ();
+
+  nl_batch.count = 0;
+  nl_batch.len = 0;
+}
+
+static int
+netlink_batch_add (struct nlmsghdr *n, struct prefix *p)
+{
+  if (nl_batch.count == NL_BATCH_MAX ||
+      nl_batch.len + NLMSG_ALIGN (n->nlmsg_len) > sizeof nl_batch.buf)
+    netlink_batch_flush ();
+
+  n->nlmsg_seq = ++netlink_cmd.seq;
+  n->nlmsg_flags |= NLM_F_ACK;
+  if (nl_batch.count == 0)
+    nl_batch.seq = n->nlmsg_seq;
+
+  if (IS_ZEBRA_DEBUG_KERNEL)
+    zlog_debug ("netlink_batch_add: %s type %s(%u), seq=%u", netlink_cmd.name,
+		lookup (nlmsg_str, n->nlmsg_type), n->nlmsg_type,
+		n->nlmsg_seq);
+
+  memcpy (nl_batch.buf + nl_batch.len, n, n->nlmsg_len);
+  nl_batch.len += NLMSG_ALIGN (n->nlmsg_len);
+  prefix_copy (&nl_batch.p[nl_batch.count], p);
+  nl_batch.count++;
+
+  return 0;
+}
+
+void
+kernel_batch_begin (void)
+{
+  nl_batch.open = 1;
+}
+
+void
+kernel_batch_end (void)
+{
+  netlink_batch_flush ();
+  nl_batch.open = 0;
+}
+
 /* sendmsg() to netlink socket then recvmsg(). */
 static int
 netlink_talk (struct nlmsghdr *n, struct nlsock *nl)
@@ -1357,6 +1534,10 @@ netlink_talk (struct nlmsghdr *n, struct nlsock *nl)
   struct msghdr msg = { (void *) &snl, sizeof snl, &iov, 1, NULL, 0, 0 };
   int save_errno;
 
+  /* messages already batched go first */
+  if (nl == &netlink_cmd)
+    netlink_batch_flush ();
+
   memset (&snl, 0, sizeof snl);
   snl.nl_family = AF_NETLINK;
 
@@ -1922,6 +2103,8 @@ skip:
   snl.nl_family = AF_NETLINK;
 
   /* Talk to netlink socket. */
+  if (nl_batch.open)
+    return netlink_batch_add (&req.n, p);
   return netlink_talk (&req.n, &netlink_cmd);
 }
 
@@ -2029,7 +2212,10 @@ extern struct thread_master *master;
 static int
 kernel_read (struct thread *thread)
 {
-  netlink_parse_info (netlink_information_fetch, &netlink);
+  netlink_parse_info (netlink_event_queue, &netlink);
+  rib_update_batch_begin ();
+  netlink_event_apply ();
+  rib_update_batch_end ();
   thread_add_read (zebrad.master, kernel_read, NULL, netlink.sock);
 
   return 0;
@@ -2096,5 +2282,7 @@ kernel_init (void)
       thread_add_read (zebrad.master, kernel_read, NULL, netlink.sock);
     }
 
+  netlink_event_init (netlink_information_fetch);
+
   linkmetrics_netlink_init (LMGENL_FAMILY_NAME, LMGENL_MCGROUP_NAME);
 }
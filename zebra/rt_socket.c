@@ -228,6 +228,17 @@ kernel_rtm_ipv4 (int cmd, struct prefix *p, struct rib *rib, int family)
   return 0; /*XXX*/
 }
 
+/* Routes are sent one message at a time. */
+void
+kernel_batch_begin (void)
+{
+}
+
+void
+kernel_batch_end (void)
+{
+}
+
 int
 kernel_add_ipv4 (struct prefix *p, struct rib *rib)
 {
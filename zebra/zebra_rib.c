@@ -34,12 +34,14 @@
 #include "workqueue.h"
 #include "prefix.h"
 #include "routemap.h"
+#include "hash.h"
 
 #include "zebra/rib.h"
 #include "zebra/rt.h"
 #include "zebra/zserv.h"
 #include "zebra/redistribute.h"
 #include "zebra/debug.h"
+#include "zebra/interface.h"
 
 /* Default rtm_table for all clients */
 extern struct zebra_t zebrad;
@@ -205,6 +207,33 @@ DEFUN (no_rib_sort_nexthops,
   return CMD_SUCCESS;
 }
 
+DEFUN (rib_queue_batch,
+       rib_queue_batch_cmd,
+       "rib queue-batch <1-10000>",
+       "RIB information\n"
+       "Route nodes processed per run of the RIB work queue\n"
+       "Number of route nodes\n")
+{
+  u_int32_t batch;
+
+  VTY_GET_INTEGER_RANGE ("queue batch", batch, argv[0], 1, 10000);
+  zebrad.mq->batch = batch;
+
+  return CMD_SUCCESS;
+}
+
+DEFUN (no_rib_queue_batch,
+       no_rib_queue_batch_cmd,
+       "no rib queue-batch",
+       NO_STR
+       "RIB information\n"
+       "Route nodes processed per run of the RIB work queue\n")
+{
+  zebrad.mq->batch = MQ_BATCH_DEFAULT;
+
+  return CMD_SUCCESS;
+}
+
 /* compare nexthops by ifindex */
 static int
 nexthop_cmp_ifindex (struct nexthop *a, struct nexthop *b)
@@ -632,7 +661,7 @@ nexthop_active_ipv4 (struct rib *rib, struct nexthop *nexthop, int set,
 	  || match->type == ZEBRA_ROUTE_BGP)
 	{
 	  do {
-	    rn = rn->parent;
+	    rn = route_node_parent (rn);
 	  } while (rn && rn->info == NULL);
 	  if (rn)
 	    route_lock_node (rn);
@@ -749,7 +778,7 @@ nexthop_active_ipv6 (struct rib *rib, struct nexthop *nexthop, int set,
 	  || match->type == ZEBRA_ROUTE_BGP)
 	{
 	  do {
-	    rn = rn->parent;
+	    rn = route_node_parent (rn);
 	  } while (rn && rn->info == NULL);
 	  if (rn)
 	    route_lock_node (rn);
@@ -853,7 +882,7 @@ rib_match_ipv4 (struct in_addr addr)
 	  || match->type == ZEBRA_ROUTE_BGP)
 	{
 	  do {
-	    rn = rn->parent;
+	    rn = route_node_parent (rn);
 	  } while (rn && rn->info == NULL);
 	  if (rn)
 	    route_lock_node (rn);
@@ -1035,7 +1064,7 @@ rib_match_ipv6 (struct in6_addr *addr)
 	  || match->type == ZEBRA_ROUTE_BGP)
 	{
 	  do {
-	    rn = rn->parent;
+	    rn = route_node_parent (rn);
 	  } while (rn && rn->info == NULL);
 	  if (rn)
 	    route_lock_node (rn);
@@ -1231,6 +1260,28 @@ rib_install_kernel (struct route_node *rn, struct rib *rib)
     }
 }
 
+/* The kernel rejected a route sent as part of a batch: as above, the
+ * selected route is not in the FIB. */
+void
+rib_kernel_reject (struct prefix *p)
+{
+  struct route_table *table;
+  struct route_node *rn;
+  struct rib *rib;
+  struct nexthop *nexthop;
+
+  table = vrf_table (family2afi (p->family), SAFI_UNICAST, 0);
+  if (! table || ! (rn = route_node_lookup (table, p)))
+    return;
+
+  for (rib = rn->info; rib; rib = rib->next)
+    if (CHECK_FLAG (rib->flags, ZEBRA_FLAG_SELECTED))
+      for (nexthop = rib->nexthop; nexthop; nexthop = nexthop->next)
+	UNSET_FLAG (nexthop->flags, NEXTHOP_FLAG_FIB);
+
+  route_unlock_node (rn);
+}
+
 /* Uninstall the route from kernel. */
 static int
 rib_uninstall_kernel (struct route_node *rn, struct rib *rib)
@@ -1271,6 +1322,255 @@ rib_uninstall (struct route_node *rn, struct rib *rib)
     }
 }
 
+/* Reverse index from interfaces and gateway addresses to the route
+ * nodes whose nexthops depend on them, so that an interface event
+ * requeues only those nodes rather than the whole RIB.  The chain of
+ * dependencies of a node hangs off rn->aggregate, which zebra has no
+ * other use for in the RIB, and is rebuilt each time rib_process() has
+ * run on the node.
+ */
+#define RIB_DEP_IFINDEX  1
+#define RIB_DEP_GATE     2
+
+struct rib_dep
+{
+  struct route_node *rn;		/* dependent node */
+  struct rib_dep *node_next;		/* next dependency of rn */
+
+  /* Nodes with the same dependency. */
+  struct rib_dep *prev;
+  struct rib_dep *next;
+
+  u_char type;
+  void *owner;				/* struct rib_dep_if or gateway node */
+};
+
+/* Ifindex 0 collects the nodes to look at on any interface event:
+ * interface name nexthops not yet bound and unresolved recursive
+ * nexthops. */
+struct rib_dep_if
+{
+  unsigned int ifindex;
+  struct rib_dep *deps;
+};
+
+static struct hash *rib_dep_ifindex;
+
+/* Host routes of gateway addresses, each locked once per dependency. */
+static struct route_table *rib_dep_gate_ipv4;
+#ifdef HAVE_IPV6
+static struct route_table *rib_dep_gate_ipv6;
+#endif /* HAVE_IPV6 */
+
+static unsigned int
+rib_dep_if_hash_key (void *data)
+{
+  return ((struct rib_dep_if *) data)->ifindex;
+}
+
+static int
+rib_dep_if_hash_cmp (const void *a, const void *b)
+{
+  return ((const struct rib_dep_if *) a)->ifindex ==
+    ((const struct rib_dep_if *) b)->ifindex;
+}
+
+static void *
+rib_dep_if_alloc (void *data)
+{
+  struct rib_dep_if *dif;
+
+  dif = XCALLOC (MTYPE_RIB_DEP, sizeof (struct rib_dep_if));
+  dif->ifindex = ((struct rib_dep_if *) data)->ifindex;
+  return dif;
+}
+
+static struct route_table *
+rib_dep_gate_table (u_char family)
+{
+  switch (family)
+    {
+    case AF_INET:
+      return rib_dep_gate_ipv4;
+#ifdef HAVE_IPV6
+    case AF_INET6:
+      return rib_dep_gate_ipv6;
+#endif /* HAVE_IPV6 */
+    }
+  return NULL;
+}
+
+static struct rib_dep **
+rib_dep_list (struct rib_dep *dep)
+{
+  if (dep->type == RIB_DEP_IFINDEX)
+    return &((struct rib_dep_if *) dep->owner)->deps;
+  else
+    return (struct rib_dep **) &((struct route_node *) dep->owner)->info;
+}
+
+/* Add a dependency of rn on owner, unless it already has it.  Return
+ * whether it was added. */
+static int
+rib_dep_add (struct route_node *rn, u_char type, void *owner)
+{
+  struct rib_dep *dep, **list;
+
+  for (dep = rn->aggregate; dep; dep = dep->node_next)
+    if (dep->owner == owner)
+      return 0;
+
+  dep = XCALLOC (MTYPE_RIB_DEP, sizeof (struct rib_dep));
+  dep->rn = rn;
+  dep->type = type;
+  dep->owner = owner;
+
+  list = rib_dep_list (dep);
+  dep->next = *list;
+  if (*list)
+    (*list)->prev = dep;
+  *list = dep;
+
+  if (rn->aggregate == NULL)
+    route_lock_node (rn);
+  dep->node_next = rn->aggregate;
+  rn->aggregate = dep;
+
+  return 1;
+}
+
+static void
+rib_dep_add_ifindex (struct route_node *rn, unsigned int ifindex)
+{
+  struct rib_dep_if key, *dif;
+
+  key.ifindex = ifindex;
+  dif = hash_get (rib_dep_ifindex, &key, rib_dep_if_alloc);
+  rib_dep_add (rn, RIB_DEP_IFINDEX, dif);
+}
+
+static void
+rib_dep_add_gate (struct route_node *rn, u_char family, union g_addr *gate)
+{
+  struct prefix p;
+  struct route_node *gn;
+
+  memset (&p, 0, sizeof (struct prefix));
+  p.family = family;
+  if (family == AF_INET)
+    {
+      p.prefixlen = IPV4_MAX_BITLEN;
+      p.u.prefix4 = gate->ipv4;
+    }
+#ifdef HAVE_IPV6
+  else
+    {
+      p.prefixlen = IPV6_MAX_BITLEN;
+      p.u.prefix6 = gate->ipv6;
+    }
+#endif /* HAVE_IPV6 */
+
+  gn = route_node_get (rib_dep_gate_table (family), &p);
+  if (! rib_dep_add (rn, RIB_DEP_GATE, gn))
+    route_unlock_node (gn);
+}
+
+static void
+rib_dep_free (struct rib_dep *dep)
+{
+  struct rib_dep_if *dif;
+
+  if (dep->next)
+    dep->next->prev = dep->prev;
+  if (dep->prev)
+    dep->prev->next = dep->next;
+  else
+    *rib_dep_list (dep) = dep->next;
+
+  if (dep->type == RIB_DEP_IFINDEX)
+    {
+      dif = dep->owner;
+      if (dif->deps == NULL)
+	{
+	  hash_release (rib_dep_ifindex, dif);
+	  XFREE (MTYPE_RIB_DEP, dif);
+	}
+    }
+  else
+    route_unlock_node (dep->owner);
+
+  XFREE (MTYPE_RIB_DEP, dep);
+}
+
+/* Record what the nexthops of the node's routes depend on now. */
+static void
+rib_dep_update (struct route_node *rn)
+{
+  struct rib_dep *old, *next;
+  struct rib *rib;
+  struct nexthop *nexthop;
+
+  /* Build the new chain before freeing the old one, so that the node
+   * stays locked and shared entries are not recreated. */
+  old = rn->aggregate;
+  rn->aggregate = NULL;
+
+  for (rib = rn->info; rib; rib = rib->next)
+    {
+      if (CHECK_FLAG (rib->status, RIB_ENTRY_REMOVED))
+	continue;
+
+      for (nexthop = rib->nexthop; nexthop; nexthop = nexthop->next)
+	switch (nexthop->type)
+	  {
+	  case NEXTHOP_TYPE_IFINDEX:
+	  case NEXTHOP_TYPE_IFNAME:
+#ifdef HAVE_IPV6
+	  case NEXTHOP_TYPE_IPV6_IFNAME:
+#endif /* HAVE_IPV6 */
+	    /* an unbound name has ifindex 0 */
+	    rib_dep_add_ifindex (rn, nexthop->ifindex);
+	    break;
+	  case NEXTHOP_TYPE_IPV4:
+	  case NEXTHOP_TYPE_IPV4_IFINDEX:
+#ifdef HAVE_IPV6
+	  case NEXTHOP_TYPE_IPV6:
+	  case NEXTHOP_TYPE_IPV6_IFINDEX:
+#endif /* HAVE_IPV6 */
+	    if (nexthop->ifindex)
+	      rib_dep_add_ifindex (rn, nexthop->ifindex);
+	    if (nexthop->rifindex)
+	      rib_dep_add_ifindex (rn, nexthop->rifindex);
+#ifdef HAVE_IPV6
+	    if (nexthop->type == NEXTHOP_TYPE_IPV6 ||
+		nexthop->type == NEXTHOP_TYPE_IPV6_IFINDEX)
+	      {
+		if (! IN6_IS_ADDR_LINKLOCAL (&nexthop->gate.ipv6))
+		  rib_dep_add_gate (rn, AF_INET6, &nexthop->gate);
+	      }
+	    else
+#endif /* HAVE_IPV6 */
+	      rib_dep_add_gate (rn, AF_INET, &nexthop->gate);
+	    if (CHECK_FLAG (rib->flags, ZEBRA_FLAG_INTERNAL) &&
+		! CHECK_FLAG (nexthop->flags, NEXTHOP_FLAG_ACTIVE))
+	      rib_dep_add_ifindex (rn, 0);
+	    break;
+	  default:
+	    break;
+	  }
+    }
+
+  if (old)
+    {
+      for (; old; old = next)
+	{
+	  next = old->node_next;
+	  rib_dep_free (old);
+	}
+      route_unlock_node (rn);
+    }
+}
+
 static void rib_unlink (struct route_node *, struct rib *);
 
 /* Core function for processing routing information base. */
@@ -1472,24 +1772,27 @@ rib_process (struct route_node *rn)
     }
 
 end:
+  rib_dep_update (rn);
   if (IS_ZEBRA_DEBUG_RIB_Q)
     zlog_debug ("%s: %s/%d: rn %p dequeued", __func__, buf, rn->p.prefixlen, rn);
 }
 
-/* Take a list of route_node structs and return 1, if there was a record
- * picked from it and processed by rib_process(). Don't process more, 
- * than one RN record; operate only in the specified sub-queue.
+/* Take the first route_node of a sub-queue and return 1, if there was
+ * a record picked from it and processed by rib_process(). Don't process
+ * more, than one RN record; operate only in the specified sub-queue.
  */
 static unsigned int
-process_subq (struct list * subq, u_char qindex)
+process_subq (struct meta_subq *subq, u_char qindex)
 {
-  struct listnode *lnode  = listhead (subq);
   struct route_node *rnode;
 
-  if (!lnode)
+  if (!subq->count)
     return 0;
 
-  rnode = listgetdata (lnode);
+  rnode = subq->rn[subq->head];
+  subq->head = (subq->head + 1) & (subq->size - 1);
+  subq->count--;
+
   rib_process (rnode);
 
   if (rnode->info) /* The first RIB record is holding the flags bitmask. */
@@ -1503,26 +1806,43 @@ process_subq (struct list * subq, u_char qindex)
     }
 #endif
   route_unlock_node (rnode);
-  list_delete_node (subq, lnode);
   return 1;
 }
 
 /* Dispatch the meta queue by picking, processing and unlocking the next RN from
- * a non-empty sub-queue with lowest priority. wq is equal to zebra->ribq and data
- * is pointed to the meta queue structure.
+ * a non-empty sub-queue with lowest priority, for up to mq->batch nodes or
+ * THREAD_YIELD_TIME_SLOT. Kernel updates of the batch are sent together.
+ * wq is equal to zebra->ribq and data is pointed to the meta queue structure.
  */
 static wq_item_status
-meta_queue_process (struct work_queue *dummy, void *data)
+meta_queue_process (struct work_queue *wq, void *data)
 {
   struct meta_queue * mq = data;
+  struct timeval start, now;
+  u_int32_t processed = 0;
   unsigned i;
 
-  for (i = 0; i < MQ_SIZE; i++)
-    if (process_subq (mq->subq[i], i))
-      {
-	mq->size--;
+  quagga_gettime (QUAGGA_CLK_MONOTONIC, &start);
+  kernel_batch_begin ();
+
+  while (mq->size && processed < mq->batch)
+    {
+      for (i = 0; i < MQ_SIZE; i++)
+	if (process_subq (&mq->subq[i], i))
+	  {
+	    mq->size--;
+	    break;
+	  }
+      processed++;
+
+      quagga_gettime (QUAGGA_CLK_MONOTONIC, &now);
+      if (timersub_usec (&now, &start) >= THREAD_YIELD_TIME_SLOT)
 	break;
-      }
+    }
+
+  kernel_batch_end ();
+  wq->units += processed;
+
   return mq->size ? WQ_REQUEUE : WQ_SUCCESS;
 }
 
@@ -1542,6 +1862,28 @@ static const u_char meta_queue_map[ZEBRA_ROUTE_MAX] = {
   [ZEBRA_ROUTE_BABEL]   = 2,
 };
 
+static void
+meta_subq_add (struct meta_subq *subq, struct route_node *rn)
+{
+  struct route_node **ring;
+  u_int32_t i;
+
+  if (subq->count == subq->size)
+    {
+      ring = XCALLOC (MTYPE_RIB_QUEUE,
+		      2 * subq->size * sizeof (struct route_node *));
+      for (i = 0; i < subq->count; i++)
+	ring[i] = subq->rn[(subq->head + i) & (subq->size - 1)];
+      XFREE (MTYPE_RIB_QUEUE, subq->rn);
+      subq->rn = ring;
+      subq->size *= 2;
+      subq->head = 0;
+    }
+
+  subq->rn[(subq->head + subq->count) & (subq->size - 1)] = rn;
+  subq->count++;
+}
+
 /* Look into the RN and queue it into one or more priority queues,
  * increasing the size for each data push done.
  */
@@ -1568,7 +1910,7 @@ rib_meta_queue_add (struct meta_queue *mq, struct route_node *rn)
 	}
 
       SET_FLAG (((struct rib *)rn->info)->rn_status, RIB_ROUTE_QUEUED(qindex));
-      listnode_add (mq->subq[qindex], rn);
+      meta_subq_add (&mq->subq[qindex], rn);
       route_lock_node (rn);
       mq->size++;
 
@@ -1641,9 +1983,11 @@ meta_queue_new (void)
 
   for (i = 0; i < MQ_SIZE; i++)
     {
-      new->subq[i] = list_new ();
-      assert(new->subq[i]);
+      new->subq[i].size = 64;
+      new->subq[i].rn = XCALLOC (MTYPE_RIB_QUEUE, new->subq[i].size *
+				 sizeof (struct route_node *));
     }
+  new->batch = MQ_BATCH_DEFAULT;
 
   return new;
 }
@@ -3165,27 +3509,278 @@ static_delete_ipv6 (struct prefix *p, u_char type, struct in6_addr *gate,
 }
 #endif /* HAVE_IPV6 */
 
-/* RIB update function. */
+/* Requeue the nodes on a dependency list, returning how many were not
+ * already queued. */
+static u_int32_t
+rib_dep_requeue (struct rib_dep *dep)
+{
+  u_int32_t queued = 0, size;
+
+  for (; dep; dep = dep->next)
+    if (dep->rn->info)
+      {
+	size = zebrad.mq->size;
+	rib_queue_add (&zebrad, dep->rn);
+	if (zebrad.mq->size != size)
+	  queued++;
+      }
+  return queued;
+}
+
+static u_int32_t
+rib_dep_requeue_ifindex (unsigned int ifindex)
+{
+  struct rib_dep_if key, *dif;
+
+  key.ifindex = ifindex;
+  dif = hash_lookup (rib_dep_ifindex, &key);
+  return dif ? rib_dep_requeue (dif->deps) : 0;
+}
+
+/* Requeue the nodes with a gateway within prefix p. */
+static u_int32_t
+rib_dep_requeue_gate (struct prefix *p)
+{
+  struct route_table *table;
+  struct route_node *top, *gn;
+  struct prefix q;
+  u_int32_t queued = 0;
+
+  table = rib_dep_gate_table (p->family);
+  if (table == NULL)
+    return 0;
+
+  prefix_copy (&q, p);
+  apply_mask (&q);
+
+  top = route_node_get (table, &q);
+  route_lock_node (top);
+  for (gn = top; gn; gn = route_next_until (gn, top))
+    if (gn->info)
+      queued += rib_dep_requeue (gn->info);
+  route_unlock_node (top);
+
+  return queued;
+}
+
+/* While a batch of kernel events is applied, the interfaces and
+ * prefixes to examine are only collected, and each is examined once
+ * when the batch ends.  Interfaces are collected by ifindex: a link
+ * may be removed and another created under the same name meanwhile. */
+struct rib_update_pending
+{
+  unsigned int ifindex;
+  u_int32_t queued;
+};
+
+static int rib_update_batching;
+static struct hash *rib_update_ifs;
+static struct route_table *rib_update_gate_ipv4;
+#ifdef HAVE_IPV6
+static struct route_table *rib_update_gate_ipv6;
+#endif /* HAVE_IPV6 */
+
+static struct route_table *
+rib_update_gate_table (u_char family)
+{
+  switch (family)
+    {
+    case AF_INET:
+      return rib_update_gate_ipv4;
+#ifdef HAVE_IPV6
+    case AF_INET6:
+      return rib_update_gate_ipv6;
+#endif /* HAVE_IPV6 */
+    }
+  return NULL;
+}
+
+static unsigned int
+rib_update_pending_hash_key (void *data)
+{
+  return ((struct rib_update_pending *) data)->ifindex;
+}
+
+static int
+rib_update_pending_hash_cmp (const void *a, const void *b)
+{
+  return ((const struct rib_update_pending *) a)->ifindex ==
+    ((const struct rib_update_pending *) b)->ifindex;
+}
+
+static void *
+rib_update_pending_alloc (void *data)
+{
+  struct rib_update_pending *pending;
+
+  pending = XCALLOC (MTYPE_RIB_UPDATE, sizeof (struct rib_update_pending));
+  pending->ifindex = ((struct rib_update_pending *) data)->ifindex;
+  return pending;
+}
+
+static void
+rib_update_pending_free (void *data)
+{
+  XFREE (MTYPE_RIB_UPDATE, data);
+}
+
+static void
+rib_update_defer_gate (struct rib_update_pending *pending, struct prefix *p)
+{
+  struct route_table *table;
+  struct route_node *rn;
+  struct prefix q;
+
+  table = rib_update_gate_table (p->family);
+  if (table == NULL)
+    return;
+
+  prefix_copy (&q, p);
+  apply_mask (&q);
+
+  rn = route_node_get (table, &q);
+  if (rn->info)
+    route_unlock_node (rn);
+  else
+    rn->info = pending;
+}
+
+static void
+rib_update_defer (struct interface *ifp, struct prefix *p)
+{
+  struct rib_update_pending key, *pending;
+  struct listnode *node;
+  struct connected *ifc;
+
+  key.ifindex = ifp->ifindex;
+  pending = hash_get (rib_update_ifs, &key, rib_update_pending_alloc);
+
+  if (p)
+    rib_update_defer_gate (pending, p);
+  else
+    for (ALL_LIST_ELEMENTS_RO (ifp->connected, node, ifc))
+      rib_update_defer_gate (pending, ifc->address);
+}
+
+/* Examine the routes depending on an interface or, if p is given, on
+ * one of its connected prefixes. */
 void
-rib_update (void)
+rib_update_interface (struct interface *ifp, struct prefix *p)
+{
+  struct zebra_if *zif = ifp->info;
+  struct listnode *node;
+  struct connected *ifc;
+  u_int32_t queued;
+
+  if (rib_update_batching && zif)
+    {
+      rib_update_defer (ifp, p);
+      return;
+    }
+
+  queued = rib_dep_requeue_ifindex (ifp->ifindex);
+  queued += rib_dep_requeue_ifindex (0);
+  if (p)
+    queued += rib_dep_requeue_gate (p);
+  else
+    for (ALL_LIST_ELEMENTS_RO (ifp->connected, node, ifc))
+      queued += rib_dep_requeue_gate (ifc->address);
+
+  if (IS_ZEBRA_DEBUG_RIB_Q)
+    zlog_debug ("%s: %s: %u route nodes requeued", __func__, ifp->name,
+		queued);
+
+  if (zif)
+    {
+      zif->rib_events++;
+      zif->rib_requeued += queued;
+      zif->rib_last_requeued = queued;
+    }
+}
+
+/* Start collecting the effects of interface events. */
+void
+rib_update_batch_begin (void)
+{
+  rib_update_batching = 1;
+}
+
+static u_int32_t
+rib_update_batch_gates (struct route_table *table)
 {
   struct route_node *rn;
-  struct route_table *table;
-  
-  table = vrf_table (AFI_IP, SAFI_UNICAST, 0);
-  if (table)
-    for (rn = route_top (table); rn; rn = route_next (rn))
-      if (rn->info)
-        rib_queue_add (&zebrad, rn);
+  struct rib_update_pending *pending;
+  u_int32_t queued = 0, n;
 
-  table = vrf_table (AFI_IP6, SAFI_UNICAST, 0);
-  if (table)
-    for (rn = route_top (table); rn; rn = route_next (rn))
-      if (rn->info)
-        rib_queue_add (&zebrad, rn);
+  for (rn = route_top (table); rn; rn = route_next (rn))
+    if ((pending = rn->info) != NULL)
+      {
+	n = rib_dep_requeue_gate (&rn->p);
+	pending->queued += n;
+	queued += n;
+	rn->info = NULL;
+	route_unlock_node (rn);
+      }
+
+  return queued;
+}
+
+static void
+rib_update_batch_if (struct hash_backet *backet, void *arg)
+{
+  struct rib_update_pending *pending = backet->data;
+
+  pending->queued = rib_dep_requeue_ifindex (pending->ifindex);
+  *(u_int32_t *) arg += pending->queued;
+}
+
+/* Account the routes requeued to the interface, if it still has the
+ * ifindex of its events. */
+static void
+rib_update_batch_account (struct hash_backet *backet, void *arg)
+{
+  struct rib_update_pending *pending = backet->data;
+  struct interface *ifp;
+  struct zebra_if *zif;
+
+  ifp = if_lookup_by_index (pending->ifindex);
+  if (ifp && (zif = ifp->info) != NULL)
+    {
+      zif->rib_events++;
+      zif->rib_requeued += pending->queued;
+      zif->rib_last_requeued = pending->queued;
+    }
+}
+
+/* Examine everything collected since rib_update_batch_begin, each
+ * interface and connected prefix once. */
+void
+rib_update_batch_end (void)
+{
+  u_int32_t queued;
+  unsigned int count;
+
+  rib_update_batching = 0;
+
+  count = rib_update_ifs->count;
+  if (count == 0)
+    return;
+
+  queued = rib_dep_requeue_ifindex (0);
+  hash_iterate (rib_update_ifs, rib_update_batch_if, &queued);
+  queued += rib_update_batch_gates (rib_update_gate_ipv4);
+#ifdef HAVE_IPV6
+  queued += rib_update_batch_gates (rib_update_gate_ipv6);
+#endif /* HAVE_IPV6 */
+
+  hash_iterate (rib_update_ifs, rib_update_batch_account, NULL);
+  hash_clean (rib_update_ifs, rib_update_pending_free);
+
+  if (IS_ZEBRA_DEBUG_RIB_Q)
+    zlog_debug ("%s: %u interfaces: %u route nodes requeued", __func__,
+		count, queued);
 }
 
-
 /* Remove all routes which comes from non main table.  */
 static void
 rib_weed_table (struct route_table *table)
@@ -3320,6 +3915,9 @@ config_write_rib (struct vty *vty)
   else if (sort_nexthops < 0)
     vty_out (vty, "rib sort-nexthops ascending%s", VTY_NEWLINE);
 
+  if (zebrad.mq->batch != MQ_BATCH_DEFAULT)
+    vty_out (vty, "rib queue-batch %u%s", zebrad.mq->batch, VTY_NEWLINE);
+
   return 0;
 }
 
@@ -3336,6 +3934,17 @@ void
 rib_init (void)
 {
   rib_queue_init (&zebrad);
+  rib_dep_ifindex = hash_create (rib_dep_if_hash_key, rib_dep_if_hash_cmp);
+  rib_dep_gate_ipv4 = route_table_init ();
+#ifdef HAVE_IPV6
+  rib_dep_gate_ipv6 = route_table_init ();
+#endif /* HAVE_IPV6 */
+  rib_update_ifs = hash_create (rib_update_pending_hash_key,
+			       rib_update_pending_hash_cmp);
+  rib_update_gate_ipv4 = route_table_init ();
+#ifdef HAVE_IPV6
+  rib_update_gate_ipv6 = route_table_init ();
+#endif /* HAVE_IPV6 */
   /* VRF initialization.  */
   vrf_init ();
 
@@ -3344,4 +3953,6 @@ rib_init (void)
   install_element (CONFIG_NODE, &rib_sort_nexthops_descending_cmd);
   install_element (CONFIG_NODE, &rib_sort_nexthops_ascending_cmd);
   install_element (CONFIG_NODE, &no_rib_sort_nexthops_cmd);
+  install_element (CONFIG_NODE, &rib_queue_batch_cmd);
+  install_element (CONFIG_NODE, &no_rib_queue_batch_cmd);
 }
@@ -0,0 +1,401 @@
+/* Zebra nexthop tracking
+ *
+ * This file is part of GNU Zebra.
+ *
+ * GNU Zebra is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * GNU Zebra is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Zebra; see the file COPYING.  If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <zebra.h>
+
+#include "prefix.h"
+#include "table.h"
+#include "memory.h"
+#include "linklist.h"
+#include "stream.h"
+#include "zclient.h"
+#include "thread.h"
+#include "command.h"
+#include "log.h"
+
+#include "zebra/rib.h"
+#include "zebra/zserv.h"
+#include "zebra/debug.h"
+#include "zebra/zebra_rnh.h"
+
+extern struct zebra_t zebrad;
+
+/* registered addresses, by family */
+static struct route_table *rnh_table[AFI_MAX];
+
+/* addresses to resolve again, once the current event is done */
+static struct list *rnh_dirty;
+static struct thread *t_rnh;
+
+/* scratch space for resolutions */
+static struct stream *rnh_stream;
+
+/* statistics */
+static u_int32_t rnh_resolutions;
+static u_int32_t rnh_updates;
+
+/* Resolve the address again, returns 1 if the result differs from the
+   one known so far */
+static int
+rnh_resolve (struct rnh *rnh)
+{
+  struct prefix *p = &rnh->node->p;
+  struct stream *s = rnh_stream;
+  struct rib *rib = NULL;
+  struct nexthop *nexthop;
+  unsigned long nump;
+  u_char num = 0;
+  size_t len;
+
+  rnh_resolutions++;
+
+  if (p->family == AF_INET)
+    rib = rib_match_ipv4 (p->u.prefix4);
+#ifdef HAVE_IPV6
+  else if (p->family == AF_INET6)
+    rib = rib_match_ipv6 (&p->u.prefix6);
+#endif /* HAVE_IPV6 */
+
+  stream_reset (s);
+  stream_putl (s, rib ? rib->metric : 0);
+  nump = stream_get_endp (s);
+  stream_putc (s, 0);
+  if (rib)
+    for (nexthop = rib->nexthop; nexthop; nexthop = nexthop->next)
+      {
+        if (! CHECK_FLAG (nexthop->flags, NEXTHOP_FLAG_FIB))
+          continue;
+        if (STREAM_WRITEABLE (s) < 1 + IPV6_MAX_BYTELEN + 4 || num == 255)
+          break;
+
+        stream_putc (s, nexthop->type);
+        switch (nexthop->type)
+          {
+          case ZEBRA_NEXTHOP_IPV4:
+            stream_put_in_addr (s, &nexthop->gate.ipv4);
+            break;
+          case ZEBRA_NEXTHOP_IPV4_IFINDEX:
+          case ZEBRA_NEXTHOP_IPV4_IFNAME:
+            stream_put_in_addr (s, &nexthop->gate.ipv4);
+            stream_putl (s, nexthop->ifindex);
+            break;
+#ifdef HAVE_IPV6
+          case ZEBRA_NEXTHOP_IPV6:
+            stream_put (s, &nexthop->gate.ipv6, 16);
+            break;
+          case ZEBRA_NEXTHOP_IPV6_IFINDEX:
+          case ZEBRA_NEXTHOP_IPV6_IFNAME:
+            stream_put (s, &nexthop->gate.ipv6, 16);
+            stream_putl (s, nexthop->ifindex);
+            break;
+#endif /* HAVE_IPV6 */
+          case ZEBRA_NEXTHOP_IFINDEX:
+          case ZEBRA_NEXTHOP_IFNAME:
+            stream_putl (s, nexthop->ifindex);
+            break;
+          default:
+            break;
+          }
+        num++;
+      }
+  stream_putc_at (s, nump, num);
+
+  len = stream_get_endp (s);
+  if (rnh->state && rnh->state_len == len &&
+      memcmp (rnh->state, STREAM_DATA (s), len) == 0)
+    return 0;
+
+  if (rnh->state)
+    XFREE (MTYPE_RNH, rnh->state);
+  rnh->state = XMALLOC (MTYPE_RNH, len);
+  memcpy (rnh->state, STREAM_DATA (s), len);
+  rnh->state_len = len;
+  return 1;
+}
+
+static void
+rnh_free (struct rnh *rnh)
+{
+  struct route_node *rn = rnh->node;
+
+  if (rnh->dirty)
+    listnode_delete (rnh_dirty, rnh);
+  if (rnh->state)
+    XFREE (MTYPE_RNH, rnh->state);
+  list_delete (rnh->clients);
+  XFREE (MTYPE_RNH, rnh);
+
+  rn->info = NULL;
+  route_unlock_node (rn);
+}
+
+static int
+zebra_rnh_process (struct thread *thread)
+{
+  struct listnode *node, *cnode;
+  struct zserv *client;
+  struct rnh *rnh;
+
+  t_rnh = NULL;
+
+  while ((node = listhead (rnh_dirty)) != NULL)
+    {
+      rnh = listgetdata (node);
+      list_delete_node (rnh_dirty, node);
+      rnh->dirty = 0;
+
+      if (! rnh_resolve (rnh))
+        continue;
+
+      if (IS_ZEBRA_DEBUG_EVENT)
+        {
+          char buf[INET6_ADDRSTRLEN];
+
+          zlog_debug ("%s: %s resolved differently, telling %u clients",
+                      __func__, inet_ntop (rnh->node->p.family,
+                                           &rnh->node->p.u.prefix,
+                                           buf, sizeof (buf)),
+                      listcount (rnh->clients));
+        }
+
+      for (ALL_LIST_ELEMENTS_RO (rnh->clients, cnode, client))
+        {
+          zsend_nexthop_update (client, &rnh->node->p, rnh->state,
+                                rnh->state_len);
+          rnh_updates++;
+        }
+    }
+
+  return 0;
+}
+
+/* A route for p changed: the addresses it covers may resolve
+   differently */
+void
+zebra_rnh_changed (struct prefix *p)
+{
+  struct route_table *table;
+  struct route_node *top, *rn;
+  struct prefix q;
+  struct rnh *rnh;
+  afi_t afi = family2afi (p->family);
+
+  if (afi != AFI_IP && afi != AFI_IP6)
+    return;
+  table = rnh_table[afi];
+  if (table == NULL || route_table_count (table) == 0)
+    return;
+
+  prefix_copy (&q, p);
+  apply_mask (&q);
+
+  top = route_node_get (table, &q);
+  route_lock_node (top);
+  for (rn = top; rn; rn = route_next_until (rn, top))
+    if ((rnh = rn->info) != NULL && ! rnh->dirty)
+      {
+        rnh->dirty = 1;
+        listnode_add (rnh_dirty, rnh);
+      }
+  route_unlock_node (top);
+
+  if (listcount (rnh_dirty) && t_rnh == NULL)
+    t_rnh = thread_add_event (zebrad.master, zebra_rnh_process, NULL, 0);
+}
+
+static void
+rnh_add (struct prefix *p, struct zserv *client)
+{
+  struct route_node *rn;
+  struct rnh *rnh;
+
+  rn = route_node_get (rnh_table[family2afi (p->family)], p);
+  if (rn->info)
+    {
+      rnh = rn->info;
+      route_unlock_node (rn);
+    }
+  else
+    {
+      rnh = XCALLOC (MTYPE_RNH, sizeof (struct rnh));
+      rnh->node = rn;
+      rnh->clients = list_new ();
+      rn->info = rnh;
+      rnh_resolve (rnh);
+    }
+
+  if (listnode_lookup (rnh->clients, client) == NULL)
+    listnode_add (rnh->clients, client);
+
+  /* the client starts from the resolution known so far */
+  zsend_nexthop_update (client, &rn->p, rnh->state, rnh->state_len);
+}
+
+static void
+rnh_delete (struct prefix *p, struct zserv *client)
+{
+  struct route_node *rn;
+  struct rnh *rnh;
+
+  rn = route_node_lookup (rnh_table[family2afi (p->family)], p);
+  if (rn == NULL)
+    return;
+  route_unlock_node (rn);
+
+  rnh = rn->info;
+  listnode_delete (rnh->clients, client);
+  if (listcount (rnh->clients) == 0)
+    rnh_free (rnh);
+}
+
+/* ZEBRA_NEXTHOP_REGISTER and ZEBRA_NEXTHOP_UNREGISTER carry one or
+   more addresses, each as a family and the address */
+int
+zebra_rnh_register (uint16_t cmd, struct zserv *client, uint16_t length)
+{
+  struct stream *s = client->ibuf;
+  size_t end = stream_get_getp (s) + length;
+  struct prefix p;
+
+  while (stream_get_getp (s) < end)
+    {
+      memset (&p, 0, sizeof (struct prefix));
+      p.family = stream_getc (s);
+      if (p.family == AF_INET)
+        p.prefixlen = IPV4_MAX_BITLEN;
+#ifdef HAVE_IPV6
+      else if (p.family == AF_INET6)
+        p.prefixlen = IPV6_MAX_BITLEN;
+#endif /* HAVE_IPV6 */
+      else
+        {
+          zlog_err ("%s: invalid family %u", __func__, p.family);
+          return -1;
+        }
+      if (end - stream_get_getp (s) < (size_t) PSIZE (p.prefixlen))
+        {
+          zlog_err ("%s: invalid length: %u", __func__, length);
+          return -1;
+        }
+      stream_get (&p.u.prefix, s, PSIZE (p.prefixlen));
+
+      if (cmd == ZEBRA_NEXTHOP_REGISTER)
+        rnh_add (&p, client);
+      else
+        rnh_delete (&p, client);
+    }
+
+  return 0;
+}
+
+void
+zebra_rnh_client_close (struct zserv *client)
+{
+  struct route_node *rn;
+  struct rnh *rnh;
+  afi_t afi;
+
+  for (afi = AFI_IP; afi < AFI_MAX; afi++)
+    if (rnh_table[afi])
+      for (rn = route_top (rnh_table[afi]); rn; rn = route_next (rn))
+        if ((rnh = rn->info) != NULL)
+          {
+            listnode_delete (rnh->clients, client);
+            if (listcount (rnh->clients) == 0)
+              rnh_free (rnh);
+          }
+}
+
+static void
+rnh_show (struct vty *vty, afi_t afi)
+{
+  struct route_node *rn;
+  struct listnode *node;
+  struct zserv *client;
+  struct rnh *rnh;
+  char buf[INET6_ADDRSTRLEN];
+  u_int32_t metric;
+  unsigned long count = 0;
+
+  for (rn = route_top (rnh_table[afi]); rn; rn = route_next (rn))
+    {
+      if ((rnh = rn->info) == NULL)
+        continue;
+      count++;
+
+      memcpy (&metric, rnh->state, sizeof (metric));
+      vty_out (vty, "%s%s", inet_ntop (rn->p.family, &rn->p.u.prefix,
+                                       buf, sizeof (buf)), VTY_NEWLINE);
+      if (rnh->state[4])
+        vty_out (vty, "  resolved by %u nexthops, metric %u%s",
+                 rnh->state[4], ntohl (metric), VTY_NEWLINE);
+      else
+        vty_out (vty, "  unresolved%s", VTY_NEWLINE);
+      vty_out (vty, "  clients:");
+      for (ALL_LIST_ELEMENTS_RO (rnh->clients, node, client))
+        vty_out (vty, " fd %d", client->sock);
+      vty_out (vty, "%s", VTY_NEWLINE);
+    }
+
+  vty_out (vty, "%lu addresses tracked; %u resolutions, %u updates sent%s",
+           count, rnh_resolutions, rnh_updates, VTY_NEWLINE);
+}
+
+DEFUN (show_ip_nht,
+       show_ip_nht_cmd,
+       "show ip nht",
+       SHOW_STR
+       IP_STR
+       "IP nexthop tracking\n")
+{
+  rnh_show (vty, AFI_IP);
+  return CMD_SUCCESS;
+}
+
+#ifdef HAVE_IPV6
+DEFUN (show_ipv6_nht,
+       show_ipv6_nht_cmd,
+       "show ipv6 nht",
+       SHOW_STR
+       IPV6_STR
+       "IPv6 nexthop tracking\n")
+{
+  rnh_show (vty, AFI_IP6);
+  return CMD_SUCCESS;
+}
+#endif /* HAVE_IPV6 */
+
+void
+zebra_rnh_init (void)
+{
+  rnh_table[AFI_IP] = route_table_init ();
+#ifdef HAVE_IPV6
+  rnh_table[AFI_IP6] = route_table_init ();
+#endif /* HAVE_IPV6 */
+  rnh_dirty = list_new ();
+  rnh_stream = stream_new (ZEBRA_MAX_PACKET_SIZ);
+
+  install_element (VIEW_NODE, &show_ip_nht_cmd);
+  install_element (ENABLE_NODE, &show_ip_nht_cmd);
+#ifdef HAVE_IPV6
+  install_element (VIEW_NODE, &show_ipv6_nht_cmd);
+  install_element (ENABLE_NODE, &show_ipv6_nht_cmd);
+#endif /* HAVE_IPV6 */
+}
@@ -0,0 +1,48 @@
+/* Zebra nexthop tracking
+ *
+ * This file is part of GNU Zebra.
+ *
+ * GNU Zebra is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * GNU Zebra is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Zebra; see the file COPYING.  If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef _ZEBRA_RNH_H
+#define _ZEBRA_RNH_H
+
+/* A nexthop address registered by clients.  Its resolution (metric
+   and nexthops of the longest match, as in a ZEBRA_NEXTHOP_UPDATE) is
+   kept until a route covering the address changes; it is then
+   resolved again and the clients are told only if it differs. */
+struct rnh
+{
+  struct route_node *node;      /* in the table of its family */
+  struct list *clients;
+
+  u_char dirty;
+
+  u_char *state;
+  u_int16_t state_len;
+};
+
+struct prefix;
+struct zserv;
+
+extern void zebra_rnh_init (void);
+extern void zebra_rnh_changed (struct prefix *p);
+extern int zebra_rnh_register (uint16_t cmd, struct zserv *client,
+                               uint16_t length);
+extern void zebra_rnh_client_close (struct zserv *client);
+
+#endif /* _ZEBRA_RNH_H */
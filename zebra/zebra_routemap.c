@@ -438,7 +438,7 @@ route_match_ip_next_hop (void *rule, struct prefix *prefix,
       default:
         return RMAP_NOMATCH;
       }
-      alist = access_list_lookup (AFI_IP, (char *) rule);
+      alist = access_list_ref_lookup (rule);
       if (alist == NULL)
 	return RMAP_NOMATCH;
 
@@ -453,14 +453,14 @@ route_match_ip_next_hop (void *rule, struct prefix *prefix,
 static void *
 route_match_ip_next_hop_compile (const char *arg)
 {
-  return XSTRDUP (MTYPE_ROUTE_MAP_COMPILED, arg);
+  return access_list_ref_new (AFI_IP, arg);
 }
 
 /* Free route map's compiled `. */
 static void
 route_match_ip_next_hop_free (void *rule)
 {
-  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+  access_list_ref_free (rule);
 }
 
 /* Route map commands for ip next-hop matching. */
@@ -504,7 +504,7 @@ route_match_ip_next_hop_prefix_list (void *rule, struct prefix *prefix,
       default:
         return RMAP_NOMATCH;
       }
-      plist = prefix_list_lookup (AFI_IP, (char *) rule);
+      plist = prefix_list_ref_lookup (rule);
       if (plist == NULL)
         return RMAP_NOMATCH;
 
@@ -517,13 +517,13 @@ route_match_ip_next_hop_prefix_list (void *rule, struct prefix *prefix,
 static void *
 route_match_ip_next_hop_prefix_list_compile (const char *arg)
 {
-  return XSTRDUP (MTYPE_ROUTE_MAP_COMPILED, arg);
+  return prefix_list_ref_new (AFI_IP, arg);
 }
 
 static void
 route_match_ip_next_hop_prefix_list_free (void *rule)
 {
-  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+  prefix_list_ref_free (rule);
 }
 
 static struct route_map_rule_cmd route_match_ip_next_hop_prefix_list_cmd =
@@ -546,7 +546,7 @@ route_match_ip_address (void *rule, struct prefix *prefix,
 
   if (type == RMAP_ZEBRA)
     {
-      alist = access_list_lookup (AFI_IP, (char *) rule);
+      alist = access_list_ref_lookup (rule);
       if (alist == NULL)
 	return RMAP_NOMATCH;
     
@@ -561,14 +561,14 @@ route_match_ip_address (void *rule, struct prefix *prefix,
 static void *
 route_match_ip_address_compile (const char *arg)
 {
-  return XSTRDUP (MTYPE_ROUTE_MAP_COMPILED, arg);
+  return access_list_ref_new (AFI_IP, arg);
 }
 
 /* Free route map's compiled `ip address' value. */
 static void
 route_match_ip_address_free (void *rule)
 {
-  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+  access_list_ref_free (rule);
 }
 
 /* Route map commands for ip address matching. */
@@ -590,7 +590,7 @@ route_match_ip_address_prefix_list (void *rule, struct prefix *prefix,
 
   if (type == RMAP_ZEBRA)
     {
-      plist = prefix_list_lookup (AFI_IP, (char *) rule);
+      plist = prefix_list_ref_lookup (rule);
       if (plist == NULL)
 	return RMAP_NOMATCH;
     
@@ -603,13 +603,13 @@ route_match_ip_address_prefix_list (void *rule, struct prefix *prefix,
 static void *
 route_match_ip_address_prefix_list_compile (const char *arg)
 {
-  return XSTRDUP (MTYPE_ROUTE_MAP_COMPILED, arg);
+  return prefix_list_ref_new (AFI_IP, arg);
 }
 
 static void
 route_match_ip_address_prefix_list_free (void *rule)
 {
-  XFREE (MTYPE_ROUTE_MAP_COMPILED, rule);
+  prefix_list_ref_free (rule);
 }
 
 static struct route_map_rule_cmd route_match_ip_address_prefix_list_cmd =
@@ -806,6 +806,86 @@ vty_show_ip_route (struct vty *vty, struct route_node *rn, struct rib *rib)
     }
 }
 
+/* A walk over the routes of a table, showing them a chunk at a time.
+   The node to carry on from stays locked in between. */
+struct vty_show_route
+{
+  afi_t afi;
+  int type;			/* or -1 for all routes */
+  void (*show) (struct vty *, struct route_node *, struct rib *);
+  struct route_node *rn;
+  int first;
+};
+
+static int
+vty_show_route_output (struct vty *vty, void *arg)
+{
+  struct vty_show_route *walk = arg;
+  struct route_node *rn;
+  struct rib *rib;
+
+  for (rn = walk->rn; rn; rn = route_next (rn))
+    {
+      if (vty_output_full (vty))
+	{
+	  walk->rn = rn;
+	  return 1;
+	}
+
+      for (rib = rn->info; rib; rib = rib->next)
+	{
+	  if (walk->type >= 0 && rib->type != walk->type)
+	    continue;
+	  if (walk->first)
+	    {
+	      if (walk->afi == AFI_IP)
+		vty_out (vty, SHOW_ROUTE_V4_HEADER);
+#ifdef HAVE_IPV6
+	      else
+		vty_out (vty, SHOW_ROUTE_V6_HEADER);
+#endif /* HAVE_IPV6 */
+	      walk->first = 0;
+	    }
+	  (*walk->show) (vty, rn, rib);
+	}
+    }
+
+  walk->rn = NULL;
+  return 0;
+}
+
+static void
+vty_show_route_clean (void *arg)
+{
+  struct vty_show_route *walk = arg;
+
+  if (walk->rn)
+    route_unlock_node (walk->rn);
+  XFREE (MTYPE_VTY_OUTPUT, walk);
+}
+
+/* Show the routes of TYPE, or all, in the table of AFI. */
+static void
+vty_show_route_start (struct vty *vty, afi_t afi, int type,
+		      void (*show) (struct vty *, struct route_node *,
+				    struct rib *))
+{
+  struct route_table *table;
+  struct vty_show_route *walk;
+
+  table = vrf_table (afi, SAFI_UNICAST, 0);
+  if (! table)
+    return;
+
+  walk = XCALLOC (MTYPE_VTY_OUTPUT, sizeof (struct vty_show_route));
+  walk->afi = afi;
+  walk->type = type;
+  walk->show = show;
+  walk->rn = route_top (table);
+  walk->first = 1;
+  vty_output_start (vty, vty_show_route_output, vty_show_route_clean, walk);
+}
+
 DEFUN (show_ip_route,
        show_ip_route_cmd,
        "show ip route",
@@ -813,26 +893,8 @@ DEFUN (show_ip_route,
        IP_STR
        "IP routing table\n")
 {
-  struct route_table *table;
-  struct route_node *rn;
-  struct rib *rib;
-  int first = 1;
-
-  table = vrf_table (AFI_IP, SAFI_UNICAST, 0);
-  if (! table)
-    return CMD_SUCCESS;
-
   /* Show all IPv4 routes. */
-  for (rn = route_top (table); rn; rn = route_next (rn))
-    for (rib = rn->info; rib; rib = rib->next)
-      {
-	if (first)
-	  {
-	    vty_out (vty, SHOW_ROUTE_V4_HEADER);
-	    first = 0;
-	  }
-	vty_show_ip_route (vty, rn, rib);
-      }
+  vty_show_route_start (vty, AFI_IP, -1, vty_show_ip_route);
   return CMD_SUCCESS;
 }
 
@@ -926,10 +988,6 @@ DEFUN (show_ip_route_protocol,
        QUAGGA_IP_REDIST_HELP_STR_ZEBRA)
 {
   int type;
-  struct route_table *table;
-  struct route_node *rn;
-  struct rib *rib;
-  int first = 1;
 
   type = proto_redistnum (AFI_IP, argv[0]);
   if (type < 0)
@@ -938,22 +996,8 @@ DEFUN (show_ip_route_protocol,
       return CMD_WARNING;
     }
   
-  table = vrf_table (AFI_IP, SAFI_UNICAST, 0);
-  if (! table)
-    return CMD_SUCCESS;
-
   /* Show matched type IPv4 routes. */
-  for (rn = route_top (table); rn; rn = route_next (rn))
-    for (rib = rn->info; rib; rib = rib->next)
-      if (rib->type == type)
-	{
-	  if (first)
-	    {
-	      vty_out (vty, SHOW_ROUTE_V4_HEADER);
-	      first = 0;
-	    }
-	  vty_show_ip_route (vty, rn, rib);
-	}
+  vty_show_route_start (vty, AFI_IP, type, vty_show_ip_route);
   return CMD_SUCCESS;
 }
 
@@ -1752,26 +1796,8 @@ DEFUN (show_ipv6_route,
        IP_STR
        "IPv6 routing table\n")
 {
-  struct route_table *table;
-  struct route_node *rn;
-  struct rib *rib;
-  int first = 1;
-
-  table = vrf_table (AFI_IP6, SAFI_UNICAST, 0);
-  if (! table)
-    return CMD_SUCCESS;
-
   /* Show all IPv6 route. */
-  for (rn = route_top (table); rn; rn = route_next (rn))
-    for (rib = rn->info; rib; rib = rib->next)
-      {
-	if (first)
-	  {
-	    vty_out (vty, SHOW_ROUTE_V6_HEADER);
-	    first = 0;
-	  }
-	vty_show_ipv6_route (vty, rn, rib);
-      }
+  vty_show_route_start (vty, AFI_IP6, -1, vty_show_ipv6_route);
   return CMD_SUCCESS;
 }
 
@@ -1826,10 +1852,6 @@ DEFUN (show_ipv6_route_protocol,
 	QUAGGA_IP6_REDIST_HELP_STR_ZEBRA)
 {
   int type;
-  struct route_table *table;
-  struct route_node *rn;
-  struct rib *rib;
-  int first = 1;
 
   type = proto_redistnum (AFI_IP6, argv[0]);
   if (type < 0)
@@ -1838,22 +1860,8 @@ DEFUN (show_ipv6_route_protocol,
       return CMD_WARNING;
     }
   
-  table = vrf_table (AFI_IP6, SAFI_UNICAST, 0);
-  if (! table)
-    return CMD_SUCCESS;
-
   /* Show matched type IPv6 routes. */
-  for (rn = route_top (table); rn; rn = route_next (rn))
-    for (rib = rn->info; rib; rib = rib->next)
-      if (rib->type == type)
-	{
-	  if (first)
-	    {
-	      vty_out (vty, SHOW_ROUTE_V6_HEADER);
-	      first = 0;
-	    }
-	  vty_show_ipv6_route (vty, rn, rib);
-	}
+  vty_show_route_start (vty, AFI_IP6, type, vty_show_ipv6_route);
   return CMD_SUCCESS;
 }
 
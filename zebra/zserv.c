@@ -37,12 +37,17 @@
 #include "network.h"
 #include "buffer.h"
 #include "zserv_linkmetrics.h"
+#include "zserv_rib_shm.h"
+#include "zebra_rnh.h"
 
 #include "zebra/zserv.h"
 #include "zebra/router-id.h"
 #include "zebra/redistribute.h"
 #include "zebra/debug.h"
 #include "zebra/ipforward.h"
+
+/* Size of the buffer data from a client is read into. */
+#define ZSERV_RBUF_SIZE (16 * ZEBRA_MAX_PACKET_SIZ)
 
 /* Event list of zebra. */
 enum event { ZEBRA_SERV, ZEBRA_READ, ZEBRA_WRITE };
@@ -55,16 +60,6 @@ extern struct zebra_privs_t zserv_privs;
 
 static void zebra_client_close (struct zserv *client);
 
-static int
-zserv_delayed_close(struct thread *thread)
-{
-  struct zserv *client = THREAD_ARG(thread);
-
-  client->t_suicide = NULL;
-  zebra_client_close(client);
-  return 0;
-}
-
 /* When client connects, it sends hello message
  * with promise to send zebra routes of specific type.
  * Zebra stores a socket fd of the client into
@@ -80,11 +75,7 @@ zserv_flush_data(struct thread *thread)
   struct zserv *client = THREAD_ARG(thread);
 
   client->t_write = NULL;
-  if (client->t_suicide)
-    {
-      zebra_client_close(client);
-      return -1;
-    }
+  client->write_calls++;
   switch (buffer_flush_available(client->wb, client->sock))
     {
     case BUFFER_ERROR:
@@ -102,32 +93,19 @@ zserv_flush_data(struct thread *thread)
   return 0;
 }
 
+/* Queue the message in obuf.  Messages are written together, once the
+   current event is done, so that a run of them (from redistribution of
+   many routes, say) takes few writev() calls. */
 int
 zebra_server_send_message(struct zserv *client)
 {
-  if (client->t_suicide)
-    return -1;
-  switch (buffer_write(client->wb, client->sock, STREAM_DATA(client->obuf),
-		       stream_get_endp(client->obuf)))
-    {
-    case BUFFER_ERROR:
-      zlog_warn("%s: buffer_write failed to zserv client fd %d, closing",
-      		 __func__, client->sock);
-      /* Schedule a delayed close since many of the functions that call this
-         one do not check the return code.  They do not allow for the
-	 possibility that an I/O error may have caused the client to be
-	 deleted. */
-      client->t_suicide = thread_add_event(zebrad.master, zserv_delayed_close,
-					   client, 0);
-      return -1;
-    case BUFFER_EMPTY:
-      THREAD_OFF(client->t_write);
-      break;
-    case BUFFER_PENDING:
-      THREAD_WRITE_ON(zebrad.master, client->t_write,
-		      zserv_flush_data, client, client->sock);
-      break;
-    }
+  buffer_put(client->wb, STREAM_DATA(client->obuf),
+	     stream_get_endp(client->obuf));
+  client->msgs_written++;
+
+  if (client->t_write == NULL)
+    client->t_write = thread_add_event(zebrad.master, zserv_flush_data,
+				       client, 0);
   return 0;
 }
 
@@ -671,6 +649,51 @@ zsend_router_id_update (struct zserv *client, struct prefix *p)
 
   return zebra_server_send_message(client);
 }
+
+/* Tell a client where the shared-memory RIB is and which version it
+   is at, an empty path when it isn't exported. */
+int
+zsend_rib_shm_update (struct zserv *client, u_int32_t generation,
+                      u_int32_t version, const char *path)
+{
+  struct stream *s;
+  size_t len = path ? strlen (path) : 0;
+
+  s = client->obuf;
+  stream_reset (s);
+
+  zserv_create_header (s, ZEBRA_RIB_SHM_UPDATE);
+  stream_putl (s, generation);
+  stream_putl (s, version);
+  stream_putw (s, len);
+  if (len)
+    stream_put (s, path, len);
+
+  stream_putw_at (s, 0, stream_get_endp (s));
+
+  return zebra_server_send_message (client);
+}
+
+/* The resolution of a tracked nexthop address: the metric and the
+   nexthops of the longest match, encoded by zebra_rnh.c */
+int
+zsend_nexthop_update (struct zserv *client, struct prefix *p,
+                      u_char *state, u_int16_t len)
+{
+  struct stream *s;
+
+  s = client->obuf;
+  stream_reset (s);
+
+  zserv_create_header (s, ZEBRA_NEXTHOP_UPDATE);
+  stream_putc (s, p->family);
+  stream_put (s, &p->u.prefix, PSIZE (p->prefixlen));
+  stream_put (s, state, len);
+
+  stream_putw_at (s, 0, stream_get_endp (s));
+
+  return zebra_server_send_message (client);
+}
 
 /* Register zebra server interface information.  Send current all
    interface and address information. */
@@ -1162,11 +1185,17 @@ zebra_client_close (struct zserv *client)
       client->sock = -1;
     }
 
+  /* Stop tracking its nexthops. */
+  zebra_rnh_client_close (client);
+  zserv_linkmetrics_client_close (client);
+
   /* Free stream buffers. */
   if (client->ibuf)
     stream_free (client->ibuf);
   if (client->obuf)
     stream_free (client->obuf);
+  if (client->rb)
+    stream_free (client->rb);
   if (client->wb)
     buffer_free(client->wb);
 
@@ -1175,8 +1204,6 @@ zebra_client_close (struct zserv *client)
     thread_cancel (client->t_read);
   if (client->t_write)
     thread_cancel (client->t_write);
-  if (client->t_suicide)
-    thread_cancel (client->t_suicide);
 
   /* Free client structure. */
   listnode_delete (zebrad.client_list, client);
@@ -1195,6 +1222,7 @@ zebra_client_create (int sock)
   client->sock = sock;
   client->ibuf = stream_new (ZEBRA_MAX_PACKET_SIZ);
   client->obuf = stream_new (ZEBRA_MAX_PACKET_SIZ);
+  client->rb = stream_new (ZSERV_RBUF_SIZE);
   client->wb = buffer_new(0);
 
   /* Set table number. */
@@ -1207,106 +1235,22 @@ zebra_client_create (int sock)
   zebra_event (ZEBRA_READ, sock, client);
 }
 
-/* Handler of zebra service request. */
-static int
-zebra_client_read (struct thread *thread)
+/* Process the message in ibuf. */
+static void
+zebra_client_dispatch (struct zserv *client)
 {
-  int sock;
-  struct zserv *client;
-  size_t already;
   uint16_t length, command;
-  uint8_t marker, version;
-
-  /* Get thread data.  Reset reading thread because I'm running. */
-  sock = THREAD_FD (thread);
-  client = THREAD_ARG (thread);
-  client->t_read = NULL;
-
-  if (client->t_suicide)
-    {
-      zebra_client_close(client);
-      return -1;
-    }
-
-  /* Read length and command (if we don't have it already). */
-  if ((already = stream_get_endp(client->ibuf)) < ZEBRA_HEADER_SIZE)
-    {
-      ssize_t nbyte;
-      if (((nbyte = stream_read_try (client->ibuf, sock,
-				     ZEBRA_HEADER_SIZE-already)) == 0) ||
-	  (nbyte == -1))
-	{
-	  if (IS_ZEBRA_DEBUG_EVENT)
-	    zlog_debug ("connection closed socket [%d]", sock);
-	  zebra_client_close (client);
-	  return -1;
-	}
-      if (nbyte != (ssize_t)(ZEBRA_HEADER_SIZE-already))
-	{
-	  /* Try again later. */
-	  zebra_event (ZEBRA_READ, sock, client);
-	  return 0;
-	}
-      already = ZEBRA_HEADER_SIZE;
-    }
-
-  /* Reset to read from the beginning of the incoming packet. */
-  stream_set_getp(client->ibuf, 0);
 
-  /* Fetch header values */
+  stream_set_getp (client->ibuf, 0);
   length = stream_getw (client->ibuf);
-  marker = stream_getc (client->ibuf);
-  version = stream_getc (client->ibuf);
+  stream_forward_getp (client->ibuf, 2);	/* marker and version */
   command = stream_getw (client->ibuf);
 
-  if (marker != ZEBRA_HEADER_MARKER || version != ZSERV_VERSION)
-    {
-      zlog_err("%s: socket %d version mismatch, marker %d, version %d",
-               __func__, sock, marker, version);
-      zebra_client_close (client);
-      return -1;
-    }
-  if (length < ZEBRA_HEADER_SIZE) 
-    {
-      zlog_warn("%s: socket %d message length %u is less than header size %d",
-	        __func__, sock, length, ZEBRA_HEADER_SIZE);
-      zebra_client_close (client);
-      return -1;
-    }
-  if (length > STREAM_SIZE(client->ibuf))
-    {
-      zlog_warn("%s: socket %d message length %u exceeds buffer size %lu",
-	        __func__, sock, length, (u_long)STREAM_SIZE(client->ibuf));
-      zebra_client_close (client);
-      return -1;
-    }
-
-  /* Read rest of data. */
-  if (already < length)
-    {
-      ssize_t nbyte;
-      if (((nbyte = stream_read_try (client->ibuf, sock,
-				     length-already)) == 0) ||
-	  (nbyte == -1))
-	{
-	  if (IS_ZEBRA_DEBUG_EVENT)
-	    zlog_debug ("connection closed [%d] when reading zebra data", sock);
-	  zebra_client_close (client);
-	  return -1;
-	}
-      if (nbyte != (ssize_t)(length-already))
-        {
-	  /* Try again later. */
-	  zebra_event (ZEBRA_READ, sock, client);
-	  return 0;
-	}
-    }
-
   length -= ZEBRA_HEADER_SIZE;
 
   /* Debug packet information. */
   if (IS_ZEBRA_DEBUG_EVENT)
-    zlog_debug ("zebra message comes from socket [%d]", sock);
+    zlog_debug ("zebra message comes from socket [%d]", client->sock);
 
   if (IS_ZEBRA_DEBUG_PACKET && IS_ZEBRA_DEBUG_RECV)
     zlog_debug ("zebra message received [%s] %d", 
@@ -1376,6 +1320,14 @@ zebra_client_read (struct thread *thread)
     case ZEBRA_LINKMETRICS_METRICS_REQUEST:
       zserv_recv_linkmetrics_request (client, length);
       break;
+    case ZEBRA_RIB_SHM_SUBSCRIBE:
+    case ZEBRA_RIB_SHM_UNSUBSCRIBE:
+      zserv_recv_rib_shm_subscribe (command, client, length);
+      break;
+    case ZEBRA_NEXTHOP_REGISTER:
+    case ZEBRA_NEXTHOP_UNREGISTER:
+      zebra_rnh_register (command, client, length);
+      break;
     case ZEBRA_HELLO:
       zread_hello (client);
       break;
@@ -1383,15 +1335,91 @@ zebra_client_read (struct thread *thread)
       zlog_info ("Zebra received unknown command %d", command);
       break;
     }
+}
+
+/* Handler of zebra service request: read what the client has sent and
+   process each complete message. */
+static int
+zebra_client_read (struct thread *thread)
+{
+  int sock;
+  struct zserv *client;
+  struct stream *rb;
+  ssize_t nbyte;
+  size_t getp, remain;
+  uint16_t length;
+  uint8_t marker, version;
 
-  if (client->t_suicide)
+  /* Get thread data.  Reset reading thread because I'm running. */
+  sock = THREAD_FD (thread);
+  client = THREAD_ARG (thread);
+  client->t_read = NULL;
+  rb = client->rb;
+
+  nbyte = stream_read_try (rb, sock, STREAM_WRITEABLE (rb));
+  if (nbyte == 0 || nbyte == -1)
     {
-      /* No need to wait for thread callback, just kill immediately. */
-      zebra_client_close(client);
+      if (IS_ZEBRA_DEBUG_EVENT)
+	zlog_debug ("connection closed socket [%d]", sock);
+      zebra_client_close (client);
       return -1;
     }
+  if (nbyte < 0)
+    {
+      /* Try again later. */
+      zebra_event (ZEBRA_READ, sock, client);
+      return 0;
+    }
+  client->read_calls++;
+
+  while (STREAM_READABLE (rb) >= ZEBRA_HEADER_SIZE)
+    {
+      /* Fetch header values */
+      getp = stream_get_getp (rb);
+      length = stream_getw_from (rb, getp);
+      marker = stream_getc_from (rb, getp + 2);
+      version = stream_getc_from (rb, getp + 3);
+
+      if (marker != ZEBRA_HEADER_MARKER || version != ZSERV_VERSION)
+	{
+	  zlog_err("%s: socket %d version mismatch, marker %d, version %d",
+		   __func__, sock, marker, version);
+	  zebra_client_close (client);
+	  return -1;
+	}
+      if (length < ZEBRA_HEADER_SIZE) 
+	{
+	  zlog_warn("%s: socket %d message length %u is less than header "
+		    "size %d", __func__, sock, length, ZEBRA_HEADER_SIZE);
+	  zebra_client_close (client);
+	  return -1;
+	}
+      if (length > STREAM_SIZE(client->ibuf))
+	{
+	  zlog_warn("%s: socket %d message length %u exceeds buffer size %lu",
+		    __func__, sock, length, (u_long)STREAM_SIZE(client->ibuf));
+	  zebra_client_close (client);
+	  return -1;
+	}
+
+      if (STREAM_READABLE (rb) < length)
+	break;
+
+      stream_reset (client->ibuf);
+      stream_put (client->ibuf, stream_pnt (rb), length);
+      stream_forward_getp (rb, length);
+      client->msgs_read++;
+
+      zebra_client_dispatch (client);
+    }
+
+  /* Move any partial message to the start of the buffer. */
+  remain = STREAM_READABLE (rb);
+  if (remain)
+    memmove (STREAM_DATA (rb), stream_pnt (rb), remain);
+  stream_set_getp (rb, 0);
+  stream_set_endp (rb, remain);
 
-  stream_reset (client->ibuf);
   zebra_event (ZEBRA_READ, sock, client);
   return 0;
 }
@@ -1652,7 +1680,22 @@ DEFUN (show_zebra_client,
   struct zserv *client;
 
   for (ALL_LIST_ELEMENTS_RO (zebrad.client_list, node, client))
-    vty_out (vty, "Client fd %d%s", client->sock, VTY_NEWLINE);
+    {
+      vty_out (vty, "Client fd %d%s", client->sock, VTY_NEWLINE);
+      vty_out (vty, "  Read %u messages in %u calls (%.1f per call)%s",
+	       client->msgs_read, client->read_calls,
+	       client->read_calls ?
+	       (double) client->msgs_read / client->read_calls : 0.0,
+	       VTY_NEWLINE);
+      vty_out (vty, "  Wrote %u messages in %u calls (%.1f per call)%s",
+	       client->msgs_written, client->write_calls,
+	       client->write_calls ?
+	       (double) client->msgs_written / client->write_calls : 0.0,
+	       VTY_NEWLINE);
+      if (client->rib_shm_subscribed)
+	vty_out (vty, "  Notified of shared-memory RIB changes%s",
+		 VTY_NEWLINE);
+    }
   
   return CMD_SUCCESS;
 }
@@ -1777,6 +1820,7 @@ config_write_forwarding (struct vty *vty)
   /* FIXME: Find better place for that. */
   router_id_write (vty);
   zserv_linkmetrics_config_write (vty);
+  zserv_rib_shm_config_write (vty);
 
   if (ipforward ())
     vty_out (vty, "ip forwarding%s", VTY_NEWLINE);
@@ -1832,6 +1876,12 @@ zebra_init (void)
 
   /* zebra link metrics initialization */
   zserv_linkmetrics_init ();
+
+  /* shared-memory RIB export */
+  zserv_rib_shm_init ();
+
+  /* nexthop tracking */
+  zebra_rnh_init ();
 }
 
 /* Make zebra server socket, wiping any existing one (see bug #403). */
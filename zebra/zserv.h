@@ -42,6 +42,10 @@ struct zserv
   struct stream *ibuf;
   struct stream *obuf;
 
+  /* Data read from the client: each complete message is copied to
+     ibuf in turn to be processed. */
+  struct stream *rb;
+
   /* Buffer of data waiting to be written to client. */
   struct buffer *wb;
 
@@ -49,9 +53,6 @@ struct zserv
   struct thread *t_read;
   struct thread *t_write;
 
-  /* Thread for delayed close. */
-  struct thread *t_suicide;
-
   /* default routing table this client munges */
   int rtm_table;
 
@@ -69,6 +70,17 @@ struct zserv
 
   /* nonzero if subscribed to linkmetrics updates */
   u_char linkmetrics_subscribed;
+  /* nonzero if it accepts ZEBRA_LINKMETRICS_BATCH messages */
+  u_char linkmetrics_batch;
+
+  /* nonzero if notified of shared-memory RIB changes */
+  u_char rib_shm_subscribed;
+
+  /* Statistics. */
+  u_int32_t msgs_read;
+  u_int32_t read_calls;
+  u_int32_t msgs_written;
+  u_int32_t write_calls;
 };
 
 /* Zebra instance */
@@ -111,6 +123,10 @@ extern int zsend_interface_update (int, struct zserv *, struct interface *);
 extern int zsend_route_multipath (int, struct zserv *, struct prefix *, 
                                   struct rib *);
 extern int zsend_router_id_update(struct zserv *, struct prefix *);
+extern int zsend_rib_shm_update (struct zserv *, u_int32_t, u_int32_t,
+                                 const char *);
+extern int zsend_nexthop_update (struct zserv *, struct prefix *,
+                                 u_char *, u_int16_t);
 
 extern pid_t pid;
 
@@ -26,6 +26,8 @@
 #include "stream.h"
 #include "command.h"
 #include "memory.h"
+#include "thread.h"
+#include "linklist.h"
 #include "zebra_linkmetrics.h"
 #include "linkmetrics_netlink.h"
 
@@ -130,8 +132,8 @@ DEFUN (no_linkmetrics_netlink_group,
   return zserv_set_linkmetrics_netlink (vty, lmgenl_family, lmgenl_group);
 }
 
-void
-zserv_linkmetrics_init (void)
+static void
+zserv_linkmetrics_netlink_init (void)
 {
   install_element (CONFIG_NODE, &linkmetrics_netlink_family_cmd);
   install_element (CONFIG_NODE, &no_linkmetrics_netlink_family_cmd);
@@ -140,8 +142,8 @@ zserv_linkmetrics_init (void)
   install_element (CONFIG_NODE, &no_linkmetrics_netlink_group_cmd);
 }
 
-int
-zserv_linkmetrics_config_write (struct vty *vty)
+static void
+zserv_linkmetrics_netlink_config_write (struct vty *vty)
 {
   if (lmgenl_family && strcmp (lmgenl_family, LMGENL_FAMILY_NAME) != 0)
     {
@@ -154,25 +156,368 @@ zserv_linkmetrics_config_write (struct vty *vty)
       vty_out (vty, "netlink linkmetrics-group %s%s",
                lmgenl_group, VTY_NEWLINE);
     }
+}
+
+#endif	/* HAVE_LIBNLGENL */
+
+/* Link metrics and link status updates are not sent to clients as
+ * they arrive.  They are collected per interface, a later update of
+ * the same kind about the same neighbor replacing an earlier one, and
+ * sent together when the flush interval expires, as one
+ * ZEBRA_LINKMETRICS_BATCH message to clients that accept those.  Link
+ * status updates cut the interval short. */
+#define ZSERV_LINKMETRICS_FLUSH_INTERVAL 100 /* msec */
+
+struct zserv_linkmetrics_update
+{
+  u_char type;			/* ZEBRA_LINKMETRICS_{METRICS,STATUS} */
+  struct zserv *exclude;	/* client it came from, if any */
+  union
+  {
+    struct zebra_linkmetrics metrics;
+    struct zebra_linkstatus status;
+  } u;
+};
+
+struct zserv_linkmetrics_if
+{
+  u_int32_t ifindex;
+  unsigned int count;
+  unsigned int size;
+  struct zserv_linkmetrics_update *updates;
+};
+
+static struct list *zserv_linkmetrics_ifs;
+static struct thread *zserv_linkmetrics_t_flush;
+static int zserv_linkmetrics_flush_now;
+static u_int32_t zserv_linkmetrics_flush_interval =
+  ZSERV_LINKMETRICS_FLUSH_INTERVAL;
+
+static struct
+{
+  u_int32_t metrics;
+  u_int32_t status;
+  u_int32_t superseded;
+  u_int32_t flushes;
+  u_int32_t batches;
+  u_int32_t sent;
+} zserv_linkmetrics_stats;
+
+static void
+zserv_linkmetrics_if_free (void *data)
+{
+  struct zserv_linkmetrics_if *lmif = data;
+
+  if (lmif->updates)
+    XFREE (MTYPE_LINKMETRICS_UPDATE, lmif->updates);
+  XFREE (MTYPE_LINKMETRICS_UPDATE, lmif);
+}
+
+static struct zserv_linkmetrics_if *
+zserv_linkmetrics_if_get (u_int32_t ifindex)
+{
+  struct zserv_linkmetrics_if *lmif;
+  struct listnode *node;
+
+  for (ALL_LIST_ELEMENTS_RO (zserv_linkmetrics_ifs, node, lmif))
+    if (lmif->ifindex == ifindex)
+      return lmif;
+
+  lmif = XCALLOC (MTYPE_LINKMETRICS_UPDATE, sizeof (*lmif));
+  lmif->ifindex = ifindex;
+  listnode_add (zserv_linkmetrics_ifs, lmif);
+
+  return lmif;
+}
+
+/* nonzero if two updates are of the same kind about the same neighbor */
+static int
+zserv_linkmetrics_update_same (const struct zserv_linkmetrics_update *a,
+                               const struct zserv_linkmetrics_update *b)
+{
+  if (a->type != b->type || a->exclude != b->exclude)
+    return 0;
+
+  if (a->type == ZEBRA_LINKMETRICS_METRICS)
+    return (a->u.metrics.nbr_addr4.s_addr == b->u.metrics.nbr_addr4.s_addr &&
+            IN6_ARE_ADDR_EQUAL (&a->u.metrics.nbr_addr6,
+                                &b->u.metrics.nbr_addr6));
+  else
+    return (a->u.status.nbr_addr4.s_addr == b->u.status.nbr_addr4.s_addr &&
+            IN6_ARE_ADDR_EQUAL (&a->u.status.nbr_addr6,
+                                &b->u.status.nbr_addr6));
+}
+
+static int zserv_linkmetrics_flush (struct thread *thread);
+
+static void
+zserv_linkmetrics_schedule (int now)
+{
+  if (now && !zserv_linkmetrics_flush_now)
+    THREAD_OFF (zserv_linkmetrics_t_flush);
+
+  if (zserv_linkmetrics_t_flush)
+    return;
+
+  if (now || zserv_linkmetrics_flush_interval == 0)
+    {
+      zserv_linkmetrics_flush_now = 1;
+      zserv_linkmetrics_t_flush =
+        thread_add_event (zebrad.master, zserv_linkmetrics_flush, NULL, 0);
+    }
+  else
+    zserv_linkmetrics_t_flush =
+      thread_add_timer_msec (zebrad.master, zserv_linkmetrics_flush, NULL,
+                             zserv_linkmetrics_flush_interval);
+}
+
+/* queue an update, dropping any it supersedes */
+static void
+zserv_linkmetrics_queue (struct zserv_linkmetrics_update *update,
+                         u_int32_t ifindex)
+{
+  struct zserv_linkmetrics_if *lmif;
+  unsigned int i;
+
+  lmif = zserv_linkmetrics_if_get (ifindex);
+
+  for (i = 0; i < lmif->count; i++)
+    if (zserv_linkmetrics_update_same (&lmif->updates[i], update))
+      {
+        /* keep updates in the order they are to be applied */
+        memmove (&lmif->updates[i], &lmif->updates[i + 1],
+                 (lmif->count - i - 1) * sizeof (*lmif->updates));
+        lmif->count--;
+        zserv_linkmetrics_stats.superseded++;
+        break;
+      }
+
+  if (lmif->count == lmif->size)
+    {
+      lmif->size = lmif->size ? lmif->size * 2 : 16;
+      lmif->updates = XREALLOC (MTYPE_LINKMETRICS_UPDATE, lmif->updates,
+                                lmif->size * sizeof (*lmif->updates));
+    }
+  lmif->updates[lmif->count++] = *update;
+
+  zserv_linkmetrics_schedule (update->type == ZEBRA_LINKMETRICS_STATUS);
+}
+
+/* forget a closing client */
+void
+zserv_linkmetrics_client_close (struct zserv *client)
+{
+  struct zserv_linkmetrics_if *lmif;
+  struct listnode *node;
+  unsigned int i;
+
+  for (ALL_LIST_ELEMENTS_RO (zserv_linkmetrics_ifs, node, lmif))
+    for (i = 0; i < lmif->count; i++)
+      if (lmif->updates[i].exclude == client)
+        lmif->updates[i].exclude = NULL;
+}
+
+static void
+zserv_linkmetrics_batch_send (struct zserv *client)
+{
+  int n;
+
+  n = zapi_linkmetrics_batch_finish (client->obuf);
+  if (n <= 0)
+    return;
+
+  if (zebra_server_send_message (client))
+    zlog_warn ("%s: zebra_server_send_message() failed for "
+               "client on fd %d", __func__, client->sock);
+
+  zserv_linkmetrics_stats.batches++;
+  zserv_linkmetrics_stats.sent += n;
+}
+
+static int
+zserv_linkmetrics_batch_add (struct stream *s,
+                             const struct zserv_linkmetrics_update *update)
+{
+  if (update->type == ZEBRA_LINKMETRICS_METRICS)
+    return zapi_linkmetrics_batch_add_metrics (s, &update->u.metrics);
+  else
+    return zapi_linkmetrics_batch_add_status (s, &update->u.status);
+}
+
+/* send all queued updates to a client in as few messages as fit */
+static void
+zserv_linkmetrics_flush_batch (struct zserv *client)
+{
+  struct zserv_linkmetrics_if *lmif;
+  struct zserv_linkmetrics_update *update;
+  struct listnode *node;
+  unsigned int i;
+
+  zapi_linkmetrics_batch_start (client->obuf);
+
+  for (ALL_LIST_ELEMENTS_RO (zserv_linkmetrics_ifs, node, lmif))
+    for (i = 0; i < lmif->count; i++)
+      {
+        update = &lmif->updates[i];
+        if (update->exclude == client)
+          continue;
+
+        if (zserv_linkmetrics_batch_add (client->obuf, update) == 0)
+          continue;
+
+        /* the message is full */
+        zserv_linkmetrics_batch_send (client);
+        zapi_linkmetrics_batch_start (client->obuf);
+        zserv_linkmetrics_batch_add (client->obuf, update);
+      }
+
+  zserv_linkmetrics_batch_send (client);
+}
+
+/* send all queued updates to a client one message each */
+static void
+zserv_linkmetrics_flush_single (struct zserv *client)
+{
+  struct zserv_linkmetrics_if *lmif;
+  struct zserv_linkmetrics_update *update;
+  struct listnode *node;
+  unsigned int i;
+  int r;
+
+  for (ALL_LIST_ELEMENTS_RO (zserv_linkmetrics_ifs, node, lmif))
+    for (i = 0; i < lmif->count; i++)
+      {
+        update = &lmif->updates[i];
+        if (update->exclude == client)
+          continue;
+
+        if (update->type == ZEBRA_LINKMETRICS_METRICS)
+          r = zapi_write_linkmetrics (client->obuf, &update->u.metrics);
+        else
+          r = zapi_write_linkstatus (client->obuf, &update->u.status);
+        if (r)
+          {
+            zlog_warn ("%s: writing link update failed for "
+                       "client on fd %d", __func__, client->sock);
+            continue;
+          }
+
+        if (zebra_server_send_message (client))
+          zlog_warn ("%s: zebra_server_send_message() failed for "
+                     "client on fd %d", __func__, client->sock);
+
+        zserv_linkmetrics_stats.sent++;
+      }
+}
+
+static int
+zserv_linkmetrics_flush (struct thread *thread)
+{
+  struct listnode *node;
+  struct zserv *client;
+
+  zserv_linkmetrics_t_flush = NULL;
+  zserv_linkmetrics_flush_now = 0;
+  zserv_linkmetrics_stats.flushes++;
+
+  for (ALL_LIST_ELEMENTS_RO (zebrad.client_list, node, client))
+    {
+      if (!client->linkmetrics_subscribed)
+        continue;
+
+      if (client->linkmetrics_batch)
+        zserv_linkmetrics_flush_batch (client);
+      else
+        zserv_linkmetrics_flush_single (client);
+    }
+
+  list_delete_all_node (zserv_linkmetrics_ifs);
 
   return 0;
 }
 
-#else  /* HAVE_LIBNLGENL */
+DEFUN (linkmetrics_flush_interval,
+       linkmetrics_flush_interval_cmd,
+       "linkmetrics flush-interval <0-10000>",
+       "Link metrics configuration\n"
+       "Time to collect link metrics updates before sending them to clients\n"
+       "Milliseconds\n")
+{
+  VTY_GET_INTEGER_RANGE ("flush interval", zserv_linkmetrics_flush_interval,
+                         argv[0], 0, 10000);
+  return CMD_SUCCESS;
+}
+
+DEFUN (no_linkmetrics_flush_interval,
+       no_linkmetrics_flush_interval_cmd,
+       "no linkmetrics flush-interval",
+       NO_STR
+       "Link metrics configuration\n"
+       "Time to collect link metrics updates before sending them to clients\n")
+{
+  zserv_linkmetrics_flush_interval = ZSERV_LINKMETRICS_FLUSH_INTERVAL;
+  return CMD_SUCCESS;
+}
+
+ALIAS (no_linkmetrics_flush_interval,
+       no_linkmetrics_flush_interval_val_cmd,
+       "no linkmetrics flush-interval <0-10000>",
+       NO_STR
+       "Link metrics configuration\n"
+       "Time to collect link metrics updates before sending them to clients\n"
+       "Milliseconds\n")
+
+DEFUN (show_zebra_linkmetrics,
+       show_zebra_linkmetrics_cmd,
+       "show zebra linkmetrics",
+       SHOW_STR
+       "Zebra information\n"
+       "Link metrics updates\n")
+{
+  vty_out (vty, "Flush interval %u msec%s",
+           zserv_linkmetrics_flush_interval, VTY_NEWLINE);
+  vty_out (vty, "Received %u metrics and %u status updates, "
+           "%u superseded%s", zserv_linkmetrics_stats.metrics,
+           zserv_linkmetrics_stats.status,
+           zserv_linkmetrics_stats.superseded, VTY_NEWLINE);
+  vty_out (vty, "Sent %u updates in %u flushes, %u batch messages%s",
+           zserv_linkmetrics_stats.sent, zserv_linkmetrics_stats.flushes,
+           zserv_linkmetrics_stats.batches, VTY_NEWLINE);
+
+  return CMD_SUCCESS;
+}
 
 void
 zserv_linkmetrics_init (void)
 {
+  zserv_linkmetrics_ifs = list_new ();
+  zserv_linkmetrics_ifs->del = zserv_linkmetrics_if_free;
+
+  install_element (CONFIG_NODE, &linkmetrics_flush_interval_cmd);
+  install_element (CONFIG_NODE, &no_linkmetrics_flush_interval_cmd);
+  install_element (CONFIG_NODE, &no_linkmetrics_flush_interval_val_cmd);
+  install_element (VIEW_NODE, &show_zebra_linkmetrics_cmd);
+  install_element (ENABLE_NODE, &show_zebra_linkmetrics_cmd);
+
+#ifdef HAVE_LIBNLGENL
+  zserv_linkmetrics_netlink_init ();
+#endif	/* HAVE_LIBNLGENL */
 }
 
 int
 zserv_linkmetrics_config_write (struct vty *vty)
 {
-  return 0;
-}
+  if (zserv_linkmetrics_flush_interval != ZSERV_LINKMETRICS_FLUSH_INTERVAL)
+    vty_out (vty, "linkmetrics flush-interval %u%s",
+             zserv_linkmetrics_flush_interval, VTY_NEWLINE);
 
+#ifdef HAVE_LIBNLGENL
+  zserv_linkmetrics_netlink_config_write (vty);
 #endif	/* HAVE_LIBNLGENL */
 
+  return 0;
+}
+
 /* Send a link metrics update to subscribed zclients
  *
  * If provided, skip the excluded client
@@ -181,36 +526,20 @@ int
 zserv_send_linkmetrics (struct zebra_linkmetrics *metrics,
                         struct zserv *exclude_client)
 {
-  struct listnode *node;
-  struct zserv *client;
+  struct zserv_linkmetrics_update update;
 
   if (IS_ZEBRA_DEBUG_EVENT)
     {
-      zlog_debug ("%s: sending link metrics update", __func__);
+      zlog_debug ("%s: queueing link metrics update", __func__);
       zebra_linkmetrics_logdebug (metrics);
     }
 
-  /* send to all subscribed clients */
-  for (ALL_LIST_ELEMENTS_RO (zebrad.client_list, node, client))
-    {
-      /* skip an excluded client */
-      if (client == exclude_client)
-        continue;
-
-      if (client->linkmetrics_subscribed)
-        {
-          if (zapi_write_linkmetrics (client->obuf, metrics))
-            {
-              zlog_warn ("%s: zapi_write_linkmetrics() failed for "
-                         "client on fd %d", __func__, client->sock);
-              continue;
-            }
+  zserv_linkmetrics_stats.metrics++;
 
-          if (zebra_server_send_message (client))
-            zlog_warn ("%s: zebra_server_send_message() failed for "
-                       "client on fd %d", __func__, client->sock);
-        }
-    }
+  update.type = ZEBRA_LINKMETRICS_METRICS;
+  update.exclude = exclude_client;
+  update.u.metrics = *metrics;
+  zserv_linkmetrics_queue (&update, metrics->ifindex);
 
   return 0;
 }
@@ -266,36 +595,20 @@ int
 zserv_send_linkstatus (struct zebra_linkstatus *status,
                        struct zserv *exclude_client)
 {
-  struct listnode *node;
-  struct zserv *client;
+  struct zserv_linkmetrics_update update;
 
   if (IS_ZEBRA_DEBUG_EVENT)
     {
-      zlog_debug ("%s: sending link status update", __func__);
+      zlog_debug ("%s: queueing link status update", __func__);
       zebra_linkstatus_logdebug (status);
     }
 
-  /* send to all subscribed clients */
-  for (ALL_LIST_ELEMENTS_RO (zebrad.client_list, node, client))
-    {
-      /* skip an excluded client */
-      if (client == exclude_client)
-        continue;
-
-      if (client->linkmetrics_subscribed)
-        {
-          if (zapi_write_linkstatus (client->obuf, status))
-            {
-              zlog_warn ("%s: zapi_write_linkstatus() failed for "
-                         "client on fd %d", __func__, client->sock);
-              continue;
-            }
+  zserv_linkmetrics_stats.status++;
 
-          if (zebra_server_send_message (client))
-            zlog_warn ("%s: zebra_server_send_message() failed for "
-                       "client on fd %d", __func__, client->sock);
-        }
-    }
+  update.type = ZEBRA_LINKMETRICS_STATUS;
+  update.exclude = exclude_client;
+  update.u.status = *status;
+  zserv_linkmetrics_queue (&update, status->ifindex);
 
   return 0;
 }
@@ -306,17 +619,23 @@ zserv_recv_linkmetrics_subscribe (uint16_t cmd, struct zserv *client,
 			     uint16_t length)
 {
   int r = 0;
+  u_char flags = 0;
 
-  if (length)
+  /* a subscription may carry a byte of options */
+  if (length > (cmd == ZEBRA_LINKMETRICS_SUBSCRIBE ? 1 : 0))
     {
       zlog_err ("%s: invalid length: %u", __func__, length);
       return -1;
     }
+  if (length)
+    flags = stream_getc (client->ibuf);
 
   switch (cmd)
     {
     case ZEBRA_LINKMETRICS_SUBSCRIBE:
       client->linkmetrics_subscribed = 1;
+      client->linkmetrics_batch =
+        CHECK_FLAG (flags, ZEBRA_LINKMETRICS_SUBSCRIBE_BATCH) ? 1 : 0;
       break;
 
     case ZEBRA_LINKMETRICS_UNSUBSCRIBE:
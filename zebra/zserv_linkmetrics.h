@@ -29,6 +29,7 @@ struct vty;
 
 void zserv_linkmetrics_init (void);
 int zserv_linkmetrics_config_write (struct vty *vty);
+void zserv_linkmetrics_client_close (struct zserv *client);
 
 int zserv_send_linkmetrics (struct zebra_linkmetrics *metrics,
                             struct zserv *exclude_client);
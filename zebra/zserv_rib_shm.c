@@ -0,0 +1,339 @@
+/* Zebra shared-memory RIB export
+ *
+ * This file is part of GNU Zebra.
+ *
+ * GNU Zebra is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * GNU Zebra is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Zebra; see the file COPYING.  If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <zebra.h>
+
+#include "prefix.h"
+#include "table.h"
+#include "thread.h"
+#include "command.h"
+#include "linklist.h"
+#include "log.h"
+#include "rib_shm.h"
+
+#include "zebra/rib.h"
+#include "zebra/zserv.h"
+#include "zebra/debug.h"
+#include "zebra/redistribute.h"
+#include "zebra/zserv_rib_shm.h"
+
+extern struct zebra_t zebrad;
+
+/* The selected route of every IPv4 and IPv6 unicast prefix, as
+   redistributed, is also written to rib_shm.  Subscribed clients map
+   the file themselves; zserv sends them no routes, only one
+   ZEBRA_RIB_SHM_UPDATE per burst of changes. */
+static struct rib_shm *rib_shm;
+static struct thread *t_rib_shm_notify;
+
+static void
+zserv_rib_shm_route (struct rib *rib, struct rib_shm_route *route)
+{
+  struct nexthop *nexthop;
+
+  memset (route, 0, sizeof (struct rib_shm_route));
+  route->type = rib->type;
+  route->flags = rib->flags;
+  route->distance = rib->distance;
+  route->metric = rib->metric;
+
+  /* the nexthop zsend_route_multipath() would send */
+  for (nexthop = rib->nexthop; nexthop; nexthop = nexthop->next)
+    if (CHECK_FLAG (nexthop->flags, NEXTHOP_FLAG_FIB))
+      {
+        switch (nexthop->type)
+          {
+          case NEXTHOP_TYPE_IPV4:
+          case NEXTHOP_TYPE_IPV4_IFINDEX:
+            memcpy (route->gate, &nexthop->gate.ipv4, IPV4_MAX_BYTELEN);
+            break;
+#ifdef HAVE_IPV6
+          case NEXTHOP_TYPE_IPV6:
+          case NEXTHOP_TYPE_IPV6_IFINDEX:
+          case NEXTHOP_TYPE_IPV6_IFNAME:
+            memcpy (route->gate, &nexthop->gate.ipv6, IPV6_MAX_BYTELEN);
+            break;
+#endif /* HAVE_IPV6 */
+          default:
+            break;
+          }
+        route->ifindex = nexthop->ifindex;
+        break;
+      }
+}
+
+static int
+zserv_rib_shm_notify (struct thread *thread)
+{
+  struct listnode *node;
+  struct zserv *client;
+  u_int32_t generation = 0, version = 0;
+  const char *path = NULL;
+
+  t_rib_shm_notify = NULL;
+
+  if (rib_shm)
+    {
+      generation = rib_shm->header->generation;
+      version = rib_shm->header->version;
+      path = rib_shm->path;
+    }
+
+  for (ALL_LIST_ELEMENTS_RO (zebrad.client_list, node, client))
+    if (client->rib_shm_subscribed)
+      zsend_rib_shm_update (client, generation, version, path);
+
+  return 0;
+}
+
+/* Whether the client reads the routes it redistributes from the file,
+   rather than from zserv. */
+int
+zserv_rib_shm_serves (struct zserv *client)
+{
+  return rib_shm != NULL && client->rib_shm_subscribed;
+}
+
+static void
+zserv_rib_shm_changed (void)
+{
+  if (t_rib_shm_notify == NULL)
+    t_rib_shm_notify = thread_add_event (zebrad.master, zserv_rib_shm_notify,
+                                         NULL, 0);
+}
+
+void
+zserv_rib_shm_add (struct prefix *p, struct rib *rib)
+{
+  struct rib_shm_route route;
+  char buf[INET6_ADDRSTRLEN];
+
+  if (rib_shm == NULL || (p->family != AF_INET && p->family != AF_INET6))
+    return;
+
+  zserv_rib_shm_route (rib, &route);
+  if (rib_shm_set (rib_shm, p, &route))
+    {
+      zlog_warn ("%s: can't export %s/%d", __func__,
+                 inet_ntop (p->family, &p->u.prefix, buf, sizeof (buf)),
+                 p->prefixlen);
+      return;
+    }
+  zserv_rib_shm_changed ();
+}
+
+void
+zserv_rib_shm_delete (struct prefix *p, struct rib *rib)
+{
+  if (rib_shm == NULL || (p->family != AF_INET && p->family != AF_INET6))
+    return;
+
+  if (rib_shm_unset (rib_shm, p) == 0)
+    zserv_rib_shm_changed ();
+}
+
+static void
+zserv_rib_shm_export_table (afi_t afi)
+{
+  struct route_table *table;
+  struct route_node *rn;
+  struct rib *rib;
+
+  table = vrf_table (afi, SAFI_UNICAST, 0);
+  if (table == NULL)
+    return;
+
+  for (rn = route_top (table); rn; rn = route_next (rn))
+    for (rib = rn->info; rib; rib = rib->next)
+      if (CHECK_FLAG (rib->flags, ZEBRA_FLAG_SELECTED))
+        {
+          zserv_rib_shm_add (&rn->p, rib);
+          break;
+        }
+}
+
+DEFUN (rib_export_shm,
+       rib_export_shm_cmd,
+       "rib export shared-memory PATH",
+       "RIB configuration\n"
+       "Export the RIB to other daemons\n"
+       "Through a shared-memory file\n"
+       "Absolute path of the file\n")
+{
+  struct rib_shm *shm;
+
+  if (argv[0][0] != '/')
+    {
+      vty_out (vty, "%% The path must be absolute%s", VTY_NEWLINE);
+      return CMD_WARNING;
+    }
+  if (rib_shm && strcmp (rib_shm->path, argv[0]) == 0)
+    return CMD_SUCCESS;
+
+  shm = rib_shm_create (argv[0], RIB_SHM_SLOTS_DEFAULT, RIB_SHM_LOG_DEFAULT);
+  if (shm == NULL)
+    {
+      vty_out (vty, "%% Can't create %s: %s%s", argv[0],
+               safe_strerror (errno), VTY_NEWLINE);
+      return CMD_WARNING;
+    }
+
+  if (rib_shm)
+    rib_shm_destroy (rib_shm);
+  rib_shm = shm;
+
+  zserv_rib_shm_export_table (AFI_IP);
+#ifdef HAVE_IPV6
+  zserv_rib_shm_export_table (AFI_IP6);
+#endif /* HAVE_IPV6 */
+  zserv_rib_shm_changed ();
+
+  return CMD_SUCCESS;
+}
+
+DEFUN (no_rib_export_shm,
+       no_rib_export_shm_cmd,
+       "no rib export shared-memory",
+       NO_STR
+       "RIB configuration\n"
+       "Export the RIB to other daemons\n"
+       "Through a shared-memory file\n")
+{
+  struct listnode *node;
+  struct zserv *client;
+
+  if (rib_shm)
+    {
+      rib_shm_destroy (rib_shm);
+      rib_shm = NULL;
+
+      /* Clients drop the routes of the file before zserv sends them
+         again. */
+      for (ALL_LIST_ELEMENTS_RO (zebrad.client_list, node, client))
+        if (client->rib_shm_subscribed)
+          {
+            zsend_rib_shm_update (client, 0, 0, NULL);
+            zebra_redistribute_all (client);
+          }
+    }
+
+  return CMD_SUCCESS;
+}
+
+ALIAS (no_rib_export_shm,
+       no_rib_export_shm_path_cmd,
+       "no rib export shared-memory PATH",
+       NO_STR
+       "RIB configuration\n"
+       "Export the RIB to other daemons\n"
+       "Through a shared-memory file\n"
+       "Absolute path of the file\n")
+
+DEFUN (show_zebra_rib_export,
+       show_zebra_rib_export_cmd,
+       "show zebra rib-export",
+       SHOW_STR
+       "Zebra information\n"
+       "Shared-memory RIB export\n")
+{
+  struct listnode *node;
+  struct zserv *client;
+  unsigned int subscribed = 0;
+
+  if (rib_shm == NULL)
+    {
+      vty_out (vty, "The RIB is not exported%s", VTY_NEWLINE);
+      return CMD_SUCCESS;
+    }
+
+  for (ALL_LIST_ELEMENTS_RO (zebrad.client_list, node, client))
+    if (client->rib_shm_subscribed)
+      subscribed++;
+
+  vty_out (vty, "Exporting to %s (generation %u)%s", rib_shm->path,
+           rib_shm->header->generation, VTY_NEWLINE);
+  vty_out (vty, "  %u routes in %u slots, version %u, log of %u changes%s",
+           rib_shm->header->routes, rib_shm->header->slots,
+           rib_shm->header->version, rib_shm->header->log_size, VTY_NEWLINE);
+  vty_out (vty, "  %u clients notified of changes%s", subscribed,
+           VTY_NEWLINE);
+
+  return CMD_SUCCESS;
+}
+
+/* receive a shared-memory RIB subscribe/unsubscribe */
+int
+zserv_recv_rib_shm_subscribe (uint16_t cmd, struct zserv *client,
+                              uint16_t length)
+{
+  if (length)
+    {
+      zlog_err ("%s: invalid length: %u", __func__, length);
+      return -1;
+    }
+
+  switch (cmd)
+    {
+    case ZEBRA_RIB_SHM_SUBSCRIBE:
+      client->rib_shm_subscribed = 1;
+      /* the client syncs with the current version at once */
+      if (rib_shm)
+        return zsend_rib_shm_update (client, rib_shm->header->generation,
+                                     rib_shm->header->version,
+                                     rib_shm->path);
+      return zsend_rib_shm_update (client, 0, 0, NULL);
+
+    case ZEBRA_RIB_SHM_UNSUBSCRIBE:
+      if (client->rib_shm_subscribed)
+        {
+          client->rib_shm_subscribed = 0;
+          /* zserv sends the routes again */
+          if (rib_shm)
+            zebra_redistribute_all (client);
+        }
+      break;
+
+    default:
+      zlog_err ("%s: invalid zebra rib shm subscribe command: %u",
+                __func__, cmd);
+      return -1;
+    }
+
+  return 0;
+}
+
+int
+zserv_rib_shm_config_write (struct vty *vty)
+{
+  if (rib_shm)
+    vty_out (vty, "rib export shared-memory %s%s", rib_shm->path,
+             VTY_NEWLINE);
+  return 0;
+}
+
+void
+zserv_rib_shm_init (void)
+{
+  install_element (CONFIG_NODE, &rib_export_shm_cmd);
+  install_element (CONFIG_NODE, &no_rib_export_shm_cmd);
+  install_element (CONFIG_NODE, &no_rib_export_shm_path_cmd);
+  install_element (VIEW_NODE, &show_zebra_rib_export_cmd);
+  install_element (ENABLE_NODE, &show_zebra_rib_export_cmd);
+}
@@ -0,0 +1,40 @@
+/* Zebra shared-memory RIB export
+ *
+ * This file is part of GNU Zebra.
+ *
+ * GNU Zebra is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * GNU Zebra is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Zebra; see the file COPYING.  If not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef _ZSERV_RIB_SHM_H_
+#define _ZSERV_RIB_SHM_H_
+
+#include "zserv.h"
+
+struct vty;
+struct prefix;
+struct rib;
+
+void zserv_rib_shm_init (void);
+int zserv_rib_shm_config_write (struct vty *vty);
+
+void zserv_rib_shm_add (struct prefix *p, struct rib *rib);
+void zserv_rib_shm_delete (struct prefix *p, struct rib *rib);
+
+int zserv_rib_shm_serves (struct zserv *client);
+int zserv_recv_rib_shm_subscribe (uint16_t cmd, struct zserv *client,
+                                  uint16_t length);
+
+#endif	/* _ZSERV_RIB_SHM_H_ */